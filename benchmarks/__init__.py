@@ -0,0 +1 @@
+"""Benchmark suite for pymedia; see benchmarks/README.md."""
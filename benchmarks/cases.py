@@ -0,0 +1,482 @@
+"""Benchmark cases: at least one per public function and per native entry point.
+
+A case is one call on an `Inputs` clip. ``input`` names what the call
+consumes, which is what fps and MB/s are computed from:
+
+- ``video``: the clip (``units`` passes over it for multi-input calls);
+- ``audio``: the clip's soundtrack as WAV (no frame rate);
+- ``slides``: the PNG slides plus the encoded soundtrack (frames produced);
+- ``none``: tiny inputs such as fingerprints or subtitle text (time only).
+"""
+
+from __future__ import annotations
+
+import asyncio
+import re
+from dataclasses import dataclass
+from pathlib import Path
+from typing import Any, Callable
+
+import pymedia
+
+from .synthetic import SAMPLE_SRT, Inputs
+
+NATIVE_SOURCES = Path(__file__).resolve().parent.parent / "src" / "pymedia" / "_lib"
+
+# Public names that are not operations.
+NOT_TIMED = {
+    "SUPPORTED_BATCH_OPS",
+    "JOB_STATES",
+    "CancelToken",
+    "OperationCancelled",
+    "MediaJob",
+    "JobCancelledError",
+}
+
+
+@dataclass(frozen=True)
+class Case:
+    name: str
+    api: str  # public function (or native symbol) the case exercises
+    run: Callable[[Inputs], Any]
+    input: str = "video"
+    units: int = 1
+    needs_audio: bool = False  # reads the clip's own audio track
+
+
+def _iter_all_batches(m: Inputs) -> int:
+    return sum(len(ts) for _, ts in pymedia.iter_frame_batches(m.video, batch_size=16))
+
+
+def _batch_run(m: Inputs) -> int:
+    sizes = []
+    jobs = [("extract_frame", m.video, {"timestamp": t, "format": "png"}) for t in (0.5, 1.5)]
+    pymedia.batch_run(jobs, lambda index, out: sizes.append(len(out)))
+    return sum(sizes)
+
+
+def _submit_jobs(m: Inputs) -> list:
+    jobs = [
+        pymedia.submit_job("trim_video", m.video, start=0.5, end=m.duration - 0.5) for _ in range(4)
+    ]
+    results = [job.result() for job in jobs]
+    jobs[0].stats()
+    return results
+
+
+async def _gather_async(m: Inputs) -> list:
+    return await asyncio.gather(
+        *(
+            pymedia.run_async("compress_video", m.video, crf=30, preset="ultrafast")
+            for _ in range(2)
+        )
+    )
+
+
+def _cancelled_job(m: Inputs) -> None:
+    job = pymedia.submit_job("compress_video", m.video, crf=28, preset="medium")
+    job.progress()
+    job.cancel()
+    job.done()
+    try:
+        job.result()
+    except pymedia.JobCancelledError:
+        pass
+
+
+def _controlled_compress(m: Inputs) -> bytes:
+    """compress_video[medium] with every control attached, to time their overhead."""
+    return pymedia.compress_video(
+        m.video,
+        crf=28,
+        preset="medium",
+        progress=lambda *_: None,
+        cancel=pymedia.CancelToken(),
+        stats={},
+    )
+
+
+def _cancel_halfway(m: Inputs) -> None:
+    """Time to stop: cancels from the progress callback at 50%."""
+    token = pymedia.CancelToken()
+
+    def progress(processed: float, duration: float) -> None:
+        if processed >= duration / 2:
+            token.cancel()
+
+    try:
+        pymedia.compress_video(m.video, crf=28, preset="medium", progress=progress, cancel=token)
+    except pymedia.OperationCancelled:
+        pass
+
+
+CASES: list[Case] = [
+    # ── info / analysis ──
+    Case("get_video_info", "get_video_info", lambda m: pymedia.get_video_info(m.video)),
+    Case("list_keyframes", "list_keyframes", lambda m: pymedia.list_keyframes(m.video)),
+    Case("detect_scenes", "detect_scenes", lambda m: pymedia.detect_scenes(m.video)),
+    Case(
+        "detect_scenes[keyframes_only]",
+        "detect_scenes",
+        lambda m: pymedia.detect_scenes(m.video, keyframes_only=True),
+    ),
+    Case("video_fingerprint", "video_fingerprint", lambda m: pymedia.video_fingerprint(m.video)),
+    Case(
+        "fingerprint_similarity",
+        "fingerprint_similarity",
+        lambda m: pymedia.fingerprint_similarity(m.fingerprint, m.fingerprint),
+        input="none",
+    ),
+    Case(
+        "trim_to_keyframes",
+        "trim_to_keyframes",
+        lambda m: pymedia.trim_to_keyframes(m.video, 0.5, m.duration - 0.5),
+    ),
+    Case(
+        "frame_accurate_trim",
+        "frame_accurate_trim",
+        lambda m: pymedia.frame_accurate_trim(m.video, 0.3, m.duration - 0.3),
+    ),
+    Case(
+        "render_edl",
+        "render_edl",
+        lambda m: pymedia.render_edl(
+            m.video, [(0.1 * m.duration, 0.3 * m.duration), (0.5 * m.duration, 0.9 * m.duration)]
+        ),
+    ),
+    # ── batch / jobs / control ──
+    Case(
+        "batch_map[compress x4]",
+        "batch_map",
+        lambda m: pymedia.batch_map(
+            [("compress_video", m.video, {"crf": 30, "preset": "ultrafast"})] * 4
+        ),
+        units=4,
+    ),
+    Case("batch_run[extract_frame x2]", "batch_run", _batch_run, units=2),
+    Case("submit_job[trim x4]", "submit_job", _submit_jobs, units=4),
+    Case("run_async[compress x2]", "run_async", lambda m: asyncio.run(_gather_async(m)), units=2),
+    Case("submit_job[cancelled]", "submit_job", _cancelled_job),
+    Case("compress_video[medium+controls]", "compress_video", _controlled_compress),
+    Case("compress_video[cancel at 50%]", "compress_video", _cancel_halfway),
+    # ── audio ──
+    Case(
+        "extract_audio[mp3]",
+        "extract_audio",
+        lambda m: pymedia.extract_audio(m.video, "mp3"),
+        needs_audio=True,
+    ),
+    Case(
+        "extract_audio[wav]",
+        "extract_audio",
+        lambda m: pymedia.extract_audio(m.video, "wav"),
+        needs_audio=True,
+    ),
+    Case(
+        "adjust_volume",
+        "adjust_volume",
+        lambda m: pymedia.adjust_volume(m.video, 0.5),
+        needs_audio=True,
+    ),
+    Case(
+        "normalize_loudness",
+        "normalize_loudness",
+        lambda m: pymedia.normalize_loudness(m.video),
+        needs_audio=True,
+    ),
+    Case(
+        "mix_audio_tracks",
+        "mix_audio_tracks",
+        lambda m: pymedia.mix_audio_tracks(m.video, [m.wav], duck_track=1),
+        needs_audio=True,
+    ),
+    Case(
+        "fade_audio",
+        "fade_audio",
+        lambda m: pymedia.fade_audio(m.wav, in_sec=0.5, out_sec=0.5),
+        input="audio",
+    ),
+    Case(
+        "crossfade_audio",
+        "crossfade_audio",
+        lambda m: pymedia.crossfade_audio(m.wav, m.wav, duration=0.5),
+        input="audio",
+        units=2,
+    ),
+    Case(
+        "normalize_audio_lufs",
+        "normalize_audio_lufs",
+        lambda m: pymedia.normalize_audio_lufs(m.wav),
+        input="audio",
+    ),
+    Case(
+        "change_audio_bitrate",
+        "change_audio_bitrate",
+        lambda m: pymedia.change_audio_bitrate(m.wav, 96000),
+        input="audio",
+    ),
+    Case(
+        "resample_audio",
+        "resample_audio",
+        lambda m: pymedia.resample_audio(m.wav, 16000, channels=1, format="wav"),
+        input="audio",
+    ),
+    Case(
+        "silence_detect", "silence_detect", lambda m: pymedia.silence_detect(m.wav), input="audio"
+    ),
+    Case(
+        "silence_remove", "silence_remove", lambda m: pymedia.silence_remove(m.wav), input="audio"
+    ),
+    Case(
+        "audio_peaks",
+        "audio_peaks",
+        lambda m: pymedia.audio_peaks(m.wav, samples_per_pixel=(256, 1024)),
+        input="audio",
+    ),
+    Case(
+        "audio_spectrogram",
+        "audio_spectrogram",
+        lambda m: pymedia.audio_spectrogram(m.wav),
+        input="audio",
+    ),
+    *(
+        Case(
+            f"transcode_audio[{fmt}]",
+            "transcode_audio",
+            lambda m, fmt=fmt: pymedia.transcode_audio(m.wav, format=fmt),
+            input="audio",
+        )
+        for fmt in ("aac", "mp3", "opus", "flac")
+    ),
+    Case(
+        "mix_audio",
+        "mix_audio",
+        lambda m: pymedia.mix_audio([m.wav, m.wav], weights=[0.7, 0.3]),
+        input="audio",
+        units=2,
+    ),
+    # ── video: remux / encode ──
+    Case("convert_format[mkv]", "convert_format", lambda m: pymedia.convert_format(m.video, "mkv")),
+    Case("convert_format[mov]", "convert_format", lambda m: pymedia.convert_format(m.video, "mov")),
+    Case("transcode_video", "transcode_video", lambda m: pymedia.transcode_video(m.video, crf=23)),
+    Case(
+        "transcode_video[bitrate]",
+        "transcode_video",
+        lambda m: pymedia.transcode_video(m.video, video_bitrate=2_000_000),
+    ),
+    *(
+        Case(
+            f"compress_video[{preset}]",
+            "compress_video",
+            lambda m, preset=preset: pymedia.compress_video(m.video, crf=28, preset=preset),
+        )
+        for preset in ("ultrafast", "medium")
+    ),
+    Case(
+        "compress_video[segments=4]",
+        "compress_video",
+        lambda m: pymedia.compress_video(m.video, crf=28, preset="veryfast", segments=4),
+    ),
+    Case("change_fps", "change_fps", lambda m: pymedia.change_fps(m.video, 15)),
+    Case(
+        "resize_video",
+        "resize_video",
+        lambda m: pymedia.resize_video(m.video, m.even(m.width / 2), m.even(m.height / 2)),
+    ),
+    Case(
+        "crop_video",
+        "crop_video",
+        lambda m: pymedia.crop_video(
+            m.video, 0, 0, m.even(m.width * 3 / 4), m.even(m.height * 3 / 4)
+        ),
+    ),
+    Case(
+        "pad_video",
+        "pad_video",
+        lambda m: pymedia.pad_video(m.video, m.width + 64, m.height + 64, x=32, y=32),
+    ),
+    Case("flip_video", "flip_video", lambda m: pymedia.flip_video(m.video, horizontal=True)),
+    Case(
+        "create_audio_image_video",
+        "create_audio_image_video",
+        lambda m: pymedia.create_audio_image_video(
+            m.audio,
+            m.slides,
+            seconds_per_image=m.profile.seconds_per_image,
+            transition=m.profile.transition,
+            width=m.width,
+            height=m.height,
+        ),
+        input="slides",
+    ),
+    # ── video: editing ──
+    Case(
+        "trim_video",
+        "trim_video",
+        lambda m: pymedia.trim_video(m.video, 0.5, m.duration - 0.5),
+    ),
+    Case("cut_video", "cut_video", lambda m: pymedia.cut_video(m.video, 0.5, m.duration / 2)),
+    Case(
+        "split_video",
+        "split_video",
+        lambda m: pymedia.split_video(m.video, segment_duration=1.0),
+    ),
+    Case("mute_video", "mute_video", lambda m: pymedia.mute_video(m.video)),
+    Case("replace_audio", "replace_audio", lambda m: pymedia.replace_audio(m.video, m.audio)),
+    Case(
+        "change_video_audio",
+        "change_video_audio",
+        lambda m: pymedia.change_video_audio(m.video, m.audio),
+    ),
+    Case("rotate_video", "rotate_video", lambda m: pymedia.rotate_video(m.video, 90)),
+    Case("change_speed", "change_speed", lambda m: pymedia.change_speed(m.video, 1.5)),
+    Case("reverse_video", "reverse_video", lambda m: pymedia.reverse_video(m.video)),
+    Case(
+        "merge_videos",
+        "merge_videos",
+        lambda m: pymedia.merge_videos(m.video, m.video),
+        units=2,
+    ),
+    Case(
+        "concat_videos[x3]",
+        "concat_videos",
+        lambda m: pymedia.concat_videos([m.video] * 3),
+        units=3,
+    ),
+    # ── video: effects / composition ──
+    Case("blur_video", "blur_video", lambda m: pymedia.blur_video(m.video, sigma=2.0)),
+    Case("denoise_video", "denoise_video", lambda m: pymedia.denoise_video(m.video)),
+    Case("sharpen_video", "sharpen_video", lambda m: pymedia.sharpen_video(m.video)),
+    Case(
+        "color_correct",
+        "color_correct",
+        lambda m: pymedia.color_correct(m.video, brightness=0.05, contrast=1.1, saturation=1.2),
+    ),
+    Case("apply_lut", "apply_lut", lambda m: pymedia.apply_lut(m.video, b"gamma=1.2\n")),
+    Case(
+        "apply_filtergraph",
+        "apply_filtergraph",
+        lambda m: pymedia.apply_filtergraph(m.video, video_filters="blur=1.5,brightness=0.05"),
+    ),
+    Case(
+        "add_watermark",
+        "add_watermark",
+        lambda m: pymedia.add_watermark(m.video, m.logo, x=16, y=16, opacity=0.6),
+    ),
+    Case(
+        "overlay_video",
+        "overlay_video",
+        lambda m: pymedia.overlay_video(
+            m.video, m.video, 16, 16, width=m.even(m.width / 4), height=m.even(m.height / 4)
+        ),
+    ),
+    Case(
+        "stack_videos[hstack]",
+        "stack_videos",
+        lambda m: pymedia.stack_videos([m.video, m.video], layout="hstack"),
+        units=2,
+    ),
+    Case(
+        "split_screen[2x2]",
+        "split_screen",
+        lambda m: pymedia.split_screen([m.video] * 4, layout="2x2"),
+        units=4,
+    ),
+    Case("stabilize_video", "stabilize_video", lambda m: pymedia.stabilize_video(m.video)),
+    Case(
+        "subtitle_burn_in",
+        "subtitle_burn_in",
+        lambda m: pymedia.subtitle_burn_in(m.video, SAMPLE_SRT),
+    ),
+    Case("video_to_gif", "video_to_gif", lambda m: pymedia.video_to_gif(m.video)),
+    # ── frames ──
+    Case(
+        "extract_frame[exact]",
+        "extract_frame",
+        lambda m: pymedia.extract_frame(m.video, m.duration / 2),
+    ),
+    Case(
+        "extract_frame[keyframe]",
+        "extract_frame",
+        lambda m: pymedia.extract_frame(m.video, m.duration / 2, accuracy="keyframe"),
+    ),
+    Case(
+        "extract_frame_raw",
+        "extract_frame_raw",
+        lambda m: pymedia.extract_frame_raw(m.video, m.duration / 2),
+    ),
+    Case("iter_frame_batches", "iter_frame_batches", _iter_all_batches),
+    Case("extract_frames", "extract_frames", lambda m: pymedia.extract_frames(m.video, 0.5)),
+    Case("create_thumbnail", "create_thumbnail", lambda m: pymedia.create_thumbnail(m.video)),
+    Case("generate_preview", "generate_preview", lambda m: pymedia.generate_preview(m.video)),
+    # ── metadata ──
+    Case("strip_metadata", "strip_metadata", lambda m: pymedia.strip_metadata(m.video)),
+    Case(
+        "set_metadata",
+        "set_metadata",
+        lambda m: pymedia.set_metadata(m.video, "title", "benchmark"),
+    ),
+    # ── streaming ──
+    Case(
+        "create_fragmented_mp4",
+        "create_fragmented_mp4",
+        lambda m: pymedia.create_fragmented_mp4(m.video),
+    ),
+    Case("stream_copy", "stream_copy", lambda m: pymedia.stream_copy(m.video)),
+    Case(
+        "probe_media[packets+frames]",
+        "probe_media",
+        lambda m: pymedia.probe_media(m.video, packets=True, frames=True),
+    ),
+    Case(
+        "analyze_loudness",
+        "analyze_loudness",
+        lambda m: pymedia.analyze_loudness(m.video),
+        needs_audio=True,
+    ),
+    Case("analyze_gop", "analyze_gop", lambda m: pymedia.analyze_gop(m.video)),
+    Case("detect_vfr_cfr", "detect_vfr_cfr", lambda m: pymedia.detect_vfr_cfr(m.video)),
+    Case("package_hls", "package_hls", lambda m: pymedia.package_hls(m.video, segment_time=1)),
+    Case("package_dash", "package_dash", lambda m: pymedia.package_dash(m.video, segment_time=1)),
+    # ── subtitles ──
+    Case(
+        "convert_subtitles",
+        "convert_subtitles",
+        lambda m: pymedia.convert_subtitles(SAMPLE_SRT),
+        input="none",
+    ),
+    Case(
+        "add_subtitle_track",
+        "add_subtitle_track",
+        lambda m: pymedia.add_subtitle_track(m.video, SAMPLE_SRT, codec=m.subtitle_codec),
+    ),
+    Case(
+        "extract_subtitles",
+        "extract_subtitles",
+        lambda m: pymedia.extract_subtitles(m.subtitled),
+    ),
+    Case(
+        "remove_subtitle_tracks",
+        "remove_subtitle_tracks",
+        lambda m: pymedia.remove_subtitle_tracks(m.subtitled),
+    ),
+]
+
+
+def native_symbols() -> list[str]:
+    """Every `PYMEDIA_API` entry point declared in the native sources."""
+    pattern = re.compile(r"^PYMEDIA_API\b[^(;]*?\**\s*\b(\w+)\s*\(", re.M)
+    names = set()
+    for path in NATIVE_SOURCES.rglob("*.c"):
+        names.update(pattern.findall(path.read_text(encoding="utf-8")))
+    return sorted(names)
+
+
+def missing_wrappers() -> list[str]:
+    """Public functions that no case exercises."""
+    covered = {case.api for case in CASES}
+    return sorted(
+        name
+        for name in pymedia.__all__
+        if name not in NOT_TIMED and callable(getattr(pymedia, name)) and name not in covered
+    )
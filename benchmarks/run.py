@@ -0,0 +1,345 @@
+"""Time every benchmark case on synthetic inputs and report JSON.
+
+    python -m benchmarks.run --resolutions 480p,1080p --output results.json
+    python -m benchmarks.run --compare results.json --filter "compress_video*"
+
+Each case runs once untimed (warm-up, per-stage statistics and the native
+entry points it reaches) and then ``--repeat`` timed times. Reported per
+case and input: median/min/max wall time, median CPU time, fps, MB/s,
+peak RSS and output size. A progress line per case goes to stderr.
+"""
+
+from __future__ import annotations
+
+import argparse
+import contextlib
+import ctypes
+import fnmatch
+import functools
+import json
+import os
+import platform
+import statistics
+import sys
+import time
+from datetime import datetime, timezone
+from typing import Any, Callable
+
+from pymedia._core import _PROGRESS_CALLBACK, _lib
+
+from .cases import CASES, Case, missing_wrappers, native_symbols
+from .synthetic import PROFILES, RESOLUTIONS, Inputs
+
+SCHEMA_VERSION = 1
+
+# Bound before any recording so the harness's own statistics calls are not
+# attributed to the cases.
+_control_new = _lib.pymedia_control_new
+_control_enable_stats = _lib.pymedia_control_enable_stats
+_control_bind = _lib.pymedia_control_bind
+_control_stats_json = _lib.pymedia_control_stats_json
+_control_free = _lib.pymedia_control_free
+_free = _lib.pymedia_free
+
+
+# ---------- measurement ----------
+
+
+def _reset_peak_rss() -> bool:
+    """Reset the kernel's peak-RSS watermark (Linux); False if unsupported."""
+    try:
+        with open("/proc/self/clear_refs", "w") as f:
+            f.write("5")
+        return True
+    except OSError:
+        return False
+
+
+def _rss_bytes(field: str) -> int | None:
+    try:
+        with open("/proc/self/status") as f:
+            for line in f:
+                if line.startswith(field + ":"):
+                    return int(line.split()[1]) * 1024
+    except OSError:
+        pass
+    return None
+
+
+def _process_peak_rss() -> int | None:
+    try:
+        import resource
+    except ImportError:  # Windows
+        return None
+    peak = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+    return peak if sys.platform == "darwin" else peak * 1024
+
+
+def _stage_stats(run: Callable[[], Any]) -> dict:
+    """Run under a bound native control and return its per-stage statistics."""
+    control = _control_new(_PROGRESS_CALLBACK(), None)
+    if not control:
+        raise MemoryError("Could not allocate operation control")
+    _control_enable_stats(control)
+    previous = _control_bind(control)
+    try:
+        run()
+    finally:
+        _control_bind(previous)
+        ptr = _control_stats_json(control)
+        stats = json.loads(ctypes.string_at(ptr).decode("utf-8")) if ptr else {}
+        if ptr:
+            _free(ptr)
+        _control_free(control)
+    # Only stages the call went through.
+    stats["stages"] = {k: v for k, v in stats.get("stages", {}).items() if v.get("calls")}
+    return stats
+
+
+@contextlib.contextmanager
+def _record_native_calls(names: list[str], seen: set[str]):
+    """Route the listed `_lib` symbols through recorders that add to `seen`."""
+    originals = {name: getattr(_lib, name) for name in names if hasattr(_lib, name)}
+
+    def recorder(name, fn):
+        @functools.wraps(fn)
+        def call(*args):
+            seen.add(name)
+            return fn(*args)
+
+        return call
+
+    for name, fn in originals.items():
+        setattr(_lib, name, recorder(name, fn))
+    try:
+        yield
+    finally:
+        for name, fn in originals.items():
+            setattr(_lib, name, fn)
+
+
+def _output_size(result: Any) -> int | None:
+    if isinstance(result, (bytes, bytearray)):
+        return len(result)
+    if isinstance(result, (list, tuple)) and all(isinstance(r, (bytes, bytearray)) for r in result):
+        return sum(len(r) for r in result)
+    return None
+
+
+def _work(case: Case, m: Inputs) -> tuple[int | None, int | None]:
+    """Input bytes and video frames one call of `case` consumes."""
+    if case.input == "video":
+        return len(m.video) * case.units, m.frames * case.units
+    if case.input == "audio":
+        return len(m.wav) * case.units, None
+    if case.input == "slides":
+        return sum(len(s) for s in m.slides) + len(m.audio), m.frames
+    return None, None
+
+
+def run_case(case: Case, m: Inputs, repeat: int, symbols: list[str]) -> dict[str, Any]:
+    entry: dict[str, Any] = {"case": case.name, "api": case.api, "input": m.id}
+    if case.needs_audio and not m.has_audio:
+        entry["skipped"] = "input has no audio track"
+        return entry
+
+    seen: set[str] = set()
+    try:
+        with _record_native_calls(symbols, seen):
+            entry["stats"] = _stage_stats(lambda: case.run(m))
+        entry["native"] = sorted(seen)
+
+        wall, cpu, peaks = [], [], []
+        result = None
+        for _ in range(repeat):
+            result = None  # drop the previous output before measuring
+            per_case = _reset_peak_rss()
+            started, started_cpu = time.perf_counter(), time.process_time()
+            result = case.run(m)
+            wall.append(time.perf_counter() - started)
+            cpu.append(time.process_time() - started_cpu)
+            peaks.append(_rss_bytes("VmHWM") if per_case else _process_peak_rss())
+    except Exception as exc:
+        entry["error"] = f"{type(exc).__name__}: {exc}"
+        entry.setdefault("native", sorted(seen))
+        return entry
+
+    median = statistics.median(wall)
+    in_bytes, frames = _work(case, m)
+    peak = max((p for p in peaks if p is not None), default=None)
+    entry.update(
+        runs=len(wall),
+        median_s=round(median, 6),
+        min_s=round(min(wall), 6),
+        max_s=round(max(wall), 6),
+        cpu_s=round(statistics.median(cpu), 6),
+        fps=round(frames / median, 2) if frames and median > 0 else None,
+        mb_per_s=round(in_bytes / 1e6 / median, 3) if in_bytes and median > 0 else None,
+        input_bytes=in_bytes,
+        output_bytes=_output_size(result),
+        peak_rss_mb=round(peak / 2**20, 1) if peak is not None else None,
+    )
+    return entry
+
+
+# ---------- comparison ----------
+
+
+def compare(results: list[dict], baseline: dict, threshold: float) -> list[str]:
+    """Cases whose median wall time grew by more than `threshold` (0.1 = 10%)."""
+    before = {
+        (r["case"], r["input"]): r["median_s"]
+        for r in baseline.get("results", [])
+        if "median_s" in r
+    }
+    regressions = []
+    for r in results:
+        old = before.get((r["case"], r["input"]))
+        if old and "median_s" in r and r["median_s"] > old * (1 + threshold):
+            regressions.append(
+                f"{r['input']:<18} {r['case']:<38} {old * 1e3:9.1f} ms -> "
+                f"{r['median_s'] * 1e3:9.1f} ms ({r['median_s'] / old - 1:+.0%})"
+            )
+    return regressions
+
+
+# ---------- driver ----------
+
+
+def _choices(value: str, known: dict, what: str) -> list[str]:
+    names = list(known) if value == "all" else [v.strip() for v in value.split(",") if v.strip()]
+    unknown = [n for n in names if n not in known]
+    if unknown:
+        raise SystemExit(f"unknown {what}: {', '.join(unknown)} (known: {', '.join(known)})")
+    return names
+
+
+def _host() -> dict[str, Any]:
+    try:
+        from importlib.metadata import version
+
+        pymedia_version = version("python-media")
+    except Exception:
+        pymedia_version = None
+    return {
+        "platform": platform.platform(),
+        "machine": platform.machine(),
+        "processor": platform.processor(),
+        "cpu_count": os.cpu_count(),
+        "python": platform.python_version(),
+        "pymedia": pymedia_version,
+    }
+
+
+def _summary_line(r: dict) -> str:
+    head = f"{r['input']:<18} {r['case']:<38}"
+    if "skipped" in r:
+        return f"{head} skipped: {r['skipped']}"
+    if "error" in r:
+        return f"{head} ERROR {r['error']}"
+    fps = f"{r['fps']:8.1f} fps" if r["fps"] else " " * 12
+    mbps = f"{r['mb_per_s']:8.2f} MB/s" if r["mb_per_s"] else " " * 13
+    rss = f"{r['peak_rss_mb']:7.1f} MB" if r["peak_rss_mb"] is not None else ""
+    return f"{head} {r['median_s'] * 1e3:9.1f} ms {fps} {mbps} {rss}"
+
+
+def main(argv: list[str] | None = None) -> int:
+    parser = argparse.ArgumentParser(
+        prog="python -m benchmarks.run", description=__doc__.split("\n")[0]
+    )
+    parser.add_argument(
+        "--resolutions",
+        default="480p,1080p",
+        help=f"comma-separated, or 'all' ({', '.join(RESOLUTIONS)})",
+    )
+    parser.add_argument(
+        "--profiles",
+        default="baseline",
+        help=f"comma-separated, or 'all' ({', '.join(PROFILES)})",
+    )
+    parser.add_argument("--duration", type=float, default=4.0, help="clip length in seconds")
+    parser.add_argument("--repeat", type=int, default=3, help="timed runs per case")
+    parser.add_argument("--filter", default="*", help="comma-separated glob(s) on case names")
+    parser.add_argument("--output", default="-", help="JSON report path ('-': stdout)")
+    parser.add_argument("--compare", metavar="BASELINE", help="earlier JSON report to diff against")
+    parser.add_argument(
+        "--threshold",
+        type=float,
+        default=0.15,
+        help="slowdown that counts as a regression with --compare (default: 0.15)",
+    )
+    parser.add_argument("--list", action="store_true", help="list case names and exit")
+    args = parser.parse_args(argv)
+
+    patterns = [p.strip() for p in args.filter.split(",") if p.strip()]
+    cases = [c for c in CASES if any(fnmatch.fnmatchcase(c.name, p) for p in patterns)]
+    if args.list:
+        for case in cases:
+            print(case.name)
+        return 0
+    if not cases:
+        raise SystemExit(f"no case matches {args.filter!r}")
+    if args.repeat < 1 or args.duration < 2.0:
+        raise SystemExit("--repeat must be >= 1 and --duration >= 2.0")
+    resolutions = _choices(args.resolutions, RESOLUTIONS, "resolution")
+    profiles = _choices(args.profiles, PROFILES, "profile")
+    symbols = native_symbols()
+
+    per_case_rss = _reset_peak_rss()
+    inputs, results = [], []
+    for resolution in resolutions:
+        for name in profiles:
+            print(f"generating {resolution}/{name} ...", file=sys.stderr, flush=True)
+            m = Inputs(resolution, PROFILES[name], args.duration)
+            inputs.append(m.describe())
+            for case in cases:
+                entry = run_case(case, m, args.repeat, symbols)
+                results.append(entry)
+                print(_summary_line(entry), file=sys.stderr, flush=True)
+            del m
+
+    reached = set().union(*(r.get("native", ()) for r in results))
+    report = {
+        "schema": SCHEMA_VERSION,
+        "created": datetime.now(timezone.utc).isoformat(timespec="seconds"),
+        "host": _host(),
+        "config": {
+            "resolutions": resolutions,
+            "profiles": profiles,
+            "duration": args.duration,
+            "repeat": args.repeat,
+            "filter": args.filter,
+        },
+        # "case": peak RSS was reset before each timed run; "process": it is
+        # the process-wide high-water mark so far (non-Linux).
+        "rss_scope": "case" if per_case_rss else "process",
+        "inputs": inputs,
+        "results": results,
+        "coverage": {
+            "wrappers_missing": missing_wrappers(),
+            "native_symbols": len(symbols),
+            "native_missing": [s for s in symbols if s not in reached],
+        },
+    }
+
+    text = json.dumps(report, indent=2)
+    if args.output == "-":
+        print(text)
+    else:
+        with open(args.output, "w", encoding="utf-8") as f:
+            f.write(text + "\n")
+
+    failed = [r for r in results if "error" in r]
+    status = 1 if failed else 0
+    if args.compare:
+        with open(args.compare, encoding="utf-8") as f:
+            regressions = compare(results, json.load(f), args.threshold)
+        for line in regressions:
+            print(f"REGRESSION {line}", file=sys.stderr)
+        if regressions:
+            status = 1
+    return status
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,247 @@
+"""Deterministic synthetic inputs for the benchmark suite.
+
+Everything is generated in-process through pymedia itself: slides are
+written as PNG with `zlib`, the soundtrack as WAV with `wave`, and the two
+are assembled by `create_audio_image_video`. No fixtures, network or
+`ffmpeg` binary are involved, and a given resolution/profile/duration
+always produces the same media on the same FFmpeg build.
+"""
+
+from __future__ import annotations
+
+import functools
+import io
+import math
+import random
+import struct
+import time
+import wave
+import zlib
+from array import array
+from dataclasses import asdict, dataclass
+from typing import Any
+
+import pymedia
+
+SLIDESHOW_FPS = 25
+
+RESOLUTIONS: dict[str, tuple[int, int]] = {
+    "480p": (854, 480),
+    "1080p": (1920, 1080),
+    "4k": (3840, 2160),
+}
+
+
+@dataclass(frozen=True)
+class Profile:
+    """How one synthetic input is encoded.
+
+    The H.264 encoder settings pymedia exposes are the x264 preset and CRF,
+    so the GOP structure is steered through the content: hard cuts
+    (``transition="none"``) make x264 place a keyframe at every slide, while
+    fades keep one long GOP. ``preset`` re-encodes the slideshow (which is
+    always x264 ``medium``) with `compress_video`; ``ultrafast`` drops
+    B-frames and CABAC.
+    """
+
+    name: str
+    description: str
+    seconds_per_image: float = 1.0
+    transition: str = "fade"
+    content: str = "gradient"  # gradient | noise
+    preset: str | None = None  # None: keep the slideshow encode
+    audio_codec: str | None = "aac"  # aac | mp3 | None (no audio track)
+    sample_rate: int = 48000
+    channels: int = 2
+    container: str = "mp4"  # mp4 | mkv | mov
+
+
+PROFILES: dict[str, Profile] = {
+    p.name: p
+    for p in (
+        Profile("baseline", "long GOP, fades, AAC 48 kHz stereo, MP4"),
+        Profile(
+            "short-gop",
+            "hard cut every 0.5 s (keyframe per cut), AAC 48 kHz stereo",
+            seconds_per_image=0.5,
+            transition="none",
+        ),
+        Profile("motion", "sliding transitions", transition="slide_left"),
+        Profile(
+            "noise",
+            "high-entropy slides (large frames, high bitrate)",
+            content="noise",
+        ),
+        Profile(
+            "ultrafast",
+            "x264 ultrafast re-encode (no B-frames, CAVLC), AAC 22.05 kHz mono",
+            preset="ultrafast",
+            sample_rate=22050,
+            channels=1,
+        ),
+        Profile(
+            "mp3-mkv",
+            "MP3 44.1 kHz stereo in Matroska",
+            audio_codec="mp3",
+            sample_rate=44100,
+            container="mkv",
+        ),
+        Profile("silent", "no audio track", audio_codec=None),
+    )
+}
+
+
+# ---------- primitives ----------
+
+
+def png_image(width: int, height: int, seed: int, content: str = "gradient") -> bytes:
+    """Return an RGB PNG: a diagonal colour gradient or seeded noise."""
+    rng = random.Random(seed)
+    stride = width * 3
+    if content == "noise":
+        pool = [rng.getrandbits(8 * stride).to_bytes(stride, "little") for _ in range(61)]
+        rows = [pool[rng.randrange(len(pool))] for _ in range(height)]
+    else:
+        r0, g0, b0 = (rng.randrange(256) for _ in range(3))
+        base = bytearray(stride)
+        for x in range(width):
+            t = x * 255 // max(width - 1, 1)
+            base[3 * x] = (r0 + t) & 255
+            base[3 * x + 1] = (g0 + t // 2) & 255
+            base[3 * x + 2] = (b0 - t) & 255
+        base = bytes(base)
+        rows = []
+        for y in range(height):
+            shift = 3 * ((y * width // max(height, 1)) % width)
+            rows.append(base[shift:] + base[:shift])
+    raw = b"".join(b"\x00" + row for row in rows)
+
+    def chunk(tag: bytes, data: bytes) -> bytes:
+        body = tag + data
+        return struct.pack(">I", len(data)) + body + struct.pack(">I", zlib.crc32(body))
+
+    header = struct.pack(">IIBBBBB", width, height, 8, 2, 0, 0, 0)
+    return (
+        b"\x89PNG\r\n\x1a\n"
+        + chunk(b"IHDR", header)
+        + chunk(b"IDAT", zlib.compress(raw, 1))
+        + chunk(b"IEND", b"")
+    )
+
+
+def wav_tone(duration: float, sample_rate: int = 48000, channels: int = 2) -> bytes:
+    """Return 16-bit PCM: a two-partial tone stepping in pitch every 0.5 s,
+    with 0.4 s of silence every 2 s so silence analysis has work to do."""
+    frames = int(duration * sample_rate)
+    samples = array("h", bytes(2 * frames * channels))
+    for i in range(frames):
+        t = i / sample_rate
+        if t % 2.0 >= 1.6:
+            continue
+        f = 220.0 * (1 + int(t * 2) % 4)
+        v = 0.45 * math.sin(2 * math.pi * f * t) + 0.15 * math.sin(2 * math.pi * 3.01 * f * t)
+        s = int(v * 32767)
+        for c in range(channels):
+            samples[i * channels + c] = s
+    out = io.BytesIO()
+    with wave.open(out, "wb") as wf:
+        wf.setnchannels(channels)
+        wf.setsampwidth(2)
+        wf.setframerate(sample_rate)
+        wf.writeframes(samples.tobytes())
+    return out.getvalue()
+
+
+SAMPLE_SRT = (
+    "1\n00:00:00,200 --> 00:00:01,400\nSynthetic benchmark input\n\n"
+    "2\n00:00:01,600 --> 00:00:03,000\nSecond cue with a longer line of text\n"
+)
+
+
+# ---------- inputs ----------
+
+
+class Inputs:
+    """One synthetic clip plus everything derived from it that cases need.
+
+    Derived inputs are built on first use and are not part of any timing.
+    """
+
+    def __init__(self, resolution: str, profile: Profile, duration: float):
+        self.resolution = resolution
+        self.profile = profile
+        self.duration = duration
+        self.width, self.height = RESOLUTIONS[resolution]
+        self.id = f"{resolution}/{profile.name}"
+
+        started = time.perf_counter()
+        count = max(2, int(math.ceil(duration / profile.seconds_per_image)))
+        self.slides = [
+            png_image(self.width, self.height, seed=i + 1, content=profile.content)
+            for i in range(count)
+        ]
+        self.wav = wav_tone(duration, profile.sample_rate, profile.channels)
+        self.audio = pymedia.transcode_audio(
+            self.wav,
+            format=profile.audio_codec or "aac",
+            sample_rate=profile.sample_rate,
+            channels=profile.channels,
+        )
+        video = pymedia.create_audio_image_video(
+            self.audio,
+            self.slides,
+            seconds_per_image=profile.seconds_per_image,
+            transition=profile.transition,
+            width=self.width,
+            height=self.height,
+        )
+        if profile.preset:
+            video = pymedia.compress_video(video, crf=20, preset=profile.preset)
+        if profile.audio_codec is None:
+            video = pymedia.mute_video(video)
+        if profile.container != "mp4":
+            video = pymedia.convert_format(video, profile.container)
+        self.video = video
+        self.generate_s = time.perf_counter() - started
+
+        self.info = pymedia.get_video_info(video)
+        self.frames = int(round(self.info["fps"] * self.info["duration"]))
+        self.keyframes = len(pymedia.list_keyframes(video))
+
+    @property
+    def has_audio(self) -> bool:
+        return bool(self.info.get("has_audio"))
+
+    def even(self, value: float) -> int:
+        return max(2, int(value) & ~1)
+
+    @functools.cached_property
+    def logo(self) -> bytes:
+        return png_image(self.even(self.width / 8), self.even(self.height / 8), seed=99)
+
+    @functools.cached_property
+    def fingerprint(self) -> bytes:
+        return pymedia.video_fingerprint(self.video)
+
+    @property
+    def subtitle_codec(self) -> str:
+        return "subrip" if self.profile.container == "mkv" else "mov_text"
+
+    @functools.cached_property
+    def subtitled(self) -> bytes:
+        return pymedia.add_subtitle_track(self.video, SAMPLE_SRT, codec=self.subtitle_codec)
+
+    def describe(self) -> dict[str, Any]:
+        keys = ("video_codec", "audio_codec", "fps", "duration", "bitrate", "sample_rate")
+        return {
+            "id": self.id,
+            "resolution": self.resolution,
+            "width": self.width,
+            "height": self.height,
+            "profile": asdict(self.profile),
+            "bytes": len(self.video),
+            "frames": self.frames,
+            "keyframes": self.keyframes,
+            "generate_s": round(self.generate_s, 3),
+            **{f"probed_{k}": self.info.get(k) for k in keys},
+        }
@@ -32,6 +32,11 @@ FFMPEG_LIBS = ["libavformat", "libavcodec", "libavutil", "libswresample", "libsw
 extra_cflags = pkg_config(FFMPEG_LIBS, "--cflags")
 extra_ldflags = pkg_config(FFMPEG_LIBS, "--libs")
 
+# PYMEDIA_SANITIZE=thread (or address, undefined) builds an instrumented
+# library for the thread-safety stress tests; see docs/development.md.
+sanitize = os.environ.get("PYMEDIA_SANITIZE", "").strip()
+sanitize_flags = [f"-fsanitize={sanitize}", "-g", "-fno-omit-frame-pointer"] if sanitize else []
+
 # On Windows runners, FFmpeg zip layouts are predictable enough to provide
 # a direct fallback when pkg-config is missing or .pc files are absent.
 if sys.platform == "win32" and not extra_cflags and not extra_ldflags:
@@ -147,6 +152,7 @@ class BuildSharedLib(build_ext):
                         src,
                     ]
                     + arch_flags
+                    + sanitize_flags
                     + extra_cflags
                     + extra_ldflags
                 )
@@ -157,15 +163,18 @@ class BuildSharedLib(build_ext):
                         "-shared",
                         "-fPIC",
                         "-O2",
-                        "-s",
+                    ]
+                    + ([] if sanitize else ["-s"])
+                    + [
                         "-o",
                         out,
                         src,
                     ]
                     + arch_flags
+                    + sanitize_flags
                     + extra_cflags
                     + extra_ldflags
-                    + ["-lm"]
+                    + ["-lm", "-pthread"]
                 )
 
         print(f"Building libpymedia.so: {' '.join(cmd)}")
@@ -1,19 +1,41 @@
-from pymedia.analysis import detect_scenes, frame_accurate_trim, list_keyframes, trim_to_keyframes
+from pymedia.analysis import (
+    detect_scenes,
+    fingerprint_similarity,
+    frame_accurate_trim,
+    list_keyframes,
+    render_edl,
+    trim_to_keyframes,
+    video_fingerprint,
+)
 from pymedia.audio import (
     adjust_volume,
+    audio_peaks,
+    audio_spectrogram,
     change_audio_bitrate,
     crossfade_audio,
     extract_audio,
     fade_audio,
+    mix_audio,
     mix_audio_tracks,
     normalize_audio_lufs,
+    normalize_loudness,
     resample_audio,
     silence_detect,
     silence_remove,
     transcode_audio,
 )
-from pymedia.frames import create_thumbnail, extract_frame, extract_frames, generate_preview
+from pymedia.batch import SUPPORTED_BATCH_OPS, batch_map, batch_run
+from pymedia.control import CancelToken, OperationCancelled
+from pymedia.frames import (
+    create_thumbnail,
+    extract_frame,
+    extract_frame_raw,
+    extract_frames,
+    generate_preview,
+    iter_frame_batches,
+)
 from pymedia.info import get_video_info
+from pymedia.jobs import JOB_STATES, JobCancelledError, MediaJob, run_async, submit_job
 from pymedia.metadata import set_metadata, strip_metadata
 from pymedia.streaming import (
     analyze_gop,
@@ -73,17 +95,34 @@ __all__ = [
     "get_video_info",
     "list_keyframes",
     "detect_scenes",
+    "video_fingerprint",
+    "fingerprint_similarity",
     "trim_to_keyframes",
     "frame_accurate_trim",
+    "render_edl",
+    "batch_run",
+    "batch_map",
+    "SUPPORTED_BATCH_OPS",
+    "CancelToken",
+    "OperationCancelled",
+    "submit_job",
+    "run_async",
+    "MediaJob",
+    "JobCancelledError",
+    "JOB_STATES",
     "extract_audio",
     "adjust_volume",
     "fade_audio",
     "crossfade_audio",
     "normalize_audio_lufs",
+    "normalize_loudness",
     "change_audio_bitrate",
     "resample_audio",
     "silence_detect",
     "silence_remove",
+    "audio_peaks",
+    "audio_spectrogram",
+    "mix_audio",
     "mix_audio_tracks",
     "transcode_audio",
     "convert_format",
@@ -119,6 +158,8 @@ __all__ = [
     "reverse_video",
     "concat_videos",
     "extract_frame",
+    "extract_frame_raw",
+    "iter_frame_batches",
     "extract_frames",
     "create_thumbnail",
     "generate_preview",
@@ -83,6 +83,55 @@ _lib.list_keyframes_json.argtypes = [
 ]
 _lib.list_keyframes_json.restype = ctypes.c_void_p
 
+# ── detect_scenes_json ──
+_lib.detect_scenes_json.argtypes = [
+    ctypes.POINTER(ctypes.c_uint8),
+    ctypes.c_size_t,
+    ctypes.c_double,
+    ctypes.c_double,
+    ctypes.c_int,
+]
+_lib.detect_scenes_json.restype = ctypes.c_void_p
+
+# ── video_fingerprint ──
+_lib.video_fingerprint.argtypes = [
+    ctypes.POINTER(ctypes.c_uint8),
+    ctypes.c_size_t,
+    ctypes.c_double,
+    ctypes.c_char_p,
+    ctypes.POINTER(ctypes.c_size_t),
+]
+_lib.video_fingerprint.restype = ctypes.POINTER(ctypes.c_uint8)
+
+# ── smart_trim_video ──
+_lib.smart_trim_video.argtypes = [
+    ctypes.POINTER(ctypes.c_uint8),
+    ctypes.c_size_t,
+    ctypes.c_double,
+    ctypes.c_double,
+    ctypes.POINTER(ctypes.c_size_t),
+]
+_lib.smart_trim_video.restype = ctypes.POINTER(ctypes.c_uint8)
+
+# ── render_edl ──
+_lib.render_edl.argtypes = [
+    ctypes.POINTER(ctypes.c_uint8),
+    ctypes.c_size_t,
+    ctypes.POINTER(ctypes.c_double),
+    ctypes.c_int,
+    ctypes.POINTER(ctypes.c_size_t),
+]
+_lib.render_edl.restype = ctypes.POINTER(ctypes.c_uint8)
+
+# ── fingerprint_similarity ──
+_lib.fingerprint_similarity.argtypes = [
+    ctypes.c_char_p,
+    ctypes.c_size_t,
+    ctypes.c_char_p,
+    ctypes.c_size_t,
+]
+_lib.fingerprint_similarity.restype = ctypes.c_double
+
 # ── list_video_packet_timestamps_json ──
 _lib.list_video_packet_timestamps_json.argtypes = [
     ctypes.POINTER(ctypes.c_uint8),
@@ -118,6 +167,133 @@ _lib.transcode_audio_advanced.argtypes = [
 ]
 _lib.transcode_audio_advanced.restype = ctypes.POINTER(ctypes.c_uint8)
 
+# ── audio_fade ──
+_lib.audio_fade.argtypes = [
+    ctypes.POINTER(ctypes.c_uint8),
+    ctypes.c_size_t,
+    ctypes.c_double,
+    ctypes.c_double,
+    ctypes.c_char_p,
+    ctypes.POINTER(ctypes.c_size_t),
+]
+_lib.audio_fade.restype = ctypes.POINTER(ctypes.c_uint8)
+
+# ── audio_normalize_lufs ──
+_lib.audio_normalize_lufs.argtypes = [
+    ctypes.POINTER(ctypes.c_uint8),
+    ctypes.c_size_t,
+    ctypes.c_double,
+    ctypes.c_char_p,
+    ctypes.POINTER(ctypes.c_size_t),
+]
+_lib.audio_normalize_lufs.restype = ctypes.POINTER(ctypes.c_uint8)
+
+# ── normalize_loudness ──
+_lib.normalize_loudness.argtypes = [
+    ctypes.POINTER(ctypes.c_uint8),
+    ctypes.c_size_t,
+    ctypes.c_double,
+    ctypes.c_double,
+    ctypes.POINTER(ctypes.c_size_t),
+]
+_lib.normalize_loudness.restype = ctypes.POINTER(ctypes.c_uint8)
+
+# ── analyze_loudness_json ──
+_lib.analyze_loudness_json.argtypes = [ctypes.POINTER(ctypes.c_uint8), ctypes.c_size_t]
+_lib.analyze_loudness_json.restype = ctypes.c_void_p
+
+# ── audio_silence_ranges_json ──
+_lib.audio_silence_ranges_json.argtypes = [
+    ctypes.POINTER(ctypes.c_uint8),
+    ctypes.c_size_t,
+    ctypes.c_double,
+    ctypes.c_double,
+]
+_lib.audio_silence_ranges_json.restype = ctypes.c_void_p
+
+# ── audio_silence_remove ──
+_lib.audio_silence_remove.argtypes = [
+    ctypes.POINTER(ctypes.c_uint8),
+    ctypes.c_size_t,
+    ctypes.c_double,
+    ctypes.c_double,
+    ctypes.c_char_p,
+    ctypes.POINTER(ctypes.c_size_t),
+]
+_lib.audio_silence_remove.restype = ctypes.POINTER(ctypes.c_uint8)
+
+# ── audio_peaks ──
+_lib.audio_peaks.argtypes = [
+    ctypes.POINTER(ctypes.c_uint8),
+    ctypes.c_size_t,
+    ctypes.POINTER(ctypes.c_int),
+    ctypes.c_int,
+    ctypes.c_int,
+    ctypes.POINTER(ctypes.c_size_t),
+]
+_lib.audio_peaks.restype = ctypes.POINTER(ctypes.c_uint8)
+
+# ── audio_spectrogram ──
+_lib.audio_spectrogram.argtypes = [
+    ctypes.POINTER(ctypes.c_uint8),
+    ctypes.c_size_t,
+    ctypes.c_int,
+    ctypes.c_int,
+    ctypes.c_int,
+    ctypes.c_int,
+    ctypes.c_double,
+    ctypes.c_double,
+    ctypes.c_int,
+    ctypes.c_int,
+    ctypes.c_int,
+    ctypes.POINTER(ctypes.c_int),
+    ctypes.POINTER(ctypes.c_int),
+    ctypes.POINTER(ctypes.c_size_t),
+]
+_lib.audio_spectrogram.restype = ctypes.POINTER(ctypes.c_uint8)
+
+# ── audio_crossfade ──
+_lib.audio_crossfade.argtypes = [
+    ctypes.POINTER(ctypes.c_uint8),
+    ctypes.c_size_t,
+    ctypes.POINTER(ctypes.c_uint8),
+    ctypes.c_size_t,
+    ctypes.c_double,
+    ctypes.c_char_p,
+    ctypes.POINTER(ctypes.c_int),
+    ctypes.POINTER(ctypes.c_size_t),
+]
+_lib.audio_crossfade.restype = ctypes.POINTER(ctypes.c_uint8)
+
+# ── audio_mix ──
+_lib.audio_mix.argtypes = [
+    ctypes.POINTER(ctypes.POINTER(ctypes.c_uint8)),
+    ctypes.POINTER(ctypes.c_size_t),
+    ctypes.c_int,
+    ctypes.POINTER(ctypes.c_double),
+    ctypes.c_int,
+    ctypes.c_char_p,
+    ctypes.POINTER(ctypes.c_int),
+    ctypes.POINTER(ctypes.c_size_t),
+]
+_lib.audio_mix.restype = ctypes.POINTER(ctypes.c_uint8)
+
+# ── audio_mix_video ──
+_lib.audio_mix_video.argtypes = [
+    ctypes.POINTER(ctypes.POINTER(ctypes.c_uint8)),
+    ctypes.POINTER(ctypes.c_size_t),
+    ctypes.c_int,
+    ctypes.POINTER(ctypes.c_double),
+    ctypes.c_int,
+    ctypes.POINTER(ctypes.c_double),
+    ctypes.POINTER(ctypes.c_int),
+    ctypes.c_int,
+    ctypes.c_double,
+    ctypes.c_double,
+    ctypes.POINTER(ctypes.c_size_t),
+]
+_lib.audio_mix_video.restype = ctypes.POINTER(ctypes.c_uint8)
+
 # ── convert_format ──
 _lib.convert_format.argtypes = [
     ctypes.POINTER(ctypes.c_uint8),
@@ -155,6 +331,63 @@ _lib.extract_frame.argtypes = [
 ]
 _lib.extract_frame.restype = ctypes.POINTER(ctypes.c_uint8)
 
+# ── extract_keyframe ──
+_lib.extract_keyframe.argtypes = [
+    ctypes.POINTER(ctypes.c_uint8),
+    ctypes.c_size_t,
+    ctypes.c_double,
+    ctypes.c_char_p,
+    ctypes.POINTER(ctypes.c_size_t),
+]
+_lib.extract_keyframe.restype = ctypes.POINTER(ctypes.c_uint8)
+
+# ── extract_frame_raw ──
+_lib.extract_frame_raw.argtypes = [
+    ctypes.POINTER(ctypes.c_uint8),
+    ctypes.c_size_t,
+    ctypes.c_double,
+    ctypes.c_char_p,
+    ctypes.c_int,
+    ctypes.c_int,
+    ctypes.c_char_p,
+    ctypes.c_int,
+    ctypes.POINTER(ctypes.c_int),
+    ctypes.POINTER(ctypes.c_int),
+    ctypes.POINTER(ctypes.c_size_t),
+]
+_lib.extract_frame_raw.restype = ctypes.POINTER(ctypes.c_uint8)
+
+# ── frame_batcher ──
+_lib.frame_batcher_open.argtypes = [
+    ctypes.POINTER(ctypes.c_uint8),
+    ctypes.c_size_t,
+    ctypes.c_double,
+    ctypes.c_int,
+    ctypes.c_int,
+    ctypes.c_char_p,
+    ctypes.c_char_p,
+    ctypes.c_int,
+    ctypes.POINTER(ctypes.c_int),
+    ctypes.POINTER(ctypes.c_int),
+    ctypes.POINTER(ctypes.c_size_t),
+]
+_lib.frame_batcher_open.restype = ctypes.c_void_p
+_lib.frame_batcher_start.argtypes = [
+    ctypes.c_void_p,
+    ctypes.POINTER(ctypes.POINTER(ctypes.c_uint8)),
+    ctypes.c_int,
+    ctypes.c_int,
+]
+_lib.frame_batcher_start.restype = ctypes.c_int
+_lib.frame_batcher_next.argtypes = [
+    ctypes.c_void_p,
+    ctypes.POINTER(ctypes.c_double),
+    ctypes.POINTER(ctypes.c_int),
+]
+_lib.frame_batcher_next.restype = ctypes.c_int
+_lib.frame_batcher_close.argtypes = [ctypes.c_void_p]
+_lib.frame_batcher_close.restype = None
+
 # ── reencode_video ──
 _lib.reencode_video.argtypes = [
     ctypes.POINTER(ctypes.c_uint8),
@@ -167,6 +400,19 @@ _lib.reencode_video.argtypes = [
 ]
 _lib.reencode_video.restype = ctypes.POINTER(ctypes.c_uint8)
 
+# ── reencode_video_parallel ──
+_lib.reencode_video_parallel.argtypes = [
+    ctypes.POINTER(ctypes.c_uint8),
+    ctypes.c_size_t,
+    ctypes.c_int,
+    ctypes.c_char_p,
+    ctypes.c_int,
+    ctypes.c_int,
+    ctypes.c_int,
+    ctypes.POINTER(ctypes.c_size_t),
+]
+_lib.reencode_video_parallel.restype = ctypes.POINTER(ctypes.c_uint8)
+
 # ── transcode_video_bitrate ──
 _lib.transcode_video_bitrate.argtypes = [
     ctypes.POINTER(ctypes.c_uint8),
@@ -353,6 +599,15 @@ _lib.merge_videos.argtypes = [
 ]
 _lib.merge_videos.restype = ctypes.POINTER(ctypes.c_uint8)
 
+# ── concat_videos ──
+_lib.concat_videos.argtypes = [
+    ctypes.POINTER(ctypes.POINTER(ctypes.c_uint8)),
+    ctypes.POINTER(ctypes.c_size_t),
+    ctypes.c_int,
+    ctypes.POINTER(ctypes.c_size_t),
+]
+_lib.concat_videos.restype = ctypes.POINTER(ctypes.c_uint8)
+
 # ── reverse_video ──
 _lib.reverse_video.argtypes = [
     ctypes.POINTER(ctypes.c_uint8),
@@ -410,6 +665,72 @@ _lib.remove_subtitle_tracks.argtypes = [
 ]
 _lib.remove_subtitle_tracks.restype = ctypes.POINTER(ctypes.c_uint8)
 
+
+# ── pymedia_batch_run ──
+class _BatchJob(ctypes.Structure):
+    """Mirror of `BatchJob` in modules/batch.c."""
+
+    _fields_ = [
+        ("op", ctypes.c_char_p),
+        ("data", ctypes.POINTER(ctypes.c_uint8)),
+        ("size", ctypes.c_size_t),
+        ("args", ctypes.c_double * 4),
+        ("text", ctypes.c_char_p),
+    ]
+
+
+_BATCH_CALLBACK = ctypes.CFUNCTYPE(
+    None, ctypes.c_void_p, ctypes.c_int, ctypes.POINTER(ctypes.c_uint8), ctypes.c_size_t
+)
+
+_lib.pymedia_batch_run.argtypes = [
+    ctypes.POINTER(_BatchJob),
+    ctypes.c_int,
+    ctypes.c_int,
+    ctypes.c_size_t,
+    _BATCH_CALLBACK,
+    ctypes.c_void_p,
+]
+_lib.pymedia_batch_run.restype = ctypes.c_int
+
+# ── pymedia_job_* ──
+_JOB_CALLBACK = ctypes.CFUNCTYPE(None, ctypes.c_void_p, ctypes.c_int)
+
+_lib.pymedia_job_submit.argtypes = [ctypes.POINTER(_BatchJob), _JOB_CALLBACK, ctypes.c_void_p]
+_lib.pymedia_job_submit.restype = ctypes.c_void_p
+_lib.pymedia_job_poll.argtypes = [ctypes.c_void_p]
+_lib.pymedia_job_poll.restype = ctypes.c_int
+_lib.pymedia_job_progress.argtypes = [ctypes.c_void_p]
+_lib.pymedia_job_progress.restype = ctypes.c_double
+_lib.pymedia_job_cancel.argtypes = [ctypes.c_void_p]
+_lib.pymedia_job_cancel.restype = None
+_lib.pymedia_job_wait.argtypes = [ctypes.c_void_p]
+_lib.pymedia_job_wait.restype = ctypes.c_int
+_lib.pymedia_job_result.argtypes = [ctypes.c_void_p, ctypes.POINTER(ctypes.c_size_t)]
+_lib.pymedia_job_result.restype = ctypes.c_void_p
+_lib.pymedia_job_control.argtypes = [ctypes.c_void_p]
+_lib.pymedia_job_control.restype = ctypes.c_void_p
+_lib.pymedia_job_release.argtypes = [ctypes.c_void_p]
+_lib.pymedia_job_release.restype = None
+
+# ── pymedia_control_* ──
+_PROGRESS_CALLBACK = ctypes.CFUNCTYPE(None, ctypes.c_void_p, ctypes.c_double, ctypes.c_double)
+
+_lib.pymedia_control_new.argtypes = [_PROGRESS_CALLBACK, ctypes.c_void_p]
+_lib.pymedia_control_new.restype = ctypes.c_void_p
+_lib.pymedia_control_cancel.argtypes = [ctypes.c_void_p]
+_lib.pymedia_control_cancel.restype = None
+_lib.pymedia_control_cancelled.argtypes = [ctypes.c_void_p]
+_lib.pymedia_control_cancelled.restype = ctypes.c_int
+_lib.pymedia_control_bind.argtypes = [ctypes.c_void_p]
+_lib.pymedia_control_bind.restype = ctypes.c_void_p
+_lib.pymedia_control_enable_stats.argtypes = [ctypes.c_void_p]
+_lib.pymedia_control_enable_stats.restype = None
+_lib.pymedia_control_stats_json.argtypes = [ctypes.c_void_p]
+_lib.pymedia_control_stats_json.restype = ctypes.c_void_p
+_lib.pymedia_control_free.argtypes = [ctypes.c_void_p]
+_lib.pymedia_control_free.restype = None
+
 # ── allocator bridge ──
 _lib.pymedia_free.argtypes = [ctypes.c_void_p]
 _lib.pymedia_free.restype = None
@@ -424,3 +745,14 @@ def _call_bytes_fn(fn, *args):
     data = ctypes.string_at(result_ptr, out_size.value)
     _lib.pymedia_free(result_ptr)
     return data
+
+
+def _take_native_buffer(result_ptr, size: int) -> bytearray:
+    """Copy a native malloc'd buffer into a writable `bytearray` and free it."""
+    try:
+        out = bytearray(size)
+        if size:
+            ctypes.memmove((ctypes.c_char * size).from_buffer(out), result_ptr, size)
+        return out
+    finally:
+        _lib.pymedia_free(result_ptr)
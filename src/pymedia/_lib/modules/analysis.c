@@ -0,0 +1,383 @@
+// ============================================================
+// analysis — single-pass low-resolution luma decode, scene cuts,
+// perceptual fingerprints
+// ============================================================
+
+#define SCENE_LUMA_W 64
+#define SCENE_LUMA_H 64
+#define SCENE_HIST_BINS 32
+
+typedef int (*luma_sample_fn)(void *opaque, const uint8_t *luma, int w, int h, double t);
+
+// Decode the primary video stream once and hand sampled frames to `cb` as a
+// tightly packed w x h GRAY8 plane. With `interval` > 0 the first frame at
+// or after each interval is kept; `keyframes_only` skips non-key packets
+// entirely. The decoder runs with the loop filter disabled since the output
+// only feeds coarse statistics. A positive return from `cb` stops the scan
+// and a negative one fails it. Returns the number of samples, or -1 on
+// error.
+static int for_each_luma_sample(uint8_t *video_data, size_t video_size, int w, int h,
+                                double interval, int keyframes_only,
+                                luma_sample_fn cb, void *opaque) {
+    BufferData bd;
+    AVFormatContext *ifmt_ctx = NULL;
+    AVIOContext *input_avio_ctx = NULL;
+    AVCodecContext *dec_ctx = NULL;
+    AVPacket *pkt = NULL;
+    AVFrame *frame = NULL;
+    struct SwsContext *sws = NULL;
+    uint8_t *luma = NULL;
+    int samples = -1;
+
+    if (open_input_memory(video_data, video_size, &ifmt_ctx, &input_avio_ctx, &bd) < 0)
+        goto cleanup;
+    int video_idx = find_stream(ifmt_ctx, AVMEDIA_TYPE_VIDEO);
+    if (video_idx < 0) goto cleanup;
+    AVRational tb = ifmt_ctx->streams[video_idx]->time_base;
+
+    AVCodecParameters *codecpar = ifmt_ctx->streams[video_idx]->codecpar;
+    const AVCodec *decoder = avcodec_find_decoder(codecpar->codec_id);
+    if (!decoder) goto cleanup;
+    dec_ctx = avcodec_alloc_context3(decoder);
+    if (!dec_ctx) goto cleanup;
+    avcodec_parameters_to_context(dec_ctx, codecpar);
+    dec_ctx->thread_count = 0;
+    dec_ctx->skip_loop_filter = AVDISCARD_ALL;
+    if (keyframes_only) dec_ctx->skip_frame = AVDISCARD_NONKEY;
+    if (avcodec_open2(dec_ctx, decoder, NULL) < 0) goto cleanup;
+
+    pkt = av_packet_alloc();
+    frame = av_frame_alloc();
+    luma = malloc((size_t)w * h);
+    if (!pkt || !frame || !luma) goto cleanup;
+
+    int count = 0, stopped = 0, have_last = 0, flushing = 0;
+    double last_t = 0.0;
+    while (!stopped) {
+        if (!flushing) {
+            if (read_next_stream_packet(ifmt_ctx, video_idx, pkt) <= 0) {
+                pm_send_packet(dec_ctx, NULL);
+                flushing = 1;
+            } else {
+                if (!keyframes_only || (pkt->flags & AV_PKT_FLAG_KEY))
+                    pm_send_packet(dec_ctx, pkt);
+                av_packet_unref(pkt);
+            }
+        }
+
+        while (pm_receive_frame(dec_ctx, frame) == 0) {
+            int64_t ts = frame->best_effort_timestamp;
+            if (ts == AV_NOPTS_VALUE) ts = frame->pts;
+            double t = ts == AV_NOPTS_VALUE ? 0.0 : ts * av_q2d(tb);
+            int take = !have_last || interval <= 0.0 || t >= last_t + interval - 1e-6;
+            if (take) {
+                have_last = 1;
+                last_t = t;
+                if (scale_frame_packed(&sws, frame, AV_PIX_FMT_GRAY8, w, h,
+                                       SWS_AREA, luma) < 0) {
+                    av_frame_unref(frame);
+                    goto cleanup;
+                }
+                count++;
+                int r = cb(opaque, luma, w, h, t);
+                if (r < 0) {
+                    av_frame_unref(frame);
+                    goto cleanup;
+                }
+                if (r > 0) stopped = 1;
+            }
+            av_frame_unref(frame);
+            if (stopped) break;
+        }
+        if (flushing) break;
+    }
+    samples = count;
+
+cleanup:
+    free(luma);
+    if (sws) sws_freeContext(sws);
+    if (frame) av_frame_free(&frame);
+    if (pkt) av_packet_free(&pkt);
+    if (dec_ctx) avcodec_free_context(&dec_ctx);
+    close_input(&ifmt_ctx, &input_avio_ctx);
+    return samples;
+}
+
+// Sum of absolute differences between two byte planes.
+static uint64_t luma_sad(const uint8_t *a, const uint8_t *b, size_t n) {
+    uint64_t sad = 0;
+    size_t i = 0;
+#ifdef PM_HAVE_SSE2
+    __m128i acc = _mm_setzero_si128();
+    for (; i + 16 <= n; i += 16) {
+        __m128i va = _mm_loadu_si128((const __m128i *)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i *)(b + i));
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(va, vb));
+    }
+    sad = (uint64_t)_mm_cvtsi128_si64(acc) +
+          (uint64_t)_mm_cvtsi128_si64(_mm_unpackhi_epi64(acc, acc));
+#endif
+    for (; i < n; i++)
+        sad += (uint64_t)abs((int)a[i] - (int)b[i]);
+    return sad;
+}
+
+static void luma_histogram(const uint8_t *luma, size_t n, uint32_t *hist) {
+    memset(hist, 0, SCENE_HIST_BINS * sizeof(*hist));
+    for (size_t i = 0; i < n; i++)
+        hist[luma[i] * SCENE_HIST_BINS / 256]++;
+}
+
+typedef struct {
+    double threshold;
+    uint8_t prev[SCENE_LUMA_W * SCENE_LUMA_H];
+    uint32_t prev_hist[SCENE_HIST_BINS];
+    int have_prev;
+    char *json;
+    size_t len, cap;
+    int first;
+} SceneState;
+
+// Score is the mean of the normalized pixel SAD and the histogram L1
+// distance, both in [0, 1]: SAD reacts to motion-free cuts between similar
+// palettes, the histogram term to lighting/content changes under motion.
+static int scene_sample(void *opaque, const uint8_t *luma, int w, int h, double t) {
+    SceneState *st = opaque;
+    size_t n = (size_t)w * h;
+    uint32_t hist[SCENE_HIST_BINS];
+    luma_histogram(luma, n, hist);
+
+    if (st->have_prev) {
+        double sad = (double)luma_sad(st->prev, luma, n) / (255.0 * n);
+        uint64_t hdiff = 0;
+        for (int i = 0; i < SCENE_HIST_BINS; i++)
+            hdiff += hist[i] > st->prev_hist[i] ? hist[i] - st->prev_hist[i]
+                                                : st->prev_hist[i] - hist[i];
+        double score = 0.5 * sad + 0.5 * ((double)hdiff / (2.0 * n));
+        if (score >= st->threshold) {
+            char item[96];
+            snprintf(item, sizeof(item), "%s{\"time\":%.6f,\"score\":%.6f}",
+                     st->first ? "" : ",", t, score);
+            json_append(&st->json, &st->len, &st->cap, item);
+            st->first = 0;
+        }
+    }
+    memcpy(st->prev, luma, n);
+    memcpy(st->prev_hist, hist, sizeof(hist));
+    st->have_prev = 1;
+    return 0;
+}
+
+PYMEDIA_API char* detect_scenes_json(uint8_t *video_data, size_t video_size,
+                                     double threshold, double sample_interval,
+                                     int keyframes_only) {
+    SceneState *st = calloc(1, sizeof(*st));
+    if (!st) return NULL;
+    st->threshold = threshold;
+    st->first = 1;
+    st->cap = 256;
+    st->json = malloc(st->cap);
+    if (!st->json) {
+        free(st);
+        return NULL;
+    }
+    st->json[0] = '\0';
+    json_append(&st->json, &st->len, &st->cap, "[");
+
+    char *json = NULL;
+    if (for_each_luma_sample(video_data, video_size, SCENE_LUMA_W, SCENE_LUMA_H,
+                             sample_interval, keyframes_only, scene_sample, st) >= 0) {
+        json_append(&st->json, &st->len, &st->cap, "]");
+        json = st->json;
+    } else {
+        free(st->json);
+    }
+    free(st);
+    return json;
+}
+
+// ============================================================
+// video fingerprint — per-sample 64-bit pHash/dHash sequences
+// ============================================================
+//
+// Layout (little-endian): "PMFP", u8 version, u8 algorithm, u16 reserved,
+// u32 sample interval in ms, then one u64 hash per sample.
+
+#define FP_HEADER_SIZE 12
+#define FP_VERSION 1
+#define FP_ALGO_PHASH 0
+#define FP_ALGO_DHASH 1
+#define PHASH_SIZE 32
+
+static int get_fingerprint_algorithm(const char *name) {
+    if (!name || strcmp(name, "phash") == 0) return FP_ALGO_PHASH;
+    if (strcmp(name, "dhash") == 0) return FP_ALGO_DHASH;
+    return -1;
+}
+
+static uint64_t get_le64(const uint8_t *p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; i--) v = v << 8 | p[i];
+    return v;
+}
+
+static int popcount64(uint64_t x) {
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+    return (int)((x * 0x0101010101010101ULL) >> 56);
+}
+
+typedef struct {
+    int algorithm;
+    float dct_basis[8][PHASH_SIZE];  // first 8 DCT-II basis rows
+    float rows[PHASH_SIZE][8];
+    uint8_t *out;
+    size_t len, cap;
+} FingerprintState;
+
+// pHash: low 8x8 DCT coefficients of a 32x32 luma image, one bit per
+// coefficient above the median (DC excluded from the median).
+static uint64_t phash_luma(FingerprintState *st, const uint8_t *luma) {
+    float coeffs[64];
+    for (int y = 0; y < PHASH_SIZE; y++) {
+        const uint8_t *row = luma + y * PHASH_SIZE;
+        for (int u = 0; u < 8; u++) {
+            float acc = 0.0f;
+            for (int x = 0; x < PHASH_SIZE; x++) acc += st->dct_basis[u][x] * row[x];
+            st->rows[y][u] = acc;
+        }
+    }
+    for (int v = 0; v < 8; v++) {
+        for (int u = 0; u < 8; u++) {
+            float acc = 0.0f;
+            for (int y = 0; y < PHASH_SIZE; y++) acc += st->dct_basis[v][y] * st->rows[y][u];
+            coeffs[v * 8 + u] = acc;
+        }
+    }
+
+    float sorted[63];
+    memcpy(sorted, coeffs + 1, sizeof(sorted));
+    for (int i = 1; i < 63; i++) {
+        float key = sorted[i];
+        int j = i - 1;
+        while (j >= 0 && sorted[j] > key) { sorted[j + 1] = sorted[j]; j--; }
+        sorted[j + 1] = key;
+    }
+    float median = sorted[31];
+
+    uint64_t hash = 0;
+    for (int i = 0; i < 64; i++)
+        if (coeffs[i] > median) hash |= 1ULL << i;
+    return hash;
+}
+
+// dHash: sign of horizontal gradients over a 9x8 luma image.
+static uint64_t dhash_luma(const uint8_t *luma) {
+    uint64_t hash = 0;
+    for (int y = 0; y < 8; y++)
+        for (int x = 0; x < 8; x++)
+            if (luma[y * 9 + x + 1] > luma[y * 9 + x]) hash |= 1ULL << (y * 8 + x);
+    return hash;
+}
+
+static int fingerprint_sample(void *opaque, const uint8_t *luma, int w, int h, double t) {
+    FingerprintState *st = opaque;
+    (void)w;
+    (void)h;
+    (void)t;
+    uint64_t hash = st->algorithm == FP_ALGO_PHASH ? phash_luma(st, luma) : dhash_luma(luma);
+    if (st->len + 8 > st->cap) {
+        size_t cap = st->cap * 2;
+        uint8_t *tmp = realloc(st->out, cap);
+        if (!tmp) return -1;
+        st->out = tmp;
+        st->cap = cap;
+    }
+    put_le64(st->out + st->len, hash);
+    st->len += 8;
+    return 0;
+}
+
+PYMEDIA_API uint8_t* video_fingerprint(uint8_t *video_data, size_t video_size,
+                                       double sample_interval, const char *algorithm,
+                                       size_t *out_size) {
+    *out_size = 0;
+    int algo = get_fingerprint_algorithm(algorithm);
+    if (algo < 0) {
+        fprintf(stderr, "Unsupported fingerprint algorithm: %s\n", algorithm);
+        return NULL;
+    }
+    if (sample_interval <= 0.0) return NULL;
+
+    FingerprintState *st = calloc(1, sizeof(*st));
+    if (!st) return NULL;
+    st->algorithm = algo;
+    st->cap = 4096;
+    st->out = malloc(st->cap);
+    if (!st->out) {
+        free(st);
+        return NULL;
+    }
+    for (int u = 0; u < 8; u++)
+        for (int x = 0; x < PHASH_SIZE; x++)
+            st->dct_basis[u][x] = (float)cos(M_PI * (2 * x + 1) * u / (2.0 * PHASH_SIZE));
+
+    double interval_ms = sample_interval * 1000.0 + 0.5;
+    memcpy(st->out, "PMFP", 4);
+    st->out[4] = FP_VERSION;
+    st->out[5] = (uint8_t)algo;
+    st->out[6] = st->out[7] = 0;
+    put_le32(st->out + 8, interval_ms > 4294967295.0 ? 0xffffffffu : (uint32_t)interval_ms);
+    st->len = FP_HEADER_SIZE;
+
+    int w = algo == FP_ALGO_PHASH ? PHASH_SIZE : 9;
+    int h = algo == FP_ALGO_PHASH ? PHASH_SIZE : 8;
+    uint8_t *result = NULL;
+    if (for_each_luma_sample(video_data, video_size, w, h, sample_interval, 0,
+                             fingerprint_sample, st) > 0 &&
+        st->len > FP_HEADER_SIZE) {
+        result = st->out;
+        *out_size = st->len;
+    } else {
+        free(st->out);
+    }
+    free(st);
+    return result;
+}
+
+// Best alignment of two hash sequences: slide one over the other, requiring
+// at least half of the shorter sequence to overlap, and return
+// 1 - (mean Hamming distance / 64) of the best offset. Returns -1 when the
+// fingerprints are malformed or were built with different settings.
+PYMEDIA_API double fingerprint_similarity(const uint8_t *a, size_t a_size,
+                                          const uint8_t *b, size_t b_size) {
+    if (a_size < FP_HEADER_SIZE || b_size < FP_HEADER_SIZE) return -1.0;
+    if (memcmp(a, "PMFP", 4) != 0 || memcmp(b, "PMFP", 4) != 0) return -1.0;
+    if (a[4] != FP_VERSION || b[4] != FP_VERSION || a[5] != b[5]) return -1.0;
+    if (get_le32(a + 8) != get_le32(b + 8)) return -1.0;
+    if ((a_size - FP_HEADER_SIZE) % 8 || (b_size - FP_HEADER_SIZE) % 8) return -1.0;
+
+    long na = (long)((a_size - FP_HEADER_SIZE) / 8);
+    long nb = (long)((b_size - FP_HEADER_SIZE) / 8);
+    if (na == 0 || nb == 0) return -1.0;
+    const uint8_t *ha = a + FP_HEADER_SIZE;
+    const uint8_t *hb = b + FP_HEADER_SIZE;
+
+    long min_overlap = (na < nb ? na : nb) / 2;
+    if (min_overlap < 1) min_overlap = 1;
+
+    double best = 0.0;
+    for (long offset = -(nb - min_overlap); offset <= na - min_overlap; offset++) {
+        long start = offset > 0 ? offset : 0;
+        long end = na < offset + nb ? na : offset + nb;
+        long overlap = end - start;
+        if (overlap < min_overlap) continue;
+        uint64_t dist = 0;
+        for (long i = start; i < end; i++)
+            dist += popcount64(get_le64(ha + i * 8) ^ get_le64(hb + (i - offset) * 8));
+        double sim = 1.0 - (double)dist / (64.0 * overlap);
+        if (sim > best) best = sim;
+    }
+    return best;
+}
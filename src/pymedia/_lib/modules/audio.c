@@ -39,32 +39,193 @@ static enum AVSampleFormat pick_sample_fmt(const AVCodec *codec, enum AVSampleFo
     return fmts[0];
 }
 
+// ---------- resampler / FIFO cache ----------
+//
+// Batch jobs convert many short files with the same rate/layout pairs, where
+// building a resampler (filter bank) and FIFO dominates. Initialized
+// SwrContexts are parked here keyed by their conversion options, and FIFOs
+// by sample format/channels. Acquire removes an entry, so a context is only
+// ever used by one call at a time; release parks it again (or frees it when
+// the cache is full).
+
+#define AUDIO_CACHE_SLOTS 8
+
+typedef struct {
+    char *key;
+    SwrContext *swr;
+} SwrCacheEntry;
+
+typedef struct {
+    enum AVSampleFormat fmt;
+    int channels;
+    AVAudioFifo *fifo;
+} FifoCacheEntry;
+
+static pm_once_t audio_cache_once = PM_ONCE_INIT;
+static pm_mutex_t audio_cache_lock;
+static SwrCacheEntry swr_cache[AUDIO_CACHE_SLOTS];
+static FifoCacheEntry fifo_cache[AUDIO_CACHE_SLOTS];
+
+static void audio_cache_init_once(void) {
+    pm_mutex_init(&audio_cache_lock);
+}
+
+// Only the caller-set conversion options form the key: swr_init writes
+// back derived options (channel counts, internal format), so a full
+// serialization would differ before and after initialization.
+static const char *const swr_key_options[] = {
+#if FF_NEW_CHANNEL_LAYOUT
+    "in_chlayout", "out_chlayout",
+#else
+    "in_channel_layout", "out_channel_layout",
+#endif
+    "in_sample_fmt", "out_sample_fmt", "in_sample_rate", "out_sample_rate",
+};
+
+static char *swr_cache_key(SwrContext *swr) {
+    size_t len = 0, cap = 256;
+    char *key = av_malloc(cap);
+    if (!key) return NULL;
+    key[0] = '\0';
+    for (size_t i = 0; i < sizeof(swr_key_options) / sizeof(swr_key_options[0]); i++) {
+        uint8_t *value = NULL;
+        if (av_opt_get(swr, swr_key_options[i], 0, &value) < 0) {
+            av_free(key);
+            return NULL;
+        }
+        int n = snprintf(key + len, cap - len, "%s;", (const char *)value);
+        av_free(value);
+        if (n < 0 || (size_t)n >= cap - len) {
+            av_free(key);
+            return NULL;
+        }
+        len += n;
+    }
+    return key;
+}
+
+// Initialize a configured `*swr`, or swap it for a parked context with the
+// same options. Re-running swr_init on a parked context resets its delay
+// buffers while keeping the already-built resampling filter.
+static int swr_cache_init(SwrContext **swr) {
+    if (!*swr) return -1;
+    char *key = swr_cache_key(*swr);
+    if (key) {
+        SwrContext *hit = NULL;
+        pm_once(&audio_cache_once, audio_cache_init_once);
+        pm_mutex_lock(&audio_cache_lock);
+        for (int i = 0; i < AUDIO_CACHE_SLOTS; i++) {
+            if (swr_cache[i].swr && strcmp(swr_cache[i].key, key) == 0) {
+                hit = swr_cache[i].swr;
+                swr_cache[i].swr = NULL;
+                av_freep(&swr_cache[i].key);
+                break;
+            }
+        }
+        pm_mutex_unlock(&audio_cache_lock);
+        av_free(key);
+        if (hit) {
+            swr_free(swr);
+            *swr = hit;
+        }
+    }
+    return swr_init(*swr);
+}
+
+static void swr_cache_release(SwrContext **swr) {
+    if (!*swr) return;
+    char *key = swr_is_initialized(*swr) ? swr_cache_key(*swr) : NULL;
+    if (key) {
+        pm_once(&audio_cache_once, audio_cache_init_once);
+        pm_mutex_lock(&audio_cache_lock);
+        for (int i = 0; i < AUDIO_CACHE_SLOTS; i++) {
+            if (!swr_cache[i].swr) {
+                swr_cache[i].swr = *swr;
+                swr_cache[i].key = key;
+                *swr = NULL;
+                key = NULL;
+                break;
+            }
+        }
+        pm_mutex_unlock(&audio_cache_lock);
+        av_free(key);
+    }
+    swr_free(swr);
+}
+
+static AVAudioFifo *audio_fifo_acquire(enum AVSampleFormat fmt, int channels, int nb_samples) {
+    AVAudioFifo *fifo = NULL;
+    pm_once(&audio_cache_once, audio_cache_init_once);
+    pm_mutex_lock(&audio_cache_lock);
+    for (int i = 0; i < AUDIO_CACHE_SLOTS; i++) {
+        if (fifo_cache[i].fifo && fifo_cache[i].fmt == fmt && fifo_cache[i].channels == channels) {
+            fifo = fifo_cache[i].fifo;
+            fifo_cache[i].fifo = NULL;
+            break;
+        }
+    }
+    pm_mutex_unlock(&audio_cache_lock);
+    if (fifo && av_audio_fifo_realloc(fifo, nb_samples) < 0) {
+        av_audio_fifo_free(fifo);
+        fifo = NULL;
+    }
+    return fifo ? fifo : av_audio_fifo_alloc(fmt, channels, nb_samples);
+}
+
+static void audio_fifo_release(AVAudioFifo **fifo, enum AVSampleFormat fmt, int channels) {
+    if (!*fifo) return;
+    av_audio_fifo_reset(*fifo);
+    pm_once(&audio_cache_once, audio_cache_init_once);
+    pm_mutex_lock(&audio_cache_lock);
+    for (int i = 0; i < AUDIO_CACHE_SLOTS; i++) {
+        if (!fifo_cache[i].fifo) {
+            fifo_cache[i] = (FifoCacheEntry){ fmt, channels, *fifo };
+            *fifo = NULL;
+            break;
+        }
+    }
+    pm_mutex_unlock(&audio_cache_lock);
+    if (*fifo) {
+        av_audio_fifo_free(*fifo);
+        *fifo = NULL;
+    }
+}
+
+// Fill `frame` with `nb_samples` of encoder-format audio. The buffer is kept
+// between calls and only reallocated when the encoder still holds a
+// reference to it or the size changes.
+static int encoder_frame_prepare(AVFrame *frame, AVCodecContext *enc_ctx, int nb_samples) {
+    if (frame->buf[0] && frame->nb_samples == nb_samples)
+        return av_frame_make_writable(frame);
+    av_frame_unref(frame);
+    frame->format = enc_ctx->sample_fmt;
+#if FF_NEW_CHANNEL_LAYOUT
+    av_channel_layout_copy(&frame->ch_layout, &enc_ctx->ch_layout);
+#else
+    frame->channel_layout = enc_ctx->channel_layout;
+#endif
+    frame->sample_rate = enc_ctx->sample_rate;
+    frame->nb_samples = nb_samples;
+    return av_frame_get_buffer(frame, 0);
+}
+
 static void encode_fifo_frames(AVAudioFifo *fifo, AVCodecContext *enc_ctx,
                                 AVFormatContext *ofmt_ctx, AVStream *out_stream,
                                 AVPacket *enc_pkt, AVFrame *enc_frame,
                                 int frame_size, int64_t *pts_counter) {
     while (av_audio_fifo_size(fifo) >= frame_size) {
-        enc_frame->format = enc_ctx->sample_fmt;
-#if FF_NEW_CHANNEL_LAYOUT
-        av_channel_layout_copy(&enc_frame->ch_layout, &enc_ctx->ch_layout);
-#else
-        enc_frame->channel_layout = enc_ctx->channel_layout;
-#endif
-        enc_frame->sample_rate = enc_ctx->sample_rate;
-        enc_frame->nb_samples = frame_size;
-        av_frame_get_buffer(enc_frame, 0);
+        if (encoder_frame_prepare(enc_frame, enc_ctx, frame_size) < 0) return;
         av_audio_fifo_read(fifo, (void **)enc_frame->data, frame_size);
         enc_frame->pts = *pts_counter;
         *pts_counter += frame_size;
 
-        avcodec_send_frame(enc_ctx, enc_frame);
-        av_frame_unref(enc_frame);
+        pm_send_frame(enc_ctx, enc_frame);
 
-        while (avcodec_receive_packet(enc_ctx, enc_pkt) == 0) {
-            enc_pkt->stream_index = 0;
+        while (pm_receive_packet(enc_ctx, enc_pkt) == 0) {
+            enc_pkt->stream_index = out_stream->index;
             av_packet_rescale_ts(enc_pkt, enc_ctx->time_base,
                                  out_stream->time_base);
-            av_interleaved_write_frame(ofmt_ctx, enc_pkt);
+            pm_write_frame(ofmt_ctx, enc_pkt);
             av_packet_unref(enc_pkt);
         }
     }
@@ -77,31 +238,111 @@ static void encode_fifo_remaining(AVAudioFifo *fifo, AVCodecContext *enc_ctx,
     int remaining = av_audio_fifo_size(fifo);
     if (remaining <= 0) return;
 
-    enc_frame->format = enc_ctx->sample_fmt;
-#if FF_NEW_CHANNEL_LAYOUT
-    av_channel_layout_copy(&enc_frame->ch_layout, &enc_ctx->ch_layout);
-#else
-    enc_frame->channel_layout = enc_ctx->channel_layout;
-#endif
-    enc_frame->sample_rate = enc_ctx->sample_rate;
-    enc_frame->nb_samples = remaining;
-    av_frame_get_buffer(enc_frame, 0);
+    if (encoder_frame_prepare(enc_frame, enc_ctx, remaining) < 0) return;
     av_audio_fifo_read(fifo, (void **)enc_frame->data, remaining);
     enc_frame->pts = *pts_counter;
     *pts_counter += remaining;
 
-    avcodec_send_frame(enc_ctx, enc_frame);
+    pm_send_frame(enc_ctx, enc_frame);
     av_frame_unref(enc_frame);
 
-    while (avcodec_receive_packet(enc_ctx, enc_pkt) == 0) {
-        enc_pkt->stream_index = 0;
+    while (pm_receive_packet(enc_ctx, enc_pkt) == 0) {
+        enc_pkt->stream_index = out_stream->index;
         av_packet_rescale_ts(enc_pkt, enc_ctx->time_base,
                              out_stream->time_base);
-        av_interleaved_write_frame(ofmt_ctx, enc_pkt);
+        pm_write_frame(ofmt_ctx, enc_pkt);
         av_packet_unref(enc_pkt);
     }
 }
 
+// ---------- stream-copy fast path ----------
+//
+// When the source codec already matches the requested format the packets
+// are remuxed untouched, which avoids a decode/encode round trip and keeps
+// the original sample rate and channel layout.
+
+static int audio_copy_compatible(enum AVCodecID codec_id, const char *format) {
+    switch (codec_id) {
+    case AV_CODEC_ID_AAC:    return strcmp(format, "aac") == 0;
+    case AV_CODEC_ID_MP3:    return strcmp(format, "mp3") == 0;
+    case AV_CODEC_ID_VORBIS: return strcmp(format, "ogg") == 0;
+    case AV_CODEC_ID_FLAC:   return strcmp(format, "flac") == 0;
+    case AV_CODEC_ID_OPUS:   return strcmp(format, "opus") == 0;
+    default:                 return 0;
+    }
+}
+
+// Returns NULL if the muxer rejects the stream or nothing was written; the
+// caller then rewinds the input and falls back to re-encoding.
+static uint8_t *remux_audio_stream(AVFormatContext *ifmt_ctx, int audio_idx,
+                                   const char *muxer_name, size_t *out_size) {
+    AVFormatContext *ofmt_ctx = NULL;
+    AVPacket *pkt = NULL;
+    uint8_t *output_buffer = NULL;
+    uint8_t *result = NULL;
+    AVStream *in_stream = ifmt_ctx->streams[audio_idx];
+
+    avformat_alloc_output_context2(&ofmt_ctx, NULL, muxer_name, NULL);
+    if (!ofmt_ctx) goto cleanup;
+    if (avio_open_dyn_buf(&ofmt_ctx->pb) < 0) goto cleanup;
+
+    AVStream *out_stream = avformat_new_stream(ofmt_ctx, NULL);
+    if (!out_stream) goto cleanup;
+    if (avcodec_parameters_copy(out_stream->codecpar, in_stream->codecpar) < 0)
+        goto cleanup;
+    out_stream->codecpar->codec_tag = 0;
+    out_stream->time_base = in_stream->time_base;
+    if (avformat_write_header(ofmt_ctx, NULL) < 0) goto cleanup;
+
+    pkt = av_packet_alloc();
+    if (!pkt) goto cleanup;
+
+    int64_t ts_offset = AV_NOPTS_VALUE;
+    while (pm_read_frame(ifmt_ctx, pkt) >= 0) {
+        if (pkt->stream_index != audio_idx) {
+            av_packet_unref(pkt);
+            continue;
+        }
+        // Standalone audio starts at zero even when the track was offset
+        // inside the source container.
+        if (ts_offset == AV_NOPTS_VALUE)
+            ts_offset = pkt->dts != AV_NOPTS_VALUE ? pkt->dts
+                      : pkt->pts != AV_NOPTS_VALUE ? pkt->pts : 0;
+        if (pkt->pts != AV_NOPTS_VALUE) pkt->pts -= ts_offset;
+        if (pkt->dts != AV_NOPTS_VALUE) pkt->dts -= ts_offset;
+        pkt->stream_index = out_stream->index;
+        av_packet_rescale_ts(pkt, in_stream->time_base, out_stream->time_base);
+        pkt->pos = -1;
+        pm_write_frame(ofmt_ctx, pkt);
+        av_packet_unref(pkt);
+    }
+
+    av_write_trailer(ofmt_ctx);
+    int output_size = avio_close_dyn_buf(ofmt_ctx->pb, &output_buffer);
+    ofmt_ctx->pb = NULL;
+
+    if (output_size > 0) {
+        result = malloc(output_size);
+        if (result) {
+            memcpy(result, output_buffer, output_size);
+            *out_size = output_size;
+        }
+    }
+
+cleanup:
+    av_packet_free(&pkt);
+    if (ofmt_ctx) {
+        if (ofmt_ctx->pb) {
+            uint8_t *dummy;
+            avio_close_dyn_buf(ofmt_ctx->pb, &dummy);
+            av_free(dummy);
+        }
+        avformat_free_context(ofmt_ctx);
+    }
+    av_free(output_buffer);
+    return result;
+}
+
 PYMEDIA_API uint8_t* extract_audio(uint8_t *video_data, size_t video_size,
                        const char *format, size_t *out_size) {
     *out_size = 0;
@@ -111,6 +352,8 @@ PYMEDIA_API uint8_t* extract_audio(uint8_t *video_data, size_t video_size,
     AVCodecContext *enc_ctx = NULL;
     SwrContext *swr = NULL;
     AVAudioFifo *fifo = NULL;
+    enum AVSampleFormat fifo_fmt = AV_SAMPLE_FMT_NONE;
+    int fifo_channels = 0;
     AVPacket *dec_pkt = NULL, *enc_pkt = NULL;
     AVFrame *dec_frame = NULL, *enc_frame = NULL;
     AVIOContext *input_avio_ctx = NULL;
@@ -136,8 +379,15 @@ PYMEDIA_API uint8_t* extract_audio(uint8_t *video_data, size_t video_size,
     int audio_idx = find_stream(ifmt_ctx, AVMEDIA_TYPE_AUDIO);
     if (audio_idx < 0) goto cleanup;
 
-    // Decoder
     AVCodecParameters *codecpar = ifmt_ctx->streams[audio_idx]->codecpar;
+    if (audio_copy_compatible(codecpar->codec_id, format)) {
+        result = remux_audio_stream(ifmt_ctx, audio_idx, muxer_name, out_size);
+        if (result) goto cleanup;
+        // Header rejected (e.g. missing extradata): rewind and re-encode.
+        av_seek_frame(ifmt_ctx, -1, 0, AVSEEK_FLAG_BACKWARD);
+    }
+
+    // Decoder
     const AVCodec *decoder = avcodec_find_decoder(codecpar->codec_id);
     if (!decoder) goto cleanup;
     dec_ctx = avcodec_alloc_context3(decoder);
@@ -205,9 +455,11 @@ PYMEDIA_API uint8_t* extract_audio(uint8_t *video_data, size_t video_size,
             : av_get_default_channel_layout(dec_ctx->channels),
         dec_ctx->sample_fmt, dec_ctx->sample_rate, 0, NULL);
 #endif
-    if (!swr || swr_init(swr) < 0) goto cleanup;
+    if (swr_cache_init(&swr) < 0) goto cleanup;
 
-    fifo = av_audio_fifo_alloc(enc_sample_fmt, 2, frame_size);
+    fifo_fmt = enc_sample_fmt;
+    fifo_channels = 2;
+    fifo = audio_fifo_acquire(fifo_fmt, fifo_channels, frame_size);
     if (!fifo) goto cleanup;
 
     // Output
@@ -230,13 +482,13 @@ PYMEDIA_API uint8_t* extract_audio(uint8_t *video_data, size_t video_size,
     int64_t pts_counter = 0;
 
     // Decode + resample + encode loop
-    while (av_read_frame(ifmt_ctx, dec_pkt) >= 0) {
+    while (pm_read_frame(ifmt_ctx, dec_pkt) >= 0) {
         if (dec_pkt->stream_index == audio_idx) {
-            if (avcodec_send_packet(dec_ctx, dec_pkt) < 0) {
+            if (pm_send_packet(dec_ctx, dec_pkt) < 0) {
                 av_packet_unref(dec_pkt);
                 continue;
             }
-            while (avcodec_receive_frame(dec_ctx, dec_frame) == 0) {
+            while (pm_receive_frame(dec_ctx, dec_frame) == 0) {
                 int out_samples = swr_get_out_samples(swr, dec_frame->nb_samples);
                 if (out_samples <= 0) continue;
                 if (out_samples > resamp_buf_size) {
@@ -246,7 +498,7 @@ PYMEDIA_API uint8_t* extract_audio(uint8_t *video_data, size_t video_size,
                         out_samples, enc_sample_fmt, 0);
                     resamp_buf_size = out_samples;
                 }
-                int converted = swr_convert(swr, resamp_buf, out_samples,
+                int converted = pm_swr_convert(swr, resamp_buf, out_samples,
                     (const uint8_t **)dec_frame->data, dec_frame->nb_samples);
                 if (converted > 0) {
                     av_audio_fifo_write(fifo, (void **)resamp_buf, converted);
@@ -260,8 +512,8 @@ PYMEDIA_API uint8_t* extract_audio(uint8_t *video_data, size_t video_size,
     }
 
     // Flush decoder
-    avcodec_send_packet(dec_ctx, NULL);
-    while (avcodec_receive_frame(dec_ctx, dec_frame) == 0) {
+    pm_send_packet(dec_ctx, NULL);
+    while (pm_receive_frame(dec_ctx, dec_frame) == 0) {
         int out_samples = swr_get_out_samples(swr, dec_frame->nb_samples);
         if (out_samples <= 0) continue;
         if (out_samples > resamp_buf_size) {
@@ -271,7 +523,7 @@ PYMEDIA_API uint8_t* extract_audio(uint8_t *video_data, size_t video_size,
                 out_samples, enc_sample_fmt, 0);
             resamp_buf_size = out_samples;
         }
-        int converted = swr_convert(swr, resamp_buf, out_samples,
+        int converted = pm_swr_convert(swr, resamp_buf, out_samples,
             (const uint8_t **)dec_frame->data, dec_frame->nb_samples);
         if (converted > 0) {
             av_audio_fifo_write(fifo, (void **)resamp_buf, converted);
@@ -290,7 +542,7 @@ PYMEDIA_API uint8_t* extract_audio(uint8_t *video_data, size_t video_size,
                 out_samples, enc_sample_fmt, 0);
             resamp_buf_size = out_samples;
         }
-        int converted = swr_convert(swr, resamp_buf, out_samples, NULL, 0);
+        int converted = pm_swr_convert(swr, resamp_buf, out_samples, NULL, 0);
         if (converted <= 0) break;
         av_audio_fifo_write(fifo, (void **)resamp_buf, converted);
         encode_fifo_frames(fifo, enc_ctx, ofmt_ctx, out_stream,
@@ -301,12 +553,12 @@ PYMEDIA_API uint8_t* extract_audio(uint8_t *video_data, size_t video_size,
                           enc_pkt, enc_frame, &pts_counter);
 
     // Flush encoder
-    avcodec_send_frame(enc_ctx, NULL);
-    while (avcodec_receive_packet(enc_ctx, enc_pkt) == 0) {
-        enc_pkt->stream_index = 0;
+    pm_send_frame(enc_ctx, NULL);
+    while (pm_receive_packet(enc_ctx, enc_pkt) == 0) {
+        enc_pkt->stream_index = out_stream->index;
         av_packet_rescale_ts(enc_pkt, enc_ctx->time_base,
                              out_stream->time_base);
-        av_interleaved_write_frame(ofmt_ctx, enc_pkt);
+        pm_write_frame(ofmt_ctx, enc_pkt);
         av_packet_unref(enc_pkt);
     }
 
@@ -329,8 +581,8 @@ cleanup:
     if (dec_frame) av_frame_free(&dec_frame);
     if (enc_pkt) av_packet_free(&enc_pkt);
     if (dec_pkt) av_packet_free(&dec_pkt);
-    if (fifo) av_audio_fifo_free(fifo);
-    if (swr) swr_free(&swr);
+    audio_fifo_release(&fifo, fifo_fmt, fifo_channels);
+    swr_cache_release(&swr);
     if (enc_ctx) avcodec_free_context(&enc_ctx);
     if (dec_ctx) avcodec_free_context(&dec_ctx);
     if (ofmt_ctx) {
@@ -356,6 +608,8 @@ PYMEDIA_API uint8_t* transcode_audio_advanced(uint8_t *video_data, size_t video_
     AVCodecContext *enc_ctx = NULL;
     SwrContext *swr = NULL;
     AVAudioFifo *fifo = NULL;
+    enum AVSampleFormat fifo_fmt = AV_SAMPLE_FMT_NONE;
+    int fifo_channels = 0;
     AVPacket *dec_pkt = NULL, *enc_pkt = NULL;
     AVFrame *dec_frame = NULL, *enc_frame = NULL;
     AVIOContext *input_avio_ctx = NULL;
@@ -453,9 +707,11 @@ PYMEDIA_API uint8_t* transcode_audio_advanced(uint8_t *video_data, size_t video_
             : av_get_default_channel_layout(dec_ctx->channels),
         dec_ctx->sample_fmt, dec_ctx->sample_rate, 0, NULL);
 #endif
-    if (!swr || swr_init(swr) < 0) goto cleanup;
+    if (swr_cache_init(&swr) < 0) goto cleanup;
 
-    fifo = av_audio_fifo_alloc(enc_sample_fmt, out_channels, frame_size);
+    fifo_fmt = enc_sample_fmt;
+    fifo_channels = out_channels;
+    fifo = audio_fifo_acquire(fifo_fmt, fifo_channels, frame_size);
     if (!fifo) goto cleanup;
 
     avformat_alloc_output_context2(&ofmt_ctx, NULL, muxer_name, NULL);
@@ -475,13 +731,13 @@ PYMEDIA_API uint8_t* transcode_audio_advanced(uint8_t *video_data, size_t video_
     if (!dec_pkt || !enc_pkt || !dec_frame || !enc_frame) goto cleanup;
 
     int64_t pts_counter = 0;
-    while (av_read_frame(ifmt_ctx, dec_pkt) >= 0) {
+    while (pm_read_frame(ifmt_ctx, dec_pkt) >= 0) {
         if (dec_pkt->stream_index == audio_idx) {
-            if (avcodec_send_packet(dec_ctx, dec_pkt) < 0) {
+            if (pm_send_packet(dec_ctx, dec_pkt) < 0) {
                 av_packet_unref(dec_pkt);
                 continue;
             }
-            while (avcodec_receive_frame(dec_ctx, dec_frame) == 0) {
+            while (pm_receive_frame(dec_ctx, dec_frame) == 0) {
                 int out_samples = swr_get_out_samples(swr, dec_frame->nb_samples);
                 if (out_samples <= 0) continue;
                 if (out_samples > resamp_buf_size) {
@@ -491,7 +747,7 @@ PYMEDIA_API uint8_t* transcode_audio_advanced(uint8_t *video_data, size_t video_
                         out_samples, enc_sample_fmt, 0);
                     resamp_buf_size = out_samples;
                 }
-                int converted = swr_convert(swr, resamp_buf, out_samples,
+                int converted = pm_swr_convert(swr, resamp_buf, out_samples,
                     (const uint8_t **)dec_frame->data, dec_frame->nb_samples);
                 if (converted > 0) {
                     av_audio_fifo_write(fifo, (void **)resamp_buf, converted);
@@ -504,8 +760,8 @@ PYMEDIA_API uint8_t* transcode_audio_advanced(uint8_t *video_data, size_t video_
         av_packet_unref(dec_pkt);
     }
 
-    avcodec_send_packet(dec_ctx, NULL);
-    while (avcodec_receive_frame(dec_ctx, dec_frame) == 0) {
+    pm_send_packet(dec_ctx, NULL);
+    while (pm_receive_frame(dec_ctx, dec_frame) == 0) {
         int out_samples = swr_get_out_samples(swr, dec_frame->nb_samples);
         if (out_samples <= 0) continue;
         if (out_samples > resamp_buf_size) {
@@ -515,7 +771,7 @@ PYMEDIA_API uint8_t* transcode_audio_advanced(uint8_t *video_data, size_t video_
                 out_samples, enc_sample_fmt, 0);
             resamp_buf_size = out_samples;
         }
-        int converted = swr_convert(swr, resamp_buf, out_samples,
+        int converted = pm_swr_convert(swr, resamp_buf, out_samples,
             (const uint8_t **)dec_frame->data, dec_frame->nb_samples);
         if (converted > 0) {
             av_audio_fifo_write(fifo, (void **)resamp_buf, converted);
@@ -533,7 +789,7 @@ PYMEDIA_API uint8_t* transcode_audio_advanced(uint8_t *video_data, size_t video_
                 out_samples, enc_sample_fmt, 0);
             resamp_buf_size = out_samples;
         }
-        int converted = swr_convert(swr, resamp_buf, out_samples, NULL, 0);
+        int converted = pm_swr_convert(swr, resamp_buf, out_samples, NULL, 0);
         if (converted <= 0) break;
         av_audio_fifo_write(fifo, (void **)resamp_buf, converted);
         encode_fifo_frames(fifo, enc_ctx, ofmt_ctx, out_stream,
@@ -543,12 +799,12 @@ PYMEDIA_API uint8_t* transcode_audio_advanced(uint8_t *video_data, size_t video_
     encode_fifo_remaining(fifo, enc_ctx, ofmt_ctx, out_stream,
                           enc_pkt, enc_frame, &pts_counter);
 
-    avcodec_send_frame(enc_ctx, NULL);
-    while (avcodec_receive_packet(enc_ctx, enc_pkt) == 0) {
-        enc_pkt->stream_index = 0;
+    pm_send_frame(enc_ctx, NULL);
+    while (pm_receive_packet(enc_ctx, enc_pkt) == 0) {
+        enc_pkt->stream_index = out_stream->index;
         av_packet_rescale_ts(enc_pkt, enc_ctx->time_base,
                              out_stream->time_base);
-        av_interleaved_write_frame(ofmt_ctx, enc_pkt);
+        pm_write_frame(ofmt_ctx, enc_pkt);
         av_packet_unref(enc_pkt);
     }
 
@@ -571,8 +827,8 @@ cleanup:
     if (dec_frame) av_frame_free(&dec_frame);
     if (enc_pkt) av_packet_free(&enc_pkt);
     if (dec_pkt) av_packet_free(&dec_pkt);
-    if (fifo) av_audio_fifo_free(fifo);
-    if (swr) swr_free(&swr);
+    audio_fifo_release(&fifo, fifo_fmt, fifo_channels);
+    swr_cache_release(&swr);
     if (enc_ctx) avcodec_free_context(&enc_ctx);
     if (dec_ctx) avcodec_free_context(&dec_ctx);
     if (ofmt_ctx) {
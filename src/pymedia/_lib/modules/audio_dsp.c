@@ -0,0 +1,1176 @@
+// ============================================================
+// audio DSP — float planar decode/encode plumbing, gain/mix/
+// envelope kernels, fades, silence, crossfades, mixing
+// ============================================================
+
+#define AUDIO_DSP_CHUNK 4096
+#define AUDIO_DSP_MAX_CHANNELS 8
+
+// Failure causes reported through the `status` out-parameter of
+// audio_crossfade and audio_mix; 0 means any other failure.
+#define AUDIO_DSP_ERR_LAYOUT 1      // an input cannot be resampled to the output layout
+#define AUDIO_DSP_ERR_SHORT 2       // crossfade overlap shorter than one sample
+
+// ---------- kernels ----------
+
+static void dsp_gain(float *x, int n, float g) {
+    int i = 0;
+#ifdef PM_HAVE_SSE2
+    __m128 vg = _mm_set1_ps(g);
+    for (; i + 4 <= n; i += 4)
+        _mm_storeu_ps(x + i, _mm_mul_ps(_mm_loadu_ps(x + i), vg));
+#endif
+    for (; i < n; i++) x[i] *= g;
+}
+
+// dst += g * src
+static void dsp_mix(float *dst, const float *src, int n, float g) {
+    int i = 0;
+#ifdef PM_HAVE_SSE2
+    __m128 vg = _mm_set1_ps(g);
+    for (; i + 4 <= n; i += 4) {
+        __m128 v = _mm_mul_ps(_mm_loadu_ps(src + i), vg);
+        _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), v));
+    }
+#endif
+    for (; i < n; i++) dst[i] += g * src[i];
+}
+
+// dst += gains * src (per-sample gain automation)
+static void dsp_mix_varying(float *dst, const float *src, const float *gains, int n) {
+    int i = 0;
+#ifdef PM_HAVE_SSE2
+    for (; i + 4 <= n; i += 4) {
+        __m128 v = _mm_mul_ps(_mm_loadu_ps(src + i), _mm_loadu_ps(gains + i));
+        _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), v));
+    }
+#endif
+    for (; i < n; i++) dst[i] += gains[i] * src[i];
+}
+
+// Linear envelope: x[i] *= g0 + i * step.
+static void dsp_ramp(float *x, int n, float g0, float step) {
+    int i = 0;
+#ifdef PM_HAVE_SSE2
+    __m128 vg = _mm_setr_ps(g0, g0 + step, g0 + 2 * step, g0 + 3 * step);
+    __m128 vstep = _mm_set1_ps(4 * step);
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_ps(x + i, _mm_mul_ps(_mm_loadu_ps(x + i), vg));
+        vg = _mm_add_ps(vg, vstep);
+    }
+#endif
+    for (; i < n; i++) x[i] *= g0 + i * step;
+}
+
+static void dsp_clip(float *x, int n) {
+    int i = 0;
+#ifdef PM_HAVE_SSE2
+    __m128 lo = _mm_set1_ps(-1.0f), hi = _mm_set1_ps(1.0f);
+    for (; i + 4 <= n; i += 4)
+        _mm_storeu_ps(x + i, _mm_min_ps(_mm_max_ps(_mm_loadu_ps(x + i), lo), hi));
+#endif
+    for (; i < n; i++) x[i] = x[i] < -1.0f ? -1.0f : (x[i] > 1.0f ? 1.0f : x[i]);
+}
+
+static double dsp_sum_squares(const float *x, int n) {
+    double acc = 0.0;
+    int i = 0;
+#ifdef PM_HAVE_SSE2
+    __m128 vacc = _mm_setzero_ps();
+    for (; i + 4 <= n; i += 4) {
+        __m128 v = _mm_loadu_ps(x + i);
+        vacc = _mm_add_ps(vacc, _mm_mul_ps(v, v));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, vacc);
+    acc = (double)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+    for (; i < n; i++) acc += (double)x[i] * x[i];
+    return acc;
+}
+
+static float **dsp_alloc_planes(int channels, int nb_samples) {
+    uint8_t **buf = NULL;
+    if (av_samples_alloc_array_and_samples(&buf, NULL, channels, nb_samples,
+                                           AV_SAMPLE_FMT_FLTP, 0) < 0)
+        return NULL;
+    return (float **)buf;
+}
+
+static void dsp_free_planes(float ***planes) {
+    if (!*planes) return;
+    av_freep(&(*planes)[0]);
+    av_freep(planes);
+}
+
+// Per-plane pointers advanced by `offset` samples.
+static void dsp_offset_planes(float **src, int channels, int offset, float **dst) {
+    for (int c = 0; c < channels; c++) dst[c] = src[c] + offset;
+}
+
+// ---------- reader: any input -> float planar chunks ----------
+
+typedef struct {
+    BufferData bd;
+    AVFormatContext *ifmt_ctx;
+    AVIOContext *avio_ctx;
+    AVCodecContext *dec_ctx;
+    SwrContext *swr;
+    AVPacket *pkt;
+    AVFrame *frame;
+    int audio_idx;
+    int sample_rate;
+    int channels;
+    float **buf;        // last chunk, `channels` planes
+    int buf_cap;
+    int sent_eof;
+    int draining;       // decoder exhausted, draining the resampler
+    // Optional sink for packets of other streams (e.g. video copied through
+    // while the audio is re-encoded). NULL discards them.
+    void (*on_packet)(void *opaque, AVPacket *pkt);
+    void *opaque;
+} AudioReader;
+
+static void audio_reader_close(AudioReader *r) {
+    dsp_free_planes(&r->buf);
+    if (r->frame) av_frame_free(&r->frame);
+    if (r->pkt) av_packet_free(&r->pkt);
+    swr_cache_release(&r->swr);
+    if (r->dec_ctx) avcodec_free_context(&r->dec_ctx);
+    close_input(&r->ifmt_ctx, &r->avio_ctx);
+}
+
+// Open the first audio stream of `data`, resampling to `sample_rate` /
+// `channels` float planar (<= 0 keeps the source value). Returns -2 when
+// the stream decodes but no resampler to that layout can be set up.
+static int audio_reader_open(AudioReader *r, uint8_t *data, size_t size,
+                             int sample_rate, int channels) {
+    memset(r, 0, sizeof(*r));
+    if (open_input_memory(data, size, &r->ifmt_ctx, &r->avio_ctx, &r->bd) < 0)
+        goto fail;
+    r->audio_idx = find_stream(r->ifmt_ctx, AVMEDIA_TYPE_AUDIO);
+    if (r->audio_idx < 0) goto fail;
+
+    AVCodecParameters *codecpar = r->ifmt_ctx->streams[r->audio_idx]->codecpar;
+    const AVCodec *decoder = avcodec_find_decoder(codecpar->codec_id);
+    if (!decoder) goto fail;
+    r->dec_ctx = avcodec_alloc_context3(decoder);
+    if (!r->dec_ctx) goto fail;
+    avcodec_parameters_to_context(r->dec_ctx, codecpar);
+    if (avcodec_open2(r->dec_ctx, decoder, NULL) < 0) goto fail;
+
+#if FF_NEW_CHANNEL_LAYOUT
+    int in_channels = r->dec_ctx->ch_layout.nb_channels;
+#else
+    int in_channels = r->dec_ctx->channels;
+#endif
+    if (in_channels <= 0) in_channels = 2;
+    r->sample_rate = sample_rate > 0 ? sample_rate : r->dec_ctx->sample_rate;
+    r->channels = channels > 0 ? channels : in_channels;
+    if (r->channels > AUDIO_DSP_MAX_CHANNELS) r->channels = 2;
+    if (r->sample_rate <= 0) goto fail;
+
+#if FF_NEW_CHANNEL_LAYOUT
+    {
+        AVChannelLayout out_layout;
+        AVChannelLayout in_layout;
+        av_channel_layout_default(&out_layout, r->channels);
+        if (r->dec_ctx->ch_layout.nb_channels > 0)
+            av_channel_layout_copy(&in_layout, &r->dec_ctx->ch_layout);
+        else
+            av_channel_layout_default(&in_layout, 2);
+        swr_alloc_set_opts2(&r->swr, &out_layout, AV_SAMPLE_FMT_FLTP, r->sample_rate,
+            &in_layout, r->dec_ctx->sample_fmt, r->dec_ctx->sample_rate, 0, NULL);
+        av_channel_layout_uninit(&out_layout);
+        av_channel_layout_uninit(&in_layout);
+    }
+#else
+    r->swr = swr_alloc_set_opts(NULL,
+        av_get_default_channel_layout(r->channels), AV_SAMPLE_FMT_FLTP, r->sample_rate,
+        r->dec_ctx->channel_layout ? r->dec_ctx->channel_layout
+            : av_get_default_channel_layout(r->dec_ctx->channels),
+        r->dec_ctx->sample_fmt, r->dec_ctx->sample_rate, 0, NULL);
+#endif
+    if (swr_cache_init(&r->swr) < 0) {
+        audio_reader_close(r);
+        return -2;
+    }
+
+    r->pkt = av_packet_alloc();
+    r->frame = av_frame_alloc();
+    r->buf_cap = AUDIO_DSP_CHUNK;
+    r->buf = dsp_alloc_planes(r->channels, r->buf_cap);
+    if (!r->pkt || !r->frame || !r->buf) goto fail;
+    return 0;
+
+fail:
+    audio_reader_close(r);
+    return -1;
+}
+
+// Helpers that read `data` more than once: pass `pass` of `passes` reports
+// progress from pass * duration over passes * duration.
+static void audio_reader_pass(AudioReader *r, int pass, int passes) {
+    int64_t duration = r->ifmt_ctx->duration > 0 ? r->ifmt_ctx->duration : 0;
+    pm_progress_input(pass * duration, passes * duration);
+}
+
+static int audio_reader_convert(AudioReader *r, const AVFrame *frame) {
+    int in_samples = frame ? frame->nb_samples : 0;
+    int out_samples = swr_get_out_samples(r->swr, in_samples);
+    if (out_samples <= 0) return 0;
+    if (out_samples > r->buf_cap) {
+        dsp_free_planes(&r->buf);
+        r->buf = dsp_alloc_planes(r->channels, out_samples);
+        if (!r->buf) return -1;
+        r->buf_cap = out_samples;
+    }
+    return pm_swr_convert(r->swr, (uint8_t **)r->buf, r->buf_cap,
+                       frame ? (const uint8_t **)frame->data : NULL, in_samples);
+}
+
+static int audio_reader_next_packet(AudioReader *r) {
+    if (!r->on_packet) return read_next_stream_packet(r->ifmt_ctx, r->audio_idx, r->pkt);
+    while (pm_read_frame(r->ifmt_ctx, r->pkt) >= 0) {
+        if (r->pkt->stream_index == r->audio_idx) return 1;
+        r->on_packet(r->opaque, r->pkt);
+        av_packet_unref(r->pkt);
+    }
+    return 0;
+}
+
+// Decode and resample the next chunk into r->buf. Returns the number of
+// samples per channel, 0 at end of stream, < 0 on error.
+static int audio_reader_read(AudioReader *r) {
+    while (!r->draining) {
+        int ret = pm_receive_frame(r->dec_ctx, r->frame);
+        if (ret == 0) {
+            int n = audio_reader_convert(r, r->frame);
+            av_frame_unref(r->frame);
+            if (n != 0) return n;
+            continue;
+        }
+        if (ret != AVERROR(EAGAIN) || r->sent_eof) {
+            r->draining = 1;
+            break;
+        }
+        if (audio_reader_next_packet(r) <= 0) {
+            pm_send_packet(r->dec_ctx, NULL);
+            r->sent_eof = 1;
+            continue;
+        }
+        pm_send_packet(r->dec_ctx, r->pkt);
+        av_packet_unref(r->pkt);
+    }
+    int n = audio_reader_convert(r, NULL);
+    return n > 0 ? n : 0;
+}
+
+// ---------- writer: float planar chunks -> encoded audio file ----------
+
+typedef struct {
+    AVFormatContext *ofmt_ctx;
+    AVStream *out_stream;
+    AVStream *copy_stream;  // optional stream-copied companion (video)
+    AVCodecContext *enc_ctx;
+    SwrContext *swr;
+    AVAudioFifo *fifo;
+    AVPacket *pkt;
+    AVFrame *frame;
+    uint8_t **conv;
+    int conv_cap;
+    int frame_size;
+    int channels;
+    int64_t pts;
+} AudioWriter;
+
+static const AVCodec *find_audio_encoder(const char *format, const char *encoder_name) {
+    const AVCodec *encoder = avcodec_find_encoder_by_name(encoder_name);
+    if (!encoder && strcmp(format, "ogg") == 0) {
+        encoder = avcodec_find_encoder_by_name("vorbis");
+        if (!encoder) encoder = avcodec_find_encoder(AV_CODEC_ID_VORBIS);
+    }
+    if (!encoder && strcmp(format, "opus") == 0) {
+        encoder = avcodec_find_encoder_by_name("opus");
+        if (!encoder) encoder = avcodec_find_encoder(AV_CODEC_ID_OPUS);
+    }
+    return encoder;
+}
+
+static void audio_writer_close(AudioWriter *w) {
+    if (w->conv) { av_freep(&w->conv[0]); av_freep(&w->conv); }
+    if (w->frame) av_frame_free(&w->frame);
+    if (w->pkt) av_packet_free(&w->pkt);
+    if (w->enc_ctx) audio_fifo_release(&w->fifo, w->enc_ctx->sample_fmt, w->channels);
+    swr_cache_release(&w->swr);
+    if (w->enc_ctx) avcodec_free_context(&w->enc_ctx);
+    if (w->ofmt_ctx) {
+        if (w->ofmt_ctx->pb) {
+            uint8_t *dummy;
+            avio_close_dyn_buf(w->ofmt_ctx->pb, &dummy);
+            av_free(dummy);
+        }
+        avformat_free_context(w->ofmt_ctx);
+    }
+    memset(w, 0, sizeof(*w));
+}
+
+// Open an encoder for `format`. `muxer` overrides the format's default
+// container; `copy_par`, when set, adds a stream-copied companion stream
+// (written with audio_writer_copy_packet) ahead of the audio stream.
+static int audio_writer_open_ex(AudioWriter *w, const char *format, const char *muxer,
+                                int sample_rate, int channels,
+                                const AVCodecParameters *copy_par, AVRational copy_tb) {
+    memset(w, 0, sizeof(*w));
+    const char *encoder_name, *muxer_name;
+    enum AVSampleFormat enc_sample_fmt;
+    int bitrate;
+    if (!format || get_audio_format_info(format, &encoder_name, &muxer_name,
+                                         &enc_sample_fmt, &bitrate) < 0) {
+        fprintf(stderr, "Unsupported audio format: %s\n", format ? format : "(null)");
+        return -1;
+    }
+    if (muxer) muxer_name = muxer;
+
+    const AVCodec *encoder = find_audio_encoder(format, encoder_name);
+    if (!encoder) goto fail;
+    w->enc_ctx = avcodec_alloc_context3(encoder);
+    if (!w->enc_ctx) goto fail;
+    w->enc_ctx->sample_rate = sample_rate;
+    w->enc_ctx->sample_fmt = pick_sample_fmt(encoder, enc_sample_fmt);
+    if (strcmp(format, "ogg") == 0)
+        w->enc_ctx->strict_std_compliance = FF_COMPLIANCE_EXPERIMENTAL;
+#if FF_NEW_CHANNEL_LAYOUT
+    av_channel_layout_default(&w->enc_ctx->ch_layout, channels);
+#else
+    w->enc_ctx->channel_layout = av_get_default_channel_layout(channels);
+    w->enc_ctx->channels = channels;
+#endif
+    if (bitrate > 0) w->enc_ctx->bit_rate = bitrate;
+    w->enc_ctx->time_base = (AVRational){1, sample_rate};
+
+    const AVOutputFormat *ofmt = av_guess_format(muxer_name, NULL, NULL);
+    if (ofmt && (ofmt->flags & AVFMT_GLOBALHEADER))
+        w->enc_ctx->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+    if (avcodec_open2(w->enc_ctx, encoder, NULL) < 0) goto fail;
+    w->frame_size = w->enc_ctx->frame_size > 0 ? w->enc_ctx->frame_size : 1024;
+    w->channels = channels;
+
+    // Same rate and layout: the resampler only converts the sample format.
+#if FF_NEW_CHANNEL_LAYOUT
+    swr_alloc_set_opts2(&w->swr, &w->enc_ctx->ch_layout, w->enc_ctx->sample_fmt, sample_rate,
+        &w->enc_ctx->ch_layout, AV_SAMPLE_FMT_FLTP, sample_rate, 0, NULL);
+#else
+    w->swr = swr_alloc_set_opts(NULL,
+        w->enc_ctx->channel_layout, w->enc_ctx->sample_fmt, sample_rate,
+        w->enc_ctx->channel_layout, AV_SAMPLE_FMT_FLTP, sample_rate, 0, NULL);
+#endif
+    if (swr_cache_init(&w->swr) < 0) goto fail;
+
+    w->fifo = audio_fifo_acquire(w->enc_ctx->sample_fmt, channels, w->frame_size);
+    if (!w->fifo) goto fail;
+
+    avformat_alloc_output_context2(&w->ofmt_ctx, NULL, muxer_name, NULL);
+    if (!w->ofmt_ctx) goto fail;
+    if (avio_open_dyn_buf(&w->ofmt_ctx->pb) < 0) goto fail;
+    if (copy_par) {
+        w->copy_stream = avformat_new_stream(w->ofmt_ctx, NULL);
+        if (!w->copy_stream) goto fail;
+        avcodec_parameters_copy(w->copy_stream->codecpar, copy_par);
+        w->copy_stream->codecpar->codec_tag = 0;
+        w->copy_stream->time_base = copy_tb;
+    }
+    w->out_stream = avformat_new_stream(w->ofmt_ctx, NULL);
+    if (!w->out_stream) goto fail;
+    avcodec_parameters_from_context(w->out_stream->codecpar, w->enc_ctx);
+    w->out_stream->time_base = w->enc_ctx->time_base;
+    if (avformat_write_header(w->ofmt_ctx, NULL) < 0) goto fail;
+
+    w->pkt = av_packet_alloc();
+    w->frame = av_frame_alloc();
+    if (!w->pkt || !w->frame) goto fail;
+    return 0;
+
+fail:
+    audio_writer_close(w);
+    return -1;
+}
+
+static int audio_writer_open(AudioWriter *w, const char *format, int sample_rate, int channels) {
+    return audio_writer_open_ex(w, format, NULL, sample_rate, channels, NULL, (AVRational){0, 1});
+}
+
+// Write a packet of the companion stream unchanged, rescaling from `src_tb`.
+static void audio_writer_copy_packet(AudioWriter *w, AVPacket *pkt, AVRational src_tb) {
+    pkt->stream_index = w->copy_stream->index;
+    av_packet_rescale_ts(pkt, src_tb, w->copy_stream->time_base);
+    pkt->pos = -1;
+    pm_write_frame(w->ofmt_ctx, pkt);
+}
+
+static int audio_writer_write(AudioWriter *w, float **planes, int nb_samples) {
+    if (nb_samples <= 0) return 0;
+    if (nb_samples > w->conv_cap) {
+        if (w->conv) { av_freep(&w->conv[0]); av_freep(&w->conv); }
+        if (av_samples_alloc_array_and_samples(&w->conv, NULL, w->channels, nb_samples,
+                                               w->enc_ctx->sample_fmt, 0) < 0)
+            return -1;
+        w->conv_cap = nb_samples;
+    }
+    int converted = pm_swr_convert(w->swr, w->conv, w->conv_cap,
+                                (const uint8_t **)planes, nb_samples);
+    if (converted < 0) return -1;
+    av_audio_fifo_write(w->fifo, (void **)w->conv, converted);
+    encode_fifo_frames(w->fifo, w->enc_ctx, w->ofmt_ctx, w->out_stream,
+                       w->pkt, w->frame, w->frame_size, &w->pts);
+    return 0;
+}
+
+// Flush the encoder and return the finished file (malloc'd).
+static uint8_t *audio_writer_finish(AudioWriter *w, size_t *out_size) {
+    uint8_t *output_buffer = NULL;
+    uint8_t *result = NULL;
+
+    encode_fifo_remaining(w->fifo, w->enc_ctx, w->ofmt_ctx, w->out_stream,
+                          w->pkt, w->frame, &w->pts);
+    pm_send_frame(w->enc_ctx, NULL);
+    while (pm_receive_packet(w->enc_ctx, w->pkt) == 0) {
+        w->pkt->stream_index = w->out_stream->index;
+        av_packet_rescale_ts(w->pkt, w->enc_ctx->time_base, w->out_stream->time_base);
+        pm_write_frame(w->ofmt_ctx, w->pkt);
+        av_packet_unref(w->pkt);
+    }
+    av_write_trailer(w->ofmt_ctx);
+
+    int output_size = avio_close_dyn_buf(w->ofmt_ctx->pb, &output_buffer);
+    w->ofmt_ctx->pb = NULL;
+    if (output_size > 0) {
+        result = malloc(output_size);
+        if (result) {
+            memcpy(result, output_buffer, output_size);
+            *out_size = output_size;
+        }
+    }
+    av_free(output_buffer);
+    return result;
+}
+
+// Packet sink for AudioReader.on_packet: copies one stream of the reader's
+// input into the writer's companion stream.
+typedef struct {
+    AudioWriter *w;
+    int stream_idx;
+    AVRational time_base;
+} PacketCopy;
+
+static void packet_copy_cb(void *opaque, AVPacket *pkt) {
+    PacketCopy *copy = opaque;
+    if (pkt->stream_index == copy->stream_idx)
+        audio_writer_copy_packet(copy->w, pkt, copy->time_base);
+}
+
+// Move up to `count` samples from `fifo` to the writer in chunks through `tmp`.
+static int dsp_drain_fifo(AVAudioFifo *fifo, int count, float **tmp, int tmp_cap,
+                          AudioWriter *w) {
+    while (count > 0) {
+        int n = count < tmp_cap ? count : tmp_cap;
+        n = av_audio_fifo_read(fifo, (void **)tmp, n);
+        if (n <= 0) break;
+        if (audio_writer_write(w, tmp, n) < 0) return -1;
+        count -= n;
+    }
+    return 0;
+}
+
+// ---------- fade ----------
+
+PYMEDIA_API uint8_t* audio_fade(uint8_t *data, size_t size, double in_sec, double out_sec,
+                                const char *format, size_t *out_size) {
+    *out_size = 0;
+    AudioReader r;
+    AudioWriter w;
+    AVAudioFifo *tail = NULL;
+    float **tmp = NULL;
+    uint8_t *result = NULL;
+    int writer_open = 0;
+
+    if (audio_reader_open(&r, data, size, -1, -1) < 0) return NULL;
+    if (audio_writer_open(&w, format, r.sample_rate, r.channels) < 0) goto cleanup;
+    writer_open = 1;
+
+    int64_t fade_in = (int64_t)(in_sec * r.sample_rate);
+    int fade_out = (int)(out_sec * r.sample_rate);
+    tmp = dsp_alloc_planes(r.channels, AUDIO_DSP_CHUNK);
+    if (!tmp) goto cleanup;
+    // Fade-out needs the last `fade_out` samples, which are only known at
+    // EOF: hold them back in a FIFO instead of decoding the whole track.
+    if (fade_out > 0) {
+        tail = av_audio_fifo_alloc(AV_SAMPLE_FMT_FLTP, r.channels, fade_out + AUDIO_DSP_CHUNK);
+        if (!tail) goto cleanup;
+    }
+
+    int64_t pos = 0;
+    int n;
+    while ((n = audio_reader_read(&r)) > 0) {
+        if (pos < fade_in) {
+            int count = (int)(fade_in - pos < n ? fade_in - pos : n);
+            for (int c = 0; c < r.channels; c++)
+                dsp_ramp(r.buf[c], count, (float)((double)pos / fade_in), (float)(1.0 / fade_in));
+        }
+        pos += n;
+        if (!tail) {
+            if (audio_writer_write(&w, r.buf, n) < 0) goto cleanup;
+            continue;
+        }
+        av_audio_fifo_write(tail, (void **)r.buf, n);
+        int excess = av_audio_fifo_size(tail) - fade_out;
+        if (excess > 0 && dsp_drain_fifo(tail, excess, tmp, AUDIO_DSP_CHUNK, &w) < 0)
+            goto cleanup;
+    }
+    if (n < 0) goto cleanup;
+
+    if (tail) {
+        int count = av_audio_fifo_size(tail);
+        if (count > 0) {
+            float **out = dsp_alloc_planes(r.channels, count);
+            if (!out) goto cleanup;
+            av_audio_fifo_read(tail, (void **)out, count);
+            for (int c = 0; c < r.channels; c++)
+                dsp_ramp(out[c], count, 1.0f, -1.0f / count);
+            int ret = audio_writer_write(&w, out, count);
+            dsp_free_planes(&out);
+            if (ret < 0) goto cleanup;
+        }
+    }
+    result = audio_writer_finish(&w, out_size);
+
+cleanup:
+    dsp_free_planes(&tmp);
+    if (tail) av_audio_fifo_free(tail);
+    if (writer_open) audio_writer_close(&w);
+    audio_reader_close(&r);
+    return result;
+}
+
+// ---------- static gain ----------
+
+// Decode `data` again at the given rate/layout, apply `gain` with hard
+// clipping and encode. Second pass of the measure-then-apply helpers.
+static uint8_t *audio_gain_encode(uint8_t *data, size_t size, int sample_rate, int channels,
+                                  float gain, const char *format, size_t *out_size) {
+    AudioReader r;
+    AudioWriter w;
+    uint8_t *result = NULL;
+    int n;
+
+    if (audio_reader_open(&r, data, size, sample_rate, channels) < 0) return NULL;
+    if (audio_writer_open(&w, format, sample_rate, channels) < 0) {
+        audio_reader_close(&r);
+        return NULL;
+    }
+    audio_reader_pass(&r, 1, 2);
+    while ((n = audio_reader_read(&r)) > 0) {
+        for (int c = 0; c < channels; c++) {
+            dsp_gain(r.buf[c], n, gain);
+            dsp_clip(r.buf[c], n);
+        }
+        if (audio_writer_write(&w, r.buf, n) < 0) break;
+    }
+    if (n == 0) result = audio_writer_finish(&w, out_size);
+    audio_writer_close(&w);
+    audio_reader_close(&r);
+    pm_progress_input(0, 0);
+    return result;
+}
+
+// ---------- silence ----------
+//
+// SilenceDetector keeps a running mean-square over a short trailing window
+// (ring of per-sample energies) and reports each silent range through a
+// callback as soon as it closes, so memory is O(window) regardless of
+// duration.
+
+#define SILENCE_WINDOW_SEC 0.02
+#define SILENCE_XFADE_SEC 0.01
+
+typedef void (*silence_range_fn)(void *opaque, int64_t start, int64_t end);
+
+typedef struct {
+    int channels;
+    int window;
+    float *energy;          // ring of per-sample mean-square across channels
+    double sum;
+    int64_t t;
+    double threshold_sq;
+    int64_t min_frames;
+    int64_t run_start;      // -1 while loud
+    int64_t last_end;       // end of the last emitted range
+    silence_range_fn emit;
+    void *opaque;
+} SilenceDetector;
+
+static int silence_detector_init(SilenceDetector *d, int sample_rate, int channels,
+                                 double threshold_db, double min_silence,
+                                 silence_range_fn emit, void *opaque) {
+    memset(d, 0, sizeof(*d));
+    d->channels = channels;
+    d->window = (int)(SILENCE_WINDOW_SEC * sample_rate);
+    if (d->window < 1) d->window = 1;
+    d->energy = calloc(d->window, sizeof(float));
+    if (!d->energy) return -1;
+    double threshold = pow(10.0, threshold_db / 20.0);
+    d->threshold_sq = threshold * threshold;
+    d->min_frames = (int64_t)(min_silence * sample_rate);
+    if (d->min_frames < 1) d->min_frames = 1;
+    d->run_start = -1;
+    d->emit = emit;
+    d->opaque = opaque;
+    return 0;
+}
+
+static void silence_detector_free(SilenceDetector *d) {
+    free(d->energy);
+    d->energy = NULL;
+}
+
+static void silence_detector_close_run(SilenceDetector *d, int64_t end) {
+    if (d->run_start >= 0 && end - d->run_start >= d->min_frames) {
+        d->emit(d->opaque, d->run_start, end);
+        d->last_end = end;
+    }
+    d->run_start = -1;
+}
+
+static void silence_detector_feed(SilenceDetector *d, float **planes, int n) {
+    float inv_channels = 1.0f / d->channels;
+    for (int i = 0; i < n; i++) {
+        float e = 0.0f;
+        for (int c = 0; c < d->channels; c++) e += planes[c][i] * planes[c][i];
+        e *= inv_channels;
+        int slot = (int)(d->t % d->window);
+        d->sum += e - d->energy[slot];
+        if (d->sum < 0.0) d->sum = 0.0;
+        d->energy[slot] = e;
+
+        int64_t filled = d->t + 1 < d->window ? d->t + 1 : d->window;
+        int silent = d->sum / filled <= d->threshold_sq;
+        if (silent && d->run_start < 0) {
+            // The whole trailing window is quiet: silence began at its start.
+            d->run_start = d->t - filled + 1;
+            // A loud blip shorter than the window reaches back into the
+            // previous range; keep emitted ranges disjoint and ordered.
+            if (d->run_start < d->last_end) d->run_start = d->last_end;
+        } else if (!silent && d->run_start >= 0) {
+            silence_detector_close_run(d, d->t);
+        }
+        d->t++;
+    }
+}
+
+static void silence_detector_finish(SilenceDetector *d) {
+    silence_detector_close_run(d, d->t);
+}
+
+typedef struct {
+    char *json;
+    size_t len, cap;
+    int sample_rate;
+    int first;
+} SilenceJson;
+
+static void silence_emit_json(void *opaque, int64_t start, int64_t end) {
+    SilenceJson *sj = opaque;
+    char item[96];
+    snprintf(item, sizeof(item), "%s{\"start\":%.6f,\"end\":%.6f}", sj->first ? "" : ",",
+             (double)start / sj->sample_rate, (double)end / sj->sample_rate);
+    json_append(&sj->json, &sj->len, &sj->cap, item);
+    sj->first = 0;
+}
+
+PYMEDIA_API char* audio_silence_ranges_json(uint8_t *data, size_t size,
+                                            double threshold_db, double min_silence) {
+    AudioReader r;
+    SilenceDetector d;
+    SilenceJson sj = { NULL, 0, 256, 0, 1 };
+    int n = -1;
+
+    if (audio_reader_open(&r, data, size, -1, -1) < 0) return NULL;
+    sj.sample_rate = r.sample_rate;
+    sj.json = malloc(sj.cap);
+    if (!sj.json) goto cleanup;
+    sj.json[0] = '\0';
+    json_append(&sj.json, &sj.len, &sj.cap, "[");
+
+    if (silence_detector_init(&d, r.sample_rate, r.channels, threshold_db, min_silence,
+                              silence_emit_json, &sj) < 0)
+        goto cleanup;
+    while ((n = audio_reader_read(&r)) > 0) silence_detector_feed(&d, r.buf, n);
+    if (n == 0) silence_detector_finish(&d);
+    silence_detector_free(&d);
+    json_append(&sj.json, &sj.len, &sj.cap, "]");
+
+cleanup:
+    audio_reader_close(&r);
+    if (n < 0) {
+        free(sj.json);
+        return NULL;
+    }
+    return sj.json;
+}
+
+typedef struct {
+    int64_t *ranges;        // start/end pairs in samples
+    int count, cap;
+    int error;              // a range could not be stored
+} SilenceRanges;
+
+static void silence_emit_range(void *opaque, int64_t start, int64_t end) {
+    SilenceRanges *sr = opaque;
+    if (sr->count == sr->cap) {
+        int cap = sr->cap ? sr->cap * 2 : 16;
+        int64_t *grown = realloc(sr->ranges, sizeof(int64_t) * 2 * cap);
+        if (!grown) {
+            sr->error = 1;
+            return;
+        }
+        sr->ranges = grown;
+        sr->cap = cap;
+    }
+    sr->ranges[2 * sr->count] = start;
+    sr->ranges[2 * sr->count + 1] = end;
+    sr->count++;
+}
+
+// Two streaming passes: the first runs the detector and records ranges,
+// the second writes everything outside them. Non-silent audio is passed
+// through untouched; at each cut the first and last `xfade` samples of the
+// removed range are crossfaded, so the splice happens inside quiet
+// material and never clicks. Memory is O(window + xfade + ranges).
+PYMEDIA_API uint8_t* audio_silence_remove(uint8_t *data, size_t size, double threshold_db,
+                                          double min_silence, const char *format,
+                                          size_t *out_size) {
+    *out_size = 0;
+    AudioReader r;
+    AudioWriter w;
+    SilenceDetector d;
+    SilenceRanges sr = { NULL, 0, 0, 0 };
+    float **xbuf = NULL, **tmp = NULL;
+    uint8_t *result = NULL;
+    int writer_open = 0;
+    int n;
+
+    if (audio_reader_open(&r, data, size, -1, -1) < 0) return NULL;
+    audio_reader_pass(&r, 0, 2);
+    if (silence_detector_init(&d, r.sample_rate, r.channels, threshold_db, min_silence,
+                              silence_emit_range, &sr) < 0)
+        goto cleanup;
+    while ((n = audio_reader_read(&r)) > 0) silence_detector_feed(&d, r.buf, n);
+    if (n == 0) silence_detector_finish(&d);
+    silence_detector_free(&d);
+    if (n < 0 || sr.error) goto cleanup;
+
+    int sample_rate = r.sample_rate, channels = r.channels;
+    audio_reader_close(&r);
+    if (audio_reader_open(&r, data, size, sample_rate, channels) < 0) goto cleanup;
+    audio_reader_pass(&r, 1, 2);
+    if (audio_writer_open(&w, format, sample_rate, channels) < 0) goto cleanup;
+    writer_open = 1;
+
+    int64_t xfade = (int64_t)(SILENCE_XFADE_SEC * sample_rate);
+    if (xfade > d.min_frames / 2) xfade = d.min_frames / 2;
+    if (xfade < 1) xfade = 1;
+    xbuf = dsp_alloc_planes(channels, (int)xfade);
+    tmp = dsp_alloc_planes(channels, (int)xfade);
+    if (!xbuf || !tmp) goto cleanup;
+
+    int64_t pos = 0;
+    int range = 0;
+    float *span[AUDIO_DSP_MAX_CHANNELS];
+    while ((n = audio_reader_read(&r)) > 0) {
+        int i = 0;
+        while (i < n) {
+            int64_t abs_i = pos + i;
+            if (range >= sr.count) {
+                dsp_offset_planes(r.buf, channels, i, span);
+                if (audio_writer_write(&w, span, n - i) < 0) goto cleanup;
+                break;
+            }
+            int64_t s = sr.ranges[2 * range], e = sr.ranges[2 * range + 1];
+            int64_t fade_in = e - xfade;
+            int64_t stop;
+            if (abs_i < s) {
+                // Kept audio: copied through as-is.
+                stop = s;
+                int len = (int)((stop < pos + n ? stop : pos + n) - abs_i);
+                dsp_offset_planes(r.buf, channels, i, span);
+                if (audio_writer_write(&w, span, len) < 0) goto cleanup;
+                i += len;
+            } else if (abs_i < s + xfade) {
+                stop = s + xfade;
+                int len = (int)((stop < pos + n ? stop : pos + n) - abs_i);
+                for (int c = 0; c < channels; c++)
+                    memcpy(xbuf[c] + (abs_i - s), r.buf[c] + i, sizeof(float) * len);
+                i += len;
+            } else if (abs_i < fade_in) {
+                stop = fade_in;
+                i += (int)((stop < pos + n ? stop : pos + n) - abs_i);
+            } else if (abs_i < e) {
+                stop = e;
+                int len = (int)((stop < pos + n ? stop : pos + n) - abs_i);
+                int64_t k0 = abs_i - fade_in;
+                for (int c = 0; c < channels; c++) {
+                    for (int k = 0; k < len; k++) {
+                        float g = (float)(k0 + k + 1) / (float)(xfade + 1);
+                        tmp[c][k] = xbuf[c][k0 + k] * (1.0f - g) + r.buf[c][i + k] * g;
+                    }
+                }
+                if (audio_writer_write(&w, tmp, len) < 0) goto cleanup;
+                i += len;
+            } else {
+                range++;
+            }
+        }
+        pos += n;
+    }
+    if (n < 0) goto cleanup;
+    result = audio_writer_finish(&w, out_size);
+
+cleanup:
+    free(sr.ranges);
+    dsp_free_planes(&tmp);
+    dsp_free_planes(&xbuf);
+    if (writer_open) audio_writer_close(&w);
+    audio_reader_close(&r);
+    pm_progress_input(0, 0);
+    return result;
+}
+
+// ---------- crossfade ----------
+
+PYMEDIA_API uint8_t* audio_crossfade(uint8_t *data_a, size_t size_a,
+                                     uint8_t *data_b, size_t size_b, double duration,
+                                     const char *format, int *status, size_t *out_size) {
+    *out_size = 0;
+    *status = 0;
+    AudioReader ra, rb;
+    AudioWriter w;
+    AVAudioFifo *tail = NULL, *head = NULL;
+    float **tmp = NULL, **fa = NULL, **fb = NULL;
+    uint8_t *result = NULL;
+    int rb_open = 0, writer_open = 0;
+
+    if (audio_reader_open(&ra, data_a, size_a, -1, -1) < 0) return NULL;
+    int ret = audio_reader_open(&rb, data_b, size_b, ra.sample_rate, ra.channels);
+    if (ret < 0) {
+        if (ret == -2) *status = AUDIO_DSP_ERR_LAYOUT;
+        goto cleanup;
+    }
+    rb_open = 1;
+    if (audio_writer_open(&w, format, ra.sample_rate, ra.channels) < 0) goto cleanup;
+    writer_open = 1;
+
+    int channels = ra.channels;
+    int fade = (int)(duration * ra.sample_rate);
+    if (fade <= 0) {
+        *status = AUDIO_DSP_ERR_SHORT;
+        goto cleanup;
+    }
+    tail = av_audio_fifo_alloc(AV_SAMPLE_FMT_FLTP, channels, fade + AUDIO_DSP_CHUNK);
+    head = av_audio_fifo_alloc(AV_SAMPLE_FMT_FLTP, channels, fade + AUDIO_DSP_CHUNK);
+    tmp = dsp_alloc_planes(channels, AUDIO_DSP_CHUNK);
+    if (!tail || !head || !tmp) goto cleanup;
+
+    // A streams through, holding back its last `fade` samples.
+    int n;
+    while ((n = audio_reader_read(&ra)) > 0) {
+        av_audio_fifo_write(tail, (void **)ra.buf, n);
+        int excess = av_audio_fifo_size(tail) - fade;
+        if (excess > 0 && dsp_drain_fifo(tail, excess, tmp, AUDIO_DSP_CHUNK, &w) < 0)
+            goto cleanup;
+    }
+    if (n < 0) goto cleanup;
+
+    while (av_audio_fifo_size(head) < fade && (n = audio_reader_read(&rb)) > 0)
+        av_audio_fifo_write(head, (void **)rb.buf, n);
+    if (n < 0) goto cleanup;
+
+    int overlap = av_audio_fifo_size(tail);
+    if (av_audio_fifo_size(head) < overlap) overlap = av_audio_fifo_size(head);
+    if (overlap <= 0) {
+        *status = AUDIO_DSP_ERR_SHORT;
+        goto cleanup;
+    }
+    if (dsp_drain_fifo(tail, av_audio_fifo_size(tail) - overlap, tmp, AUDIO_DSP_CHUNK, &w) < 0)
+        goto cleanup;
+
+    fa = dsp_alloc_planes(channels, overlap);
+    fb = dsp_alloc_planes(channels, overlap);
+    if (!fa || !fb) goto cleanup;
+    av_audio_fifo_read(tail, (void **)fa, overlap);
+    av_audio_fifo_read(head, (void **)fb, overlap);
+    for (int c = 0; c < channels; c++) {
+        dsp_ramp(fa[c], overlap, 1.0f, -1.0f / overlap);
+        dsp_ramp(fb[c], overlap, 0.0f, 1.0f / overlap);
+        dsp_mix(fa[c], fb[c], overlap, 1.0f);
+        dsp_clip(fa[c], overlap);
+    }
+    if (audio_writer_write(&w, fa, overlap) < 0) goto cleanup;
+
+    if (dsp_drain_fifo(head, av_audio_fifo_size(head), tmp, AUDIO_DSP_CHUNK, &w) < 0)
+        goto cleanup;
+    while ((n = audio_reader_read(&rb)) > 0)
+        if (audio_writer_write(&w, rb.buf, n) < 0) goto cleanup;
+    if (n < 0) goto cleanup;
+    result = audio_writer_finish(&w, out_size);
+
+cleanup:
+    dsp_free_planes(&fb);
+    dsp_free_planes(&fa);
+    dsp_free_planes(&tmp);
+    if (head) av_audio_fifo_free(head);
+    if (tail) av_audio_fifo_free(tail);
+    if (writer_open) audio_writer_close(&w);
+    if (rb_open) audio_reader_close(&rb);
+    audio_reader_close(&ra);
+    return result;
+}
+
+// ---------- mixing ----------
+
+#define MIX_DUCK_DETECT_SEC 0.01
+#define MIX_DUCK_ATTACK_SEC 0.02
+#define MIX_DUCK_RELEASE_SEC 0.3
+
+typedef struct {
+    const double *weights;          // per input, NULL = 1.0
+    int normalize;                  // divide weights by their absolute sum
+    const double *envelopes;        // (time, gain) pairs for all inputs, concatenated
+    const int *envelope_counts;     // points per input, NULL = no automation
+    int duck_key;                   // input whose presence ducks the others, -1 = off
+    double duck_db;
+    double duck_threshold_db;
+} MixOptions;
+
+// Linear interpolation over sorted (time, gain) points; `cursor` only moves
+// forward, so evaluating a whole chunk is O(chunk + points).
+static void mix_envelope_fill(const double *points, int count, int *cursor, int64_t pos,
+                              int sample_rate, float base, float *out, int n) {
+    if (count <= 0) {
+        for (int i = 0; i < n; i++) out[i] = base;
+        return;
+    }
+    for (int i = 0; i < n; i++) {
+        double t = (double)(pos + i) / sample_rate;
+        while (*cursor + 1 < count && points[2 * (*cursor + 1)] <= t) (*cursor)++;
+        double g;
+        if (t <= points[0] || *cursor + 1 >= count) {
+            g = t <= points[0] ? points[1] : points[2 * (count - 1) + 1];
+        } else {
+            double t0 = points[2 * *cursor], g0 = points[2 * *cursor + 1];
+            double t1 = points[2 * (*cursor + 1)], g1 = points[2 * (*cursor + 1) + 1];
+            g = t1 > t0 ? g0 + (g1 - g0) * (t - t0) / (t1 - t0) : g1;
+        }
+        out[i] = base * (float)g;
+    }
+}
+
+// Mix `count` inputs at input 0's rate/layout. Each input is decoded in
+// lockstep through its own AudioReader (own decoder and SwrContext) and a
+// small FIFO, so memory does not grow with duration. Per-sample gains
+// combine the static weight, the track's envelope and the ducking gain
+// driven by `duck_key`. With `copy_video`, input 0's video stream is
+// stream-copied into the output and the mix is trimmed or padded with
+// silence to that stream's end; without a video stream it follows input
+// 0's audio. `status` (may be NULL) receives AUDIO_DSP_ERR_LAYOUT when a
+// later input cannot be resampled to input 0's layout.
+static uint8_t *audio_mix_run(uint8_t **inputs, size_t *sizes, int count,
+                              const MixOptions *opt, const char *format, const char *muxer,
+                              int copy_video, int *status, size_t *out_size) {
+    *out_size = 0;
+    if (count <= 0) return NULL;
+    AudioReader *readers = calloc(count, sizeof(*readers));
+    AVAudioFifo **fifos = calloc(count, sizeof(*fifos));
+    int *done = calloc(count, sizeof(*done));
+    float *weights = calloc(count, sizeof(*weights));
+    int *cursors = calloc(count, sizeof(*cursors));
+    const double **env = calloc(count, sizeof(*env));
+    AudioWriter w;
+    PacketCopy copy;
+    float **mix = NULL, **tmp = NULL, **key = NULL;
+    float *gains = NULL, *duck = NULL;
+    uint8_t *result = NULL;
+    int opened = 0, writer_open = 0;
+    if (!readers || !fifos || !done || !weights || !cursors || !env) goto cleanup;
+
+    for (; opened < count; opened++) {
+        int rate = opened ? readers[0].sample_rate : -1;
+        int channels = opened ? readers[0].channels : -1;
+        int ret = audio_reader_open(&readers[opened], inputs[opened], sizes[opened],
+                                    rate, channels);
+        if (ret < 0) {
+            if (ret == -2 && opened && status) *status = AUDIO_DSP_ERR_LAYOUT;
+            goto cleanup;
+        }
+    }
+    int channels = readers[0].channels;
+    int sample_rate = readers[0].sample_rate;
+    int video_idx = copy_video ? find_stream(readers[0].ifmt_ctx, AVMEDIA_TYPE_VIDEO) : -1;
+    AVStream *vst = video_idx >= 0 ? readers[0].ifmt_ctx->streams[video_idx] : NULL;
+    if (audio_writer_open_ex(&w, format, muxer, sample_rate, channels,
+                             vst ? vst->codecpar : NULL,
+                             vst ? vst->time_base : (AVRational){0, 1}) < 0)
+        goto cleanup;
+    writer_open = 1;
+    int64_t limit = -1;             // samples to produce, -1 = follow input 0
+    if (vst) {
+        copy = (PacketCopy){ &w, video_idx, vst->time_base };
+        readers[0].on_packet = packet_copy_cb;
+        readers[0].opaque = &copy;
+        int64_t end = vst->duration;
+        if (end != AV_NOPTS_VALUE && vst->start_time != AV_NOPTS_VALUE && vst->start_time > 0)
+            end += vst->start_time;
+        if (end != AV_NOPTS_VALUE && end > 0)
+            limit = av_rescale_q(end, vst->time_base, (AVRational){1, sample_rate});
+        else if (readers[0].ifmt_ctx->duration > 0)
+            limit = av_rescale_q(readers[0].ifmt_ctx->duration, AV_TIME_BASE_Q,
+                                 (AVRational){1, sample_rate});
+    }
+
+    double weight_sum = 0.0;
+    for (int k = 0; k < count; k++) weight_sum += fabs(opt->weights ? opt->weights[k] : 1.0);
+    if (!opt->normalize || weight_sum <= 0.0) weight_sum = 1.0;
+    const double *points = opt->envelopes;
+    for (int k = 0; k < count; k++) {
+        weights[k] = (float)((opt->weights ? opt->weights[k] : 1.0) / weight_sum);
+        env[k] = points;
+        if (opt->envelope_counts && points) points += 2 * opt->envelope_counts[k];
+        fifos[k] = av_audio_fifo_alloc(AV_SAMPLE_FMT_FLTP, channels, 2 * AUDIO_DSP_CHUNK);
+        if (!fifos[k]) goto cleanup;
+    }
+    int duck_key = opt->duck_key >= 0 && opt->duck_key < count ? opt->duck_key : -1;
+    mix = dsp_alloc_planes(channels, AUDIO_DSP_CHUNK);
+    tmp = dsp_alloc_planes(channels, AUDIO_DSP_CHUNK);
+    key = dsp_alloc_planes(channels, AUDIO_DSP_CHUNK);
+    gains = malloc(sizeof(float) * AUDIO_DSP_CHUNK);
+    duck = malloc(sizeof(float) * AUDIO_DSP_CHUNK);
+    if (!mix || !tmp || !key || !gains || !duck) goto cleanup;
+
+    double duck_threshold = pow(10.0, opt->duck_threshold_db / 10.0);  // mean-square
+    float duck_gain = (float)pow(10.0, opt->duck_db / 20.0);
+    float a_det = (float)(1.0 - exp(-1.0 / (MIX_DUCK_DETECT_SEC * sample_rate)));
+    float a_att = (float)(1.0 - exp(-1.0 / (MIX_DUCK_ATTACK_SEC * sample_rate)));
+    float a_rel = (float)(1.0 - exp(-1.0 / (MIX_DUCK_RELEASE_SEC * sample_rate)));
+    float level = 0.0f, duck_state = 1.0f;
+    int64_t pos = 0;
+
+    for (;;) {
+        int chunk = 0;
+        for (int k = 0; k < count; k++) {
+            while (!done[k] && av_audio_fifo_size(fifos[k]) < AUDIO_DSP_CHUNK) {
+                int n = audio_reader_read(&readers[k]);
+                if (n < 0) goto cleanup;
+                if (n == 0) done[k] = 1;
+                else av_audio_fifo_write(fifos[k], (void **)readers[k].buf, n);
+            }
+            int avail = av_audio_fifo_size(fifos[k]);
+            if (avail > AUDIO_DSP_CHUNK) avail = AUDIO_DSP_CHUNK;
+            if ((k == 0 || !copy_video) && avail > chunk) chunk = avail;
+        }
+        if (limit >= 0)
+            chunk = limit - pos < AUDIO_DSP_CHUNK ? (int)(limit - pos) : AUDIO_DSP_CHUNK;
+        if (chunk <= 0) break;
+
+        // Ducking gain from the key track's smoothed mean-square level.
+        if (duck_key >= 0) {
+            int got = av_audio_fifo_read(fifos[duck_key], (void **)key, chunk);
+            if (got < 0) got = 0;
+            for (int c = 0; c < channels; c++)
+                memset(key[c] + got, 0, sizeof(float) * (chunk - got));
+            for (int i = 0; i < chunk; i++) {
+                float e = 0.0f;
+                for (int c = 0; c < channels; c++) e += key[c][i] * key[c][i];
+                level += (e / channels - level) * a_det;
+                float target = level > duck_threshold ? duck_gain : 1.0f;
+                duck_state += (target - duck_state) * (target < duck_state ? a_att : a_rel);
+                duck[i] = duck_state;
+            }
+        }
+
+        for (int c = 0; c < channels; c++) memset(mix[c], 0, chunk * sizeof(float));
+        for (int k = 0; k < count; k++) {
+            float **src = tmp;
+            int got;
+            if (k == duck_key) {
+                src = key;
+                got = chunk;
+            } else {
+                got = av_audio_fifo_read(fifos[k], (void **)tmp, chunk);
+            }
+            if (got <= 0) continue;
+            int n_env = opt->envelope_counts && env[k] ? opt->envelope_counts[k] : 0;
+            if (n_env == 0 && (duck_key < 0 || k == duck_key)) {
+                for (int c = 0; c < channels; c++) dsp_mix(mix[c], src[c], got, weights[k]);
+                continue;
+            }
+            mix_envelope_fill(env[k], n_env, &cursors[k], pos, sample_rate, weights[k],
+                              gains, got);
+            if (duck_key >= 0 && k != duck_key)
+                for (int i = 0; i < got; i++) gains[i] *= duck[i];
+            for (int c = 0; c < channels; c++) dsp_mix_varying(mix[c], src[c], gains, got);
+        }
+        for (int c = 0; c < channels; c++) dsp_clip(mix[c], chunk);
+        if (audio_writer_write(&w, mix, chunk) < 0) goto cleanup;
+        pos += chunk;
+    }
+    // Audio longer than the video: read on so every video packet is copied.
+    while (vst && !done[0]) {
+        int n = audio_reader_read(&readers[0]);
+        if (n < 0) goto cleanup;
+        if (n == 0) done[0] = 1;
+    }
+    result = audio_writer_finish(&w, out_size);
+
+cleanup:
+    free(duck);
+    free(gains);
+    dsp_free_planes(&key);
+    dsp_free_planes(&tmp);
+    dsp_free_planes(&mix);
+    if (writer_open) audio_writer_close(&w);
+    for (int k = 0; fifos && k < count; k++)
+        if (fifos[k]) av_audio_fifo_free(fifos[k]);
+    for (int k = 0; k < opened; k++) audio_reader_close(&readers[k]);
+    free(env);
+    free(cursors);
+    free(weights);
+    free(done);
+    free(fifos);
+    free(readers);
+    return result;
+}
+
+// Mix `count` inputs into an audio file of `format`; the longest input
+// sets the duration and exhausted inputs contribute silence.
+PYMEDIA_API uint8_t* audio_mix(uint8_t **inputs, size_t *sizes, int count,
+                               const double *weights, int normalize,
+                               const char *format, int *status, size_t *out_size) {
+    MixOptions opt = { weights, normalize, NULL, NULL, -1, 0.0, 0.0 };
+    *status = 0;
+    return audio_mix_run(inputs, sizes, count, &opt, format, NULL, 0, status, out_size);
+}
+
+// Mix into the video of inputs[0]: its video stream is copied, the mixed
+// audio is encoded to AAC in the same MP4 mux, and its duration matches
+// that video stream. `envelopes` holds (time, gain) pairs for every input back to
+// back, `envelope_counts[k]` points each (0 = constant). `duck_key` >= 0
+// attenuates every other input by `duck_db` while that input is above
+// `duck_threshold_db`.
+PYMEDIA_API uint8_t* audio_mix_video(uint8_t **inputs, size_t *sizes, int count,
+                                     const double *weights, int normalize,
+                                     const double *envelopes, const int *envelope_counts,
+                                     int duck_key, double duck_db, double duck_threshold_db,
+                                     size_t *out_size) {
+    MixOptions opt = { weights, normalize, envelopes, envelope_counts,
+                       duck_key, duck_db, duck_threshold_db };
+    return audio_mix_run(inputs, sizes, count, &opt, "aac", "mp4", 1, NULL, out_size);
+}
@@ -0,0 +1,287 @@
+// ============================================================
+// batch — many independent jobs on a work-stealing worker pool,
+// results streamed back under a memory budget
+// ============================================================
+
+#define BATCH_MAX_ARGS 4
+#define BATCH_MAX_WORKERS 256
+
+// One job: an operation name plus its input and parameters. Mirrored by
+// `BatchJob` in _core.py; keep the layouts in sync.
+typedef struct {
+    const char *op;
+    const uint8_t *data;
+    size_t size;
+    double args[BATCH_MAX_ARGS];
+    const char *text;
+} BatchJob;
+
+// Called on the thread that runs pymedia_batch_run, once per job in
+// completion order. `data` is NULL when the job failed and is only valid
+// for the duration of the call.
+typedef void (*pymedia_batch_callback)(void *opaque, int index, const uint8_t *data,
+                                       size_t size);
+
+// ---------- operations ----------
+
+typedef uint8_t *(*batch_op_fn)(const BatchJob *job, size_t *out_size);
+
+static uint8_t *batch_convert_format(const BatchJob *j, size_t *out_size) {
+    return convert_format((uint8_t *)j->data, j->size, j->text, out_size);
+}
+
+static uint8_t *batch_trim_video(const BatchJob *j, size_t *out_size) {
+    return trim_video((uint8_t *)j->data, j->size, j->args[0], j->args[1], out_size);
+}
+
+static uint8_t *batch_mute_video(const BatchJob *j, size_t *out_size) {
+    return mute_video((uint8_t *)j->data, j->size, out_size);
+}
+
+static uint8_t *batch_compress_video(const BatchJob *j, size_t *out_size) {
+    return reencode_video((uint8_t *)j->data, j->size, (int)j->args[0], j->text, -1, -1,
+                          out_size);
+}
+
+static uint8_t *batch_resize_video(const BatchJob *j, size_t *out_size) {
+    return reencode_video((uint8_t *)j->data, j->size, (int)j->args[2], "medium",
+                          (int)j->args[0], (int)j->args[1], out_size);
+}
+
+static uint8_t *batch_extract_audio(const BatchJob *j, size_t *out_size) {
+    return extract_audio((uint8_t *)j->data, j->size, j->text, out_size);
+}
+
+static uint8_t *batch_transcode_audio(const BatchJob *j, size_t *out_size) {
+    return transcode_audio_advanced((uint8_t *)j->data, j->size, j->text, (int)j->args[0],
+                                    (int)j->args[1], (int)j->args[2], out_size);
+}
+
+static uint8_t *batch_extract_frame(const BatchJob *j, size_t *out_size) {
+    return extract_frame((uint8_t *)j->data, j->size, j->args[0], j->text, out_size);
+}
+
+static uint8_t *batch_frame_accurate_trim(const BatchJob *j, size_t *out_size) {
+    return smart_trim_video((uint8_t *)j->data, j->size, j->args[0], j->args[1], out_size);
+}
+
+static uint8_t *batch_get_video_info(const BatchJob *j, size_t *out_size) {
+    char *json = get_video_info((uint8_t *)j->data, j->size);
+    *out_size = json ? strlen(json) : 0;
+    return (uint8_t *)json;
+}
+
+static const struct {
+    const char *name;
+    batch_op_fn fn;
+} batch_ops[] = {
+    {"convert_format", batch_convert_format},
+    {"trim_video", batch_trim_video},
+    {"mute_video", batch_mute_video},
+    {"compress_video", batch_compress_video},
+    {"resize_video", batch_resize_video},
+    {"extract_audio", batch_extract_audio},
+    {"transcode_audio", batch_transcode_audio},
+    {"extract_frame", batch_extract_frame},
+    {"frame_accurate_trim", batch_frame_accurate_trim},
+    {"get_video_info", batch_get_video_info},
+};
+
+static batch_op_fn batch_find_op(const char *name) {
+    if (!name) return NULL;
+    for (size_t i = 0; i < sizeof(batch_ops) / sizeof(batch_ops[0]); i++)
+        if (strcmp(batch_ops[i].name, name) == 0) return batch_ops[i].fn;
+    return NULL;
+}
+
+// ---------- work-stealing pool ----------
+//
+// Jobs are dealt to workers as contiguous index ranges. A worker pops from
+// the front of its own range; when empty it steals the back half of the
+// fullest other range. Results go to a completion ring drained by the
+// calling thread, which runs the callback. A worker only starts a job
+// while input bytes in flight plus undelivered result bytes fit the
+// budget (one job is always allowed, so an oversized input still runs).
+
+typedef struct {
+    pm_mutex_t lock;
+    int lo, hi;
+} BatchDeque;
+
+typedef struct {
+    int index;
+    uint8_t *data;
+    size_t size;
+} BatchResult;
+
+typedef struct {
+    const BatchJob *jobs;
+    batch_op_fn *fns;
+    int count;
+    BatchDeque *deques;
+    int workers;
+    pm_mutex_t lock;
+    pm_cond_t cond;
+    BatchResult *ring;              // `count` slots, each job completes once
+    int ring_head, ring_tail;
+    size_t budget, in_flight, queued;
+} BatchPool;
+
+typedef struct {
+    BatchPool *pool;
+    int self;
+} BatchWorker;
+
+static int batch_take(BatchPool *p, int self) {
+    BatchDeque *own = &p->deques[self];
+    pm_mutex_lock(&own->lock);
+    if (own->lo < own->hi) {
+        int idx = own->lo++;
+        pm_mutex_unlock(&own->lock);
+        return idx;
+    }
+    pm_mutex_unlock(&own->lock);
+
+    for (;;) {
+        int victim = -1, best = 0;
+        for (int w = 0; w < p->workers; w++) {
+            if (w == self) continue;
+            BatchDeque *d = &p->deques[w];
+            pm_mutex_lock(&d->lock);
+            int left = d->hi - d->lo;
+            pm_mutex_unlock(&d->lock);
+            if (left > best) {
+                best = left;
+                victim = w;
+            }
+        }
+        if (victim < 0) return -1;
+
+        BatchDeque *d = &p->deques[victim];
+        pm_mutex_lock(&d->lock);
+        int left = d->hi - d->lo;
+        if (left <= 0) {
+            pm_mutex_unlock(&d->lock);
+            continue;    // raced with its owner, look again
+        }
+        int take = (left + 1) / 2;
+        int lo = d->hi - take, hi = d->hi;
+        d->hi = lo;
+        pm_mutex_unlock(&d->lock);
+
+        pm_mutex_lock(&own->lock);
+        own->lo = lo + 1;
+        own->hi = hi;
+        pm_mutex_unlock(&own->lock);
+        return lo;
+    }
+}
+
+static void *batch_worker(void *arg) {
+    BatchWorker *bw = arg;
+    BatchPool *p = bw->pool;
+    int idx;
+    while ((idx = batch_take(p, bw->self)) >= 0) {
+        const BatchJob *job = &p->jobs[idx];
+
+        pm_mutex_lock(&p->lock);
+        while (p->in_flight + p->queued > 0 &&
+               p->in_flight + p->queued + job->size > p->budget)
+            pm_cond_wait(&p->cond, &p->lock);
+        p->in_flight += job->size;
+        pm_mutex_unlock(&p->lock);
+
+        size_t size = 0;
+        uint8_t *data = p->fns[idx](job, &size);
+        if (!data) size = 0;
+
+        pm_mutex_lock(&p->lock);
+        p->in_flight -= job->size;
+        p->queued += size;
+        p->ring[p->ring_tail++] = (BatchResult){idx, data, size};
+        pm_cond_broadcast(&p->cond);
+        pm_mutex_unlock(&p->lock);
+    }
+    return NULL;
+}
+
+// Run `count` jobs on `num_threads` workers (<= 0: one per core) and hand
+// every result to `callback` on the calling thread. `max_pending_bytes`
+// bounds input bytes being processed plus results not yet delivered
+// (0: unbounded). Returns the number of failed jobs, or -1 if the batch
+// could not start (unknown operation, allocation failure).
+PYMEDIA_API int pymedia_batch_run(const BatchJob *jobs, int count, int num_threads,
+                                  size_t max_pending_bytes, pymedia_batch_callback callback,
+                                  void *opaque) {
+    BatchPool p;
+    BatchWorker *args = NULL;
+    pm_thread_t *threads = NULL;
+    int started = 0, failed = 0, ret = -1;
+
+    if (count <= 0) return 0;
+    if (!jobs || !callback) return -1;
+    memset(&p, 0, sizeof(p));
+    p.jobs = jobs;
+    p.count = count;
+    p.budget = max_pending_bytes > 0 ? max_pending_bytes : SIZE_MAX;
+    p.workers = pm_worker_count(num_threads, BATCH_MAX_WORKERS);
+    if (p.workers > count) p.workers = count;
+
+    p.fns = malloc(sizeof(*p.fns) * count);
+    p.ring = malloc(sizeof(*p.ring) * count);
+    p.deques = calloc(p.workers, sizeof(*p.deques));
+    args = calloc(p.workers, sizeof(*args));
+    threads = calloc(p.workers, sizeof(*threads));
+    if (!p.fns || !p.ring || !p.deques || !args || !threads) goto cleanup;
+    for (int i = 0; i < count; i++) {
+        p.fns[i] = batch_find_op(jobs[i].op);
+        if (!p.fns[i]) {
+            fprintf(stderr, "Unsupported batch operation: %s\n",
+                    jobs[i].op ? jobs[i].op : "(null)");
+            goto cleanup;
+        }
+    }
+
+    pm_mutex_init(&p.lock);
+    pm_cond_init(&p.cond);
+    for (int w = 0; w < p.workers; w++) {
+        pm_mutex_init(&p.deques[w].lock);
+        p.deques[w].lo = (int)((int64_t)count * w / p.workers);
+        p.deques[w].hi = (int)((int64_t)count * (w + 1) / p.workers);
+        args[w] = (BatchWorker){&p, w};
+    }
+    for (started = 0; started < p.workers; started++)
+        if (pm_thread_create(&threads[started], batch_worker, &args[started]) < 0) break;
+
+    // Deliver results as they complete. With fewer threads than planned
+    // the started workers steal the orphaned ranges.
+    pm_mutex_lock(&p.lock);
+    for (int delivered = 0; started > 0 && delivered < count; delivered++) {
+        while (p.ring_head == p.ring_tail) pm_cond_wait(&p.cond, &p.lock);
+        BatchResult r = p.ring[p.ring_head++];
+        pm_mutex_unlock(&p.lock);
+
+        if (!r.data) failed++;
+        callback(opaque, r.index, r.data, r.size);
+        free(r.data);
+
+        pm_mutex_lock(&p.lock);
+        p.queued -= r.size;
+        pm_cond_broadcast(&p.cond);
+    }
+    pm_mutex_unlock(&p.lock);
+
+    for (int w = 0; w < started; w++) pm_thread_join(threads[w]);
+    for (int w = 0; w < p.workers; w++) pm_mutex_destroy(&p.deques[w].lock);
+    pm_cond_destroy(&p.cond);
+    pm_mutex_destroy(&p.lock);
+    if (started > 0) ret = failed;
+
+cleanup:
+    free(threads);
+    free(args);
+    free(p.deques);
+    free(p.ring);
+    free(p.fns);
+    return ret;
+}
@@ -0,0 +1,483 @@
+// ============================================================
+// concat — N-way concatenation into one muxer with running
+// per-stream offsets; only inputs that differ from the first are
+// re-encoded
+// ============================================================
+
+// ---------- compatibility ----------
+
+static int codecpar_channels(const AVCodecParameters *par) {
+#if FF_NEW_CHANNEL_LAYOUT
+    return par->ch_layout.nb_channels;
+#else
+    return par->channels;
+#endif
+}
+
+static int extradata_equal(const uint8_t *a, int a_size, const uint8_t *b, int b_size) {
+    return a_size == b_size && (a_size == 0 || memcmp(a, b, a_size) == 0);
+}
+
+// Packets can share one track only with identical decoder configuration.
+static int concat_video_compatible(const AVCodecParameters *ref, const AVCodecParameters *par) {
+    return par->codec_id == ref->codec_id && par->width == ref->width &&
+           par->height == ref->height && par->format == ref->format &&
+           extradata_equal(ref->extradata, ref->extradata_size,
+                           par->extradata, par->extradata_size);
+}
+
+static int concat_audio_compatible(const AVCodecParameters *ref, const AVCodecParameters *par) {
+    return par->codec_id == ref->codec_id && par->sample_rate == ref->sample_rate &&
+           codecpar_channels(par) == codecpar_channels(ref) &&
+           extradata_equal(ref->extradata, ref->extradata_size,
+                           par->extradata, par->extradata_size);
+}
+
+// ---------- state ----------
+
+typedef struct {
+    AVFormatContext *ofmt_ctx;
+    AVStream *v_out, *a_out;        // codecpar doubles as the reference
+    H264Splice splice;
+    int can_splice;                 // mismatched video can be re-encoded
+    int64_t reorder;                // reference pts - dts, output time base
+    int resend_ps;                  // next copied keyframe needs reference SPS/PPS
+    int64_t v_off, a_off;           // where the current input starts
+    int64_t v_end, a_end;           // furthest end written so far
+    int64_t v_last_dts, a_last_dts;
+    int64_t total_us, done_us;      // progress: all inputs, inputs appended so far
+    AVPacket *pkt;
+    AVFrame *frame;
+} ConcatState;
+
+// Keep DTS strictly increasing across input joins.
+static void concat_fix_dts(AVPacket *pkt, int64_t *last_dts) {
+    if (pkt->dts == AV_NOPTS_VALUE) return;
+    if (*last_dts != AV_NOPTS_VALUE && pkt->dts <= *last_dts) pkt->dts = *last_dts + 1;
+    if (pkt->pts != AV_NOPTS_VALUE && pkt->pts < pkt->dts) pkt->pts = pkt->dts;
+    *last_dts = pkt->dts;
+}
+
+static void concat_track_end(const AVPacket *pkt, int64_t *end) {
+    int64_t ts = pkt->pts != AV_NOPTS_VALUE ? pkt->pts : pkt->dts;
+    if (ts == AV_NOPTS_VALUE) return;
+    ts += pkt->duration > 0 ? pkt->duration : 1;
+    if (ts > *end) *end = ts;
+}
+
+static void concat_write_video(ConcatState *cs, AVPacket *pkt) {
+    pkt->stream_index = cs->v_out->index;
+    pkt->pos = -1;
+    concat_fix_dts(pkt, &cs->v_last_dts);
+    concat_track_end(pkt, &cs->v_end);
+    pm_write_frame(cs->ofmt_ctx, pkt);
+}
+
+// ---------- copied input ----------
+
+static int concat_copy_video(ConcatState *cs, AVPacket *pkt, AVRational in_tb,
+                             int64_t in_start) {
+    av_packet_rescale_ts(pkt, in_tb, cs->v_out->time_base);
+    int64_t shift = cs->v_off - av_rescale_q(in_start, in_tb, cs->v_out->time_base);
+    if (pkt->pts != AV_NOPTS_VALUE) pkt->pts += shift;
+    if (pkt->dts != AV_NOPTS_VALUE) pkt->dts += shift;
+    if (cs->resend_ps && (pkt->flags & AV_PKT_FLAG_KEY) && cs->splice.ps_size > 0) {
+        AVPacket *conv = av_packet_alloc();
+        if (!conv) return -1;
+        if (h264_splice_packet(&cs->splice, pkt, 0, cs->splice.ps, cs->splice.ps_size,
+                               conv) < 0) {
+            av_packet_free(&conv);
+            return -1;
+        }
+        cs->resend_ps = 0;
+        concat_write_video(cs, conv);
+        av_packet_free(&conv);
+        return 0;
+    }
+    concat_write_video(cs, pkt);
+    return 0;
+}
+
+// ---------- re-encoded video ----------
+
+static int concat_write_encoded(ConcatState *cs, SegmentEncoder *se) {
+    while (pm_receive_packet(se->enc, se->pkt) == 0) {
+        AVPacket *pkt = se->pkt;
+        av_packet_rescale_ts(pkt, se->enc->time_base, cs->v_out->time_base);
+        if (pkt->pts != AV_NOPTS_VALUE) {
+            pkt->pts += cs->v_off;
+            pkt->dts = pkt->pts - cs->reorder;
+        }
+        AVPacket *conv = av_packet_alloc();
+        if (!conv || h264_splice_packet(&cs->splice, pkt, 1, NULL, 0, conv) < 0) {
+            av_packet_free(&conv);
+            av_packet_unref(pkt);
+            return -1;
+        }
+        concat_write_video(cs, conv);
+        av_packet_free(&conv);
+        av_packet_unref(pkt);
+    }
+    return 0;
+}
+
+static int concat_encode_frames(ConcatState *cs, AVCodecContext *dec, SegmentEncoder *se,
+                                int64_t in_start) {
+    AVFrame *frame = cs->frame;
+    while (pm_receive_frame(dec, frame) == 0) {
+        int64_t ts = frame->best_effort_timestamp;
+        if (ts == AV_NOPTS_VALUE) ts = frame->pts;
+        if (ts != AV_NOPTS_VALUE && ts >= in_start) {
+            if (av_frame_make_writable(se->frame) < 0) return -1;
+            pm_sws_scale(se->sws, (const uint8_t *const *)frame->data, frame->linesize, 0,
+                      frame->height, se->frame->data, se->frame->linesize);
+            se->frame->pts = ts - in_start;
+            if (pm_send_frame(se->enc, se->frame) < 0) return -1;
+            if (concat_write_encoded(cs, se) < 0) return -1;
+        }
+        av_frame_unref(frame);
+    }
+    return 0;
+}
+
+// ---------- re-encoded audio ----------
+
+// Open an encoder for the reference audio track: its codec, rate and layout
+// (as AudioReader resamples to). Its config must match the track's,
+// otherwise the packets could not share it.
+static AVCodecContext *concat_open_audio_encoder(const AVCodecParameters *ref, int channels) {
+    const AVCodec *encoder = avcodec_find_encoder(ref->codec_id);
+    if (!encoder) return NULL;
+    AVCodecContext *enc = avcodec_alloc_context3(encoder);
+    if (!enc) return NULL;
+    enc->sample_rate = ref->sample_rate;
+    enc->sample_fmt = pick_sample_fmt(encoder, AV_SAMPLE_FMT_FLTP);
+    if (enc->sample_fmt != AV_SAMPLE_FMT_FLTP) goto fail;
+#if FF_NEW_CHANNEL_LAYOUT
+    av_channel_layout_default(&enc->ch_layout, channels);
+#else
+    enc->channel_layout = av_get_default_channel_layout(channels);
+    enc->channels = channels;
+#endif
+    enc->bit_rate = ref->bit_rate > 0 ? ref->bit_rate : 128000;
+    enc->profile = ref->profile;
+    enc->time_base = (AVRational){1, ref->sample_rate};
+    enc->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+    if (avcodec_open2(enc, encoder, NULL) < 0) goto fail;
+    if (!extradata_equal(ref->extradata, ref->extradata_size, enc->extradata,
+                         enc->extradata_size)) {
+        fprintf(stderr, "Unsupported concat: audio encoder config differs from first input\n");
+        goto fail;
+    }
+    return enc;
+
+fail:
+    avcodec_free_context(&enc);
+    return NULL;
+}
+
+// Decode and resample the input's audio to the reference rate/layout and
+// encode it with the reference codec. concat_setup has already checked
+// that the encoder opens with a matching config.
+static int concat_encode_audio(ConcatState *cs, uint8_t *data, size_t size) {
+    AVCodecParameters *ref = cs->a_out->codecpar;
+    AudioReader r;
+    AVCodecContext *enc = NULL;
+    AVAudioFifo *fifo = NULL;
+    AVPacket *pkt = cs->pkt;
+    int ret = -1, n = 0;
+
+    if (audio_reader_open(&r, data, size, ref->sample_rate, codecpar_channels(ref)) < 0)
+        return -1;
+    enc = concat_open_audio_encoder(ref, r.channels);
+    if (!enc) goto cleanup;
+    int frame_size = enc->frame_size > 0 ? enc->frame_size : 1024;
+    fifo = audio_fifo_acquire(AV_SAMPLE_FMT_FLTP, r.channels, frame_size);
+    if (!fifo) goto cleanup;
+
+    // Encoder delay is trimmed from the front, so the first packet lands on
+    // the input's start offset.
+    int64_t pts = av_rescale_q(cs->a_off, cs->a_out->time_base, enc->time_base) +
+                  enc->initial_padding;
+    int64_t first = pts;
+    while ((n = audio_reader_read(&r)) > 0) {
+        av_audio_fifo_write(fifo, (void **)r.buf, n);
+        encode_fifo_frames(fifo, enc, cs->ofmt_ctx, cs->a_out, pkt, cs->frame, frame_size, &pts);
+    }
+    if (n < 0) goto cleanup;
+    encode_fifo_remaining(fifo, enc, cs->ofmt_ctx, cs->a_out, pkt, cs->frame, &pts);
+    pm_send_frame(enc, NULL);
+    while (pm_receive_packet(enc, pkt) == 0) {
+        pkt->stream_index = cs->a_out->index;
+        av_packet_rescale_ts(pkt, enc->time_base, cs->a_out->time_base);
+        pm_write_frame(cs->ofmt_ctx, pkt);
+        av_packet_unref(pkt);
+    }
+    int64_t end = av_rescale_q(pts - first, enc->time_base, cs->a_out->time_base) + cs->a_off;
+    if (end > cs->a_end) cs->a_end = end;
+    cs->a_last_dts = cs->a_end - 1;
+    ret = 0;
+
+cleanup:
+    av_frame_unref(cs->frame);
+    if (fifo) audio_fifo_release(&fifo, AV_SAMPLE_FMT_FLTP, r.channels);
+    if (enc) avcodec_free_context(&enc);
+    audio_reader_close(&r);
+    return ret;
+}
+
+// ---------- one input ----------
+
+static int concat_append(ConcatState *cs, uint8_t *data, size_t size) {
+    BufferData bd;
+    AVFormatContext *ifmt_ctx = NULL;
+    AVIOContext *avio_ctx = NULL;
+    AVCodecContext *dec = NULL;
+    SegmentEncoder se;
+    int ret = -1;
+    memset(&se, 0, sizeof(se));
+
+    if (open_input_memory(data, size, &ifmt_ctx, &avio_ctx, &bd) < 0) return -1;
+    pm_progress_input(cs->done_us, 0);
+    int video_idx = find_stream(ifmt_ctx, AVMEDIA_TYPE_VIDEO);
+    int audio_idx = find_stream(ifmt_ctx, AVMEDIA_TYPE_AUDIO);
+    if (cs->v_out && video_idx < 0) goto cleanup;
+
+    int copy_video = 1, copy_audio = 0, encode_audio = 0;
+    AVRational v_tb = {1, 1}, a_tb = {1, 1};
+    if (cs->v_out) {
+        AVStream *st = ifmt_ctx->streams[video_idx];
+        v_tb = st->time_base;
+        copy_video = concat_video_compatible(cs->v_out->codecpar, st->codecpar);
+    }
+    if (cs->a_out && audio_idx >= 0) {
+        a_tb = ifmt_ctx->streams[audio_idx]->time_base;
+        copy_audio = concat_audio_compatible(cs->a_out->codecpar,
+                                             ifmt_ctx->streams[audio_idx]->codecpar);
+        encode_audio = !copy_audio;
+    }
+
+    // A positive container start (e.g. an MP4 edit list) is dropped on every
+    // path, copied or re-encoded, so each input begins at its offset.
+    int64_t in_start = 0;
+    if (ifmt_ctx->start_time != AV_NOPTS_VALUE && ifmt_ctx->start_time > 0 && video_idx >= 0)
+        in_start = av_rescale_q(ifmt_ctx->start_time, AV_TIME_BASE_Q,
+                                ifmt_ctx->streams[video_idx]->time_base);
+    if (!copy_video) {
+        AVStream *st = ifmt_ctx->streams[video_idx];
+        const AVCodec *decoder = avcodec_find_decoder(st->codecpar->codec_id);
+        if (!decoder) goto cleanup;
+        dec = avcodec_alloc_context3(decoder);
+        if (!dec) goto cleanup;
+        avcodec_parameters_to_context(dec, st->codecpar);
+        if (avcodec_open2(dec, decoder, NULL) < 0) goto cleanup;
+        if (segment_encoder_open(&se, ifmt_ctx, video_idx, dec, cs->v_out->codecpar->width,
+                                 cs->v_out->codecpar->height, 1) < 0)
+            goto cleanup;
+    }
+
+    // Audio priming (negative leading timestamps) is absorbed into the offset.
+    int64_t a_shift = AV_NOPTS_VALUE;
+    AVPacket *pkt = cs->pkt;
+    int failed = 0;
+    while (!failed && pm_read_frame(ifmt_ctx, pkt) >= 0) {
+        if (pkt->stream_index == video_idx && cs->v_out) {
+            if (copy_video) {
+                if (concat_copy_video(cs, pkt, v_tb, in_start) < 0) failed = 1;
+            } else if (pm_send_packet(dec, pkt) >= 0 &&
+                       concat_encode_frames(cs, dec, &se, in_start) < 0) {
+                failed = 1;
+            }
+        } else if (pkt->stream_index == audio_idx && copy_audio) {
+            av_packet_rescale_ts(pkt, a_tb, cs->a_out->time_base);
+            if (a_shift == AV_NOPTS_VALUE) {
+                int64_t first = pkt->dts != AV_NOPTS_VALUE ? pkt->dts : pkt->pts;
+                a_shift = cs->a_off - (first != AV_NOPTS_VALUE && first < 0 ? first : 0);
+                if (ifmt_ctx->start_time != AV_NOPTS_VALUE && ifmt_ctx->start_time > 0)
+                    a_shift -= av_rescale_q(ifmt_ctx->start_time, AV_TIME_BASE_Q,
+                                            cs->a_out->time_base);
+            }
+            if (pkt->pts != AV_NOPTS_VALUE) pkt->pts += a_shift;
+            if (pkt->dts != AV_NOPTS_VALUE) pkt->dts += a_shift;
+            pkt->stream_index = cs->a_out->index;
+            pkt->pos = -1;
+            concat_fix_dts(pkt, &cs->a_last_dts);
+            concat_track_end(pkt, &cs->a_end);
+            pm_write_frame(cs->ofmt_ctx, pkt);
+        }
+        av_packet_unref(pkt);
+    }
+    if (failed) goto cleanup;
+    if (!copy_video) {
+        pm_send_packet(dec, NULL);
+        if (concat_encode_frames(cs, dec, &se, in_start) < 0) goto cleanup;
+        pm_send_frame(se.enc, NULL);
+        if (concat_write_encoded(cs, &se) < 0) goto cleanup;
+        cs->resend_ps = 1;
+    }
+    if (encode_audio && concat_encode_audio(cs, data, size) < 0) goto cleanup;
+
+    // Next input starts after the longest stream, keeping A/V in sync.
+    double end_sec = 0.0;
+    if (cs->v_out) end_sec = cs->v_end * av_q2d(cs->v_out->time_base);
+    if (cs->a_out && cs->a_end * av_q2d(cs->a_out->time_base) > end_sec)
+        end_sec = cs->a_end * av_q2d(cs->a_out->time_base);
+    if (cs->v_out) {
+        int64_t v = (int64_t)ceil(end_sec / av_q2d(cs->v_out->time_base));
+        cs->v_off = v > cs->v_end ? v : cs->v_end;
+    }
+    if (cs->a_out) {
+        int64_t a = (int64_t)ceil(end_sec / av_q2d(cs->a_out->time_base));
+        cs->a_off = a > cs->a_end ? a : cs->a_end;
+    }
+    if (ifmt_ctx->duration > 0) cs->done_us += ifmt_ctx->duration;
+    ret = 0;
+
+cleanup:
+    segment_encoder_close(&se);
+    if (dec) avcodec_free_context(&dec);
+    close_input(&ifmt_ctx, &avio_ctx);
+    return ret;
+}
+
+// ---------- reference ----------
+
+// Set up the output from the first input and check up front that every
+// other input can either be copied or re-encoded into its tracks, opening
+// the audio encoder once if any input needs it.
+static int concat_setup(ConcatState *cs, uint8_t *const *inputs, const size_t *sizes,
+                        int count) {
+    BufferData bd;
+    AVFormatContext *ifmt_ctx = NULL;
+    AVIOContext *avio_ctx = NULL;
+    int ret = -1;
+
+    if (open_input_memory(inputs[0], sizes[0], &ifmt_ctx, &avio_ctx, &bd) < 0) return -1;
+    int video_idx = find_stream(ifmt_ctx, AVMEDIA_TYPE_VIDEO);
+    int audio_idx = find_stream(ifmt_ctx, AVMEDIA_TYPE_AUDIO);
+    if (video_idx < 0 && audio_idx < 0) goto cleanup;
+    if (ifmt_ctx->duration > 0) cs->total_us = ifmt_ctx->duration;
+
+    avformat_alloc_output_context2(&cs->ofmt_ctx, NULL, "mp4", NULL);
+    if (!cs->ofmt_ctx) goto cleanup;
+    if (avio_open_dyn_buf(&cs->ofmt_ctx->pb) < 0) goto cleanup;
+    if (video_idx >= 0) {
+        AVStream *in_s = ifmt_ctx->streams[video_idx];
+        cs->v_out = avformat_new_stream(cs->ofmt_ctx, NULL);
+        if (!cs->v_out) goto cleanup;
+        avcodec_parameters_copy(cs->v_out->codecpar, in_s->codecpar);
+        cs->v_out->codecpar->codec_tag = 0;
+        cs->v_out->time_base = in_s->time_base;
+        AVCodecParameters *vpar = in_s->codecpar;
+        cs->can_splice = vpar->codec_id == AV_CODEC_ID_H264 &&
+                         (vpar->format == AV_PIX_FMT_YUV420P ||
+                          vpar->format == AV_PIX_FMT_YUVJ420P) &&
+                         h264_splice_init(&cs->splice, vpar) == 0;
+        if (read_next_stream_packet(ifmt_ctx, video_idx, cs->pkt) > 0) {
+            if (cs->pkt->pts != AV_NOPTS_VALUE && cs->pkt->dts != AV_NOPTS_VALUE &&
+                cs->pkt->pts > cs->pkt->dts)
+                cs->reorder = cs->pkt->pts - cs->pkt->dts;
+            av_packet_unref(cs->pkt);
+        }
+    }
+    if (audio_idx >= 0) {
+        AVStream *in_s = ifmt_ctx->streams[audio_idx];
+        cs->a_out = avformat_new_stream(cs->ofmt_ctx, NULL);
+        if (!cs->a_out) goto cleanup;
+        avcodec_parameters_copy(cs->a_out->codecpar, in_s->codecpar);
+        cs->a_out->codecpar->codec_tag = 0;
+        cs->a_out->time_base = in_s->time_base;
+    }
+
+    int audio_probed = 0;
+    for (int i = 1; i < count; i++) {
+        BufferData ibd;
+        AVFormatContext *in = NULL;
+        AVIOContext *in_avio = NULL;
+        if (open_input_memory(inputs[i], sizes[i], &in, &in_avio, &ibd) < 0) goto cleanup;
+        if (in->duration > 0) cs->total_us += in->duration;
+        int vi = find_stream(in, AVMEDIA_TYPE_VIDEO);
+        int ai = find_stream(in, AVMEDIA_TYPE_AUDIO);
+        int ok = !cs->v_out || (vi >= 0 && (cs->can_splice ||
+                 concat_video_compatible(cs->v_out->codecpar, in->streams[vi]->codecpar)));
+        int encode_audio = cs->a_out && ai >= 0 &&
+                           !concat_audio_compatible(cs->a_out->codecpar,
+                                                    in->streams[ai]->codecpar);
+        if (encode_audio && !avcodec_find_decoder(in->streams[ai]->codecpar->codec_id))
+            ok = 0;
+        close_input(&in, &in_avio);
+        if (!ok) {
+            fprintf(stderr, "Unsupported concat: input %d cannot join the first input's tracks\n",
+                    i);
+            goto cleanup;
+        }
+        // Every re-encoded input uses the same encoder config, so one probe
+        // decides before anything is written.
+        if (encode_audio && !audio_probed) {
+            int channels = codecpar_channels(cs->a_out->codecpar);
+            if (channels <= 0 || channels > AUDIO_DSP_MAX_CHANNELS) channels = 2;
+            AVCodecContext *enc = concat_open_audio_encoder(cs->a_out->codecpar, channels);
+            if (!enc) goto cleanup;
+            avcodec_free_context(&enc);
+            audio_probed = 1;
+        }
+    }
+    ret = 0;
+
+cleanup:
+    close_input(&ifmt_ctx, &avio_ctx);
+    return ret;
+}
+
+// Concatenate `count` inputs in order into one MP4 whose tracks take the
+// first input's video/audio parameters. Matching inputs are stream-copied;
+// others are re-encoded into the same tracks (H.264 video via in-band
+// parameter sets, audio with the first input's codec).
+PYMEDIA_API uint8_t* concat_videos(uint8_t *const *inputs, const size_t *sizes, int count,
+                                   size_t *out_size) {
+    ConcatState cs;
+    uint8_t *output_buffer = NULL, *result = NULL;
+
+    *out_size = 0;
+    if (count < 1) return NULL;
+    memset(&cs, 0, sizeof(cs));
+    cs.v_last_dts = cs.a_last_dts = AV_NOPTS_VALUE;
+    cs.pkt = av_packet_alloc();
+    cs.frame = av_frame_alloc();
+    if (!cs.pkt || !cs.frame) goto cleanup;
+
+    if (concat_setup(&cs, inputs, sizes, count) < 0) goto cleanup;
+    if (avformat_write_header(cs.ofmt_ctx, NULL) < 0) goto cleanup;
+    // Progress runs over all inputs, each counted from where the previous
+    // ones end.
+    pm_progress_input(0, cs.total_us);
+    for (int i = 0; i < count; i++)
+        if (concat_append(&cs, inputs[i], sizes[i]) < 0) goto cleanup;
+
+    av_write_trailer(cs.ofmt_ctx);
+    int output_size = avio_close_dyn_buf(cs.ofmt_ctx->pb, &output_buffer);
+    cs.ofmt_ctx->pb = NULL;
+    if (output_size > 0) {
+        result = malloc(output_size);
+        if (result) {
+            memcpy(result, output_buffer, output_size);
+            *out_size = output_size;
+        }
+    }
+    av_free(output_buffer);
+
+cleanup:
+    pm_progress_input(0, 0);
+    if (cs.frame) av_frame_free(&cs.frame);
+    if (cs.pkt) av_packet_free(&cs.pkt);
+    h264_splice_free(&cs.splice);
+    if (cs.ofmt_ctx) {
+        if (cs.ofmt_ctx->pb) {
+            uint8_t *dummy;
+            avio_close_dyn_buf(cs.ofmt_ctx->pb, &dummy);
+            av_free(dummy);
+        }
+        avformat_free_context(cs.ofmt_ctx);
+    }
+    return result;
+}
@@ -239,12 +239,12 @@ PYMEDIA_API uint8_t* filter_video_basic(uint8_t *video_data, size_t video_size,
     AVPacket *enc_pkt = av_packet_alloc();
     if (!enc_pkt) goto cleanup;
 
-    while (av_read_frame(ifmt_ctx, pkt) >= 0) {
+    while (pm_read_frame(ifmt_ctx, pkt) >= 0) {
         if (pkt->stream_index == video_idx) {
-            if (avcodec_send_packet(vdec_ctx, pkt) >= 0) {
-                while (avcodec_receive_frame(vdec_ctx, dec_frame) == 0) {
+            if (pm_send_packet(vdec_ctx, pkt) >= 0) {
+                while (pm_receive_frame(vdec_ctx, dec_frame) == 0) {
                     av_frame_make_writable(filt_frame);
-                    sws_scale(sws,
+                    pm_sws_scale(sws,
                         (const uint8_t *const *)dec_frame->data,
                         dec_frame->linesize, 0, src_h,
                         filt_frame->data, filt_frame->linesize);
@@ -252,12 +252,12 @@ PYMEDIA_API uint8_t* filter_video_basic(uint8_t *video_data, size_t video_size,
                     filter_frame_yuv420(filt_frame, mode, p1, p2, p3);
                     filt_frame->pts = dec_frame->pts;
 
-                    avcodec_send_frame(venc_ctx, filt_frame);
-                    while (avcodec_receive_packet(venc_ctx, enc_pkt) == 0) {
+                    pm_send_frame(venc_ctx, filt_frame);
+                    while (pm_receive_packet(venc_ctx, enc_pkt) == 0) {
                         enc_pkt->stream_index = stream_mapping[video_idx];
                         av_packet_rescale_ts(enc_pkt, venc_ctx->time_base,
                                              v_out->time_base);
-                        av_interleaved_write_frame(ofmt_ctx, enc_pkt);
+                        pm_write_frame(ofmt_ctx, enc_pkt);
                         av_packet_unref(enc_pkt);
                     }
                 }
@@ -268,34 +268,34 @@ PYMEDIA_API uint8_t* filter_video_basic(uint8_t *video_data, size_t video_size,
             pkt->stream_index = audio_out_idx;
             av_packet_rescale_ts(pkt, in_s->time_base, out_s->time_base);
             pkt->pos = -1;
-            av_interleaved_write_frame(ofmt_ctx, pkt);
+            pm_write_frame(ofmt_ctx, pkt);
         }
         av_packet_unref(pkt);
     }
 
-    avcodec_send_packet(vdec_ctx, NULL);
-    while (avcodec_receive_frame(vdec_ctx, dec_frame) == 0) {
+    pm_send_packet(vdec_ctx, NULL);
+    while (pm_receive_frame(vdec_ctx, dec_frame) == 0) {
         av_frame_make_writable(filt_frame);
-        sws_scale(sws, (const uint8_t *const *)dec_frame->data,
+        pm_sws_scale(sws, (const uint8_t *const *)dec_frame->data,
                   dec_frame->linesize, 0, src_h,
                   filt_frame->data, filt_frame->linesize);
         filter_frame_yuv420(filt_frame, mode, p1, p2, p3);
         filt_frame->pts = dec_frame->pts;
 
-        avcodec_send_frame(venc_ctx, filt_frame);
-        while (avcodec_receive_packet(venc_ctx, enc_pkt) == 0) {
+        pm_send_frame(venc_ctx, filt_frame);
+        while (pm_receive_packet(venc_ctx, enc_pkt) == 0) {
             enc_pkt->stream_index = stream_mapping[video_idx];
             av_packet_rescale_ts(enc_pkt, venc_ctx->time_base,
                                  v_out->time_base);
-            av_interleaved_write_frame(ofmt_ctx, enc_pkt);
+            pm_write_frame(ofmt_ctx, enc_pkt);
             av_packet_unref(enc_pkt);
         }
     }
-    avcodec_send_frame(venc_ctx, NULL);
-    while (avcodec_receive_packet(venc_ctx, enc_pkt) == 0) {
+    pm_send_frame(venc_ctx, NULL);
+    while (pm_receive_packet(venc_ctx, enc_pkt) == 0) {
         enc_pkt->stream_index = stream_mapping[video_idx];
         av_packet_rescale_ts(enc_pkt, venc_ctx->time_base, v_out->time_base);
-        av_interleaved_write_frame(ofmt_ctx, enc_pkt);
+        pm_write_frame(ofmt_ctx, enc_pkt);
         av_packet_unref(enc_pkt);
     }
     av_packet_free(&enc_pkt);
@@ -0,0 +1,516 @@
+// ============================================================
+// raw frames — decoded pixels without an image encode step
+// ============================================================
+
+static int get_raw_pix_fmt(const char *name, enum AVPixelFormat *pix_fmt) {
+    if (!name || strcmp(name, "rgb24") == 0) {
+        *pix_fmt = AV_PIX_FMT_RGB24;
+    } else if (strcmp(name, "rgba") == 0) {
+        *pix_fmt = AV_PIX_FMT_RGBA;
+    } else if (strcmp(name, "gray8") == 0 || strcmp(name, "gray") == 0) {
+        *pix_fmt = AV_PIX_FMT_GRAY8;
+    } else if (strcmp(name, "yuv420p") == 0) {
+        *pix_fmt = AV_PIX_FMT_YUV420P;
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+static int get_sws_algorithm(const char *name) {
+    if (!name || strcmp(name, "bilinear") == 0) return SWS_BILINEAR;
+    if (strcmp(name, "fast_bilinear") == 0) return SWS_FAST_BILINEAR;
+    if (strcmp(name, "bicubic") == 0) return SWS_BICUBIC;
+    if (strcmp(name, "nearest") == 0 || strcmp(name, "point") == 0) return SWS_POINT;
+    if (strcmp(name, "area") == 0) return SWS_AREA;
+    if (strcmp(name, "lanczos") == 0) return SWS_LANCZOS;
+    return -1;
+}
+
+// Fill missing output dimensions from the source aspect ratio. Chroma
+// subsampled formats need even sizes.
+static void resolve_raw_size(int src_w, int src_h, enum AVPixelFormat pix_fmt,
+                             int *out_w, int *out_h) {
+    if (*out_w <= 0 && *out_h <= 0) {
+        *out_w = src_w;
+        *out_h = src_h;
+    } else if (*out_w <= 0) {
+        *out_w = (int)((double)src_w / src_h * *out_h + 0.5);
+    } else if (*out_h <= 0) {
+        *out_h = (int)((double)src_h / src_w * *out_w + 0.5);
+    }
+    if (pix_fmt == AV_PIX_FMT_YUV420P) {
+        *out_w &= ~1;
+        *out_h &= ~1;
+    }
+    if (*out_w < 1) *out_w = pix_fmt == AV_PIX_FMT_YUV420P ? 2 : 1;
+    if (*out_h < 1) *out_h = pix_fmt == AV_PIX_FMT_YUV420P ? 2 : 1;
+}
+
+// Scale/convert `src` into a tightly packed buffer (planes back to back,
+// no row padding). The scaler is cached across calls so callers looping
+// over frames pay the sws setup once.
+static int scale_frame_packed(struct SwsContext **sws, const AVFrame *src,
+                              enum AVPixelFormat dst_fmt, int dst_w, int dst_h,
+                              int sws_flags, uint8_t *dst) {
+    uint8_t *dst_data[4];
+    int dst_linesize[4];
+
+    *sws = sws_getCachedContext(*sws, src->width, src->height, src->format,
+                                dst_w, dst_h, dst_fmt, sws_flags, NULL, NULL, NULL);
+    if (!*sws) return -1;
+    if (av_image_fill_arrays(dst_data, dst_linesize, dst, dst_fmt, dst_w, dst_h, 1) < 0)
+        return -1;
+    pm_sws_scale(*sws, (const uint8_t *const *)src->data, src->linesize,
+              0, src->height, dst_data, dst_linesize);
+    return 0;
+}
+
+PYMEDIA_API uint8_t* extract_frame_raw(uint8_t *video_data, size_t video_size,
+                                       double timestamp_sec, const char *pix_fmt,
+                                       int out_width, int out_height,
+                                       const char *scale_algo, int keyframe_only,
+                                       int *frame_width, int *frame_height,
+                                       size_t *out_size) {
+    *out_size = 0;
+    *frame_width = 0;
+    *frame_height = 0;
+    BufferData bd;
+    AVFormatContext *ifmt_ctx = NULL;
+    AVIOContext *input_avio_ctx = NULL;
+    AVCodecContext *dec_ctx = NULL;
+    AVPacket *pkt = NULL;
+    AVFrame *frame = NULL;
+    struct SwsContext *sws = NULL;
+    uint8_t *result = NULL;
+
+    enum AVPixelFormat dst_fmt;
+    if (get_raw_pix_fmt(pix_fmt, &dst_fmt) < 0) {
+        fprintf(stderr, "Unsupported raw pixel format: %s\n", pix_fmt);
+        return NULL;
+    }
+    int sws_flags = get_sws_algorithm(scale_algo);
+    if (sws_flags < 0) {
+        fprintf(stderr, "Unsupported scale algorithm: %s\n", scale_algo);
+        return NULL;
+    }
+
+    if (open_input_memory(video_data, video_size, &ifmt_ctx,
+                          &input_avio_ctx, &bd) < 0)
+        goto cleanup;
+
+    int video_idx = find_stream(ifmt_ctx, AVMEDIA_TYPE_VIDEO);
+    if (video_idx < 0) goto cleanup;
+
+    AVCodecParameters *codecpar = ifmt_ctx->streams[video_idx]->codecpar;
+    const AVCodec *decoder = avcodec_find_decoder(codecpar->codec_id);
+    if (!decoder) goto cleanup;
+    dec_ctx = avcodec_alloc_context3(decoder);
+    if (!dec_ctx) goto cleanup;
+    avcodec_parameters_to_context(dec_ctx, codecpar);
+    if (avcodec_open2(dec_ctx, decoder, NULL) < 0) goto cleanup;
+
+    pkt = av_packet_alloc();
+    frame = av_frame_alloc();
+    if (!pkt || !frame) goto cleanup;
+
+    if (decode_frame_at(ifmt_ctx, video_idx, dec_ctx, timestamp_sec,
+                        keyframe_only, pkt, frame) < 0)
+        goto cleanup;
+
+    int w = out_width, h = out_height;
+    resolve_raw_size(frame->width, frame->height, dst_fmt, &w, &h);
+
+    int size = av_image_get_buffer_size(dst_fmt, w, h, 1);
+    if (size <= 0) goto cleanup;
+    result = malloc(size);
+    if (!result) goto cleanup;
+
+    if (scale_frame_packed(&sws, frame, dst_fmt, w, h, sws_flags, result) < 0) {
+        free(result);
+        result = NULL;
+        goto cleanup;
+    }
+    *frame_width = w;
+    *frame_height = h;
+    *out_size = (size_t)size;
+
+cleanup:
+    if (sws) sws_freeContext(sws);
+    if (frame) av_frame_free(&frame);
+    if (pkt) av_packet_free(&pkt);
+    if (dec_ctx) avcodec_free_context(&dec_ctx);
+    close_input(&ifmt_ctx, &input_avio_ctx);
+    return result;
+}
+
+// ============================================================
+// frame batcher — fixed-size [B,H,W,C] batches for ML pipelines
+// ============================================================
+//
+// One producer thread demuxes/decodes and samples frames; worker threads
+// scale them straight into caller-owned batch buffers. Decoded frames and
+// batch slots are preallocated at start, so the steady state performs no
+// per-frame allocation beyond the decoder's own buffer pool.
+
+#define BATCH_FREE    0
+#define BATCH_FILLING 1
+#define BATCH_READY   2
+#define BATCH_HELD    3
+
+#define FRAME_BATCHER_MAX_WORKERS 16
+
+typedef struct {
+    int state;
+    int count;          // frames assigned by the producer
+    int done;           // frames scaled by workers
+    int filled;         // producer finished assigning frames
+    double *timestamps;
+} BatchSlot;
+
+typedef struct {
+    int slot;
+    int index;
+} ScaleJob;
+
+typedef struct FrameBatcher {
+    BufferData bd;
+    AVFormatContext *ifmt_ctx;
+    AVIOContext *avio_ctx;
+    AVCodecContext *dec_ctx;
+    int video_idx;
+    int flushing;
+
+    double fps;
+    double next_sample;
+    int sampled_any;
+
+    enum AVPixelFormat dst_fmt;
+    int width, height, sws_flags;
+    size_t frame_bytes;
+    int batch_size;
+
+    uint8_t **pool;     // caller-owned, pool_size buffers of batch_size frames
+    int pool_size;
+    BatchSlot *slots;
+    AVFrame **frames;   // pool_size * batch_size decoded frames awaiting scale
+    ScaleJob *jobs;     // ring of pending scale jobs
+    int job_head, job_count;
+
+    pm_thread_t producer;
+    pm_thread_t workers[FRAME_BATCHER_MAX_WORKERS];
+    int producer_started;
+    int num_workers;
+
+    pm_mutex_t lock;
+    pm_cond_t cond;
+    int stop, eof, error;
+    int next_read, held;
+} FrameBatcher;
+
+// Pull the next decoded frame. Returns 1 on frame, 0 at end of stream.
+static int frame_batcher_decode(FrameBatcher *b, AVPacket *pkt, AVFrame *frame) {
+    for (;;) {
+        int ret = pm_receive_frame(b->dec_ctx, frame);
+        if (ret == 0) return 1;
+        if (ret != AVERROR(EAGAIN) || b->flushing) return 0;
+        if (read_next_stream_packet(b->ifmt_ctx, b->video_idx, pkt) <= 0) {
+            pm_send_packet(b->dec_ctx, NULL);
+            b->flushing = 1;
+            continue;
+        }
+        pm_send_packet(b->dec_ctx, pkt);
+        av_packet_unref(pkt);
+    }
+}
+
+// Frame-rate sampling: keep the first frame at or after each 1/fps tick.
+static int frame_batcher_take(FrameBatcher *b, double t) {
+    if (b->fps <= 0.0) return 1;
+    double step = 1.0 / b->fps;
+    if (!b->sampled_any) {
+        b->sampled_any = 1;
+        b->next_sample = t + step;
+        return 1;
+    }
+    if (t < b->next_sample - 1e-6) return 0;
+    b->next_sample += step;
+    if (b->next_sample <= t) b->next_sample = t + step;
+    return 1;
+}
+
+static void *frame_batcher_producer(void *arg) {
+    FrameBatcher *b = arg;
+    AVPacket *pkt = av_packet_alloc();
+    AVFrame *frame = av_frame_alloc();
+    AVRational tb = b->ifmt_ctx->streams[b->video_idx]->time_base;
+    int slot = 0, input_done = 0;
+
+    if (!pkt || !frame) {
+        pm_mutex_lock(&b->lock);
+        b->error = 1;
+        b->eof = 1;
+        pm_cond_broadcast(&b->cond);
+        pm_mutex_unlock(&b->lock);
+        input_done = 1;
+    }
+
+    while (!input_done) {
+        BatchSlot *s = &b->slots[slot];
+        pm_mutex_lock(&b->lock);
+        while (!b->stop && s->state != BATCH_FREE)
+            pm_cond_wait(&b->cond, &b->lock);
+        if (b->stop) {
+            pm_mutex_unlock(&b->lock);
+            break;
+        }
+        s->state = BATCH_FILLING;
+        s->count = 0;
+        s->done = 0;
+        s->filled = 0;
+        pm_mutex_unlock(&b->lock);
+
+        int assigned = 0, stopping = 0;
+        while (assigned < b->batch_size && !stopping) {
+            if (frame_batcher_decode(b, pkt, frame) <= 0) {
+                input_done = 1;
+                break;
+            }
+            int64_t ts = frame->best_effort_timestamp;
+            if (ts == AV_NOPTS_VALUE) ts = frame->pts;
+            double t = ts == AV_NOPTS_VALUE ? 0.0 : ts * av_q2d(tb);
+            if (!frame_batcher_take(b, t)) {
+                av_frame_unref(frame);
+                continue;
+            }
+
+            av_frame_move_ref(b->frames[slot * b->batch_size + assigned], frame);
+            pm_mutex_lock(&b->lock);
+            s->timestamps[assigned] = t;
+            s->count = ++assigned;
+            ScaleJob *job = &b->jobs[(b->job_head + b->job_count) %
+                                     (b->pool_size * b->batch_size)];
+            job->slot = slot;
+            job->index = assigned - 1;
+            b->job_count++;
+            stopping = b->stop;
+            pm_cond_broadcast(&b->cond);
+            pm_mutex_unlock(&b->lock);
+        }
+
+        pm_mutex_lock(&b->lock);
+        s->filled = 1;
+        if (s->count == 0) s->state = BATCH_FREE;
+        else if (s->done == s->count) s->state = BATCH_READY;
+        if (input_done || b->stop) {
+            b->eof = 1;
+            input_done = 1;
+        }
+        pm_cond_broadcast(&b->cond);
+        pm_mutex_unlock(&b->lock);
+        slot = (slot + 1) % b->pool_size;
+    }
+
+    if (frame) av_frame_free(&frame);
+    if (pkt) av_packet_free(&pkt);
+    return NULL;
+}
+
+static void *frame_batcher_worker(void *arg) {
+    FrameBatcher *b = arg;
+    struct SwsContext *sws = NULL;
+
+    for (;;) {
+        pm_mutex_lock(&b->lock);
+        while (!b->stop && b->job_count == 0)
+            pm_cond_wait(&b->cond, &b->lock);
+        if (b->stop) {
+            pm_mutex_unlock(&b->lock);
+            break;
+        }
+        ScaleJob job = b->jobs[b->job_head];
+        b->job_head = (b->job_head + 1) % (b->pool_size * b->batch_size);
+        b->job_count--;
+        pm_mutex_unlock(&b->lock);
+
+        AVFrame *src = b->frames[job.slot * b->batch_size + job.index];
+        uint8_t *dst = b->pool[job.slot] + (size_t)job.index * b->frame_bytes;
+        int ret = scale_frame_packed(&sws, src, b->dst_fmt, b->width, b->height,
+                                     b->sws_flags, dst);
+        av_frame_unref(src);
+
+        pm_mutex_lock(&b->lock);
+        BatchSlot *s = &b->slots[job.slot];
+        if (ret < 0) b->error = 1;
+        s->done++;
+        if (s->filled && s->done == s->count) s->state = BATCH_READY;
+        pm_cond_broadcast(&b->cond);
+        pm_mutex_unlock(&b->lock);
+    }
+
+    if (sws) sws_freeContext(sws);
+    return NULL;
+}
+
+PYMEDIA_API void frame_batcher_close(FrameBatcher *b);
+
+PYMEDIA_API FrameBatcher* frame_batcher_open(uint8_t *video_data, size_t video_size,
+                                             double fps, int out_width, int out_height,
+                                             const char *pix_fmt, const char *scale_algo,
+                                             int batch_size, int *frame_width,
+                                             int *frame_height, size_t *frame_bytes) {
+    *frame_width = 0;
+    *frame_height = 0;
+    *frame_bytes = 0;
+
+    enum AVPixelFormat dst_fmt;
+    if (get_raw_pix_fmt(pix_fmt, &dst_fmt) < 0) {
+        fprintf(stderr, "Unsupported raw pixel format: %s\n", pix_fmt);
+        return NULL;
+    }
+    int sws_flags = get_sws_algorithm(scale_algo);
+    if (sws_flags < 0) {
+        fprintf(stderr, "Unsupported scale algorithm: %s\n", scale_algo);
+        return NULL;
+    }
+    if (batch_size <= 0) return NULL;
+
+    FrameBatcher *b = calloc(1, sizeof(*b));
+    if (!b) return NULL;
+    b->dst_fmt = dst_fmt;
+    b->sws_flags = sws_flags;
+    b->batch_size = batch_size;
+    b->fps = fps;
+    b->held = -1;
+    pm_mutex_init(&b->lock);
+    pm_cond_init(&b->cond);
+
+    if (open_input_memory(video_data, video_size, &b->ifmt_ctx, &b->avio_ctx, &b->bd) < 0)
+        goto fail;
+    b->video_idx = find_stream(b->ifmt_ctx, AVMEDIA_TYPE_VIDEO);
+    if (b->video_idx < 0) goto fail;
+
+    AVCodecParameters *codecpar = b->ifmt_ctx->streams[b->video_idx]->codecpar;
+    const AVCodec *decoder = avcodec_find_decoder(codecpar->codec_id);
+    if (!decoder || codecpar->width <= 0 || codecpar->height <= 0) goto fail;
+    b->dec_ctx = avcodec_alloc_context3(decoder);
+    if (!b->dec_ctx) goto fail;
+    avcodec_parameters_to_context(b->dec_ctx, codecpar);
+    if (avcodec_open2(b->dec_ctx, decoder, NULL) < 0) goto fail;
+
+    b->width = out_width;
+    b->height = out_height;
+    resolve_raw_size(codecpar->width, codecpar->height, dst_fmt, &b->width, &b->height);
+    int size = av_image_get_buffer_size(dst_fmt, b->width, b->height, 1);
+    if (size <= 0) goto fail;
+    b->frame_bytes = (size_t)size;
+
+    *frame_width = b->width;
+    *frame_height = b->height;
+    *frame_bytes = b->frame_bytes;
+    return b;
+
+fail:
+    frame_batcher_close(b);
+    return NULL;
+}
+
+// Attach the caller's batch buffers (`pool_size` buffers, each
+// batch_size * frame_bytes long) and start the decode/scale threads.
+PYMEDIA_API int frame_batcher_start(FrameBatcher *b, uint8_t **pool, int pool_size,
+                                    int num_threads) {
+    if (!b || !pool || pool_size <= 0 || b->slots) return -1;
+    int total = pool_size * b->batch_size;
+
+    b->slots = calloc(pool_size, sizeof(*b->slots));
+    b->pool = calloc(pool_size, sizeof(*b->pool));
+    b->frames = calloc(total, sizeof(*b->frames));
+    b->jobs = calloc(total, sizeof(*b->jobs));
+    if (!b->slots || !b->pool || !b->frames || !b->jobs) return -1;
+    b->pool_size = pool_size;
+
+    for (int i = 0; i < pool_size; i++) {
+        b->pool[i] = pool[i];
+        b->slots[i].timestamps = calloc(b->batch_size, sizeof(double));
+        if (!b->slots[i].timestamps) return -1;
+    }
+    for (int i = 0; i < total; i++) {
+        b->frames[i] = av_frame_alloc();
+        if (!b->frames[i]) return -1;
+    }
+
+    int workers = pm_worker_count(num_threads, FRAME_BATCHER_MAX_WORKERS);
+    for (int i = 0; i < workers; i++) {
+        if (pm_thread_create(&b->workers[i], frame_batcher_worker, b) < 0) break;
+        b->num_workers++;
+    }
+    if (b->num_workers == 0) return -1;
+    if (pm_thread_create(&b->producer, frame_batcher_producer, b) < 0) return -1;
+    b->producer_started = 1;
+    return 0;
+}
+
+// Wait for the next complete batch. Returns its pool index (the buffer stays
+// valid until the following call) and fills `timestamps`/`count`; returns -1
+// when the stream is exhausted and -2 on a decode/scale error.
+PYMEDIA_API int frame_batcher_next(FrameBatcher *b, double *timestamps, int *count) {
+    *count = 0;
+    if (!b || !b->producer_started) return -2;
+
+    pm_mutex_lock(&b->lock);
+    if (b->held >= 0) {
+        b->slots[b->held].state = BATCH_FREE;
+        b->held = -1;
+        pm_cond_broadcast(&b->cond);
+    }
+    BatchSlot *s = &b->slots[b->next_read];
+    while (!b->error && s->state != BATCH_READY &&
+           !(b->eof && s->state == BATCH_FREE))
+        pm_cond_wait(&b->cond, &b->lock);
+
+    int slot;
+    if (b->error) {
+        slot = -2;
+    } else if (s->state != BATCH_READY) {
+        slot = -1;
+    } else {
+        slot = b->next_read;
+        s->state = BATCH_HELD;
+        b->held = slot;
+        memcpy(timestamps, s->timestamps, s->count * sizeof(double));
+        *count = s->count;
+        b->next_read = (b->next_read + 1) % b->pool_size;
+    }
+    pm_mutex_unlock(&b->lock);
+    return slot;
+}
+
+PYMEDIA_API void frame_batcher_close(FrameBatcher *b) {
+    if (!b) return;
+
+    pm_mutex_lock(&b->lock);
+    b->stop = 1;
+    pm_cond_broadcast(&b->cond);
+    pm_mutex_unlock(&b->lock);
+    if (b->producer_started) pm_thread_join(b->producer);
+    for (int i = 0; i < b->num_workers; i++)
+        pm_thread_join(b->workers[i]);
+
+    if (b->frames) {
+        for (int i = 0; i < b->pool_size * b->batch_size; i++)
+            if (b->frames[i]) av_frame_free(&b->frames[i]);
+        free(b->frames);
+    }
+    if (b->slots) {
+        for (int i = 0; i < b->pool_size; i++)
+            free(b->slots[i].timestamps);
+        free(b->slots);
+    }
+    free(b->jobs);
+    free(b->pool);
+    if (b->dec_ctx) avcodec_free_context(&b->dec_ctx);
+    close_input(&b->ifmt_ctx, &b->avio_ctx);
+    pm_cond_destroy(&b->cond);
+    pm_mutex_destroy(&b->lock);
+    free(b);
+}
@@ -0,0 +1,306 @@
+// ============================================================
+// jobs — asynchronous single operations on a shared native queue,
+// returned as handles that can be polled, cancelled and waited on;
+// plus progress/cancellation/statistics controls for synchronous calls
+// ============================================================
+
+#define JOB_MAX_WORKERS 64
+
+enum {
+    PM_JOB_QUEUED,
+    PM_JOB_RUNNING,
+    PM_JOB_DONE,
+    PM_JOB_FAILED,
+    PM_JOB_CANCELLED,
+};
+
+// Called on the worker thread once the job reaches a final state.
+typedef void (*pymedia_job_callback)(void *opaque, int state);
+
+typedef struct PmJob {
+    BatchJob spec;              // op/text point at the owned copies below
+    char *op, *text;
+    batch_op_fn fn;
+    PmControl control;
+    int state;                  // guarded by job_queue_lock
+    int refs;                   // handle + queue
+    uint8_t *result;
+    size_t result_size;
+    pymedia_job_callback callback;
+    void *opaque;
+    struct PmJob *next;
+} PmJob;
+
+// The queue and its workers live for the whole process; workers start on
+// the first submit. Everything below is guarded by job_queue_lock.
+static pm_once_t job_queue_once = PM_ONCE_INIT;
+static pm_mutex_t job_queue_lock;
+static pm_cond_t job_queue_cond;     // queue became non-empty
+static pm_cond_t job_done_cond;      // some job reached a final state
+static PmJob *job_queue_head, *job_queue_tail;
+static int job_queue_workers;
+
+static int job_finished(const PmJob *job) {
+    return job->state >= PM_JOB_DONE;
+}
+
+static void job_unref_locked(PmJob *job) {
+    if (--job->refs > 0) return;
+    free(job->result);
+    free(job->op);
+    free(job->text);
+    free(job);
+}
+
+PYMEDIA_API PmControl *pymedia_control_bind(PmControl *ctl);
+
+static void *job_worker(void *arg) {
+    (void)arg;
+    for (;;) {
+        pm_mutex_lock(&job_queue_lock);
+        while (!job_queue_head) pm_cond_wait(&job_queue_cond, &job_queue_lock);
+        PmJob *job = job_queue_head;
+        job_queue_head = job->next;
+        if (!job_queue_head) job_queue_tail = NULL;
+        int skip = pm_atomic_load(&job->control.cancelled) != 0;
+        job->state = skip ? PM_JOB_CANCELLED : PM_JOB_RUNNING;
+        pm_mutex_unlock(&job_queue_lock);
+
+        uint8_t *data = NULL;
+        size_t size = 0;
+        if (!skip) {
+            pymedia_control_bind(&job->control);
+            data = job->fn(&job->spec, &size);
+            pymedia_control_bind(NULL);
+        }
+
+        pm_mutex_lock(&job_queue_lock);
+        if (!skip) {
+            if (pm_atomic_load(&job->control.cancelled)) {
+                free(data);    // cut short: the output is incomplete
+                job->state = PM_JOB_CANCELLED;
+            } else if (!data) {
+                job->state = PM_JOB_FAILED;
+            } else {
+                job->result = data;
+                job->result_size = size;
+                job->state = PM_JOB_DONE;
+            }
+        }
+        int state = job->state;
+        pm_cond_broadcast(&job_done_cond);
+        pm_mutex_unlock(&job_queue_lock);
+
+        if (job->callback) job->callback(job->opaque, state);
+
+        pm_mutex_lock(&job_queue_lock);
+        job_unref_locked(job);
+        pm_mutex_unlock(&job_queue_lock);
+    }
+    return NULL;
+}
+
+static void job_queue_init_once(void) {
+    pm_mutex_init(&job_queue_lock);
+    pm_cond_init(&job_queue_cond);
+    pm_cond_init(&job_done_cond);
+
+    // Workers never inherit the submitting call's control; each job binds
+    // its own.
+    PmControl *saved = pm_control;
+    pm_control = NULL;
+    int wanted = pm_worker_count(0, JOB_MAX_WORKERS);
+    for (int i = 0; i < wanted; i++) {
+        pm_thread_t t;
+        if (pm_thread_create(&t, job_worker, NULL) < 0) break;
+        job_queue_workers++;
+    }
+    pm_control = saved;
+}
+
+// Queue one operation (same names and arguments as pymedia_batch_run).
+// `spec->data` is borrowed and must stay valid until the job reaches a
+// final state; op and text are copied. Returns NULL for an unknown op or
+// when no worker could be started.
+PYMEDIA_API PmJob *pymedia_job_submit(const BatchJob *spec, pymedia_job_callback callback,
+                                      void *opaque) {
+    if (!spec) return NULL;
+    batch_op_fn fn = batch_find_op(spec->op);
+    if (!fn) {
+        fprintf(stderr, "Unsupported job operation: %s\n", spec->op ? spec->op : "(null)");
+        return NULL;
+    }
+
+    pm_once(&job_queue_once, job_queue_init_once);
+    if (job_queue_workers == 0) return NULL;
+
+    PmJob *job = calloc(1, sizeof(*job));
+    if (!job) return NULL;
+    job->spec = *spec;
+    job->op = strdup(spec->op);
+    job->text = spec->text ? strdup(spec->text) : NULL;
+    if (!job->op || (spec->text && !job->text)) {
+        free(job->op);
+        free(job->text);
+        free(job);
+        return NULL;
+    }
+    job->spec.op = job->op;
+    job->spec.text = job->text;
+    job->fn = fn;
+    job->control.stats_enabled = 1;
+    job->refs = 2;
+    job->callback = callback;
+    job->opaque = opaque;
+
+    pm_mutex_lock(&job_queue_lock);
+    if (job_queue_tail) job_queue_tail->next = job;
+    else job_queue_head = job;
+    job_queue_tail = job;
+    pm_cond_broadcast(&job_queue_cond);
+    pm_mutex_unlock(&job_queue_lock);
+    return job;
+}
+
+PYMEDIA_API int pymedia_job_poll(PmJob *job) {
+    pm_mutex_lock(&job_queue_lock);
+    int state = job->state;
+    pm_mutex_unlock(&job_queue_lock);
+    return state;
+}
+
+// Fraction of the source read so far, 0..1 (0 while the duration is
+// unknown). Multi-input operations report against their summed duration.
+PYMEDIA_API double pymedia_job_progress(PmJob *job) {
+    if (pymedia_job_poll(job) == PM_JOB_DONE) return 1.0;
+    int64_t duration = pm_atomic_load(&job->control.duration_us);
+    if (duration <= 0) return 0.0;
+    double p = (double)pm_atomic_load(&job->control.progress_us) / (double)duration;
+    return p < 0.0 ? 0.0 : p > 1.0 ? 1.0 : p;
+}
+
+// Request cancellation: a queued job never starts, a running one stops at
+// its next packet read. Returns immediately; the job still reports its
+// final state through poll/wait/callback.
+PYMEDIA_API void pymedia_job_cancel(PmJob *job) {
+    pm_atomic_store(&job->control.cancelled, 1);
+}
+
+// Block until the job reaches a final state and return it.
+PYMEDIA_API int pymedia_job_wait(PmJob *job) {
+    pm_mutex_lock(&job_queue_lock);
+    while (!job_finished(job)) pm_cond_wait(&job_done_cond, &job_queue_lock);
+    int state = job->state;
+    pm_mutex_unlock(&job_queue_lock);
+    return state;
+}
+
+// Hand the output of a finished job to the caller (free with pymedia_free).
+// Returns NULL unless the job is PM_JOB_DONE, and once the result was taken.
+PYMEDIA_API uint8_t *pymedia_job_result(PmJob *job, size_t *out_size) {
+    pm_mutex_lock(&job_queue_lock);
+    uint8_t *data = job->state == PM_JOB_DONE ? job->result : NULL;
+    *out_size = data ? job->result_size : 0;
+    job->result = NULL;
+    pm_mutex_unlock(&job_queue_lock);
+    return data;
+}
+
+// The job's control, for pymedia_control_stats_json: per-stage statistics
+// of the job so far. Valid while the handle is held.
+PYMEDIA_API PmControl *pymedia_job_control(PmJob *job) {
+    return &job->control;
+}
+
+// Drop the caller's handle. An unfinished job is cancelled; its memory is
+// reclaimed once the worker is done with it.
+PYMEDIA_API void pymedia_job_release(PmJob *job) {
+    if (!job) return;
+    pymedia_job_cancel(job);
+    pm_mutex_lock(&job_queue_lock);
+    job_unref_locked(job);
+    pm_mutex_unlock(&job_queue_lock);
+}
+
+// ---------- controls for synchronous calls ----------
+//
+// A control is a cancellation token with an optional progress callback.
+// Bind it to a thread and every PYMEDIA_API call that thread makes reports
+// progress to it and stops at the next packet read once it is cancelled.
+// The output of a call that ran while its control was cancelled is
+// incomplete and must be discarded.
+
+PYMEDIA_API PmControl *pymedia_control_new(pymedia_progress_callback callback, void *opaque) {
+    PmControl *ctl = calloc(1, sizeof(*ctl));
+    if (!ctl) return NULL;
+    ctl->callback = callback;
+    ctl->opaque = opaque;
+    return ctl;
+}
+
+// Safe to call from any thread while a bound call is running.
+PYMEDIA_API void pymedia_control_cancel(PmControl *ctl) {
+    pm_atomic_store(&ctl->cancelled, 1);
+}
+
+PYMEDIA_API int pymedia_control_cancelled(PmControl *ctl) {
+    return pm_atomic_load(&ctl->cancelled) != 0;
+}
+
+// Collect per-stage statistics for calls made while `ctl` is bound. Call
+// before binding; stats add up over every bound interval.
+PYMEDIA_API void pymedia_control_enable_stats(PmControl *ctl) {
+    ctl->stats_enabled = 1;
+}
+
+// Bind `ctl` (NULL: none) to the calling thread; returns the previous
+// binding so nested scopes can restore it.
+PYMEDIA_API PmControl *pymedia_control_bind(PmControl *ctl) {
+    PmControl *prev = pm_control;
+    if (prev == ctl) return prev;
+    if (prev && prev->stats_enabled) {
+        pm_atomic_add(&prev->wall_us, av_gettime_relative() - prev->stats_wall_start);
+        pm_atomic_add(&prev->cpu_us, pm_process_cpu_us() - prev->stats_cpu_start);
+    }
+    if (ctl && ctl->stats_enabled) {
+        ctl->stats_wall_start = av_gettime_relative();
+        ctl->stats_cpu_start = pm_process_cpu_us();
+    }
+    pm_control = ctl;
+    pm_control_inherited = 0;
+    return prev;
+}
+
+// Statistics as JSON (malloc'd; free with pymedia_free):
+//   {"wall_us":..,"cpu_us":..,"stages":{"demux":{"wall_us":..,"cpu_us":..,
+//    "calls":..,"packets":..,"frames":..,"bytes_in":..,"bytes_out":..},...}}
+// Top-level times cover the bound intervals, cpu_us being process-wide.
+// Stage CPU is the time the calling and worker threads spent inside the
+// stage; codec-internal threads are only visible in the top-level figure.
+PYMEDIA_API char *pymedia_control_stats_json(PmControl *ctl) {
+    char json[2048];
+    int pos = snprintf(json, sizeof(json), "{\"wall_us\":%lld,\"cpu_us\":%lld,\"stages\":{",
+                       (long long)pm_atomic_load(&ctl->wall_us),
+                       (long long)pm_atomic_load(&ctl->cpu_us));
+    for (int i = 0; i < PM_STAGE_COUNT && pos < (int)sizeof(json); i++) {
+        PmStageStats *st = &ctl->stages[i];
+        pos += snprintf(json + pos, sizeof(json) - pos,
+                        "%s\"%s\":{\"wall_us\":%lld,\"cpu_us\":%lld,\"calls\":%lld,"
+                        "\"packets\":%lld,\"frames\":%lld,\"bytes_in\":%lld,\"bytes_out\":%lld}",
+                        i ? "," : "", pm_stage_names[i],
+                        (long long)pm_atomic_load(&st->wall_us),
+                        (long long)pm_atomic_load(&st->cpu_us),
+                        (long long)pm_atomic_load(&st->calls),
+                        (long long)pm_atomic_load(&st->packets),
+                        (long long)pm_atomic_load(&st->frames),
+                        (long long)pm_atomic_load(&st->bytes_in),
+                        (long long)pm_atomic_load(&st->bytes_out));
+    }
+    if (pos >= (int)sizeof(json) - 2) return NULL;
+    snprintf(json + pos, sizeof(json) - pos, "}}");
+    return strdup(json);
+}
+
+PYMEDIA_API void pymedia_control_free(PmControl *ctl) {
+    free(ctl);
+}
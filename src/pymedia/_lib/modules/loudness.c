@@ -0,0 +1,550 @@
+// ============================================================
+// loudness — ITU-R BS.1770-4 / EBU R128 meter (integrated,
+// momentary, short-term, LRA, true peak), LUFS normalization and a
+// lookahead true-peak limiter
+// ============================================================
+//
+// The meter is fed float planar chunks from AudioReader and keeps O(1)
+// state: K-weighting biquads per channel, a 30 x 100 ms ring of sub-block
+// energies, and fixed-resolution loudness histograms for gating.
+
+#define LOUDNESS_HIST_MIN (-70.0)
+#define LOUDNESS_HIST_STEP 0.05
+#define LOUDNESS_HIST_BINS 1600     // -70 .. +10 LUFS
+#define LOUDNESS_ABS_GATE (-70.0)
+#define TRUE_PEAK_PHASES 4
+#define TRUE_PEAK_TAPS 12
+
+typedef struct {
+    double b0, b1, b2, a1, a2;
+} Biquad;
+
+typedef struct {
+    int sample_rate;
+    int channels;
+    Biquad shelf, highpass;
+    double state[AUDIO_DSP_MAX_CHANNELS][4];
+    double weights[AUDIO_DSP_MAX_CHANNELS];
+
+    int hop;                 // samples per 100 ms sub-block
+    int hop_fill;
+    double hop_energy;
+    double hops[30];
+    int64_t hop_count;
+
+    uint64_t block_count[LOUDNESS_HIST_BINS];
+    double block_energy[LOUDNESS_HIST_BINS];
+    uint64_t short_count[LOUDNESS_HIST_BINS];
+    double short_energy[LOUDNESS_HIST_BINS];
+    double momentary_max;
+    double short_term_max;
+
+    int oversample;
+    float tp_coeffs[TRUE_PEAK_PHASES][TRUE_PEAK_TAPS];
+    float tp_hist[AUDIO_DSP_MAX_CHANNELS][2 * TRUE_PEAK_TAPS];
+    int tp_pos;
+    float true_peak;
+    float sample_peak;
+
+    double sum_squares;
+    int64_t samples;
+} LoudnessMeter;
+
+typedef struct {
+    double integrated;
+    double momentary_max;
+    double short_term_max;
+    double range;
+    double true_peak_db;
+    double sample_peak_db;
+    double rms_db;
+} LoudnessResult;
+
+static double energy_to_lufs(double energy) {
+    return energy > 0.0 ? -0.691 + 10.0 * log10(energy) : -INFINITY;
+}
+
+static double amplitude_to_db(double amplitude) {
+    return amplitude > 0.0 ? 20.0 * log10(amplitude) : -INFINITY;
+}
+
+// 4x polyphase interpolator for true peak: Hann-windowed sinc with the
+// cutoff at the input Nyquist, each phase normalized to unity DC gain.
+static void true_peak_init(float coeffs[TRUE_PEAK_PHASES][TRUE_PEAK_TAPS]) {
+    int taps = TRUE_PEAK_PHASES * TRUE_PEAK_TAPS;
+    for (int p = 0; p < TRUE_PEAK_PHASES; p++) {
+        double sum = 0.0;
+        for (int t = 0; t < TRUE_PEAK_TAPS; t++) {
+            int n = p + TRUE_PEAK_PHASES * t;
+            double x = (n - (taps - 1) / 2.0) / TRUE_PEAK_PHASES;
+            double sinc = fabs(x) < 1e-9 ? 1.0 : sin(M_PI * x) / (M_PI * x);
+            double window = 0.5 * (1.0 - cos(2.0 * M_PI * (n + 1) / (taps + 1)));
+            // Stored reversed so the history window is read oldest-first.
+            coeffs[p][TRUE_PEAK_TAPS - 1 - t] = (float)(sinc * window);
+            sum += sinc * window;
+        }
+        for (int t = 0; t < TRUE_PEAK_TAPS; t++) coeffs[p][t] /= (float)sum;
+    }
+}
+
+static void loudness_meter_init(LoudnessMeter *m, int sample_rate, int channels) {
+    memset(m, 0, sizeof(*m));
+    m->sample_rate = sample_rate;
+    m->channels = channels;
+    m->hop = sample_rate / 10 > 0 ? sample_rate / 10 : 1;
+
+    // K-weighting (BS.1770 Annex 1), re-derived for the actual sample rate.
+    double fs = sample_rate;
+    double f0 = 1681.974450955533, gain_db = 3.999843853973347, q = 0.7071752369554196;
+    double k = tan(M_PI * f0 / fs);
+    double vh = pow(10.0, gain_db / 20.0);
+    double vb = pow(vh, 0.4996667741545416);
+    double a0 = 1.0 + k / q + k * k;
+    m->shelf.b0 = (vh + vb * k / q + k * k) / a0;
+    m->shelf.b1 = 2.0 * (k * k - vh) / a0;
+    m->shelf.b2 = (vh - vb * k / q + k * k) / a0;
+    m->shelf.a1 = 2.0 * (k * k - 1.0) / a0;
+    m->shelf.a2 = (1.0 - k / q + k * k) / a0;
+
+    f0 = 38.13547087602444;
+    q = 0.5003270373238773;
+    k = tan(M_PI * f0 / fs);
+    a0 = 1.0 + k / q + k * k;
+    m->highpass.b0 = 1.0;
+    m->highpass.b1 = -2.0;
+    m->highpass.b2 = 1.0;
+    m->highpass.a1 = 2.0 * (k * k - 1.0) / a0;
+    m->highpass.a2 = (1.0 - k / q + k * k) / a0;
+
+    // Channel weights for FFmpeg default layouts: LFE (index 3 of 5.1/7.1)
+    // is excluded, surround channels get +1.5 dB.
+    for (int c = 0; c < channels; c++) {
+        m->weights[c] = 1.0;
+        if (channels >= 5 && c >= 3) m->weights[c] = 1.41;
+        if (channels >= 6 && c == 3) m->weights[c] = 0.0;
+    }
+
+    m->oversample = sample_rate < 96000;
+    true_peak_init(m->tp_coeffs);
+
+    m->momentary_max = 0.0;
+    m->short_term_max = 0.0;
+}
+
+static void loudness_hist_add(uint64_t *count, double *energy_sum, double energy) {
+    double lufs = energy_to_lufs(energy);
+    if (!(lufs > LOUDNESS_ABS_GATE)) return;
+    int bin = (int)((lufs - LOUDNESS_HIST_MIN) / LOUDNESS_HIST_STEP);
+    if (bin >= LOUDNESS_HIST_BINS) bin = LOUDNESS_HIST_BINS - 1;
+    count[bin]++;
+    energy_sum[bin] += energy;
+}
+
+static void loudness_meter_end_hop(LoudnessMeter *m) {
+    m->hops[m->hop_count % 30] = m->hop_energy / m->hop;
+    m->hop_count++;
+    m->hop_energy = 0.0;
+    m->hop_fill = 0;
+
+    if (m->hop_count >= 4) {
+        double e = 0.0;
+        for (int i = 1; i <= 4; i++) e += m->hops[(m->hop_count - i) % 30];
+        e /= 4.0;
+        loudness_hist_add(m->block_count, m->block_energy, e);
+        if (e > m->momentary_max) m->momentary_max = e;
+    }
+    if (m->hop_count >= 30) {
+        double e = 0.0;
+        for (int i = 0; i < 30; i++) e += m->hops[i];
+        e /= 30.0;
+        loudness_hist_add(m->short_count, m->short_energy, e);
+        if (e > m->short_term_max) m->short_term_max = e;
+    }
+}
+
+static float true_peak_dot(const float *coeffs, const float *hist) {
+    float acc = 0.0f;
+    int t = 0;
+#ifdef PM_HAVE_SSE2
+    __m128 vacc = _mm_setzero_ps();
+    for (; t + 4 <= TRUE_PEAK_TAPS; t += 4)
+        vacc = _mm_add_ps(vacc, _mm_mul_ps(_mm_loadu_ps(coeffs + t), _mm_loadu_ps(hist + t)));
+    float lanes[4];
+    _mm_storeu_ps(lanes, vacc);
+    acc = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+    for (; t < TRUE_PEAK_TAPS; t++) acc += coeffs[t] * hist[t];
+    return acc;
+}
+
+static void loudness_meter_add(LoudnessMeter *m, float **planes, int n) {
+    for (int c = 0; c < m->channels; c++)
+        m->sum_squares += dsp_sum_squares(planes[c], n);
+    m->samples += (int64_t)n * m->channels;
+
+    // K-weighted energy, split at 100 ms sub-block boundaries.
+    int i = 0;
+    while (i < n) {
+        int seg = m->hop - m->hop_fill;
+        if (seg > n - i) seg = n - i;
+        for (int c = 0; c < m->channels; c++) {
+            if (m->weights[c] == 0.0) continue;
+            double *z = m->state[c];
+            const Biquad *s = &m->shelf, *h = &m->highpass;
+            double acc = 0.0;
+            for (int j = i; j < i + seg; j++) {
+                double x = planes[c][j];
+                double y = s->b0 * x + z[0];
+                z[0] = s->b1 * x - s->a1 * y + z[1];
+                z[1] = s->b2 * x - s->a2 * y;
+                double out = h->b0 * y + z[2];
+                z[2] = h->b1 * y - h->a1 * out + z[3];
+                z[3] = h->b2 * y - h->a2 * out;
+                acc += out * out;
+            }
+            m->hop_energy += m->weights[c] * acc;
+        }
+        m->hop_fill += seg;
+        i += seg;
+        if (m->hop_fill == m->hop) loudness_meter_end_hop(m);
+    }
+
+    // Sample and 4x-oversampled true peak.
+    for (int j = 0; j < n; j++) {
+        for (int c = 0; c < m->channels; c++) {
+            float x = planes[c][j];
+            float ax = fabsf(x);
+            if (ax > m->sample_peak) m->sample_peak = ax;
+            if (!m->oversample) continue;
+            float *hist = m->tp_hist[c];
+            hist[m->tp_pos] = x;
+            hist[m->tp_pos + TRUE_PEAK_TAPS] = x;
+            const float *window = hist + m->tp_pos + 1;
+            for (int p = 0; p < TRUE_PEAK_PHASES; p++) {
+                float y = fabsf(true_peak_dot(m->tp_coeffs[p], window));
+                if (y > m->true_peak) m->true_peak = y;
+            }
+        }
+        if (m->oversample) m->tp_pos = (m->tp_pos + 1) % TRUE_PEAK_TAPS;
+    }
+}
+
+// Mean energy of histogram bins at or above `gate` (LUFS).
+static double loudness_gated_mean(const uint64_t *count, const double *energy, double gate,
+                                  uint64_t *blocks) {
+    int start = (int)ceil((gate - LOUDNESS_HIST_MIN) / LOUDNESS_HIST_STEP);
+    if (start < 0) start = 0;
+    double sum = 0.0;
+    uint64_t n = 0;
+    for (int b = start; b < LOUDNESS_HIST_BINS; b++) {
+        sum += energy[b];
+        n += count[b];
+    }
+    if (blocks) *blocks = n;
+    return n ? sum / n : 0.0;
+}
+
+static void loudness_meter_result(const LoudnessMeter *m, LoudnessResult *out) {
+    // Integrated: absolute gate at -70 LUFS (applied on insert), then a
+    // relative gate 10 LU below the absolute-gated mean.
+    double mean = loudness_gated_mean(m->block_count, m->block_energy, LOUDNESS_ABS_GATE, NULL);
+    out->integrated = -INFINITY;
+    if (mean > 0.0) {
+        double gate = energy_to_lufs(mean) - 10.0;
+        out->integrated =
+            energy_to_lufs(loudness_gated_mean(m->block_count, m->block_energy, gate, NULL));
+    }
+
+    // LRA (EBU Tech 3342): 10th..95th percentile of short-term loudness
+    // after a relative gate 20 LU below the absolute-gated mean.
+    out->range = 0.0;
+    mean = loudness_gated_mean(m->short_count, m->short_energy, LOUDNESS_ABS_GATE, NULL);
+    if (mean > 0.0) {
+        double gate = energy_to_lufs(mean) - 20.0;
+        uint64_t total = 0;
+        loudness_gated_mean(m->short_count, m->short_energy, gate, &total);
+        int start = (int)ceil((gate - LOUDNESS_HIST_MIN) / LOUDNESS_HIST_STEP);
+        if (start < 0) start = 0;
+        if (total > 0) {
+            uint64_t lo_rank = (uint64_t)(0.10 * (total - 1)), hi_rank = (uint64_t)(0.95 * (total - 1));
+            uint64_t seen = 0;
+            double lo = 0.0, hi = 0.0;
+            int have_lo = 0;
+            for (int b = start; b < LOUDNESS_HIST_BINS; b++) {
+                if (!m->short_count[b]) continue;
+                seen += m->short_count[b];
+                double center = LOUDNESS_HIST_MIN + (b + 0.5) * LOUDNESS_HIST_STEP;
+                if (!have_lo && seen > lo_rank) { lo = center; have_lo = 1; }
+                if (seen > hi_rank) { hi = center; break; }
+            }
+            out->range = hi - lo;
+        }
+    }
+
+    out->momentary_max = energy_to_lufs(m->momentary_max);
+    out->short_term_max = energy_to_lufs(m->short_term_max);
+    float tp = m->true_peak > m->sample_peak ? m->true_peak : m->sample_peak;
+    out->true_peak_db = amplitude_to_db(tp);
+    out->sample_peak_db = amplitude_to_db(m->sample_peak);
+    out->rms_db = m->samples ? amplitude_to_db(sqrt(m->sum_squares / m->samples)) : -INFINITY;
+}
+
+// Measure `data` in one decode pass, the first of `passes` reads of it.
+// Returns 0 on success.
+static int measure_loudness(uint8_t *data, size_t size, int passes, LoudnessResult *out,
+                            int *sample_rate, int *channels) {
+    AudioReader r;
+    if (audio_reader_open(&r, data, size, -1, -1) < 0) return -1;
+    audio_reader_pass(&r, 0, passes);
+    LoudnessMeter *m = malloc(sizeof(*m));
+    if (!m) {
+        audio_reader_close(&r);
+        return -1;
+    }
+    loudness_meter_init(m, r.sample_rate, r.channels);
+    int n;
+    while ((n = audio_reader_read(&r)) > 0) loudness_meter_add(m, r.buf, n);
+    if (n == 0) loudness_meter_result(m, out);
+    if (sample_rate) *sample_rate = r.sample_rate;
+    if (channels) *channels = r.channels;
+    free(m);
+    audio_reader_close(&r);
+    return n == 0 ? 0 : -1;
+}
+
+// JSON has no infinities; Python's json module accepts -Infinity.
+static void json_append_number(char **json, size_t *len, size_t *cap, const char *key,
+                               double value, int last) {
+    char item[96];
+    if (isfinite(value))
+        snprintf(item, sizeof(item), "\"%s\":%.6f%s", key, value, last ? "" : ",");
+    else
+        snprintf(item, sizeof(item), "\"%s\":%s%s", key,
+                 value < 0 ? "-Infinity" : "Infinity", last ? "" : ",");
+    json_append(json, len, cap, item);
+}
+
+PYMEDIA_API char* analyze_loudness_json(uint8_t *data, size_t size) {
+    LoudnessResult res;
+    int sample_rate = 0, channels = 0;
+    if (measure_loudness(data, size, 1, &res, &sample_rate, &channels) < 0) return NULL;
+
+    size_t len = 0, cap = 512;
+    char *json = malloc(cap);
+    if (!json) return NULL;
+    json[0] = '\0';
+    json_append(&json, &len, &cap, "{");
+    json_append_number(&json, &len, &cap, "integrated_lufs", res.integrated, 0);
+    json_append_number(&json, &len, &cap, "momentary_max_lufs", res.momentary_max, 0);
+    json_append_number(&json, &len, &cap, "short_term_max_lufs", res.short_term_max, 0);
+    json_append_number(&json, &len, &cap, "loudness_range_lu", res.range, 0);
+    json_append_number(&json, &len, &cap, "true_peak_dbtp", res.true_peak_db, 0);
+    json_append_number(&json, &len, &cap, "peak_dbfs", res.sample_peak_db, 0);
+    json_append_number(&json, &len, &cap, "rms_dbfs", res.rms_db, 0);
+    json_append_number(&json, &len, &cap, "sample_rate", sample_rate, 0);
+    json_append_number(&json, &len, &cap, "channels", channels, 1);
+    json_append(&json, &len, &cap, "}");
+    return json;
+}
+
+// Static gain toward `target_lufs` integrated loudness. Inputs too short
+// or quiet to gate (no 400 ms block above -70 LUFS) fall back to RMS.
+PYMEDIA_API uint8_t* audio_normalize_lufs(uint8_t *data, size_t size, double target_lufs,
+                                          const char *format, size_t *out_size) {
+    *out_size = 0;
+    LoudnessResult res;
+    int sample_rate = 0, channels = 0;
+    if (measure_loudness(data, size, 2, &res, &sample_rate, &channels) < 0) return NULL;
+
+    double current = isfinite(res.integrated) ? res.integrated : res.rms_db;
+    float gain = isfinite(current) ? (float)pow(10.0, (target_lufs - current) / 20.0) : 1.0f;
+    return audio_gain_encode(data, size, sample_rate, channels, gain, format, out_size);
+}
+
+// ---------- lookahead true-peak limiter ----------
+//
+// Gain computer: every sample gets a required gain ceiling / peak, where
+// the peak includes the 4x-interpolated inter-sample values around it. A
+// sliding minimum over the lookahead window, a release-limited hold and a
+// box average of the same length give a smooth gain that has already
+// reached the required value when the peak leaves the delay line.
+
+#define LIMITER_LOOKAHEAD_SEC 0.005
+#define LIMITER_RELEASE_SEC 0.1
+
+typedef struct {
+    int channels;
+    int lookahead;
+    int delay;              // lookahead - 1 + detector centre offset
+    float gain;             // static pre-gain
+    float ceiling;
+    float release;
+    float tp_coeffs[TRUE_PEAK_PHASES][TRUE_PEAK_TAPS];
+    float tp_hist[AUDIO_DSP_MAX_CHANNELS][2 * TRUE_PEAK_TAPS];
+    int tp_pos;
+    float **delay_buf;      // channels x (delay + 1)
+    float *min_val;         // monotonic deque for the sliding minimum
+    int64_t *min_idx;
+    int min_head, min_count;
+    float *box;
+    double box_sum;
+    int box_pos;
+    float held;
+    int64_t t;
+} PeakLimiter;
+
+static void peak_limiter_free(PeakLimiter *l) {
+    dsp_free_planes(&l->delay_buf);
+    free(l->min_val);
+    free(l->min_idx);
+    free(l->box);
+    l->min_val = NULL;
+    l->min_idx = NULL;
+    l->box = NULL;
+}
+
+static int peak_limiter_init(PeakLimiter *l, int sample_rate, int channels, float gain,
+                             double ceiling_db) {
+    memset(l, 0, sizeof(*l));
+    l->channels = channels;
+    l->gain = gain;
+    l->ceiling = (float)pow(10.0, ceiling_db / 20.0);
+    l->lookahead = (int)(LIMITER_LOOKAHEAD_SEC * sample_rate);
+    if (l->lookahead < 1) l->lookahead = 1;
+    l->delay = l->lookahead - 1 + TRUE_PEAK_TAPS / 2 - 1;
+    l->release = (float)(1.0 - exp(-1.0 / (LIMITER_RELEASE_SEC * sample_rate)));
+    true_peak_init(l->tp_coeffs);
+
+    l->delay_buf = dsp_alloc_planes(channels, l->delay + 1);
+    l->min_val = malloc(sizeof(float) * l->lookahead);
+    l->min_idx = malloc(sizeof(int64_t) * l->lookahead);
+    l->box = malloc(sizeof(float) * l->lookahead);
+    if (!l->delay_buf || !l->min_val || !l->min_idx || !l->box) {
+        peak_limiter_free(l);
+        return -1;
+    }
+    for (int c = 0; c < channels; c++) memset(l->delay_buf[c], 0, sizeof(float) * (l->delay + 1));
+    for (int i = 0; i < l->lookahead; i++) l->box[i] = 1.0f;
+    l->box_sum = l->lookahead;
+    l->held = 1.0f;
+    return 0;
+}
+
+// Limit `n` samples of `in` into `out` (may alias `in`). Output lags input
+// by l->delay samples; returns the number of samples written.
+static int peak_limiter_process(PeakLimiter *l, float **in, int n, float **out) {
+    int written = 0;
+    int ring = l->delay + 1;
+    for (int j = 0; j < n; j++) {
+        float peak = 0.0f;
+        int slot = (int)(l->t % ring);
+        for (int c = 0; c < l->channels; c++) {
+            float x = in[c][j] * l->gain;
+            l->delay_buf[c][slot] = x;
+            float *hist = l->tp_hist[c];
+            hist[l->tp_pos] = x;
+            hist[l->tp_pos + TRUE_PEAK_TAPS] = x;
+            const float *window = hist + l->tp_pos + 1;
+            float p = fmaxf(fabsf(window[TRUE_PEAK_TAPS / 2]), fabsf(window[TRUE_PEAK_TAPS / 2 - 1]));
+            for (int ph = 0; ph < TRUE_PEAK_PHASES; ph++)
+                p = fmaxf(p, fabsf(true_peak_dot(l->tp_coeffs[ph], window)));
+            if (p > peak) peak = p;
+        }
+        l->tp_pos = (l->tp_pos + 1) % TRUE_PEAK_TAPS;
+
+        float need = peak > l->ceiling ? l->ceiling / peak : 1.0f;
+        if (l->min_count > 0 && l->min_idx[l->min_head] <= l->t - l->lookahead) {
+            l->min_head = (l->min_head + 1) % l->lookahead;
+            l->min_count--;
+        }
+        while (l->min_count > 0) {
+            int back = (l->min_head + l->min_count - 1) % l->lookahead;
+            if (l->min_val[back] < need) break;
+            l->min_count--;
+        }
+        int tail = (l->min_head + l->min_count) % l->lookahead;
+        l->min_val[tail] = need;
+        l->min_idx[tail] = l->t;
+        l->min_count++;
+
+        float target = l->min_val[l->min_head];
+        float held = l->held + (1.0f - l->held) * l->release;
+        l->held = target < held ? target : held;
+        l->box_sum += l->held - l->box[l->box_pos];
+        l->box[l->box_pos] = l->held;
+        l->box_pos = (l->box_pos + 1) % l->lookahead;
+        float g = (float)(l->box_sum / l->lookahead);
+
+        if (l->t >= l->delay) {
+            int read = (int)((l->t + 1) % ring);
+            for (int c = 0; c < l->channels; c++) {
+                float y = l->delay_buf[c][read] * g;
+                out[c][written] = y > l->ceiling ? l->ceiling : (y < -l->ceiling ? -l->ceiling : y);
+            }
+            written++;
+        }
+        l->t++;
+    }
+    return written;
+}
+
+// ---------- two-pass normalization with video copy ----------
+
+PYMEDIA_API uint8_t* normalize_loudness(uint8_t *video_data, size_t video_size,
+                                        double target_lufs, double true_peak_db,
+                                        size_t *out_size) {
+    *out_size = 0;
+    LoudnessResult res;
+    int sample_rate = 0, channels = 0;
+    if (measure_loudness(video_data, video_size, 2, &res, &sample_rate, &channels) < 0)
+        return NULL;
+    double current = isfinite(res.integrated) ? res.integrated : res.rms_db;
+    float gain = isfinite(current) ? (float)pow(10.0, (target_lufs - current) / 20.0) : 1.0f;
+
+    AudioReader r;
+    AudioWriter w;
+    PeakLimiter lim;
+    float **silence = NULL;
+    uint8_t *result = NULL;
+    int writer_open = 0, limiter_open = 0;
+    int n;
+
+    if (audio_reader_open(&r, video_data, video_size, sample_rate, channels) < 0) return NULL;
+    audio_reader_pass(&r, 1, 2);
+    int video_idx = find_stream(r.ifmt_ctx, AVMEDIA_TYPE_VIDEO);
+    AVStream *vst = video_idx >= 0 ? r.ifmt_ctx->streams[video_idx] : NULL;
+    if (audio_writer_open_ex(&w, "aac", "mp4", sample_rate, channels,
+                             vst ? vst->codecpar : NULL,
+                             vst ? vst->time_base : (AVRational){0, 1}) < 0)
+        goto cleanup;
+    writer_open = 1;
+    if (peak_limiter_init(&lim, sample_rate, channels, gain, true_peak_db) < 0) goto cleanup;
+    limiter_open = 1;
+
+    PacketCopy copy = { &w, video_idx, vst ? vst->time_base : (AVRational){0, 1} };
+    r.on_packet = packet_copy_cb;
+    r.opaque = &copy;
+
+    while ((n = audio_reader_read(&r)) > 0) {
+        int m = peak_limiter_process(&lim, r.buf, n, r.buf);
+        if (audio_writer_write(&w, r.buf, m) < 0) goto cleanup;
+    }
+    if (n < 0) goto cleanup;
+
+    // Push silence through the lookahead so the tail is emitted.
+    silence = dsp_alloc_planes(channels, lim.delay);
+    if (!silence) goto cleanup;
+    for (int c = 0; c < channels; c++) memset(silence[c], 0, sizeof(float) * lim.delay);
+    n = peak_limiter_process(&lim, silence, lim.delay, silence);
+    if (audio_writer_write(&w, silence, n) < 0) goto cleanup;
+
+    result = audio_writer_finish(&w, out_size);
+
+cleanup:
+    dsp_free_planes(&silence);
+    if (limiter_open) peak_limiter_free(&lim);
+    if (writer_open) audio_writer_close(&w);
+    audio_reader_close(&r);
+    pm_progress_input(0, 0);
+    return result;
+}
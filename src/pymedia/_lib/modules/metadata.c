@@ -38,7 +38,7 @@ PYMEDIA_API uint8_t* strip_metadata(uint8_t *video_data, size_t video_size,
     pkt = av_packet_alloc();
     if (!pkt) goto cleanup;
 
-    while (av_read_frame(ifmt_ctx, pkt) >= 0) {
+    while (pm_read_frame(ifmt_ctx, pkt) >= 0) {
         int si = pkt->stream_index;
         if (si < 0 || (unsigned)si >= ifmt_ctx->nb_streams || stream_mapping[si] < 0) {
             av_packet_unref(pkt); continue;
@@ -49,7 +49,7 @@ PYMEDIA_API uint8_t* strip_metadata(uint8_t *video_data, size_t video_size,
         pkt->stream_index = out_si;
         av_packet_rescale_ts(pkt, in_s->time_base, out_s->time_base);
         pkt->pos = -1;
-        av_interleaved_write_frame(ofmt_ctx, pkt);
+        pm_write_frame(ofmt_ctx, pkt);
         av_packet_unref(pkt);
     }
 
@@ -119,7 +119,7 @@ PYMEDIA_API uint8_t* set_metadata(uint8_t *video_data, size_t video_size,
     pkt = av_packet_alloc();
     if (!pkt) goto cleanup;
 
-    while (av_read_frame(ifmt_ctx, pkt) >= 0) {
+    while (pm_read_frame(ifmt_ctx, pkt) >= 0) {
         int si = pkt->stream_index;
         if (si < 0 || (unsigned)si >= ifmt_ctx->nb_streams || stream_mapping[si] < 0) {
             av_packet_unref(pkt); continue;
@@ -130,7 +130,7 @@ PYMEDIA_API uint8_t* set_metadata(uint8_t *video_data, size_t video_size,
         pkt->stream_index = out_si;
         av_packet_rescale_ts(pkt, in_s->time_base, out_s->time_base);
         pkt->pos = -1;
-        av_interleaved_write_frame(ofmt_ctx, pkt);
+        pm_write_frame(ofmt_ctx, pkt);
         av_packet_unref(pkt);
     }
 
@@ -0,0 +1,349 @@
+// ============================================================
+// parallel transcode — keyframe-aligned chunks encoded by
+// independent libx264 instances on worker threads, then stitched
+// ============================================================
+
+#define PARALLEL_MAX_SEGMENTS 64
+
+typedef struct {
+    // Shared, read-only.
+    uint8_t *data;
+    size_t size;
+    int crf;
+    const char *preset;
+    int width, height;
+    int enc_threads;
+    // Chunk range [start, end), source pts in the video time base.
+    int64_t start, end;
+    // Results, read by the caller after join.
+    AVCodecContext *enc;            // kept open for its extradata
+    AVPacket **pkts;
+    int count, cap;
+    int failed;
+} TranscodeChunk;
+
+static void transcode_chunk_free(TranscodeChunk *c) {
+    for (int i = 0; i < c->count; i++) av_packet_free(&c->pkts[i]);
+    free(c->pkts);
+    c->pkts = NULL;
+    c->count = c->cap = 0;
+    if (c->enc) avcodec_free_context(&c->enc);
+}
+
+static int transcode_chunk_drain(TranscodeChunk *c, AVPacket *enc_pkt) {
+    while (pm_receive_packet(c->enc, enc_pkt) == 0) {
+        if (c->count == c->cap) {
+            int cap = c->cap ? c->cap * 2 : 256;
+            AVPacket **grown = realloc(c->pkts, sizeof(*grown) * cap);
+            if (!grown) return -1;
+            c->pkts = grown;
+            c->cap = cap;
+        }
+        AVPacket *keep = av_packet_alloc();
+        if (!keep) return -1;
+        av_packet_move_ref(keep, enc_pkt);
+        c->pkts[c->count++] = keep;
+    }
+    return 0;
+}
+
+static int transcode_chunk_encode(TranscodeChunk *c, AVCodecContext *dec, struct SwsContext *sws,
+                                  AVFrame *dec_frame, AVFrame *scale_frame, AVPacket *enc_pkt) {
+    while (pm_receive_frame(dec, dec_frame) == 0) {
+        int64_t ts = dec_frame->best_effort_timestamp;
+        if (ts == AV_NOPTS_VALUE) ts = dec_frame->pts;
+        if (ts != AV_NOPTS_VALUE && ts >= c->start && ts < c->end) {
+            if (av_frame_make_writable(scale_frame) < 0) return -1;
+            pm_sws_scale(sws, (const uint8_t *const *)dec_frame->data, dec_frame->linesize, 0,
+                      dec_frame->height, scale_frame->data, scale_frame->linesize);
+            // Source timestamps are kept, so chunks stitch without rebasing.
+            scale_frame->pts = ts;
+            if (pm_send_frame(c->enc, scale_frame) < 0) return -1;
+            if (transcode_chunk_drain(c, enc_pkt) < 0) return -1;
+        }
+        av_frame_unref(dec_frame);
+    }
+    return 0;
+}
+
+static int transcode_chunk_run(TranscodeChunk *c) {
+    BufferData bd;
+    AVFormatContext *ifmt_ctx = NULL;
+    AVIOContext *avio_ctx = NULL;
+    AVCodecContext *dec = NULL;
+    struct SwsContext *sws = NULL;
+    AVPacket *pkt = NULL, *enc_pkt = NULL;
+    AVFrame *dec_frame = NULL, *scale_frame = NULL;
+    int ret = -1;
+
+    if (open_input_memory(c->data, c->size, &ifmt_ctx, &avio_ctx, &bd) < 0) return -1;
+    int video_idx = find_stream(ifmt_ctx, AVMEDIA_TYPE_VIDEO);
+    if (video_idx < 0) goto cleanup;
+    AVStream *st = ifmt_ctx->streams[video_idx];
+
+    const AVCodec *vdecoder = avcodec_find_decoder(st->codecpar->codec_id);
+    if (!vdecoder) goto cleanup;
+    dec = avcodec_alloc_context3(vdecoder);
+    if (!dec) goto cleanup;
+    avcodec_parameters_to_context(dec, st->codecpar);
+    if (avcodec_open2(dec, vdecoder, NULL) < 0) goto cleanup;
+
+    const AVCodec *vencoder = avcodec_find_encoder_by_name("libx264");
+    if (!vencoder) goto cleanup;
+    c->enc = avcodec_alloc_context3(vencoder);
+    if (!c->enc) goto cleanup;
+    c->enc->width = c->width;
+    c->enc->height = c->height;
+    c->enc->pix_fmt = AV_PIX_FMT_YUV420P;
+    c->enc->time_base = st->time_base;
+    AVRational fps = av_guess_frame_rate(ifmt_ctx, st, NULL);
+    if (fps.num > 0 && fps.den > 0) c->enc->framerate = fps;
+    c->enc->thread_count = c->enc_threads;
+    c->enc->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+    char crf_str[8];
+    snprintf(crf_str, sizeof(crf_str), "%d", c->crf);
+    av_opt_set(c->enc->priv_data, "crf", crf_str, 0);
+    av_opt_set(c->enc->priv_data, "preset", c->preset, 0);
+    if (avcodec_open2(c->enc, vencoder, NULL) < 0) goto cleanup;
+
+    sws = sws_getContext(st->codecpar->width, st->codecpar->height, dec->pix_fmt,
+                         c->width, c->height, AV_PIX_FMT_YUV420P,
+                         SWS_BILINEAR, NULL, NULL, NULL);
+    pkt = av_packet_alloc();
+    enc_pkt = av_packet_alloc();
+    dec_frame = av_frame_alloc();
+    scale_frame = av_frame_alloc();
+    if (!sws || !pkt || !enc_pkt || !dec_frame || !scale_frame) goto cleanup;
+    scale_frame->format = AV_PIX_FMT_YUV420P;
+    scale_frame->width = c->width;
+    scale_frame->height = c->height;
+    if (av_frame_get_buffer(scale_frame, 0) < 0) goto cleanup;
+
+    if (c->start != INT64_MIN &&
+        av_seek_frame(ifmt_ctx, video_idx, c->start, AVSEEK_FLAG_BACKWARD) < 0)
+        goto cleanup;
+
+    // Past the next chunk's keyframe only open-GOP leading frames
+    // (pts < end) still belong here; the keyframe is decoded for them.
+    int past_end = 0, failed = 0;
+    while (!failed && read_next_stream_packet(ifmt_ctx, video_idx, pkt) > 0) {
+        int64_t pts = pkt->pts != AV_NOPTS_VALUE ? pkt->pts : pkt->dts;
+        if (past_end && pts != AV_NOPTS_VALUE && pts >= c->end) {
+            av_packet_unref(pkt);
+            break;
+        }
+        if ((pkt->flags & AV_PKT_FLAG_KEY) && pts != AV_NOPTS_VALUE && pts >= c->end)
+            past_end = 1;
+        if (pm_send_packet(dec, pkt) >= 0 &&
+            transcode_chunk_encode(c, dec, sws, dec_frame, scale_frame, enc_pkt) < 0)
+            failed = 1;
+        av_packet_unref(pkt);
+    }
+    if (failed) goto cleanup;
+    pm_send_packet(dec, NULL);
+    if (transcode_chunk_encode(c, dec, sws, dec_frame, scale_frame, enc_pkt) < 0) goto cleanup;
+    pm_send_frame(c->enc, NULL);
+    if (transcode_chunk_drain(c, enc_pkt) < 0) goto cleanup;
+    ret = 0;
+
+cleanup:
+    if (scale_frame) av_frame_free(&scale_frame);
+    if (dec_frame) av_frame_free(&dec_frame);
+    if (enc_pkt) av_packet_free(&enc_pkt);
+    if (pkt) av_packet_free(&pkt);
+    if (sws) sws_freeContext(sws);
+    if (dec) avcodec_free_context(&dec);
+    close_input(&ifmt_ctx, &avio_ctx);
+    return ret;
+}
+
+static void *transcode_chunk_worker(void *arg) {
+    TranscodeChunk *c = arg;
+    c->failed = transcode_chunk_run(c) < 0;
+    return NULL;
+}
+
+// Split at keyframes into `segments` chunks (<= 0: one per core), encode
+// them concurrently with independent encoders and stitch the packets on
+// their source timestamps. Each chunk starts with an IDR and has its own
+// rate control; a chunk whose parameter sets differ from the previous one
+// carries them in-band. Audio is copied. Inputs with too few keyframes
+// fall back to reencode_video.
+PYMEDIA_API uint8_t* reencode_video_parallel(uint8_t *video_data, size_t video_size,
+                                             int crf, const char *preset,
+                                             int out_width, int out_height,
+                                             int segments, size_t *out_size) {
+    *out_size = 0;
+    BufferData bd;
+    AVFormatContext *ifmt_ctx = NULL, *ofmt_ctx = NULL;
+    AVIOContext *input_avio_ctx = NULL;
+    AVPacket *pkt = NULL;
+    TranscodeChunk *chunks = NULL;
+    pm_thread_t *threads = NULL;
+    int64_t *keys = NULL;
+    int key_count = 0, chunk_count = 0, started = 0;
+    uint8_t *output_buffer = NULL, *result = NULL, *active_ps = NULL;
+    int active_ps_size = 0;
+
+    if (!preset || preset[0] == '\0') preset = "medium";
+    if (crf < 0) crf = 23;
+    if (crf > 51) crf = 51;
+
+    if (open_input_memory(video_data, video_size, &ifmt_ctx, &input_avio_ctx, &bd) < 0)
+        goto cleanup;
+    int video_idx = find_stream(ifmt_ctx, AVMEDIA_TYPE_VIDEO);
+    if (video_idx < 0) goto cleanup;
+    int audio_idx = find_stream(ifmt_ctx, AVMEDIA_TYPE_AUDIO);
+    AVStream *vst = ifmt_ctx->streams[video_idx];
+    reencode_output_size(vst->codecpar->width, vst->codecpar->height, &out_width, &out_height);
+
+    // Progress passes over the source: keyframe scan, chunk encodes (the
+    // furthest chunk read), audio copy.
+    int64_t duration = ifmt_ctx->duration > 0 ? ifmt_ctx->duration : 0;
+    pm_progress_input(0, (audio_idx >= 0 ? 3 : 2) * duration);
+    if (collect_keyframe_pts(ifmt_ctx, video_idx, &keys, &key_count) < 0) goto cleanup;
+    int workers = pm_worker_count(segments, PARALLEL_MAX_SEGMENTS);
+    if (workers > key_count) workers = key_count;
+    if (workers < 2) {
+        close_input(&ifmt_ctx, &input_avio_ctx);
+        free(keys);
+        pm_progress_input(duration, 2 * duration);
+        result = reencode_video(video_data, video_size, crf, preset, out_width, out_height,
+                                out_size);
+        pm_progress_input(0, 0);
+        return result;
+    }
+
+    // Chunk starts: the first keyframe at or after each even time split.
+    chunks = calloc(workers, sizeof(*chunks));
+    threads = calloc(workers, sizeof(*threads));
+    if (!chunks || !threads) goto cleanup;
+    int64_t first = keys[0], last = keys[key_count - 1];
+    int k = 0;
+    for (int j = 0; j < workers; j++) {
+        int64_t target = first + (int64_t)((double)(last - first) * j / workers);
+        while (k < key_count && keys[k] < target) k++;
+        if (k >= key_count) break;
+        if (chunk_count > 0 && keys[k] <= chunks[chunk_count - 1].start) continue;
+        chunks[chunk_count++].start = keys[k];
+    }
+    int enc_threads = av_cpu_count() / chunk_count;
+    if (enc_threads < 1) enc_threads = 1;
+    for (int j = 0; j < chunk_count; j++) {
+        TranscodeChunk *c = &chunks[j];
+        c->data = video_data;
+        c->size = video_size;
+        c->crf = crf;
+        c->preset = preset;
+        c->width = out_width;
+        c->height = out_height;
+        c->enc_threads = enc_threads;
+        c->end = j + 1 < chunk_count ? chunks[j + 1].start : INT64_MAX;
+    }
+    chunks[0].start = INT64_MIN;    // leading frames before the first keyframe
+
+    pm_progress_input(duration, 0);
+    for (started = 0; started < chunk_count; started++)
+        if (pm_thread_create(&threads[started], transcode_chunk_worker, &chunks[started]) < 0)
+            break;
+    for (int j = 0; j < started; j++) pm_thread_join(threads[j]);
+    if (started < chunk_count) goto cleanup;
+    for (int j = 0; j < chunk_count; j++)
+        if (chunks[j].failed) goto cleanup;
+
+    // Output
+    avformat_alloc_output_context2(&ofmt_ctx, NULL, "mp4", NULL);
+    if (!ofmt_ctx) goto cleanup;
+    if (avio_open_dyn_buf(&ofmt_ctx->pb) < 0) goto cleanup;
+    AVStream *v_out = avformat_new_stream(ofmt_ctx, NULL);
+    if (!v_out) goto cleanup;
+    avcodec_parameters_from_context(v_out->codecpar, chunks[0].enc);
+    v_out->time_base = vst->time_base;
+    AVStream *a_out = NULL;
+    if (audio_idx >= 0) {
+        a_out = avformat_new_stream(ofmt_ctx, NULL);
+        if (!a_out) goto cleanup;
+        avcodec_parameters_copy(a_out->codecpar, ifmt_ctx->streams[audio_idx]->codecpar);
+        a_out->codecpar->codec_tag = 0;
+        a_out->time_base = ifmt_ctx->streams[audio_idx]->time_base;
+    }
+    if (avformat_write_header(ofmt_ctx, NULL) < 0) goto cleanup;
+
+    // Stitch. Encoder output is Annex B, so differing parameter sets are
+    // simply prepended to the chunk's first (IDR) packet.
+    active_ps = chunks[0].enc->extradata;
+    active_ps_size = chunks[0].enc->extradata_size;
+    int64_t last_dts = AV_NOPTS_VALUE;
+    for (int j = 0; j < chunk_count; j++) {
+        TranscodeChunk *c = &chunks[j];
+        int resend = !extradata_equal(active_ps, active_ps_size,
+                                      c->enc->extradata, c->enc->extradata_size);
+        for (int i = 0; i < c->count; i++) {
+            AVPacket *p = c->pkts[i];
+            if (resend && i == 0) {
+                AVPacket *joined = av_packet_alloc();
+                if (!joined || av_new_packet(joined, c->enc->extradata_size + p->size) < 0 ||
+                    av_packet_copy_props(joined, p) < 0) {
+                    av_packet_free(&joined);
+                    goto cleanup;
+                }
+                memcpy(joined->data, c->enc->extradata, c->enc->extradata_size);
+                memcpy(joined->data + c->enc->extradata_size, p->data, p->size);
+                av_packet_free(&c->pkts[i]);
+                c->pkts[i] = p = joined;
+                active_ps = c->enc->extradata;
+                active_ps_size = c->enc->extradata_size;
+            }
+            p->stream_index = v_out->index;
+            concat_fix_dts(p, &last_dts);
+            av_packet_rescale_ts(p, c->enc->time_base, v_out->time_base);
+            pm_write_frame(ofmt_ctx, p);
+        }
+    }
+
+    if (a_out) {
+        pkt = av_packet_alloc();
+        if (!pkt) goto cleanup;
+        pm_progress_input(2 * duration, 0);
+        if (av_seek_frame(ifmt_ctx, audio_idx, 0, AVSEEK_FLAG_BACKWARD) < 0)
+            av_seek_frame(ifmt_ctx, -1, 0, AVSEEK_FLAG_BACKWARD);
+        while (read_next_stream_packet(ifmt_ctx, audio_idx, pkt) > 0) {
+            pkt->stream_index = a_out->index;
+            av_packet_rescale_ts(pkt, ifmt_ctx->streams[audio_idx]->time_base, a_out->time_base);
+            pkt->pos = -1;
+            pm_write_frame(ofmt_ctx, pkt);
+            av_packet_unref(pkt);
+        }
+    }
+
+    av_write_trailer(ofmt_ctx);
+    int output_size = avio_close_dyn_buf(ofmt_ctx->pb, &output_buffer);
+    ofmt_ctx->pb = NULL;
+    if (output_size > 0) {
+        result = malloc(output_size);
+        if (result) {
+            memcpy(result, output_buffer, output_size);
+            *out_size = output_size;
+        }
+    }
+    av_free(output_buffer);
+
+cleanup:
+    pm_progress_input(0, 0);
+    if (pkt) av_packet_free(&pkt);
+    if (chunks)
+        for (int j = 0; j < chunk_count; j++) transcode_chunk_free(&chunks[j]);
+    free(chunks);
+    free(threads);
+    free(keys);
+    if (ofmt_ctx) {
+        if (ofmt_ctx->pb) {
+            uint8_t *dummy;
+            avio_close_dyn_buf(ofmt_ctx->pb, &dummy);
+            av_free(dummy);
+        }
+        avformat_free_context(ofmt_ctx);
+    }
+    close_input(&ifmt_ctx, &input_avio_ctx);
+    return result;
+}
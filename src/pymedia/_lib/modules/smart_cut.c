@@ -0,0 +1,657 @@
+// ============================================================
+// smart cut — frame-accurate trim that re-encodes only the partial
+// GOPs at each boundary and stream-copies the keyframe-aligned middle
+// ============================================================
+
+#define SMART_CUT_CRF "18"
+#define SMART_CUT_PRESET "medium"
+
+// ---------- H.264 parameter-set splicing ----------
+//
+// The copied middle keeps the source avcC as the track's decoder config.
+// Boundary segments come from a fresh libx264 instance that emits its own
+// SPS/PPS in-band on the first IDR; the source SPS/PPS are re-sent in-band
+// ahead of the first copied keyframe so the decoder switches back. Both
+// sets may use the same IDs, so the track is tagged avc3: players must
+// then apply in-band parameter sets instead of relying on avcC alone.
+
+typedef struct {
+    int nal_len_size;   // AVCC length prefix size, 0 for Annex B streams
+    uint8_t *ps;        // source SPS/PPS in the stream's packet format
+    int ps_size;
+} H264Splice;
+
+static void h264_splice_free(H264Splice *hs) {
+    av_freep(&hs->ps);
+    hs->ps_size = 0;
+}
+
+static void put_nal_length(uint8_t *dst, int len_size, int value) {
+    for (int i = 0; i < len_size; i++)
+        dst[i] = (uint8_t)(value >> (8 * (len_size - 1 - i)));
+}
+
+static int h264_splice_init(H264Splice *hs, const AVCodecParameters *par) {
+    memset(hs, 0, sizeof(*hs));
+    const uint8_t *ex = par->extradata;
+    int size = par->extradata_size;
+    if (size <= 0) return 0;
+    if (ex[0] != 1) {
+        // Annex B extradata is already in packet format.
+        hs->ps = av_malloc(size);
+        if (!hs->ps) return -1;
+        memcpy(hs->ps, ex, size);
+        hs->ps_size = size;
+        return 0;
+    }
+    if (size < 7) return -1;
+    hs->nal_len_size = (ex[4] & 3) + 1;
+    if (hs->nal_len_size == 3) return -1;
+
+    // avcC: SPS count/list, then PPS count/list, each with 16-bit sizes.
+    int total = 0, pos = 5;
+    for (int pass = 0; pass < 2; pass++) {
+        if (pos >= size) return -1;
+        int count = pass == 0 ? ex[pos] & 0x1f : ex[pos];
+        pos++;
+        for (int i = 0; i < count; i++) {
+            if (pos + 2 > size) return -1;
+            int len = ex[pos] << 8 | ex[pos + 1];
+            if (pos + 2 + len > size) return -1;
+            total += hs->nal_len_size + len;
+            pos += 2 + len;
+        }
+    }
+    hs->ps = av_malloc(total > 0 ? total : 1);
+    if (!hs->ps) return -1;
+    pos = 5;
+    for (int pass = 0; pass < 2; pass++) {
+        int count = pass == 0 ? ex[pos] & 0x1f : ex[pos];
+        pos++;
+        for (int i = 0; i < count; i++) {
+            int len = ex[pos] << 8 | ex[pos + 1];
+            put_nal_length(hs->ps + hs->ps_size, hs->nal_len_size, len);
+            memcpy(hs->ps + hs->ps_size + hs->nal_len_size, ex + pos + 2, len);
+            hs->ps_size += hs->nal_len_size + len;
+            pos += 2 + len;
+        }
+    }
+    return 0;
+}
+
+// Find the next Annex B start code at or after `pos`; returns its offset
+// (or `size`) and the start code length in *sc_len.
+static int annexb_next_start(const uint8_t *p, int size, int pos, int *sc_len) {
+    for (int i = pos; i + 3 <= size; i++) {
+        if (p[i] == 0 && p[i + 1] == 0) {
+            if (p[i + 2] == 1) { *sc_len = 3; return i; }
+            if (i + 4 <= size && p[i + 2] == 0 && p[i + 3] == 1) { *sc_len = 4; return i; }
+        }
+    }
+    *sc_len = 0;
+    return size;
+}
+
+// Rewrite `pkt` (optionally prefixed by `prefix`) into `out` using the
+// stream's NAL framing: Annex B encoder output becomes length-prefixed for
+// avcC tracks.
+static int h264_splice_packet(const H264Splice *hs, const AVPacket *pkt, int annexb_src,
+                              const uint8_t *prefix, int prefix_size, AVPacket *out) {
+    int body = pkt->size;
+    if (annexb_src && hs->nal_len_size) {
+        // Each start code (>= 3 bytes) is replaced by a <= 4 byte prefix.
+        body = 0;
+        int sc, pos = annexb_next_start(pkt->data, pkt->size, 0, &sc);
+        while (pos < pkt->size) {
+            int start = pos + sc, next_sc;
+            int next = annexb_next_start(pkt->data, pkt->size, start, &next_sc);
+            body += hs->nal_len_size + (next - start);
+            pos = next;
+            sc = next_sc;
+        }
+    }
+    if (av_new_packet(out, prefix_size + body) < 0) return -1;
+    if (av_packet_copy_props(out, pkt) < 0) return -1;
+    if (prefix_size) memcpy(out->data, prefix, prefix_size);
+    uint8_t *dst = out->data + prefix_size;
+    if (annexb_src && hs->nal_len_size) {
+        int sc, pos = annexb_next_start(pkt->data, pkt->size, 0, &sc);
+        while (pos < pkt->size) {
+            int start = pos + sc, next_sc;
+            int next = annexb_next_start(pkt->data, pkt->size, start, &next_sc);
+            int len = next - start;
+            put_nal_length(dst, hs->nal_len_size, len);
+            memcpy(dst + hs->nal_len_size, pkt->data + start, len);
+            dst += hs->nal_len_size + len;
+            pos = next;
+            sc = next_sc;
+        }
+    } else {
+        memcpy(dst, pkt->data, pkt->size);
+    }
+    return 0;
+}
+
+// ---------- boundary encoder ----------
+
+typedef struct {
+    AVCodecContext *enc;
+    struct SwsContext *sws;
+    AVFrame *frame;
+    AVPacket *pkt;
+} SegmentEncoder;
+
+static void segment_encoder_close(SegmentEncoder *se) {
+    if (se->pkt) av_packet_free(&se->pkt);
+    if (se->frame) av_frame_free(&se->frame);
+    if (se->sws) sws_freeContext(se->sws);
+    if (se->enc) avcodec_free_context(&se->enc);
+    memset(se, 0, sizeof(*se));
+}
+
+// libx264 at `width` x `height` in the source time base. Spliced segments
+// get in-band parameter sets and no B-frames, so their DTS can sit just
+// below the copied packets that follow.
+static int segment_encoder_open(SegmentEncoder *se, AVFormatContext *ifmt_ctx, int video_idx,
+                                const AVCodecContext *dec_ctx, int width, int height,
+                                int spliced) {
+    memset(se, 0, sizeof(*se));
+    const AVCodec *vencoder = avcodec_find_encoder_by_name("libx264");
+    if (!vencoder) {
+        fprintf(stderr, "libx264 encoder not found\n");
+        return -1;
+    }
+    AVStream *st = ifmt_ctx->streams[video_idx];
+    se->enc = avcodec_alloc_context3(vencoder);
+    if (!se->enc) goto fail;
+    se->enc->width = width;
+    se->enc->height = height;
+    se->enc->pix_fmt = AV_PIX_FMT_YUV420P;
+    se->enc->sample_aspect_ratio = dec_ctx->sample_aspect_ratio;
+    se->enc->time_base = st->time_base;
+    AVRational fps = av_guess_frame_rate(ifmt_ctx, st, NULL);
+    if (fps.num > 0 && fps.den > 0) se->enc->framerate = fps;
+    se->enc->color_range = dec_ctx->color_range;
+    se->enc->colorspace = dec_ctx->colorspace;
+    se->enc->color_primaries = dec_ctx->color_primaries;
+    se->enc->color_trc = dec_ctx->color_trc;
+    if (spliced) se->enc->max_b_frames = 0;
+    else se->enc->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+    av_opt_set(se->enc->priv_data, "crf", SMART_CUT_CRF, 0);
+    av_opt_set(se->enc->priv_data, "preset", SMART_CUT_PRESET, 0);
+    if (avcodec_open2(se->enc, vencoder, NULL) < 0) goto fail;
+
+    se->sws = sws_getContext(dec_ctx->width, dec_ctx->height, dec_ctx->pix_fmt,
+                             width, height, AV_PIX_FMT_YUV420P,
+                             SWS_BILINEAR, NULL, NULL, NULL);
+    se->frame = av_frame_alloc();
+    se->pkt = av_packet_alloc();
+    if (!se->sws || !se->frame || !se->pkt) goto fail;
+    se->frame->format = AV_PIX_FMT_YUV420P;
+    se->frame->width = width;
+    se->frame->height = height;
+    if (av_frame_get_buffer(se->frame, 0) < 0) goto fail;
+    return 0;
+
+fail:
+    segment_encoder_close(se);
+    return -1;
+}
+
+// ---------- cut plan ----------
+
+typedef struct {
+    int64_t pts, dts;
+} KeyPoint;
+
+typedef struct {
+    AVFormatContext *ifmt_ctx, *ofmt_ctx;
+    AVIOContext *input_avio_ctx;
+    BufferData bd;
+    int video_idx, audio_idx;
+    int out_video, out_audio;
+    AVRational vtb, atb;
+    KeyPoint *keys;
+    int key_count;
+    int64_t stream_end;
+    int open_gop;
+    int spliced;                    // boundary encodes + copy + splice
+    int64_t reorder;                // source pts - dts on keyframes
+    H264Splice splice;
+    AVCodecContext *dec;
+    SegmentEncoder seg;
+    int seg_open;
+    AVPacket *pkt;
+    AVFrame *frame;
+    // Current range, video time base.
+    int64_t start_ts, end_ts;
+    int64_t head_end;               // first copied keyframe (or end_ts)
+    int64_t tail_start;             // keyframe where the tail encode starts
+    int has_tail;
+    // Encoder SPS/PPS were written in-band since the source ones were last
+    // sent; spans ranges, so an encoded tail is followed by a resend even
+    // when the next range starts on a keyframe.
+    int foreign_ps;
+    // Output position where the current range starts.
+    int64_t out_offset, a_offset;
+    int64_t scan_us;                // progress: the scan pass, then the ranges
+} SmartCut;
+
+static int smart_cut_write_encoded(SmartCut *sc, AVPacket *pkt) {
+    AVStream *out = sc->ofmt_ctx->streams[sc->out_video];
+    pkt->stream_index = sc->out_video;
+    if (sc->spliced) {
+        sc->foreign_ps = 1;
+        if (pkt->pts != AV_NOPTS_VALUE) pkt->dts = pkt->pts - sc->reorder;
+        AVPacket *conv = av_packet_alloc();
+        if (!conv) return -1;
+        if (h264_splice_packet(&sc->splice, pkt, 1, NULL, 0, conv) < 0) {
+            av_packet_free(&conv);
+            return -1;
+        }
+        conv->stream_index = sc->out_video;
+        av_packet_rescale_ts(conv, sc->vtb, out->time_base);
+        int ret = pm_write_frame(sc->ofmt_ctx, conv);
+        av_packet_free(&conv);
+        return ret < 0 ? -1 : 0;
+    }
+    av_packet_rescale_ts(pkt, sc->vtb, out->time_base);
+    return pm_write_frame(sc->ofmt_ctx, pkt) < 0 ? -1 : 0;
+}
+
+static int smart_cut_drain_encoder(SmartCut *sc) {
+    SegmentEncoder *se = &sc->seg;
+    while (pm_receive_packet(se->enc, se->pkt) == 0) {
+        int ret = smart_cut_write_encoded(sc, se->pkt);
+        av_packet_unref(se->pkt);
+        if (ret < 0) return -1;
+    }
+    return 0;
+}
+
+static int smart_cut_open_segment(SmartCut *sc) {
+    if (sc->seg_open) return 0;
+    if (segment_encoder_open(&sc->seg, sc->ifmt_ctx, sc->video_idx, sc->dec, sc->dec->width,
+                             sc->dec->height, sc->spliced) < 0)
+        return -1;
+    sc->seg_open = 1;
+    return 0;
+}
+
+static int smart_cut_close_segment(SmartCut *sc) {
+    int ret = 0;
+    if (sc->seg_open) {
+        pm_send_frame(sc->seg.enc, NULL);
+        ret = smart_cut_drain_encoder(sc);
+        segment_encoder_close(&sc->seg);
+        sc->seg_open = 0;
+    }
+    return ret;
+}
+
+// Encode decoded frames inside [lo, hi), placed at the range's output offset.
+static int smart_cut_encode_frames(SmartCut *sc, int64_t lo, int64_t hi) {
+    AVFrame *frame = sc->frame;
+    while (pm_receive_frame(sc->dec, frame) == 0) {
+        int64_t ts = frame->best_effort_timestamp;
+        if (ts == AV_NOPTS_VALUE) ts = frame->pts;
+        if (ts != AV_NOPTS_VALUE && ts >= lo && ts < hi) {
+            SegmentEncoder *se = &sc->seg;
+            if (av_frame_make_writable(se->frame) < 0) return -1;
+            pm_sws_scale(se->sws, (const uint8_t *const *)frame->data, frame->linesize, 0,
+                      frame->height, se->frame->data, se->frame->linesize);
+            se->frame->pts = ts - sc->start_ts + sc->out_offset;
+            if (pm_send_frame(se->enc, se->frame) < 0) return -1;
+            if (smart_cut_drain_encoder(sc) < 0) return -1;
+        }
+        av_frame_unref(frame);
+    }
+    return 0;
+}
+
+// Flush the decoder into the open segment. Spliced segments end here with
+// their own encoder; a whole-range encoder stays open across ranges so the
+// track keeps one set of parameter sets.
+static int smart_cut_finish_segment(SmartCut *sc, int64_t lo, int64_t hi) {
+    pm_send_packet(sc->dec, NULL);
+    int ret = smart_cut_encode_frames(sc, lo, hi);
+    avcodec_flush_buffers(sc->dec);
+    if (sc->spliced && smart_cut_close_segment(sc) < 0) ret = -1;
+    return ret;
+}
+
+static int smart_cut_copy_packet(SmartCut *sc, AVPacket *pkt) {
+    AVStream *out = sc->ofmt_ctx->streams[sc->out_video];
+    int64_t shift = sc->out_offset - sc->start_ts;
+    if (pkt->pts != AV_NOPTS_VALUE) pkt->pts += shift;
+    if (pkt->dts != AV_NOPTS_VALUE) pkt->dts += shift;
+    pkt->stream_index = sc->out_video;
+    pkt->pos = -1;
+    if (sc->foreign_ps && sc->splice.ps_size > 0) {
+        AVPacket *conv = av_packet_alloc();
+        if (!conv) return -1;
+        if (h264_splice_packet(&sc->splice, pkt, 0, sc->splice.ps, sc->splice.ps_size,
+                               conv) < 0) {
+            av_packet_free(&conv);
+            return -1;
+        }
+        sc->foreign_ps = 0;
+        av_packet_rescale_ts(conv, sc->vtb, out->time_base);
+        int ret = pm_write_frame(sc->ofmt_ctx, conv);
+        av_packet_free(&conv);
+        return ret < 0 ? -1 : 0;
+    }
+    av_packet_rescale_ts(pkt, sc->vtb, out->time_base);
+    return pm_write_frame(sc->ofmt_ctx, pkt) < 0 ? -1 : 0;
+}
+
+static int key_cmp(const void *a, const void *b) {
+    int64_t x = ((const KeyPoint *)a)->pts, y = ((const KeyPoint *)b)->pts;
+    return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+// Pass 1: demux only, collect video keyframes and detect open GOPs
+// (frames after a keyframe in decode order that display before it).
+static int smart_cut_scan(SmartCut *sc) {
+    AVPacket *pkt = sc->pkt;
+    int cap = 0;
+    int64_t last_key = AV_NOPTS_VALUE;
+
+    while (read_next_stream_packet(sc->ifmt_ctx, sc->video_idx, pkt) > 0) {
+        int64_t pts = pkt->pts != AV_NOPTS_VALUE ? pkt->pts : pkt->dts;
+        if (pts != AV_NOPTS_VALUE) {
+            int64_t end = pts + (pkt->duration > 0 ? pkt->duration : 1);
+            if (end > sc->stream_end) sc->stream_end = end;
+            if (pkt->flags & AV_PKT_FLAG_KEY) {
+                if (sc->key_count == cap) {
+                    cap = cap ? cap * 2 : 64;
+                    KeyPoint *grown = realloc(sc->keys, sizeof(*sc->keys) * cap);
+                    if (!grown) {
+                        av_packet_unref(pkt);
+                        return -1;
+                    }
+                    sc->keys = grown;
+                }
+                KeyPoint *k = &sc->keys[sc->key_count++];
+                k->pts = pts;
+                k->dts = pkt->dts != AV_NOPTS_VALUE ? pkt->dts : pts;
+                if (k->pts - k->dts > sc->reorder) sc->reorder = k->pts - k->dts;
+                last_key = pts;
+            } else if (last_key != AV_NOPTS_VALUE && pts < last_key) {
+                sc->open_gop = 1;
+            }
+        }
+        av_packet_unref(pkt);
+    }
+    if (sc->key_count > 1) qsort(sc->keys, sc->key_count, sizeof(*sc->keys), key_cmp);
+    return sc->key_count > 0 ? 0 : -1;
+}
+
+static void smart_cut_close(SmartCut *sc) {
+    if (sc->frame) av_frame_free(&sc->frame);
+    if (sc->pkt) av_packet_free(&sc->pkt);
+    segment_encoder_close(&sc->seg);
+    if (sc->dec) avcodec_free_context(&sc->dec);
+    h264_splice_free(&sc->splice);
+    if (sc->ofmt_ctx) {
+        if (sc->ofmt_ctx->pb) {
+            uint8_t *dummy;
+            avio_close_dyn_buf(sc->ofmt_ctx->pb, &dummy);
+            av_free(dummy);
+        }
+        avformat_free_context(sc->ofmt_ctx);
+    }
+    close_input(&sc->ifmt_ctx, &sc->input_avio_ctx);
+    free(sc->keys);
+}
+
+// Open the source once, scan it, pick the cut mode and start the MP4 muxer.
+// Progress covers the scan plus the source span of each of the `count`
+// (start, end) second pairs in `ranges`.
+static int smart_cut_open(SmartCut *sc, uint8_t *data, size_t size, const double *ranges,
+                          int count) {
+    memset(sc, 0, sizeof(*sc));
+    sc->out_audio = -1;
+    if (open_input_memory(data, size, &sc->ifmt_ctx, &sc->input_avio_ctx, &sc->bd) < 0) return -1;
+    sc->video_idx = find_stream(sc->ifmt_ctx, AVMEDIA_TYPE_VIDEO);
+    sc->audio_idx = find_stream(sc->ifmt_ctx, AVMEDIA_TYPE_AUDIO);
+    if (sc->video_idx < 0) return -1;
+    sc->pkt = av_packet_alloc();
+    sc->frame = av_frame_alloc();
+    if (!sc->pkt || !sc->frame) return -1;
+
+    int64_t duration = sc->ifmt_ctx->duration > 0 ? sc->ifmt_ctx->duration : 0;
+    int64_t total = duration;
+    for (int i = 0; duration > 0 && i < count; i++) {
+        int64_t start = (int64_t)(ranges[2 * i] * AV_TIME_BASE);
+        int64_t end = ranges[2 * i + 1] > 0.0 ? (int64_t)(ranges[2 * i + 1] * AV_TIME_BASE)
+                                              : duration;
+        if (end > duration) end = duration;
+        if (end > start) total += end - start;
+    }
+    sc->scan_us = duration;
+    pm_progress_input(0, total);
+
+    if (smart_cut_scan(sc) < 0) return -1;
+    AVStream *vst = sc->ifmt_ctx->streams[sc->video_idx];
+    AVCodecParameters *vpar = vst->codecpar;
+    sc->vtb = vst->time_base;
+    sc->atb = sc->audio_idx >= 0 ? sc->ifmt_ctx->streams[sc->audio_idx]->time_base
+                                 : (AVRational){1, 1};
+
+    const AVCodec *vdecoder = avcodec_find_decoder(vpar->codec_id);
+    if (!vdecoder) return -1;
+    sc->dec = avcodec_alloc_context3(vdecoder);
+    if (!sc->dec) return -1;
+    avcodec_parameters_to_context(sc->dec, vpar);
+    if (avcodec_open2(sc->dec, vdecoder, NULL) < 0) return -1;
+
+    sc->spliced = vpar->codec_id == AV_CODEC_ID_H264 && !sc->open_gop &&
+                  (vpar->format == AV_PIX_FMT_YUV420P || vpar->format == AV_PIX_FMT_YUVJ420P) &&
+                  h264_splice_init(&sc->splice, vpar) == 0;
+
+    avformat_alloc_output_context2(&sc->ofmt_ctx, NULL, "mp4", NULL);
+    if (!sc->ofmt_ctx) return -1;
+    if (avio_open_dyn_buf(&sc->ofmt_ctx->pb) < 0) return -1;
+    AVStream *v_out = avformat_new_stream(sc->ofmt_ctx, NULL);
+    if (!v_out) return -1;
+    sc->out_video = v_out->index;
+    if (sc->spliced) {
+        avcodec_parameters_copy(v_out->codecpar, vpar);
+        // avc3: the in-band SPS/PPS switches at each splice are authoritative.
+        v_out->codecpar->codec_tag = MKTAG('a', 'v', 'c', '3');
+    } else {
+        // Whole-range encode: the encoder's global header is the config.
+        if (smart_cut_open_segment(sc) < 0) return -1;
+        avcodec_parameters_from_context(v_out->codecpar, sc->seg.enc);
+    }
+    v_out->time_base = sc->vtb;
+    if (sc->audio_idx >= 0) {
+        AVStream *a_out = avformat_new_stream(sc->ofmt_ctx, NULL);
+        if (!a_out) return -1;
+        avcodec_parameters_copy(a_out->codecpar, sc->ifmt_ctx->streams[sc->audio_idx]->codecpar);
+        a_out->codecpar->codec_tag = 0;
+        a_out->time_base = sc->atb;
+        sc->out_audio = a_out->index;
+    }
+    if (avformat_write_header(sc->ofmt_ctx, NULL) < 0) return -1;
+    return 0;
+}
+
+// Append source range [start_ts, end_ts) (video time base) at the current
+// output position: K0 <= start < K1 ... K2 <= end, copying [K1, K2).
+static int smart_cut_range(SmartCut *sc, int64_t start_ts, int64_t end_ts) {
+    if (end_ts > sc->stream_end) end_ts = sc->stream_end;
+    if (start_ts < 0 || start_ts >= end_ts) return -1;
+    sc->start_ts = start_ts;
+    sc->end_ts = end_ts;
+
+    int k0 = 0, k1 = -1, k2 = -1;
+    for (int i = 0; i < sc->key_count; i++) {
+        if (sc->keys[i].pts <= start_ts) k0 = i;
+        if (k1 < 0 && sc->keys[i].pts >= start_ts) k1 = i;
+        if (sc->keys[i].pts <= end_ts) k2 = i;
+    }
+    sc->head_end = end_ts;
+    sc->has_tail = 0;
+    sc->tail_start = end_ts;
+    if (sc->spliced && k1 >= 0 && sc->keys[k1].pts < end_ts) {
+        sc->head_end = sc->keys[k1].pts;
+        sc->has_tail = end_ts < sc->stream_end && sc->keys[k2].pts < end_ts;
+        if (sc->has_tail) sc->tail_start = sc->keys[k2].pts;
+    }
+    int copy_to_eof = sc->head_end < end_ts && end_ts >= sc->stream_end;
+
+    // Reads count from where this range starts in the progress total.
+    pm_progress_input(sc->scan_us + av_rescale_q(sc->out_offset - start_ts, sc->vtb,
+                                                 AV_TIME_BASE_Q), 0);
+    if (av_seek_frame(sc->ifmt_ctx, sc->video_idx, sc->keys[k0].pts, AVSEEK_FLAG_BACKWARD) < 0)
+        return -1;
+    avcodec_flush_buffers(sc->dec);
+
+    enum { PH_HEAD, PH_COPY, PH_TAIL, PH_DONE } phase = PH_HEAD;
+    if (sc->head_end == start_ts) phase = PH_COPY;
+    else if (smart_cut_open_segment(sc) < 0) return -1;
+    int audio_done = sc->audio_idx < 0, failed = 0, copying_started = 0, keys_past = 0;
+    int64_t a_start = av_rescale_q(start_ts, sc->vtb, sc->atb);
+    int64_t a_end = av_rescale_q(end_ts, sc->vtb, sc->atb);
+    AVPacket *pkt = sc->pkt;
+
+    while (!failed && !(phase == PH_DONE && audio_done) &&
+           pm_read_frame(sc->ifmt_ctx, pkt) >= 0) {
+        if (pkt->stream_index == sc->audio_idx) {
+            int64_t ts = pkt->pts != AV_NOPTS_VALUE ? pkt->pts : pkt->dts;
+            if (ts != AV_NOPTS_VALUE && ts >= a_end) audio_done = 1;
+            if (ts != AV_NOPTS_VALUE && ts >= a_start && ts < a_end) {
+                AVStream *a_out = sc->ofmt_ctx->streams[sc->out_audio];
+                int64_t shift = sc->a_offset - a_start;
+                if (pkt->pts != AV_NOPTS_VALUE) pkt->pts += shift;
+                if (pkt->dts != AV_NOPTS_VALUE) pkt->dts += shift;
+                pkt->stream_index = sc->out_audio;
+                pkt->pos = -1;
+                av_packet_rescale_ts(pkt, sc->atb, a_out->time_base);
+                if (pm_write_frame(sc->ofmt_ctx, pkt) < 0) failed = 1;
+            }
+            av_packet_unref(pkt);
+            continue;
+        }
+        if (pkt->stream_index != sc->video_idx || phase == PH_DONE) {
+            av_packet_unref(pkt);
+            continue;
+        }
+
+        int64_t pts = pkt->pts != AV_NOPTS_VALUE ? pkt->pts : pkt->dts;
+        int is_key = (pkt->flags & AV_PKT_FLAG_KEY) != 0;
+
+        if (phase == PH_HEAD) {
+            // With open GOPs the frames before head_end can trail one more
+            // keyframe in decode order.
+            if (is_key && pts >= sc->head_end) keys_past++;
+            if (keys_past > (sc->open_gop ? 1 : 0)) {
+                if (smart_cut_finish_segment(sc, start_ts, sc->head_end) < 0) failed = 1;
+                phase = sc->head_end < end_ts ? PH_COPY : PH_DONE;
+            } else {
+                if (pm_send_packet(sc->dec, pkt) >= 0 &&
+                    smart_cut_encode_frames(sc, start_ts, sc->head_end) < 0)
+                    failed = 1;
+                av_packet_unref(pkt);
+                continue;
+            }
+        }
+        if (phase == PH_COPY) {
+            if (!copying_started && !(is_key && pts == sc->head_end)) {
+                av_packet_unref(pkt);    // before K1 in decode order
+                continue;
+            }
+            copying_started = 1;
+            if (!copy_to_eof && is_key && pts >= sc->tail_start) {
+                phase = sc->has_tail ? PH_TAIL : PH_DONE;
+                if (phase == PH_TAIL && smart_cut_open_segment(sc) < 0) failed = 1;
+            } else {
+                if (smart_cut_copy_packet(sc, pkt) < 0) failed = 1;
+                av_packet_unref(pkt);
+                continue;
+            }
+        }
+        if (phase == PH_TAIL && !failed) {
+            if (is_key && pts >= end_ts) {
+                if (smart_cut_finish_segment(sc, sc->tail_start, end_ts) < 0) failed = 1;
+                phase = PH_DONE;
+            } else if (pm_send_packet(sc->dec, pkt) >= 0 &&
+                       smart_cut_encode_frames(sc, sc->tail_start, end_ts) < 0) {
+                failed = 1;
+            }
+        }
+        av_packet_unref(pkt);
+    }
+
+    // End of input inside an encoded segment.
+    if (!failed && phase == PH_HEAD &&
+        smart_cut_finish_segment(sc, start_ts, sc->head_end) < 0)
+        failed = 1;
+    if (!failed && phase == PH_TAIL &&
+        smart_cut_finish_segment(sc, sc->tail_start, end_ts) < 0)
+        failed = 1;
+    if (failed) return -1;
+
+    sc->out_offset += end_ts - start_ts;
+    sc->a_offset += a_end - a_start;
+    return 0;
+}
+
+static uint8_t* smart_cut_finish(SmartCut *sc, size_t *out_size) {
+    uint8_t *output_buffer = NULL, *result = NULL;
+    if (smart_cut_close_segment(sc) < 0) return NULL;
+    if (av_write_trailer(sc->ofmt_ctx) < 0) return NULL;
+    int output_size = avio_close_dyn_buf(sc->ofmt_ctx->pb, &output_buffer);
+    sc->ofmt_ctx->pb = NULL;
+    if (output_size > 0) {
+        result = malloc(output_size);
+        if (result) {
+            memcpy(result, output_buffer, output_size);
+            *out_size = output_size;
+        }
+    }
+    av_free(output_buffer);
+    return result;
+}
+
+// Render an edit decision list: `ranges` holds `count` (start, end) pairs in
+// seconds (end <= 0: to the end), appended in order into one MP4 with
+// continuous timestamps. The source is opened and scanned once; each range
+// is frame-accurate. H.264 yuv420p sources with closed GOPs re-encode only
+// from each start to the next keyframe and from the last keyframe before
+// each end, stream-copying everything between; anything else re-encodes
+// the ranges. Audio is packet-copied.
+PYMEDIA_API uint8_t* render_edl(uint8_t *video_data, size_t video_size, const double *ranges,
+                                int count, size_t *out_size) {
+    SmartCut sc;
+    uint8_t *result = NULL;
+
+    *out_size = 0;
+    if (count < 1) return NULL;
+    for (int i = 0; i < count; i++) {
+        double start = ranges[2 * i], end = ranges[2 * i + 1];
+        if (start < 0.0 || (end > 0.0 && end <= start)) return NULL;
+    }
+    if (smart_cut_open(&sc, video_data, video_size, ranges, count) < 0) goto cleanup;
+    for (int i = 0; i < count; i++) {
+        double start = ranges[2 * i], end = ranges[2 * i + 1];
+        int64_t start_ts = (int64_t)llround(start / av_q2d(sc.vtb));
+        int64_t end_ts = end > 0.0 ? (int64_t)llround(end / av_q2d(sc.vtb)) : sc.stream_end;
+        if (smart_cut_range(&sc, start_ts, end_ts) < 0) goto cleanup;
+    }
+    result = smart_cut_finish(&sc, out_size);
+
+cleanup:
+    smart_cut_close(&sc);
+    pm_progress_input(0, 0);
+    return result;
+}
+
+// Trim [start, end) seconds (end <= 0: to the end); a one-range EDL.
+PYMEDIA_API uint8_t* smart_trim_video(uint8_t *video_data, size_t video_size,
+                                      double start, double end, size_t *out_size) {
+    const double range[2] = {start, end};
+    return render_edl(video_data, video_size, range, 1, out_size);
+}
@@ -0,0 +1,525 @@
+// ============================================================
+// spectrogram — STFT power / mel-band features with a bundled
+// radix-2 FFT, decoded once and transformed on worker threads
+// ============================================================
+
+#define SPEC_MAX_WORKERS 32
+#define SPEC_BLOCK_FRAMES 256
+#define SPEC_MIN_FFT 16
+#define SPEC_MAX_FFT 16384
+#define SPEC_DB_FLOOR -100.0f
+#define SPEC_IMAGE_RANGE_DB 80.0f
+
+// ---------- FFT ----------
+//
+// Real input of size n is packed into an n/2 point complex transform
+// (even samples real, odd samples imaginary) and split afterwards, which
+// halves the work of a straight complex FFT.
+
+typedef struct {
+    int n;              // real transform size (power of two)
+    int m;              // n / 2 complex points
+    int *bitrev;        // m entries
+    float *tw_re, *tw_im;       // m / 2 twiddles for the complex pass
+    float *split_re, *split_im; // m twiddles for the real split
+} SpecFft;
+
+static void spec_fft_free(SpecFft *f) {
+    free(f->bitrev);
+    free(f->tw_re);
+    free(f->tw_im);
+    free(f->split_re);
+    free(f->split_im);
+    memset(f, 0, sizeof(*f));
+}
+
+static int spec_fft_init(SpecFft *f, int n) {
+    memset(f, 0, sizeof(*f));
+    f->n = n;
+    f->m = n / 2;
+    int m = f->m, bits = 0;
+    while ((1 << bits) < m) bits++;
+    f->bitrev = malloc(sizeof(int) * m);
+    f->tw_re = malloc(sizeof(float) * (m / 2));
+    f->tw_im = malloc(sizeof(float) * (m / 2));
+    f->split_re = malloc(sizeof(float) * m);
+    f->split_im = malloc(sizeof(float) * m);
+    if (!f->bitrev || !f->tw_re || !f->tw_im || !f->split_re || !f->split_im) {
+        spec_fft_free(f);
+        return -1;
+    }
+    for (int i = 0; i < m; i++) {
+        int r = 0;
+        for (int b = 0; b < bits; b++)
+            if (i & (1 << b)) r |= 1 << (bits - 1 - b);
+        f->bitrev[i] = r;
+    }
+    for (int j = 0; j < m / 2; j++) {
+        double a = -2.0 * M_PI * j / m;
+        f->tw_re[j] = (float)cos(a);
+        f->tw_im[j] = (float)sin(a);
+    }
+    for (int k = 0; k < m; k++) {
+        double a = -2.0 * M_PI * k / n;
+        f->split_re[k] = (float)cos(a);
+        f->split_im[k] = (float)sin(a);
+    }
+    return 0;
+}
+
+// In-place iterative radix-2 complex FFT of f->m points.
+static void spec_fft_complex(const SpecFft *f, float *re, float *im) {
+    int m = f->m;
+    for (int i = 0; i < m; i++) {
+        int j = f->bitrev[i];
+        if (j > i) {
+            float t = re[i]; re[i] = re[j]; re[j] = t;
+            t = im[i]; im[i] = im[j]; im[j] = t;
+        }
+    }
+    for (int len = 2; len <= m; len <<= 1) {
+        int half = len >> 1, step = m / len;
+        for (int i = 0; i < m; i += len) {
+            for (int j = 0; j < half; j++) {
+                float wr = f->tw_re[j * step], wi = f->tw_im[j * step];
+                int a = i + j, b = a + half;
+                float xr = re[b] * wr - im[b] * wi;
+                float xi = re[b] * wi + im[b] * wr;
+                re[b] = re[a] - xr;
+                im[b] = im[a] - xi;
+                re[a] += xr;
+                im[a] += xi;
+            }
+        }
+    }
+}
+
+// Power spectrum |X[k]|^2, k = 0..n/2, of the real signal x[0..n).
+// `re` / `im` are n/2 scratch floats each.
+static void spec_fft_power(const SpecFft *f, const float *x, float *re, float *im,
+                           float *power) {
+    int m = f->m;
+    for (int i = 0; i < m; i++) {
+        re[i] = x[2 * i];
+        im[i] = x[2 * i + 1];
+    }
+    spec_fft_complex(f, re, im);
+    for (int k = 0; k <= m; k++) {
+        int a = k % m, b = (m - k) % m;
+        // Even / odd half-spectra from Z[k] and conj(Z[m-k]).
+        float er = 0.5f * (re[a] + re[b]), ei = 0.5f * (im[a] - im[b]);
+        float or_ = 0.5f * (im[a] + im[b]), oi = -0.5f * (re[a] - re[b]);
+        float wr = k < m ? f->split_re[k] : -1.0f;
+        float wi = k < m ? f->split_im[k] : 0.0f;
+        float xr = er + or_ * wr - oi * wi;
+        float xi = ei + or_ * wi + oi * wr;
+        power[k] = xr * xr + xi * xi;
+    }
+}
+
+// ---------- mel filterbank ----------
+//
+// HTK mel scale with unit-peak triangular filters over the power spectrum.
+
+typedef struct {
+    int first;          // first FFT bin
+    int count;          // bins covered
+    float *weights;
+} MelBand;
+
+static double hz_to_mel(double hz) { return 2595.0 * log10(1.0 + hz / 700.0); }
+static double mel_to_hz(double mel) { return 700.0 * (pow(10.0, mel / 2595.0) - 1.0); }
+
+static void mel_bands_free(MelBand *bands, int n_mels) {
+    if (!bands) return;
+    for (int i = 0; i < n_mels; i++) free(bands[i].weights);
+    free(bands);
+}
+
+static MelBand *mel_bands_init(int n_mels, int n_fft, int sample_rate,
+                               double fmin, double fmax) {
+    int bins = n_fft / 2 + 1;
+    MelBand *bands = calloc(n_mels, sizeof(*bands));
+    double *hz = malloc(sizeof(double) * (n_mels + 2));
+    if (!bands || !hz) goto fail;
+    double lo = hz_to_mel(fmin), hi = hz_to_mel(fmax);
+    for (int i = 0; i < n_mels + 2; i++)
+        hz[i] = mel_to_hz(lo + (hi - lo) * i / (n_mels + 1));
+
+    double bin_hz = (double)sample_rate / n_fft;
+    for (int m = 0; m < n_mels; m++) {
+        double left = hz[m], center = hz[m + 1], right = hz[m + 2];
+        int first = (int)ceil(left / bin_hz);
+        int last = (int)floor(right / bin_hz);
+        if (first < 0) first = 0;
+        if (last > bins - 1) last = bins - 1;
+        int count = last >= first ? last - first + 1 : 0;
+        bands[m].first = first;
+        bands[m].count = count;
+        bands[m].weights = calloc(count > 0 ? count : 1, sizeof(float));
+        if (!bands[m].weights) goto fail;
+        for (int k = 0; k < count; k++) {
+            double f = (first + k) * bin_hz, w = 0.0;
+            if (f <= center && center > left) w = (f - left) / (center - left);
+            else if (f > center && right > center) w = (right - f) / (right - center);
+            bands[m].weights[k] = (float)(w > 0.0 ? w : 0.0);
+        }
+    }
+    free(hz);
+    return bands;
+
+fail:
+    free(hz);
+    mel_bands_free(bands, n_mels);
+    return NULL;
+}
+
+// ---------- block pipeline ----------
+//
+// The calling thread decodes and cuts the mono signal into blocks of
+// SPEC_BLOCK_FRAMES overlapping frames; workers window, transform and
+// reduce each block into its own output rows. At most `max_in_flight`
+// sample blocks exist at once, so memory stays bounded by the output.
+
+typedef struct {
+    int frames;
+    float *samples;     // (frames - 1) * hop + n_fft, freed once processed
+    float *out;         // frames * bins
+} SpecBlock;
+
+typedef struct {
+    int n_fft, hop, bins, log_scale;
+    int n_mels;
+    MelBand *mel;
+    float *window;
+    SpecFft fft;
+
+    pm_mutex_t lock;
+    pm_cond_t cond;
+    SpecBlock **blocks;
+    int block_count, block_cap;
+    int next_job;
+    int in_flight, max_in_flight;
+    int input_done;
+    int error;
+    pm_thread_t workers[SPEC_MAX_WORKERS];
+    int num_workers;
+} Spectrogram;
+
+static void spec_process_block(Spectrogram *s, SpecBlock *b, float *frame,
+                               float *re, float *im, float *power) {
+    int n = s->n_fft, nbins = n / 2 + 1;
+    for (int f = 0; f < b->frames; f++) {
+        const float *src = b->samples + (size_t)f * s->hop;
+        for (int i = 0; i < n; i++) frame[i] = src[i] * s->window[i];
+        spec_fft_power(&s->fft, frame, re, im, power);
+
+        float *row = b->out + (size_t)f * s->bins;
+        if (s->mel) {
+            for (int m = 0; m < s->n_mels; m++) {
+                const MelBand *band = &s->mel[m];
+                float acc = 0.0f;
+                for (int k = 0; k < band->count; k++)
+                    acc += band->weights[k] * power[band->first + k];
+                row[m] = acc;
+            }
+        } else {
+            memcpy(row, power, sizeof(float) * nbins);
+        }
+        if (s->log_scale) {
+            for (int k = 0; k < s->bins; k++) {
+                float db = row[k] > 1e-10f ? 10.0f * log10f(row[k]) : SPEC_DB_FLOOR;
+                row[k] = db < SPEC_DB_FLOOR ? SPEC_DB_FLOOR : db;
+            }
+        }
+    }
+}
+
+static void *spec_worker(void *arg) {
+    Spectrogram *s = arg;
+    int m = s->n_fft / 2;
+    float *frame = malloc(sizeof(float) * s->n_fft);
+    float *re = malloc(sizeof(float) * m);
+    float *im = malloc(sizeof(float) * m);
+    float *power = malloc(sizeof(float) * (m + 1));
+    int ok = frame && re && im && power;
+
+    for (;;) {
+        pm_mutex_lock(&s->lock);
+        if (!ok) {
+            s->error = 1;
+            pm_cond_broadcast(&s->cond);
+        }
+        while (ok && !s->error && s->next_job == s->block_count && !s->input_done)
+            pm_cond_wait(&s->cond, &s->lock);
+        if (!ok || s->error || s->next_job == s->block_count) {
+            pm_mutex_unlock(&s->lock);
+            break;
+        }
+        SpecBlock *b = s->blocks[s->next_job++];
+        pm_mutex_unlock(&s->lock);
+
+        spec_process_block(s, b, frame, re, im, power);
+
+        pm_mutex_lock(&s->lock);
+        free(b->samples);
+        b->samples = NULL;
+        s->in_flight--;
+        pm_cond_broadcast(&s->cond);
+        pm_mutex_unlock(&s->lock);
+    }
+
+    free(frame);
+    free(re);
+    free(im);
+    free(power);
+    return NULL;
+}
+
+// Queue `frames` frames starting at samples[0]; takes ownership of `samples`.
+static int spec_submit(Spectrogram *s, float *samples, int frames) {
+    SpecBlock *b = calloc(1, sizeof(*b));
+    if (b) b->out = malloc(sizeof(float) * (size_t)frames * s->bins);
+    if (!b || !b->out) {
+        if (b) free(b->out);
+        free(b);
+        free(samples);
+        return -1;
+    }
+    b->frames = frames;
+    b->samples = samples;
+
+    pm_mutex_lock(&s->lock);
+    while (!s->error && s->in_flight >= s->max_in_flight)
+        pm_cond_wait(&s->cond, &s->lock);
+    if (s->block_count == s->block_cap) {
+        int cap = s->block_cap ? s->block_cap * 2 : 64;
+        SpecBlock **grown = realloc(s->blocks, sizeof(*grown) * cap);
+        if (!grown) {
+            s->error = 1;
+            pm_cond_broadcast(&s->cond);
+            pm_mutex_unlock(&s->lock);
+            free(b->samples);
+            free(b->out);
+            free(b);
+            return -1;
+        }
+        s->blocks = grown;
+        s->block_cap = cap;
+    }
+    s->blocks[s->block_count++] = b;
+    s->in_flight++;
+    int err = s->error;
+    pm_cond_broadcast(&s->cond);
+    pm_mutex_unlock(&s->lock);
+    return err ? -1 : 0;
+}
+
+static void spec_finish_workers(Spectrogram *s) {
+    pm_mutex_lock(&s->lock);
+    s->input_done = 1;
+    pm_cond_broadcast(&s->cond);
+    pm_mutex_unlock(&s->lock);
+    for (int i = 0; i < s->num_workers; i++) pm_thread_join(s->workers[i]);
+    s->num_workers = 0;
+}
+
+static void spec_free(Spectrogram *s) {
+    for (int i = 0; i < s->block_count; i++) {
+        free(s->blocks[i]->samples);
+        free(s->blocks[i]->out);
+        free(s->blocks[i]);
+    }
+    free(s->blocks);
+    mel_bands_free(s->mel, s->n_mels);
+    free(s->window);
+    spec_fft_free(&s->fft);
+    pm_cond_destroy(&s->cond);
+    pm_mutex_destroy(&s->lock);
+}
+
+// Frames needed to cover `total` samples; the last frame is zero-padded.
+// With hop > n_fft the samples between frames are skipped and the count
+// stops at the last frame starting inside the audio.
+static int64_t spec_frame_count(int64_t total, int n_fft, int hop) {
+    if (total <= 0) return 0;
+    if (total <= n_fft) return 1;
+    int64_t covering = 1 + (total - n_fft + hop - 1) / hop;
+    int64_t starting = (total + hop - 1) / hop;
+    return covering < starting ? covering : starting;
+}
+
+// Decode the first audio stream, resampled to `sample_rate` (<= 0 keeps the
+// source rate) and downmixed to mono by the resampler, and return STFT
+// features as a contiguous row-major buffer. With `n_mels` > 0 each frame is
+// reduced to mel-band energies, otherwise the n_fft / 2 + 1 bin power
+// spectrum is kept. `log_scale` converts to dB. Without `image` the result
+// is float32 [frames][bins]; with `image` it is an 8-bit grayscale picture
+// [bins][frames] (highest band on the top row) spanning the loudest 80 dB.
+PYMEDIA_API uint8_t* audio_spectrogram(uint8_t *data, size_t size, int sample_rate,
+                                       int n_fft, int hop, int n_mels, double fmin,
+                                       double fmax, int log_scale, int image,
+                                       int num_threads, int *out_frames, int *out_bins,
+                                       size_t *out_size) {
+    AudioReader r;
+    Spectrogram s;
+    float *acc = NULL;
+    uint8_t *result = NULL;
+    int n = -1;
+
+    *out_frames = 0;
+    *out_bins = 0;
+    *out_size = 0;
+    if (n_fft < SPEC_MIN_FFT || n_fft > SPEC_MAX_FFT || (n_fft & (n_fft - 1)) ||
+        hop < 1 || n_mels < 0)
+        return NULL;
+    if (image) log_scale = 1;
+
+    if (audio_reader_open(&r, data, size, sample_rate, 1) < 0) return NULL;
+    if (fmax <= 0.0 || fmax > r.sample_rate / 2.0) fmax = r.sample_rate / 2.0;
+    if (fmin < 0.0 || fmin >= fmax) {
+        audio_reader_close(&r);
+        return NULL;
+    }
+
+    memset(&s, 0, sizeof(s));
+    pm_mutex_init(&s.lock);
+    pm_cond_init(&s.cond);
+    s.n_fft = n_fft;
+    s.hop = hop;
+    s.n_mels = n_mels;
+    s.log_scale = log_scale;
+    s.bins = n_mels > 0 ? n_mels : n_fft / 2 + 1;
+    s.window = malloc(sizeof(float) * n_fft);
+    if (!s.window || spec_fft_init(&s.fft, n_fft) < 0) goto cleanup;
+    for (int i = 0; i < n_fft; i++)
+        s.window[i] = (float)(0.5 - 0.5 * cos(2.0 * M_PI * i / n_fft));
+    if (n_mels > 0) {
+        s.mel = mel_bands_init(n_mels, n_fft, r.sample_rate, fmin, fmax);
+        if (!s.mel) goto cleanup;
+    }
+
+    int workers = pm_worker_count(num_threads, SPEC_MAX_WORKERS);
+    s.max_in_flight = 2 * workers;
+    for (int i = 0; i < workers; i++) {
+        if (pm_thread_create(&s.workers[i], spec_worker, &s) < 0) break;
+        s.num_workers++;
+    }
+    if (s.num_workers == 0) goto cleanup;
+
+    // `acc` holds decoded samples from the next unsubmitted frame onwards;
+    // `skip` counts samples still to drop before that frame starts (only
+    // when hop > n_fft leaves gaps between frames).
+    size_t block_span = (size_t)(SPEC_BLOCK_FRAMES - 1) * hop + n_fft;
+    size_t acc_len = 0, acc_cap = block_span + AUDIO_DSP_CHUNK, skip = 0;
+    int64_t total = 0, submitted = 0;
+    acc = malloc(sizeof(float) * acc_cap);
+    if (!acc) goto workers_done;
+
+    while ((n = audio_reader_read(&r)) > 0) {
+        total += n;
+        size_t drop = skip < (size_t)n ? skip : (size_t)n;
+        size_t kept = (size_t)n - drop;
+        skip -= drop;
+        if (acc_len + kept > acc_cap) {
+            size_t cap = acc_len + kept + block_span;
+            float *grown = realloc(acc, sizeof(float) * cap);
+            if (!grown) {
+                n = -1;
+                break;
+            }
+            acc = grown;
+            acc_cap = cap;
+        }
+        memcpy(acc + acc_len, r.buf[0] + drop, sizeof(float) * kept);
+        acc_len += kept;
+        while (acc_len >= block_span) {
+            float *samples = malloc(sizeof(float) * block_span);
+            if (!samples) {
+                n = -1;
+                break;
+            }
+            memcpy(samples, acc, sizeof(float) * block_span);
+            if (spec_submit(&s, samples, SPEC_BLOCK_FRAMES) < 0) {
+                n = -1;
+                break;
+            }
+            size_t consumed = (size_t)SPEC_BLOCK_FRAMES * hop;
+            if (consumed > acc_len) {
+                skip = consumed - acc_len;
+                consumed = acc_len;
+            }
+            memmove(acc, acc + consumed, sizeof(float) * (acc_len - consumed));
+            acc_len -= consumed;
+            submitted += SPEC_BLOCK_FRAMES;
+        }
+        if (n < 0) break;
+    }
+
+    if (n == 0) {
+        int64_t left = spec_frame_count(total, n_fft, hop) - submitted;
+        if (left > 0) {
+            size_t span = (size_t)(left - 1) * hop + n_fft;
+            float *samples = calloc(span, sizeof(float));
+            if (!samples) {
+                n = -1;
+            } else {
+                memcpy(samples, acc, sizeof(float) * (acc_len < span ? acc_len : span));
+                if (spec_submit(&s, samples, (int)left) < 0) n = -1;
+            }
+        }
+    }
+
+workers_done:
+    spec_finish_workers(&s);
+    if (n != 0 || s.error || s.block_count == 0) goto cleanup;
+
+    int64_t frames = 0;
+    for (int i = 0; i < s.block_count; i++) frames += s.blocks[i]->frames;
+    if (frames > INT32_MAX) goto cleanup;
+    size_t cells = (size_t)frames * s.bins;
+
+    if (!image) {
+        result = malloc(sizeof(float) * cells);
+        if (!result) goto cleanup;
+        size_t off = 0;
+        for (int i = 0; i < s.block_count; i++) {
+            size_t len = (size_t)s.blocks[i]->frames * s.bins;
+            memcpy((float *)result + off, s.blocks[i]->out, sizeof(float) * len);
+            off += len;
+        }
+        *out_size = sizeof(float) * cells;
+    } else {
+        float peak = SPEC_DB_FLOOR;
+        for (int i = 0; i < s.block_count; i++) {
+            size_t len = (size_t)s.blocks[i]->frames * s.bins;
+            for (size_t k = 0; k < len; k++)
+                if (s.blocks[i]->out[k] > peak) peak = s.blocks[i]->out[k];
+        }
+        float lo = peak - SPEC_IMAGE_RANGE_DB;
+        result = malloc(cells);
+        if (!result) goto cleanup;
+        int64_t col = 0;
+        for (int i = 0; i < s.block_count; i++) {
+            const SpecBlock *b = s.blocks[i];
+            for (int f = 0; f < b->frames; f++, col++) {
+                const float *row = b->out + (size_t)f * s.bins;
+                for (int k = 0; k < s.bins; k++) {
+                    float v = (row[k] - lo) * (255.0f / SPEC_IMAGE_RANGE_DB);
+                    v = v < 0.0f ? 0.0f : (v > 255.0f ? 255.0f : v);
+                    result[(size_t)(s.bins - 1 - k) * frames + col] = (uint8_t)(v + 0.5f);
+                }
+            }
+        }
+        *out_size = cells;
+    }
+    *out_frames = (int)frames;
+    *out_bins = s.bins;
+
+cleanup:
+    if (s.num_workers) spec_finish_workers(&s);
+    free(acc);
+    spec_free(&s);
+    audio_reader_close(&r);
+    return result;
+}
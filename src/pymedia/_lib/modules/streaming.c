@@ -44,7 +44,7 @@ PYMEDIA_API uint8_t* create_fragmented_mp4(uint8_t *video_data, size_t video_siz
     pkt = av_packet_alloc();
     if (!pkt) goto cleanup;
 
-    while (av_read_frame(ifmt_ctx, pkt) >= 0) {
+    while (pm_read_frame(ifmt_ctx, pkt) >= 0) {
         int si = pkt->stream_index;
         if (si < 0 || (unsigned)si >= ifmt_ctx->nb_streams || stream_mapping[si] < 0) {
             av_packet_unref(pkt);
@@ -55,7 +55,7 @@ PYMEDIA_API uint8_t* create_fragmented_mp4(uint8_t *video_data, size_t video_siz
         pkt->stream_index = stream_mapping[si];
         av_packet_rescale_ts(pkt, in_s->time_base, out_s->time_base);
         pkt->pos = -1;
-        av_interleaved_write_frame(ofmt_ctx, pkt);
+        pm_write_frame(ofmt_ctx, pkt);
         av_packet_unref(pkt);
     }
 
@@ -112,7 +112,7 @@ PYMEDIA_API char* list_video_packet_timestamps_json(uint8_t *video_data, size_t
     pkt = av_packet_alloc();
     if (!pkt) goto cleanup;
 
-    while (av_read_frame(ifmt_ctx, pkt) >= 0) {
+    while (pm_read_frame(ifmt_ctx, pkt) >= 0) {
         if (pkt->stream_index == video_idx) {
             int64_t ts = (pkt->pts != AV_NOPTS_VALUE) ? pkt->pts : pkt->dts;
             if (ts != AV_NOPTS_VALUE) {
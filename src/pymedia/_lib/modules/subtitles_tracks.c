@@ -56,10 +56,18 @@ PYMEDIA_API char* extract_subtitles_json(uint8_t *video_data, size_t video_size)
     pkt = av_packet_alloc();
     if (!pkt) goto cleanup;
 
+    // One read of the source per subtitle stream.
+    int64_t duration = ifmt_ctx->duration > 0 ? ifmt_ctx->duration : 0;
+    int passes = 0, pass = 0;
+    for (unsigned si = 0; si < ifmt_ctx->nb_streams; si++)
+        if (ifmt_ctx->streams[si]->codecpar->codec_type == AVMEDIA_TYPE_SUBTITLE) passes++;
+    pm_progress_input(0, passes * duration);
+
     int first_obj = 1;
     for (unsigned si = 0; si < ifmt_ctx->nb_streams; si++) {
         AVStream *st = ifmt_ctx->streams[si];
         if (st->codecpar->codec_type != AVMEDIA_TYPE_SUBTITLE) continue;
+        pm_progress_input(pass++ * duration, 0);
 
         const char *lang = av_dict_get(st->metadata, "language", NULL, 0)
             ? av_dict_get(st->metadata, "language", NULL, 0)->value
@@ -72,7 +80,7 @@ PYMEDIA_API char* extract_subtitles_json(uint8_t *video_data, size_t video_size)
         size_t tlen = 0;
 
         av_seek_frame(ifmt_ctx, -1, 0, AVSEEK_FLAG_BACKWARD);
-        while (av_read_frame(ifmt_ctx, pkt) >= 0) {
+        while (pm_read_frame(ifmt_ctx, pkt) >= 0) {
             if (pkt->stream_index == (int)si && pkt->size > 0) {
                 size_t copy_n = (size_t)pkt->size;
                 if (copy_n > 512) copy_n = 512;
@@ -112,6 +120,7 @@ PYMEDIA_API char* extract_subtitles_json(uint8_t *video_data, size_t video_size)
     json_append(&json, &len, &cap, "]");
 
 cleanup:
+    pm_progress_input(0, 0);
     if (pkt) av_packet_free(&pkt);
     close_input(&ifmt_ctx, &input_avio_ctx);
     return json;
@@ -163,7 +172,7 @@ PYMEDIA_API uint8_t* remove_subtitle_tracks(uint8_t *video_data, size_t video_si
     pkt = av_packet_alloc();
     if (!pkt) goto cleanup;
 
-    while (av_read_frame(ifmt_ctx, pkt) >= 0) {
+    while (pm_read_frame(ifmt_ctx, pkt) >= 0) {
         int si = pkt->stream_index;
         if (si < 0 || (unsigned)si >= ifmt_ctx->nb_streams || stream_mapping[si] < 0) {
             av_packet_unref(pkt);
@@ -174,7 +183,7 @@ PYMEDIA_API uint8_t* remove_subtitle_tracks(uint8_t *video_data, size_t video_si
         pkt->stream_index = stream_mapping[si];
         av_packet_rescale_ts(pkt, in_s->time_base, out_s->time_base);
         pkt->pos = -1;
-        av_interleaved_write_frame(ofmt_ctx, pkt);
+        pm_write_frame(ofmt_ctx, pkt);
         av_packet_unref(pkt);
     }
 
@@ -268,7 +277,7 @@ PYMEDIA_API uint8_t* add_subtitle_track(uint8_t *video_data, size_t video_size,
     pkt = av_packet_alloc();
     if (!pkt) goto cleanup;
 
-    while (av_read_frame(ifmt_ctx, pkt) >= 0) {
+    while (pm_read_frame(ifmt_ctx, pkt) >= 0) {
         int si = pkt->stream_index;
         if (si < 0 || (unsigned)si >= ifmt_ctx->nb_streams || stream_mapping[si] < 0) {
             av_packet_unref(pkt);
@@ -279,7 +288,7 @@ PYMEDIA_API uint8_t* add_subtitle_track(uint8_t *video_data, size_t video_size,
         pkt->stream_index = stream_mapping[si];
         av_packet_rescale_ts(pkt, in_s->time_base, out_s->time_base);
         pkt->pos = -1;
-        av_interleaved_write_frame(ofmt_ctx, pkt);
+        pm_write_frame(ofmt_ctx, pkt);
         av_packet_unref(pkt);
     }
 
@@ -303,7 +312,7 @@ PYMEDIA_API uint8_t* add_subtitle_track(uint8_t *video_data, size_t video_size,
         spkt.duration = end_ms - start_ms;
         spkt.stream_index = sub_index;
 
-        av_interleaved_write_frame(ofmt_ctx, &spkt);
+        pm_write_frame(ofmt_ctx, &spkt);
         av_packet_unref(&spkt);
     }
 
@@ -0,0 +1,464 @@
+// ============================================================
+// time stretch — pitch-preserving WSOLA tempo change and the
+// change_speed pipeline (threaded audio, retimed video copy)
+// ============================================================
+
+#define STRETCH_FRAME_SEC 0.030     // analysis/synthesis frame
+#define STRETCH_SEEK_SEC 0.008      // similarity search radius
+#define STRETCH_DECIMATE 4          // coarse search step
+#define SPEED_QUEUE_CHUNKS 16
+
+// ---------- kernels ----------
+
+static float dsp_dot(const float *a, const float *b, int n) {
+    float acc = 0.0f;
+    int i = 0;
+#ifdef PM_HAVE_SSE2
+    __m128 vacc = _mm_setzero_ps();
+    for (; i + 4 <= n; i += 4)
+        vacc = _mm_add_ps(vacc, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    float lanes[4];
+    _mm_storeu_ps(lanes, vacc);
+    acc = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+    for (; i < n; i++) acc += a[i] * b[i];
+    return acc;
+}
+
+// ---------- WSOLA ----------
+//
+// Output frames of `frame` samples are overlap-added every `hop_out`
+// samples with a Hann window (50% overlap sums to one). Frame k is read
+// near input position k * hop_in; within +-`seek` samples the start whose
+// first half best matches the natural continuation of the previous frame
+// is chosen, so periodic content lines up and pitch is preserved. The
+// search runs on a 4x decimated mono mix and is refined at full rate.
+
+typedef struct {
+    int channels;
+    int frame, hop_out, seek;
+    double hop_in;              // speed * hop_out
+    float *window;
+    float **in;                 // buffered input, in[c][0] is sample `in_base`
+    float *mono;
+    int in_len, in_cap;
+    int64_t in_base;
+    float **ola;                // frame samples per channel
+    float **out;                // last emitted block, hop_out samples
+    float *ref_d, *cand_d;      // decimated search scratch
+    int64_t frames;             // frames overlap-added so far
+    int64_t prev_pos;           // input position of the previous frame
+    int64_t in_total;           // real (non-padding) input samples
+    int64_t emitted;
+} TimeStretch;
+
+static void time_stretch_free(TimeStretch *ts) {
+    dsp_free_planes(&ts->in);
+    dsp_free_planes(&ts->ola);
+    dsp_free_planes(&ts->out);
+    free(ts->window);
+    free(ts->mono);
+    free(ts->ref_d);
+    free(ts->cand_d);
+    memset(ts, 0, sizeof(*ts));
+}
+
+static int time_stretch_init(TimeStretch *ts, int sample_rate, int channels, double speed) {
+    memset(ts, 0, sizeof(*ts));
+    ts->channels = channels;
+    ts->hop_out = (int)lrint(sample_rate * STRETCH_FRAME_SEC / 2);
+    if (ts->hop_out < 2 * STRETCH_DECIMATE) ts->hop_out = 2 * STRETCH_DECIMATE;
+    ts->hop_out -= ts->hop_out % STRETCH_DECIMATE;
+    ts->frame = 2 * ts->hop_out;
+    ts->seek = (int)lrint(sample_rate * STRETCH_SEEK_SEC);
+    ts->seek -= ts->seek % STRETCH_DECIMATE;
+    if (ts->seek < STRETCH_DECIMATE) ts->seek = STRETCH_DECIMATE;
+    ts->hop_in = speed * ts->hop_out;
+    ts->in_cap = ts->frame * 4 + (int)ceil(ts->hop_in) + 2 * ts->seek;
+    ts->prev_pos = -1;
+
+    ts->window = malloc(sizeof(float) * ts->frame);
+    ts->mono = malloc(sizeof(float) * ts->in_cap);
+    ts->in = dsp_alloc_planes(channels, ts->in_cap);
+    ts->ola = dsp_alloc_planes(channels, ts->frame);
+    ts->out = dsp_alloc_planes(channels, ts->hop_out);
+    int search_d = (ts->frame + 2 * ts->seek) / STRETCH_DECIMATE + 1;
+    ts->ref_d = malloc(sizeof(float) * search_d);
+    ts->cand_d = malloc(sizeof(float) * search_d);
+    if (!ts->window || !ts->mono || !ts->in || !ts->ola || !ts->out ||
+        !ts->ref_d || !ts->cand_d) {
+        time_stretch_free(ts);
+        return -1;
+    }
+    for (int i = 0; i < ts->frame; i++)
+        ts->window[i] = (float)(0.5 - 0.5 * cos(2.0 * M_PI * i / ts->frame));
+    for (int c = 0; c < channels; c++) memset(ts->ola[c], 0, sizeof(float) * ts->frame);
+    return 0;
+}
+
+// Append `n` samples (NULL planes append silence).
+static int time_stretch_push(TimeStretch *ts, float **planes, int n) {
+    if (ts->in_len + n > ts->in_cap) {
+        int cap = ts->in_len + n + ts->frame;
+        float **grown = dsp_alloc_planes(ts->channels, cap);
+        float *mono = malloc(sizeof(float) * cap);
+        if (!grown || !mono) {
+            dsp_free_planes(&grown);
+            free(mono);
+            return -1;
+        }
+        for (int c = 0; c < ts->channels; c++)
+            memcpy(grown[c], ts->in[c], sizeof(float) * ts->in_len);
+        memcpy(mono, ts->mono, sizeof(float) * ts->in_len);
+        dsp_free_planes(&ts->in);
+        free(ts->mono);
+        ts->in = grown;
+        ts->mono = mono;
+        ts->in_cap = cap;
+    }
+    float *m = ts->mono + ts->in_len;
+    memset(m, 0, sizeof(float) * n);
+    for (int c = 0; c < ts->channels; c++) {
+        float *dst = ts->in[c] + ts->in_len;
+        if (planes) {
+            memcpy(dst, planes[c], sizeof(float) * n);
+            dsp_mix(m, dst, n, 1.0f / ts->channels);
+        } else {
+            memset(dst, 0, sizeof(float) * n);
+        }
+    }
+    ts->in_len += n;
+    return 0;
+}
+
+// Best frame start in [lo, hi] (absolute, buffered) for the previous
+// frame's continuation.
+static int64_t time_stretch_search(TimeStretch *ts, int64_t lo, int64_t hi) {
+    const int D = STRETCH_DECIMATE;
+    int len = ts->hop_out, len_d = len / D;
+    const float *ref = ts->mono + (ts->prev_pos + ts->hop_out - ts->in_base);
+    const float *region = ts->mono + (lo - ts->in_base);
+    int span = (int)(hi - lo), span_d = span / D;
+
+    for (int i = 0; i < len_d; i++) {
+        const float *p = ref + i * D;
+        ts->ref_d[i] = p[0] + p[1] + p[2] + p[3];
+    }
+    for (int i = 0; i < span_d + len_d; i++) {
+        const float *p = region + i * D;
+        ts->cand_d[i] = p[0] + p[1] + p[2] + p[3];
+    }
+
+    // Coarse: normalized correlation on the decimated mix.
+    int best_d = 0;
+    float best = -INFINITY;
+    float energy = dsp_dot(ts->cand_d, ts->cand_d, len_d);
+    for (int o = 0; o <= span_d; o++) {
+        if (o > 0) {
+            float head = ts->cand_d[o - 1], tail = ts->cand_d[o + len_d - 1];
+            energy += tail * tail - head * head;
+        }
+        float score = dsp_dot(ts->ref_d, ts->cand_d + o, len_d) /
+                      sqrtf((energy > 1e-12f ? energy : 1e-12f));
+        if (score > best) {
+            best = score;
+            best_d = o;
+        }
+    }
+
+    // Fine: full-rate correlation around the coarse winner.
+    int from = best_d * D - D, to = best_d * D + D;
+    if (from < 0) from = 0;
+    if (to > span) to = span;
+    int best_o = best_d * D;
+    best = -INFINITY;
+    for (int o = from; o <= to; o++) {
+        const float *cand = region + o;
+        float e = dsp_dot(cand, cand, len);
+        float score = dsp_dot(ref, cand, len) / sqrtf(e > 1e-12f ? e : 1e-12f);
+        if (score > best) {
+            best = score;
+            best_o = o;
+        }
+    }
+    return lo + best_o;
+}
+
+// Run every frame whose search window is buffered. Each finished frame
+// leaves `hop_out` final samples in ts->out, handed to `emit`.
+typedef int (*stretch_emit_fn)(void *opaque, float **planes, int n);
+
+static int time_stretch_run(TimeStretch *ts, stretch_emit_fn emit, void *opaque) {
+    for (;;) {
+        int64_t ideal = (int64_t)llround(ts->frames * ts->hop_in);
+        int64_t lo = ideal - ts->seek, hi = ideal + ts->seek;
+        if (lo < 0) lo = 0;
+        int64_t pos = ideal;
+        if (ts->frames > 0) {
+            // The reference continuation must be buffered as well.
+            int64_t ref_end = ts->prev_pos + 2 * ts->hop_out;
+            if (hi + ts->frame > ts->in_base + ts->in_len ||
+                ref_end > ts->in_base + ts->in_len)
+                return 0;
+            pos = time_stretch_search(ts, lo, hi);
+        } else if (ts->frame > ts->in_len) {
+            return 0;
+        }
+
+        const float *win = ts->window;
+        for (int c = 0; c < ts->channels; c++) {
+            const float *src = ts->in[c] + (pos - ts->in_base);
+            float *acc = ts->ola[c];
+            int i = 0;
+            if (ts->frames == 0)
+                for (; i < ts->hop_out; i++) acc[i] += src[i];
+            for (; i < ts->frame; i++) acc[i] += src[i] * win[i];
+            memcpy(ts->out[c], acc, sizeof(float) * ts->hop_out);
+            memmove(acc, acc + ts->hop_out, sizeof(float) * (ts->frame - ts->hop_out));
+            memset(acc + ts->frame - ts->hop_out, 0, sizeof(float) * ts->hop_out);
+        }
+        ts->prev_pos = pos;
+        ts->frames++;
+
+        // Samples before the next reference or search window are done with.
+        int64_t next_lo = (int64_t)llround(ts->frames * ts->hop_in) - ts->seek;
+        int64_t keep = pos + ts->hop_out < next_lo ? pos + ts->hop_out : next_lo;
+        int drop = (int)(keep - ts->in_base);
+        if (drop > ts->in_len) drop = ts->in_len;
+        if (drop > 0) {
+            int rest = ts->in_len - drop;
+            for (int c = 0; c < ts->channels; c++)
+                memmove(ts->in[c], ts->in[c] + drop, sizeof(float) * rest);
+            memmove(ts->mono, ts->mono + drop, sizeof(float) * rest);
+            ts->in_len = rest;
+            ts->in_base += drop;
+        }
+
+        int n = ts->hop_out;
+        ts->emitted += n;
+        if (emit(opaque, ts->out, n) < 0) return -1;
+    }
+}
+
+static int time_stretch_feed(TimeStretch *ts, float **planes, int n,
+                             stretch_emit_fn emit, void *opaque) {
+    if (time_stretch_push(ts, planes, n) < 0) return -1;
+    ts->in_total += n;
+    return time_stretch_run(ts, emit, opaque);
+}
+
+// Pad with silence until round(in_total / speed) samples are out; the last
+// block is cut to that length.
+typedef struct {
+    stretch_emit_fn emit;
+    void *opaque;
+    int64_t remaining;
+} StretchTail;
+
+static int stretch_tail_emit(void *opaque, float **planes, int n) {
+    StretchTail *t = opaque;
+    if (t->remaining <= 0) return 0;
+    if (n > t->remaining) n = (int)t->remaining;
+    t->remaining -= n;
+    return t->emit(t->opaque, planes, n);
+}
+
+static int time_stretch_finish(TimeStretch *ts, double speed,
+                               stretch_emit_fn emit, void *opaque) {
+    StretchTail t = { emit, opaque, (int64_t)llround(ts->in_total / speed) - ts->emitted };
+    int pad = ts->frame + 2 * ts->seek + (int)ceil(ts->hop_in);
+    while (t.remaining > 0) {
+        if (time_stretch_push(ts, NULL, pad) < 0) return -1;
+        if (time_stretch_run(ts, stretch_tail_emit, &t) < 0) return -1;
+    }
+    return 0;
+}
+
+// ---------- change_speed ----------
+//
+// The audio stream is decoded and stretched on its own thread (with its own
+// demuxer over the same bytes) and handed over in chunks through a bounded
+// queue; the calling thread retimes and copies video packets and encodes
+// the stretched audio into the shared muxer.
+
+typedef struct {
+    float **planes;
+    int n;
+} SpeedChunk;
+
+typedef struct {
+    AudioReader r;
+    TimeStretch ts;
+    double speed;
+    float **batch;              // chunk being filled by the stretcher
+    int batch_len;
+
+    pm_mutex_t lock;
+    pm_cond_t cond;
+    SpeedChunk queue[SPEED_QUEUE_CHUNKS];
+    int head, count;
+    int done, error, stop;
+    pm_thread_t thread;
+} SpeedAudio;
+
+static int speed_audio_push(SpeedAudio *sa) {
+    if (sa->batch_len == 0) return 0;
+    pm_mutex_lock(&sa->lock);
+    while (!sa->stop && sa->count == SPEED_QUEUE_CHUNKS)
+        pm_cond_wait(&sa->cond, &sa->lock);
+    if (sa->stop) {
+        pm_mutex_unlock(&sa->lock);
+        return -1;
+    }
+    SpeedChunk *c = &sa->queue[(sa->head + sa->count) % SPEED_QUEUE_CHUNKS];
+    c->planes = sa->batch;
+    c->n = sa->batch_len;
+    sa->count++;
+    pm_cond_broadcast(&sa->cond);
+    pm_mutex_unlock(&sa->lock);
+
+    sa->batch = dsp_alloc_planes(sa->r.channels, AUDIO_DSP_CHUNK);
+    sa->batch_len = 0;
+    return sa->batch ? 0 : -1;
+}
+
+static int speed_audio_emit(void *opaque, float **planes, int n) {
+    SpeedAudio *sa = opaque;
+    int off = 0;
+    while (off < n) {
+        int take = AUDIO_DSP_CHUNK - sa->batch_len;
+        if (take > n - off) take = n - off;
+        for (int c = 0; c < sa->r.channels; c++)
+            memcpy(sa->batch[c] + sa->batch_len, planes[c] + off, sizeof(float) * take);
+        sa->batch_len += take;
+        off += take;
+        if (sa->batch_len == AUDIO_DSP_CHUNK && speed_audio_push(sa) < 0) return -1;
+    }
+    return 0;
+}
+
+static void *speed_audio_worker(void *arg) {
+    SpeedAudio *sa = arg;
+    int n, ret = 0;
+    while ((n = audio_reader_read(&sa->r)) > 0) {
+        ret = time_stretch_feed(&sa->ts, sa->r.buf, n, speed_audio_emit, sa);
+        if (ret < 0) break;
+    }
+    if (n < 0) ret = -1;
+    if (ret == 0) ret = time_stretch_finish(&sa->ts, sa->speed, speed_audio_emit, sa);
+    if (ret == 0) ret = speed_audio_push(sa);
+
+    pm_mutex_lock(&sa->lock);
+    sa->done = 1;
+    if (ret < 0) sa->error = 1;
+    pm_cond_broadcast(&sa->cond);
+    pm_mutex_unlock(&sa->lock);
+    return NULL;
+}
+
+// Encode queued chunks; with `wait` block until the worker has finished.
+static int speed_audio_drain(SpeedAudio *sa, AudioWriter *w, int wait) {
+    int ret = 0;
+    pm_mutex_lock(&sa->lock);
+    for (;;) {
+        while (sa->count > 0 && ret == 0) {
+            SpeedChunk c = sa->queue[sa->head];
+            sa->head = (sa->head + 1) % SPEED_QUEUE_CHUNKS;
+            sa->count--;
+            pm_cond_broadcast(&sa->cond);
+            pm_mutex_unlock(&sa->lock);
+            ret = audio_writer_write(w, c.planes, c.n);
+            dsp_free_planes(&c.planes);
+            pm_mutex_lock(&sa->lock);
+        }
+        if (ret < 0 || sa->error || !wait || sa->done) break;
+        pm_cond_wait(&sa->cond, &sa->lock);
+    }
+    if (sa->error) ret = -1;
+    pm_mutex_unlock(&sa->lock);
+    return ret;
+}
+
+static void speed_audio_stop(SpeedAudio *sa) {
+    pm_mutex_lock(&sa->lock);
+    sa->stop = 1;
+    pm_cond_broadcast(&sa->cond);
+    pm_mutex_unlock(&sa->lock);
+    pm_thread_join(sa->thread);
+    while (sa->count > 0) {
+        dsp_free_planes(&sa->queue[sa->head].planes);
+        sa->head = (sa->head + 1) % SPEED_QUEUE_CHUNKS;
+        sa->count--;
+    }
+}
+
+// speed > 1.0 = faster, speed < 1.0 = slower. Audio keeps its pitch and is
+// re-encoded to AAC at the source rate; video packets are copied with
+// rescaled timestamps. Inputs without decodable audio are only retimed.
+PYMEDIA_API uint8_t* change_speed(uint8_t *video_data, size_t video_size,
+                                  double speed, size_t *out_size) {
+    *out_size = 0;
+    if (speed <= 0.0) return NULL;
+
+    BufferData bd;
+    AVFormatContext *ifmt_ctx = NULL;
+    AVIOContext *input_avio_ctx = NULL;
+    AVPacket *pkt = NULL;
+    AudioWriter w;
+    SpeedAudio sa;
+    uint8_t *result = NULL;
+    int started = 0, failed = 0;
+
+    memset(&w, 0, sizeof(w));
+    memset(&sa, 0, sizeof(sa));
+    if (audio_reader_open(&sa.r, video_data, video_size, -1, -1) < 0)
+        return retime_packets(video_data, video_size, speed, out_size);
+    sa.speed = speed;
+    pm_mutex_init(&sa.lock);
+    pm_cond_init(&sa.cond);
+
+    if (open_input_memory(video_data, video_size, &ifmt_ctx, &input_avio_ctx, &bd) < 0)
+        goto cleanup;
+    int video_idx = find_stream(ifmt_ctx, AVMEDIA_TYPE_VIDEO);
+    AVStream *in_video = video_idx >= 0 ? ifmt_ctx->streams[video_idx] : NULL;
+
+    if (time_stretch_init(&sa.ts, sa.r.sample_rate, sa.r.channels, speed) < 0) goto cleanup;
+    sa.batch = dsp_alloc_planes(sa.r.channels, AUDIO_DSP_CHUNK);
+    pkt = av_packet_alloc();
+    if (!sa.batch || !pkt) goto cleanup;
+    if (audio_writer_open_ex(&w, "aac", "mp4", sa.r.sample_rate, sa.r.channels,
+                             in_video ? in_video->codecpar : NULL,
+                             in_video ? in_video->time_base : (AVRational){1, 1}) < 0)
+        goto cleanup;
+
+    if (pm_thread_create(&sa.thread, speed_audio_worker, &sa) < 0) goto cleanup;
+    started = 1;
+
+    while (in_video && read_next_stream_packet(ifmt_ctx, video_idx, pkt) > 0) {
+        if (pkt->pts != AV_NOPTS_VALUE) pkt->pts = (int64_t)(pkt->pts / speed);
+        if (pkt->dts != AV_NOPTS_VALUE) pkt->dts = (int64_t)(pkt->dts / speed);
+        if (pkt->duration > 0) pkt->duration = (int64_t)(pkt->duration / speed);
+        audio_writer_copy_packet(&w, pkt, in_video->time_base);
+        av_packet_unref(pkt);
+        if (speed_audio_drain(&sa, &w, 0) < 0) {
+            failed = 1;
+            break;
+        }
+    }
+    if (!failed && speed_audio_drain(&sa, &w, 1) < 0) failed = 1;
+    speed_audio_stop(&sa);
+    started = 0;
+    if (!failed) result = audio_writer_finish(&w, out_size);
+
+cleanup:
+    if (started) speed_audio_stop(&sa);
+    audio_writer_close(&w);
+    dsp_free_planes(&sa.batch);
+    time_stretch_free(&sa.ts);
+    audio_reader_close(&sa.r);
+    pm_cond_destroy(&sa.cond);
+    pm_mutex_destroy(&sa.lock);
+    if (pkt) av_packet_free(&pkt);
+    close_input(&ifmt_ctx, &input_avio_ctx);
+    return result;
+}
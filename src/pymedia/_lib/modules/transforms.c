@@ -14,6 +14,7 @@ PYMEDIA_API uint8_t* adjust_volume(uint8_t *video_data, size_t video_size,
     AVCodecContext *adec_ctx = NULL, *aenc_ctx = NULL;
     SwrContext *swr = NULL;
     AVAudioFifo *fifo = NULL;
+    int fifo_channels = 0;
     AVPacket *pkt = NULL, *enc_pkt = NULL;
     AVFrame *dec_frame = NULL, *enc_frame = NULL;
     uint8_t *output_buffer = NULL, *result = NULL;
@@ -82,13 +83,14 @@ PYMEDIA_API uint8_t* adjust_volume(uint8_t *video_data, size_t video_size,
             : av_get_default_channel_layout(adec_ctx->channels),
         adec_ctx->sample_fmt, adec_ctx->sample_rate, 0, NULL);
 #endif
-    if (!swr || swr_init(swr) < 0) goto cleanup;
+    if (swr_cache_init(&swr) < 0) goto cleanup;
 
 #if FF_NEW_CHANNEL_LAYOUT
-    fifo = av_audio_fifo_alloc(AV_SAMPLE_FMT_FLTP, aenc_ctx->ch_layout.nb_channels, frame_size);
+    fifo_channels = aenc_ctx->ch_layout.nb_channels;
 #else
-    fifo = av_audio_fifo_alloc(AV_SAMPLE_FMT_FLTP, aenc_ctx->channels, frame_size);
+    fifo_channels = aenc_ctx->channels;
 #endif
+    fifo = audio_fifo_acquire(AV_SAMPLE_FMT_FLTP, fifo_channels, frame_size);
     if (!fifo) goto cleanup;
 
     stream_mapping = calloc(ifmt_ctx->nb_streams, sizeof(int));
@@ -122,16 +124,16 @@ PYMEDIA_API uint8_t* adjust_volume(uint8_t *video_data, size_t video_size,
 
     int64_t pts_counter = 0;
 
-    while (av_read_frame(ifmt_ctx, pkt) >= 0) {
+    while (pm_read_frame(ifmt_ctx, pkt) >= 0) {
         if (pkt->stream_index == video_idx && video_out_idx >= 0) {
             pkt->stream_index = video_out_idx;
             av_packet_rescale_ts(pkt, ifmt_ctx->streams[video_idx]->time_base,
                                  ofmt_ctx->streams[video_out_idx]->time_base);
             pkt->pos = -1;
-            av_interleaved_write_frame(ofmt_ctx, pkt);
+            pm_write_frame(ofmt_ctx, pkt);
         } else if (pkt->stream_index == audio_idx) {
-            if (avcodec_send_packet(adec_ctx, pkt) >= 0) {
-                while (avcodec_receive_frame(adec_ctx, dec_frame) == 0) {
+            if (pm_send_packet(adec_ctx, pkt) >= 0) {
+                while (pm_receive_frame(adec_ctx, dec_frame) == 0) {
                     // Apply volume to float planar samples
                     if (dec_frame->format == AV_SAMPLE_FMT_FLTP) {
 #if FF_NEW_CHANNEL_LAYOUT
@@ -161,7 +163,7 @@ PYMEDIA_API uint8_t* adjust_volume(uint8_t *video_data, size_t video_size,
 #endif
                         resamp_buf_size = out_samples;
                     }
-                    int converted = swr_convert(swr, resamp_buf, out_samples,
+                    int converted = pm_swr_convert(swr, resamp_buf, out_samples,
                                                 (const uint8_t **)dec_frame->data,
                                                 dec_frame->nb_samples);
                     if (converted > 0) {
@@ -175,8 +177,8 @@ PYMEDIA_API uint8_t* adjust_volume(uint8_t *video_data, size_t video_size,
         av_packet_unref(pkt);
     }
 
-    avcodec_send_packet(adec_ctx, NULL);
-    while (avcodec_receive_frame(adec_ctx, dec_frame) == 0) {
+    pm_send_packet(adec_ctx, NULL);
+    while (pm_receive_frame(adec_ctx, dec_frame) == 0) {
         int out_samples = swr_get_out_samples(swr, dec_frame->nb_samples);
         if (out_samples > 0) {
             if (out_samples > resamp_buf_size) {
@@ -191,7 +193,7 @@ PYMEDIA_API uint8_t* adjust_volume(uint8_t *video_data, size_t video_size,
 #endif
                 resamp_buf_size = out_samples;
             }
-            int converted = swr_convert(swr, resamp_buf, out_samples,
+            int converted = pm_swr_convert(swr, resamp_buf, out_samples,
                                         (const uint8_t **)dec_frame->data, dec_frame->nb_samples);
             if (converted > 0) {
                 av_audio_fifo_write(fifo, (void **)resamp_buf, converted);
@@ -201,11 +203,11 @@ PYMEDIA_API uint8_t* adjust_volume(uint8_t *video_data, size_t video_size,
         }
     }
     encode_fifo_remaining(fifo, aenc_ctx, ofmt_ctx, a_out, enc_pkt, enc_frame, &pts_counter);
-    avcodec_send_frame(aenc_ctx, NULL);
-    while (avcodec_receive_packet(aenc_ctx, enc_pkt) == 0) {
+    pm_send_frame(aenc_ctx, NULL);
+    while (pm_receive_packet(aenc_ctx, enc_pkt) == 0) {
         enc_pkt->stream_index = audio_out_idx;
         av_packet_rescale_ts(enc_pkt, aenc_ctx->time_base, a_out->time_base);
-        av_interleaved_write_frame(ofmt_ctx, enc_pkt);
+        pm_write_frame(ofmt_ctx, enc_pkt);
         av_packet_unref(enc_pkt);
     }
 
@@ -227,8 +229,8 @@ cleanup:
     if (dec_frame) av_frame_free(&dec_frame);
     if (enc_pkt)   av_packet_free(&enc_pkt);
     if (pkt)       av_packet_free(&pkt);
-    if (fifo)      av_audio_fifo_free(fifo);
-    if (swr)       swr_free(&swr);
+    audio_fifo_release(&fifo, AV_SAMPLE_FMT_FLTP, fifo_channels);
+    swr_cache_release(&swr);
     if (aenc_ctx)  avcodec_free_context(&aenc_ctx);
     if (adec_ctx)  avcodec_free_context(&adec_ctx);
     if (ofmt_ctx) {
@@ -300,8 +302,12 @@ PYMEDIA_API uint8_t* merge_videos(uint8_t *data1, size_t size1,
     pkt = av_packet_alloc();
     if (!pkt) goto cleanup;
 
+    // Progress runs over both inputs; input2 counts from input1's end.
+    int64_t dur1 = ifmt1->duration > 0 ? ifmt1->duration : 0;
+    pm_progress_input(0, dur1 + (ifmt2->duration > 0 ? ifmt2->duration : 0));
+
     // Write input1
-    while (av_read_frame(ifmt1, pkt) >= 0) {
+    while (pm_read_frame(ifmt1, pkt) >= 0) {
         int si = pkt->stream_index;
         if (si < 0 || (unsigned)si >= ifmt1->nb_streams || map1[si] < 0) {
             av_packet_unref(pkt); continue;
@@ -316,7 +322,7 @@ PYMEDIA_API uint8_t* merge_videos(uint8_t *data1, size_t size1,
             last_dts[out_si] = pkt->dts;
             last_dur[out_si] = pkt->duration > 0 ? pkt->duration : 1;
         }
-        av_interleaved_write_frame(ofmt_ctx, pkt);
+        pm_write_frame(ofmt_ctx, pkt);
         av_packet_unref(pkt);
     }
 
@@ -324,7 +330,8 @@ PYMEDIA_API uint8_t* merge_videos(uint8_t *data1, size_t size1,
         dts_offset[i] = last_dts[i] + last_dur[i];
 
     // Write input2 with offset
-    while (av_read_frame(ifmt2, pkt) >= 0) {
+    pm_progress_input(dur1, 0);
+    while (pm_read_frame(ifmt2, pkt) >= 0) {
         int si = pkt->stream_index;
         if (si < 0 || (unsigned)si >= ifmt2->nb_streams || map2[si] < 0) {
             av_packet_unref(pkt); continue;
@@ -337,7 +344,7 @@ PYMEDIA_API uint8_t* merge_videos(uint8_t *data1, size_t size1,
         if (pkt->dts != AV_NOPTS_VALUE) pkt->dts += dts_offset[out_si];
         pkt->stream_index = out_si;
         pkt->pos = -1;
-        av_interleaved_write_frame(ofmt_ctx, pkt);
+        pm_write_frame(ofmt_ctx, pkt);
         av_packet_unref(pkt);
     }
 
@@ -353,6 +360,7 @@ PYMEDIA_API uint8_t* merge_videos(uint8_t *data1, size_t size1,
     }
 
 cleanup:
+    pm_progress_input(0, 0);
     free(last_dts); free(last_dur); free(dts_offset);
     free(map1); free(map2);
     if (pkt) av_packet_free(&pkt);
@@ -434,11 +442,15 @@ PYMEDIA_API uint8_t* reverse_video(uint8_t *video_data, size_t video_size,
     dec_frame = av_frame_alloc();
     if (!pkt || !enc_pkt || !dec_frame) goto cleanup;
 
+    // Decoding reports the first half of the progress, encoding the second.
+    int64_t duration_us = ifmt_ctx->duration > 0 ? ifmt_ctx->duration : 0;
+    pm_progress(0, 2 * duration_us);
+
     // Decode all video frames
-    while (av_read_frame(ifmt_ctx, pkt) >= 0) {
+    while (pm_read_frame(ifmt_ctx, pkt) >= 0) {
         if (pkt->stream_index == video_idx &&
-            avcodec_send_packet(vdec_ctx, pkt) >= 0) {
-            while (avcodec_receive_frame(vdec_ctx, dec_frame) == 0) {
+            pm_send_packet(vdec_ctx, pkt) >= 0) {
+            while (pm_receive_frame(vdec_ctx, dec_frame) == 0) {
                 if (frame_count >= frame_cap) {
                     int new_cap = frame_cap ? frame_cap * 2 : 64;
                     AVFrame **tmp = realloc(frames, new_cap * sizeof(AVFrame *));
@@ -451,8 +463,8 @@ PYMEDIA_API uint8_t* reverse_video(uint8_t *video_data, size_t video_size,
         }
         av_packet_unref(pkt);
     }
-    avcodec_send_packet(vdec_ctx, NULL);
-    while (avcodec_receive_frame(vdec_ctx, dec_frame) == 0) {
+    pm_send_packet(vdec_ctx, NULL);
+    while (pm_receive_frame(vdec_ctx, dec_frame) == 0) {
         if (frame_count < frame_cap) {
             frames[frame_count] = av_frame_clone(dec_frame);
             if (frames[frame_count]) frame_count++;
@@ -467,25 +479,27 @@ encode:
     yuv_frame->height = src_h & ~1;
     if (av_frame_get_buffer(yuv_frame, 0) < 0) goto cleanup;
 
-    for (int i = frame_count - 1; i >= 0; i--) {
+    for (int i = frame_count - 1; i >= 0 && !pm_cancelled(); i--) {
+        int64_t encoded = frame_count - 1 - i;
+        pm_progress(duration_us + duration_us * encoded / frame_count, 0);
         AVFrame *f = frames[i];
         av_frame_make_writable(yuv_frame);
-        sws_scale(sws, (const uint8_t *const *)f->data, f->linesize, 0, src_h,
+        pm_sws_scale(sws, (const uint8_t *const *)f->data, f->linesize, 0, src_h,
                   yuv_frame->data, yuv_frame->linesize);
-        yuv_frame->pts = (int64_t)(frame_count - 1 - i);
-        avcodec_send_frame(venc_ctx, yuv_frame);
-        while (avcodec_receive_packet(venc_ctx, enc_pkt) == 0) {
+        yuv_frame->pts = encoded;
+        pm_send_frame(venc_ctx, yuv_frame);
+        while (pm_receive_packet(venc_ctx, enc_pkt) == 0) {
             enc_pkt->stream_index = 0;
             av_packet_rescale_ts(enc_pkt, venc_ctx->time_base, v_out->time_base);
-            av_interleaved_write_frame(ofmt_ctx, enc_pkt);
+            pm_write_frame(ofmt_ctx, enc_pkt);
             av_packet_unref(enc_pkt);
         }
     }
-    avcodec_send_frame(venc_ctx, NULL);
-    while (avcodec_receive_packet(venc_ctx, enc_pkt) == 0) {
+    pm_send_frame(venc_ctx, NULL);
+    while (pm_receive_packet(venc_ctx, enc_pkt) == 0) {
         enc_pkt->stream_index = 0;
         av_packet_rescale_ts(enc_pkt, venc_ctx->time_base, v_out->time_base);
-        av_interleaved_write_frame(ofmt_ctx, enc_pkt);
+        pm_write_frame(ofmt_ctx, enc_pkt);
         av_packet_unref(enc_pkt);
     }
 
@@ -630,12 +644,12 @@ PYMEDIA_API uint8_t* stabilize_video(uint8_t *video_data, size_t video_size,
     int w_prev = strength;
     int w_curr = 32 - strength;
 
-    while (av_read_frame(ifmt_ctx, pkt) >= 0) {
+    while (pm_read_frame(ifmt_ctx, pkt) >= 0) {
         if (pkt->stream_index == video_idx) {
-            if (avcodec_send_packet(vdec_ctx, pkt) >= 0) {
-                while (avcodec_receive_frame(vdec_ctx, dec_frame) == 0) {
+            if (pm_send_packet(vdec_ctx, pkt) >= 0) {
+                while (pm_receive_frame(vdec_ctx, dec_frame) == 0) {
                     av_frame_make_writable(yuv_frame);
-                    sws_scale(sws, (const uint8_t *const *)dec_frame->data,
+                    pm_sws_scale(sws, (const uint8_t *const *)dec_frame->data,
                               dec_frame->linesize, 0, src_h,
                               yuv_frame->data, yuv_frame->linesize);
 
@@ -668,11 +682,11 @@ PYMEDIA_API uint8_t* stabilize_video(uint8_t *video_data, size_t video_size,
                     have_prev = 1;
 
                     yuv_frame->pts = dec_frame->pts;
-                    avcodec_send_frame(venc_ctx, yuv_frame);
-                    while (avcodec_receive_packet(venc_ctx, enc_pkt) == 0) {
+                    pm_send_frame(venc_ctx, yuv_frame);
+                    while (pm_receive_packet(venc_ctx, enc_pkt) == 0) {
                         enc_pkt->stream_index = stream_mapping[video_idx];
                         av_packet_rescale_ts(enc_pkt, venc_ctx->time_base, v_out->time_base);
-                        av_interleaved_write_frame(ofmt_ctx, enc_pkt);
+                        pm_write_frame(ofmt_ctx, enc_pkt);
                         av_packet_unref(enc_pkt);
                     }
                 }
@@ -682,15 +696,15 @@ PYMEDIA_API uint8_t* stabilize_video(uint8_t *video_data, size_t video_size,
             av_packet_rescale_ts(pkt, ifmt_ctx->streams[audio_idx]->time_base,
                                  ofmt_ctx->streams[audio_out_idx]->time_base);
             pkt->pos = -1;
-            av_interleaved_write_frame(ofmt_ctx, pkt);
+            pm_write_frame(ofmt_ctx, pkt);
         }
         av_packet_unref(pkt);
     }
 
-    avcodec_send_packet(vdec_ctx, NULL);
-    while (avcodec_receive_frame(vdec_ctx, dec_frame) == 0) {
+    pm_send_packet(vdec_ctx, NULL);
+    while (pm_receive_frame(vdec_ctx, dec_frame) == 0) {
         av_frame_make_writable(yuv_frame);
-        sws_scale(sws, (const uint8_t *const *)dec_frame->data,
+        pm_sws_scale(sws, (const uint8_t *const *)dec_frame->data,
                   dec_frame->linesize, 0, src_h,
                   yuv_frame->data, yuv_frame->linesize);
         if (have_prev) {
@@ -707,19 +721,19 @@ PYMEDIA_API uint8_t* stabilize_video(uint8_t *video_data, size_t video_size,
             }
         }
         yuv_frame->pts = dec_frame->pts;
-        avcodec_send_frame(venc_ctx, yuv_frame);
-        while (avcodec_receive_packet(venc_ctx, enc_pkt) == 0) {
+        pm_send_frame(venc_ctx, yuv_frame);
+        while (pm_receive_packet(venc_ctx, enc_pkt) == 0) {
             enc_pkt->stream_index = stream_mapping[video_idx];
             av_packet_rescale_ts(enc_pkt, venc_ctx->time_base, v_out->time_base);
-            av_interleaved_write_frame(ofmt_ctx, enc_pkt);
+            pm_write_frame(ofmt_ctx, enc_pkt);
             av_packet_unref(enc_pkt);
         }
     }
-    avcodec_send_frame(venc_ctx, NULL);
-    while (avcodec_receive_packet(venc_ctx, enc_pkt) == 0) {
+    pm_send_frame(venc_ctx, NULL);
+    while (pm_receive_packet(venc_ctx, enc_pkt) == 0) {
         enc_pkt->stream_index = stream_mapping[video_idx];
         av_packet_rescale_ts(enc_pkt, venc_ctx->time_base, v_out->time_base);
-        av_interleaved_write_frame(ofmt_ctx, enc_pkt);
+        pm_write_frame(ofmt_ctx, enc_pkt);
         av_packet_unref(enc_pkt);
     }
 
@@ -880,12 +894,12 @@ PYMEDIA_API uint8_t* subtitle_burn_in(uint8_t *video_data, size_t video_size,
 
     int cue_hint_idx = 0;
 
-    while (av_read_frame(ifmt_ctx, pkt) >= 0) {
+    while (pm_read_frame(ifmt_ctx, pkt) >= 0) {
         if (pkt->stream_index == video_idx) {
-            if (avcodec_send_packet(vdec_ctx, pkt) >= 0) {
-                while (avcodec_receive_frame(vdec_ctx, dec_frame) == 0) {
+            if (pm_send_packet(vdec_ctx, pkt) >= 0) {
+                while (pm_receive_frame(vdec_ctx, dec_frame) == 0) {
                     av_frame_make_writable(rgba_frame);
-                    sws_scale(sws_to_rgba,
+                    pm_sws_scale(sws_to_rgba,
                               (const uint8_t *const *)dec_frame->data, dec_frame->linesize,
                               0, src_h, rgba_frame->data, rgba_frame->linesize);
 
@@ -897,16 +911,16 @@ PYMEDIA_API uint8_t* subtitle_burn_in(uint8_t *video_data, size_t video_size,
                     if (active) draw_block_subtitle(rgba_frame, active, margin_bottom, font_size);
 
                     av_frame_make_writable(yuv_frame);
-                    sws_scale(sws_to_yuv,
+                    pm_sws_scale(sws_to_yuv,
                               (const uint8_t *const *)rgba_frame->data, rgba_frame->linesize,
                               0, src_h, yuv_frame->data, yuv_frame->linesize);
                     yuv_frame->pts = dec_frame->pts;
 
-                    avcodec_send_frame(venc_ctx, yuv_frame);
-                    while (avcodec_receive_packet(venc_ctx, enc_pkt) == 0) {
+                    pm_send_frame(venc_ctx, yuv_frame);
+                    while (pm_receive_packet(venc_ctx, enc_pkt) == 0) {
                         enc_pkt->stream_index = stream_mapping[video_idx];
                         av_packet_rescale_ts(enc_pkt, venc_ctx->time_base, v_out->time_base);
-                        av_interleaved_write_frame(ofmt_ctx, enc_pkt);
+                        pm_write_frame(ofmt_ctx, enc_pkt);
                         av_packet_unref(enc_pkt);
                     }
                 }
@@ -917,15 +931,15 @@ PYMEDIA_API uint8_t* subtitle_burn_in(uint8_t *video_data, size_t video_size,
             pkt->stream_index = audio_out_idx;
             av_packet_rescale_ts(pkt, in_s->time_base, out_s->time_base);
             pkt->pos = -1;
-            av_interleaved_write_frame(ofmt_ctx, pkt);
+            pm_write_frame(ofmt_ctx, pkt);
         }
         av_packet_unref(pkt);
     }
 
-    avcodec_send_packet(vdec_ctx, NULL);
-    while (avcodec_receive_frame(vdec_ctx, dec_frame) == 0) {
+    pm_send_packet(vdec_ctx, NULL);
+    while (pm_receive_frame(vdec_ctx, dec_frame) == 0) {
         av_frame_make_writable(rgba_frame);
-        sws_scale(sws_to_rgba,
+        pm_sws_scale(sws_to_rgba,
                   (const uint8_t *const *)dec_frame->data, dec_frame->linesize,
                   0, src_h, rgba_frame->data, rgba_frame->linesize);
         int64_t ts = dec_frame->best_effort_timestamp;
@@ -936,23 +950,23 @@ PYMEDIA_API uint8_t* subtitle_burn_in(uint8_t *video_data, size_t video_size,
         if (active) draw_block_subtitle(rgba_frame, active, margin_bottom, font_size);
 
         av_frame_make_writable(yuv_frame);
-        sws_scale(sws_to_yuv,
+        pm_sws_scale(sws_to_yuv,
                   (const uint8_t *const *)rgba_frame->data, rgba_frame->linesize,
                   0, src_h, yuv_frame->data, yuv_frame->linesize);
         yuv_frame->pts = dec_frame->pts;
-        avcodec_send_frame(venc_ctx, yuv_frame);
-        while (avcodec_receive_packet(venc_ctx, enc_pkt) == 0) {
+        pm_send_frame(venc_ctx, yuv_frame);
+        while (pm_receive_packet(venc_ctx, enc_pkt) == 0) {
             enc_pkt->stream_index = stream_mapping[video_idx];
             av_packet_rescale_ts(enc_pkt, venc_ctx->time_base, v_out->time_base);
-            av_interleaved_write_frame(ofmt_ctx, enc_pkt);
+            pm_write_frame(ofmt_ctx, enc_pkt);
             av_packet_unref(enc_pkt);
         }
     }
-    avcodec_send_frame(venc_ctx, NULL);
-    while (avcodec_receive_packet(venc_ctx, enc_pkt) == 0) {
+    pm_send_frame(venc_ctx, NULL);
+    while (pm_receive_packet(venc_ctx, enc_pkt) == 0) {
         enc_pkt->stream_index = stream_mapping[video_idx];
         av_packet_rescale_ts(enc_pkt, venc_ctx->time_base, v_out->time_base);
-        av_interleaved_write_frame(ofmt_ctx, enc_pkt);
+        pm_write_frame(ofmt_ctx, enc_pkt);
         av_packet_unref(enc_pkt);
     }
 
@@ -1090,6 +1104,8 @@ PYMEDIA_API uint8_t* create_audio_image_video(uint8_t *audio_data, size_t audio_
 
     for (int64_t fi = 0; fi < total_frames; fi++) {
         double t_sec = fi / (double)fps;
+        if (pm_cancelled()) break;
+        pm_progress((int64_t)(t_sec * AV_TIME_BASE), (int64_t)(audio_duration_sec * AV_TIME_BASE));
         int idx = (int)(t_sec / seconds_per_image);
         if (idx < 0) idx = 0;
         if (idx >= image_count) idx = image_count - 1;
@@ -1110,26 +1126,26 @@ PYMEDIA_API uint8_t* create_audio_image_video(uint8_t *audio_data, size_t audio_
             copy_yuv420_frame(work_frame, slides[idx], width, height);
         }
         work_frame->pts = fi;
-        avcodec_send_frame(venc_ctx, work_frame);
-        while (avcodec_receive_packet(venc_ctx, enc_pkt) == 0) {
+        pm_send_frame(venc_ctx, work_frame);
+        while (pm_receive_packet(venc_ctx, enc_pkt) == 0) {
             enc_pkt->stream_index = v_out->index;
             av_packet_rescale_ts(enc_pkt, venc_ctx->time_base, v_out->time_base);
-            av_interleaved_write_frame(ofmt_ctx, enc_pkt);
+            pm_write_frame(ofmt_ctx, enc_pkt);
             av_packet_unref(enc_pkt);
         }
     }
 
-    avcodec_send_frame(venc_ctx, NULL);
-    while (avcodec_receive_packet(venc_ctx, enc_pkt) == 0) {
+    pm_send_frame(venc_ctx, NULL);
+    while (pm_receive_packet(venc_ctx, enc_pkt) == 0) {
         enc_pkt->stream_index = v_out->index;
         av_packet_rescale_ts(enc_pkt, venc_ctx->time_base, v_out->time_base);
-        av_interleaved_write_frame(ofmt_ctx, enc_pkt);
+        pm_write_frame(ofmt_ctx, enc_pkt);
         av_packet_unref(enc_pkt);
     }
 
     int64_t a_first_pts = AV_NOPTS_VALUE;
     int64_t a_first_dts = AV_NOPTS_VALUE;
-    while (av_read_frame(a_ifmt, apkt) >= 0) {
+    while (pm_read_frame(a_ifmt, apkt) >= 0) {
         if (apkt->stream_index != audio_idx) {
             av_packet_unref(apkt);
             continue;
@@ -1154,7 +1170,7 @@ PYMEDIA_API uint8_t* create_audio_image_video(uint8_t *audio_data, size_t audio_
         apkt->stream_index = a_out->index;
         av_packet_rescale_ts(apkt, a_ifmt->streams[audio_idx]->time_base, a_out->time_base);
         apkt->pos = -1;
-        av_interleaved_write_frame(ofmt_ctx, apkt);
+        pm_write_frame(ofmt_ctx, apkt);
         av_packet_unref(apkt);
     }
 
@@ -16,6 +16,7 @@ static uint8_t* remux_video(uint8_t *video_data, size_t video_size,
     uint8_t *output_buffer = NULL;
     uint8_t *result = NULL;
     int *stream_mapping = NULL;
+    char fmt_buf[32];    // per call: format_name may point here
 
     if (open_input_memory(video_data, video_size, &ifmt_ctx,
                           &input_avio_ctx, &bd) < 0)
@@ -26,7 +27,6 @@ static uint8_t* remux_video(uint8_t *video_data, size_t video_size,
     if (!format_name || format_name[0] == '\0') {
         // Try to use input format — take first name before comma
         const char *iname = ifmt_ctx->iformat->name;
-        static char fmt_buf[32];
         const char *comma = strchr(iname, ',');
         if (comma) {
             size_t len = comma - iname;
@@ -87,7 +87,7 @@ static uint8_t* remux_video(uint8_t *video_data, size_t video_size,
     int64_t start_ts = (start_sec > 0.0)
         ? (int64_t)(start_sec * AV_TIME_BASE) : 0;
 
-    while (av_read_frame(ifmt_ctx, pkt) >= 0) {
+    while (pm_read_frame(ifmt_ctx, pkt) >= 0) {
         int si = pkt->stream_index;
         if (si < 0 || (unsigned)si >= ifmt_ctx->nb_streams ||
             stream_mapping[si] < 0) {
@@ -120,7 +120,7 @@ static uint8_t* remux_video(uint8_t *video_data, size_t video_size,
         }
         av_packet_rescale_ts(pkt, in_stream->time_base, out_stream->time_base);
         pkt->pos = -1;
-        av_interleaved_write_frame(ofmt_ctx, pkt);
+        pm_write_frame(ofmt_ctx, pkt);
         av_packet_unref(pkt);
     }
 
@@ -172,9 +172,72 @@ PYMEDIA_API uint8_t* mute_video(uint8_t *video_data, size_t video_size,
 // 4. extract_frame — extract a single frame as JPEG/PNG
 // ============================================================
 
-PYMEDIA_API uint8_t* extract_frame(uint8_t *video_data, size_t video_size,
-                       double timestamp_sec, const char *img_format,
-                       size_t *out_size) {
+// Seek to `timestamp_sec` and decode one video frame into `frame`.
+// Exact mode decodes forward from the preceding keyframe until the first
+// frame at or after the target. Keyframe mode only feeds key packets to the
+// decoder (skip_frame=NONKEY) and returns the keyframe at or before the
+// target, which avoids decoding the rest of the GOP. Returns 0 on success.
+static int decode_frame_at(AVFormatContext *ifmt_ctx, int video_idx,
+                           AVCodecContext *dec_ctx, double timestamp_sec,
+                           int keyframe_only, AVPacket *pkt, AVFrame *frame) {
+    AVStream *vs = ifmt_ctx->streams[video_idx];
+    int got_frame = 0;
+
+    if (keyframe_only) {
+        dec_ctx->skip_frame = AVDISCARD_NONKEY;
+        if (timestamp_sec > 0.0) {
+            int64_t ts = av_rescale_q((int64_t)(timestamp_sec * AV_TIME_BASE),
+                                      AV_TIME_BASE_Q, vs->time_base);
+            if (av_seek_frame(ifmt_ctx, video_idx, ts, AVSEEK_FLAG_BACKWARD) < 0)
+                av_seek_frame(ifmt_ctx, -1, (int64_t)(timestamp_sec * AV_TIME_BASE),
+                              AVSEEK_FLAG_BACKWARD);
+        }
+        while (!got_frame && pm_read_frame(ifmt_ctx, pkt) >= 0) {
+            if (pkt->stream_index == video_idx && (pkt->flags & AV_PKT_FLAG_KEY)) {
+                if (pm_send_packet(dec_ctx, pkt) >= 0 &&
+                    pm_receive_frame(dec_ctx, frame) == 0)
+                    got_frame = 1;
+            }
+            av_packet_unref(pkt);
+        }
+    } else {
+        // Seek to target
+        if (timestamp_sec > 0.0) {
+            int64_t ts = (int64_t)(timestamp_sec * AV_TIME_BASE);
+            av_seek_frame(ifmt_ctx, -1, ts, AVSEEK_FLAG_BACKWARD);
+        }
+
+        // Decode until we get a frame at or after the target timestamp
+        int64_t target_pts = (int64_t)(timestamp_sec * av_q2d(av_inv_q(vs->time_base)));
+
+        while (pm_read_frame(ifmt_ctx, pkt) >= 0) {
+            if (pkt->stream_index == video_idx) {
+                if (pm_send_packet(dec_ctx, pkt) >= 0) {
+                    if (pm_receive_frame(dec_ctx, frame) == 0) {
+                        got_frame = 1;
+                        if (frame->pts >= target_pts || timestamp_sec <= 0.0) {
+                            av_packet_unref(pkt);
+                            break;
+                        }
+                    }
+                }
+            }
+            av_packet_unref(pkt);
+        }
+    }
+
+    // If no frame yet, flush decoder
+    if (!got_frame) {
+        pm_send_packet(dec_ctx, NULL);
+        if (pm_receive_frame(dec_ctx, frame) == 0)
+            got_frame = 1;
+    }
+    return got_frame ? 0 : -1;
+}
+
+static uint8_t* extract_frame_impl(uint8_t *video_data, size_t video_size,
+                                   double timestamp_sec, const char *img_format,
+                                   int keyframe_only, size_t *out_size) {
     *out_size = 0;
     BufferData bd;
     AVFormatContext *ifmt_ctx = NULL;
@@ -222,43 +285,13 @@ PYMEDIA_API uint8_t* extract_frame(uint8_t *video_data, size_t video_size,
     avcodec_parameters_to_context(dec_ctx, codecpar);
     if (avcodec_open2(dec_ctx, decoder, NULL) < 0) goto cleanup;
 
-    // Seek to target
-    if (timestamp_sec > 0.0) {
-        int64_t ts = (int64_t)(timestamp_sec * AV_TIME_BASE);
-        av_seek_frame(ifmt_ctx, -1, ts, AVSEEK_FLAG_BACKWARD);
-    }
-
     pkt = av_packet_alloc();
     frame = av_frame_alloc();
     if (!pkt || !frame) goto cleanup;
 
-    // Decode until we get a frame at or after the target timestamp
-    int got_frame = 0;
-    int64_t target_pts = (int64_t)(timestamp_sec *
-        av_q2d(av_inv_q(ifmt_ctx->streams[video_idx]->time_base)));
-
-    while (av_read_frame(ifmt_ctx, pkt) >= 0) {
-        if (pkt->stream_index == video_idx) {
-            if (avcodec_send_packet(dec_ctx, pkt) >= 0) {
-                if (avcodec_receive_frame(dec_ctx, frame) == 0) {
-                    got_frame = 1;
-                    if (frame->pts >= target_pts || timestamp_sec <= 0.0) {
-                        av_packet_unref(pkt);
-                        break;
-                    }
-                }
-            }
-        }
-        av_packet_unref(pkt);
-    }
-
-    // If no frame yet, flush decoder
-    if (!got_frame) {
-        avcodec_send_packet(dec_ctx, NULL);
-        if (avcodec_receive_frame(dec_ctx, frame) == 0)
-            got_frame = 1;
-    }
-    if (!got_frame) goto cleanup;
+    if (decode_frame_at(ifmt_ctx, video_idx, dec_ctx, timestamp_sec,
+                        keyframe_only, pkt, frame) < 0)
+        goto cleanup;
 
     // Convert pixel format
     int w = frame->width, h = frame->height;
@@ -274,7 +307,7 @@ PYMEDIA_API uint8_t* extract_frame(uint8_t *video_data, size_t video_size,
     rgb_frame->height = h;
     if (av_frame_get_buffer(rgb_frame, 0) < 0) goto cleanup;
 
-    sws_scale(sws, (const uint8_t *const *)frame->data, frame->linesize,
+    pm_sws_scale(sws, (const uint8_t *const *)frame->data, frame->linesize,
               0, h, rgb_frame->data, rgb_frame->linesize);
 
     // Encode frame to image
@@ -295,10 +328,10 @@ PYMEDIA_API uint8_t* extract_frame(uint8_t *video_data, size_t video_size,
     if (!enc_pkt) goto cleanup;
 
     rgb_frame->pts = 0;
-    avcodec_send_frame(enc_ctx, rgb_frame);
-    avcodec_send_frame(enc_ctx, NULL); // flush
+    pm_send_frame(enc_ctx, rgb_frame);
+    pm_send_frame(enc_ctx, NULL); // flush
 
-    if (avcodec_receive_packet(enc_ctx, enc_pkt) == 0) {
+    if (pm_receive_packet(enc_ctx, enc_pkt) == 0) {
         result = malloc(enc_pkt->size);
         if (result) {
             memcpy(result, enc_pkt->data, enc_pkt->size);
@@ -326,10 +359,41 @@ cleanup:
     return result;
 }
 
+PYMEDIA_API uint8_t* extract_frame(uint8_t *video_data, size_t video_size,
+                       double timestamp_sec, const char *img_format,
+                       size_t *out_size) {
+    return extract_frame_impl(video_data, video_size, timestamp_sec,
+                              img_format, 0, out_size);
+}
+
+// Fast variant for thumbnails/previews: returns the nearest keyframe at or
+// before `timestamp_sec` without decoding the rest of the GOP.
+PYMEDIA_API uint8_t* extract_keyframe(uint8_t *video_data, size_t video_size,
+                          double timestamp_sec, const char *img_format,
+                          size_t *out_size) {
+    return extract_frame_impl(video_data, video_size, timestamp_sec,
+                              img_format, 1, out_size);
+}
+
 // ============================================================
 // 5. reencode_video — compress / resize video (H.264 output)
 // ============================================================
 
+// Resolve requested output dimensions: <= 0 keeps the source size (both)
+// or the aspect ratio (one), and the result is made even for 4:2:0.
+static void reencode_output_size(int src_w, int src_h, int *out_width, int *out_height) {
+    if (*out_width <= 0 && *out_height <= 0) {
+        *out_width = src_w;
+        *out_height = src_h;
+    } else if (*out_width <= 0) {
+        *out_width = (int)((double)src_w / src_h * *out_height + 0.5);
+    } else if (*out_height <= 0) {
+        *out_height = (int)((double)src_h / src_w * *out_width + 0.5);
+    }
+    *out_width &= ~1;
+    *out_height &= ~1;
+}
+
 PYMEDIA_API uint8_t* reencode_video(uint8_t *video_data, size_t video_size,
                         int crf, const char *preset,
                         int out_width, int out_height,
@@ -364,19 +428,7 @@ PYMEDIA_API uint8_t* reencode_video(uint8_t *video_data, size_t video_size,
     AVCodecParameters *in_vpar = ifmt_ctx->streams[video_idx]->codecpar;
     int src_w = in_vpar->width, src_h = in_vpar->height;
 
-    // Determine output dimensions
-    if (out_width <= 0 && out_height <= 0) {
-        out_width = src_w;
-        out_height = src_h;
-    } else if (out_width <= 0) {
-        out_width = (int)((double)src_w / src_h * out_height + 0.5);
-        out_width &= ~1; // ensure even
-    } else if (out_height <= 0) {
-        out_height = (int)((double)src_h / src_w * out_width + 0.5);
-        out_height &= ~1;
-    }
-    out_width &= ~1;
-    out_height &= ~1;
+    reencode_output_size(src_w, src_h, &out_width, &out_height);
 
     // Video decoder
     const AVCodec *vdecoder = avcodec_find_decoder(in_vpar->codec_id);
@@ -466,23 +518,23 @@ PYMEDIA_API uint8_t* reencode_video(uint8_t *video_data, size_t video_size,
     if (!enc_pkt) goto cleanup;
 
     // Read, decode video / copy audio
-    while (av_read_frame(ifmt_ctx, pkt) >= 0) {
+    while (pm_read_frame(ifmt_ctx, pkt) >= 0) {
         if (pkt->stream_index == video_idx) {
-            if (avcodec_send_packet(vdec_ctx, pkt) >= 0) {
-                while (avcodec_receive_frame(vdec_ctx, dec_frame) == 0) {
+            if (pm_send_packet(vdec_ctx, pkt) >= 0) {
+                while (pm_receive_frame(vdec_ctx, dec_frame) == 0) {
                     av_frame_make_writable(scale_frame);
-                    sws_scale(sws,
+                    pm_sws_scale(sws,
                         (const uint8_t *const *)dec_frame->data,
                         dec_frame->linesize, 0, src_h,
                         scale_frame->data, scale_frame->linesize);
                     scale_frame->pts = dec_frame->pts;
 
-                    avcodec_send_frame(venc_ctx, scale_frame);
-                    while (avcodec_receive_packet(venc_ctx, enc_pkt) == 0) {
+                    pm_send_frame(venc_ctx, scale_frame);
+                    while (pm_receive_packet(venc_ctx, enc_pkt) == 0) {
                         enc_pkt->stream_index = stream_mapping[video_idx];
                         av_packet_rescale_ts(enc_pkt, venc_ctx->time_base,
                                              v_out->time_base);
-                        av_interleaved_write_frame(ofmt_ctx, enc_pkt);
+                        pm_write_frame(ofmt_ctx, enc_pkt);
                         av_packet_unref(enc_pkt);
                     }
                 }
@@ -493,33 +545,33 @@ PYMEDIA_API uint8_t* reencode_video(uint8_t *video_data, size_t video_size,
             pkt->stream_index = audio_out_idx;
             av_packet_rescale_ts(pkt, in_s->time_base, out_s->time_base);
             pkt->pos = -1;
-            av_interleaved_write_frame(ofmt_ctx, pkt);
+            pm_write_frame(ofmt_ctx, pkt);
         }
         av_packet_unref(pkt);
     }
 
     // Flush video decoder + encoder
-    avcodec_send_packet(vdec_ctx, NULL);
-    while (avcodec_receive_frame(vdec_ctx, dec_frame) == 0) {
+    pm_send_packet(vdec_ctx, NULL);
+    while (pm_receive_frame(vdec_ctx, dec_frame) == 0) {
         av_frame_make_writable(scale_frame);
-        sws_scale(sws, (const uint8_t *const *)dec_frame->data,
+        pm_sws_scale(sws, (const uint8_t *const *)dec_frame->data,
                   dec_frame->linesize, 0, src_h,
                   scale_frame->data, scale_frame->linesize);
         scale_frame->pts = dec_frame->pts;
-        avcodec_send_frame(venc_ctx, scale_frame);
-        while (avcodec_receive_packet(venc_ctx, enc_pkt) == 0) {
+        pm_send_frame(venc_ctx, scale_frame);
+        while (pm_receive_packet(venc_ctx, enc_pkt) == 0) {
             enc_pkt->stream_index = stream_mapping[video_idx];
             av_packet_rescale_ts(enc_pkt, venc_ctx->time_base,
                                  v_out->time_base);
-            av_interleaved_write_frame(ofmt_ctx, enc_pkt);
+            pm_write_frame(ofmt_ctx, enc_pkt);
             av_packet_unref(enc_pkt);
         }
     }
-    avcodec_send_frame(venc_ctx, NULL);
-    while (avcodec_receive_packet(venc_ctx, enc_pkt) == 0) {
+    pm_send_frame(venc_ctx, NULL);
+    while (pm_receive_packet(venc_ctx, enc_pkt) == 0) {
         enc_pkt->stream_index = stream_mapping[video_idx];
         av_packet_rescale_ts(enc_pkt, venc_ctx->time_base, v_out->time_base);
-        av_interleaved_write_frame(ofmt_ctx, enc_pkt);
+        pm_write_frame(ofmt_ctx, enc_pkt);
         av_packet_unref(enc_pkt);
     }
     av_packet_free(&enc_pkt);
@@ -671,23 +723,23 @@ PYMEDIA_API uint8_t* transcode_video_bitrate(uint8_t *video_data, size_t video_s
     AVPacket *enc_pkt = av_packet_alloc();
     if (!enc_pkt) goto cleanup;
 
-    while (av_read_frame(ifmt_ctx, pkt) >= 0) {
+    while (pm_read_frame(ifmt_ctx, pkt) >= 0) {
         if (pkt->stream_index == video_idx) {
-            if (avcodec_send_packet(vdec_ctx, pkt) >= 0) {
-                while (avcodec_receive_frame(vdec_ctx, dec_frame) == 0) {
+            if (pm_send_packet(vdec_ctx, pkt) >= 0) {
+                while (pm_receive_frame(vdec_ctx, dec_frame) == 0) {
                     av_frame_make_writable(scale_frame);
-                    sws_scale(sws,
+                    pm_sws_scale(sws,
                         (const uint8_t *const *)dec_frame->data,
                         dec_frame->linesize, 0, src_h,
                         scale_frame->data, scale_frame->linesize);
                     scale_frame->pts = dec_frame->pts;
 
-                    avcodec_send_frame(venc_ctx, scale_frame);
-                    while (avcodec_receive_packet(venc_ctx, enc_pkt) == 0) {
+                    pm_send_frame(venc_ctx, scale_frame);
+                    while (pm_receive_packet(venc_ctx, enc_pkt) == 0) {
                         enc_pkt->stream_index = stream_mapping[video_idx];
                         av_packet_rescale_ts(enc_pkt, venc_ctx->time_base,
                                              v_out->time_base);
-                        av_interleaved_write_frame(ofmt_ctx, enc_pkt);
+                        pm_write_frame(ofmt_ctx, enc_pkt);
                         av_packet_unref(enc_pkt);
                     }
                 }
@@ -698,32 +750,32 @@ PYMEDIA_API uint8_t* transcode_video_bitrate(uint8_t *video_data, size_t video_s
             pkt->stream_index = audio_out_idx;
             av_packet_rescale_ts(pkt, in_s->time_base, out_s->time_base);
             pkt->pos = -1;
-            av_interleaved_write_frame(ofmt_ctx, pkt);
+            pm_write_frame(ofmt_ctx, pkt);
         }
         av_packet_unref(pkt);
     }
 
-    avcodec_send_packet(vdec_ctx, NULL);
-    while (avcodec_receive_frame(vdec_ctx, dec_frame) == 0) {
+    pm_send_packet(vdec_ctx, NULL);
+    while (pm_receive_frame(vdec_ctx, dec_frame) == 0) {
         av_frame_make_writable(scale_frame);
-        sws_scale(sws, (const uint8_t *const *)dec_frame->data,
+        pm_sws_scale(sws, (const uint8_t *const *)dec_frame->data,
                   dec_frame->linesize, 0, src_h,
                   scale_frame->data, scale_frame->linesize);
         scale_frame->pts = dec_frame->pts;
-        avcodec_send_frame(venc_ctx, scale_frame);
-        while (avcodec_receive_packet(venc_ctx, enc_pkt) == 0) {
+        pm_send_frame(venc_ctx, scale_frame);
+        while (pm_receive_packet(venc_ctx, enc_pkt) == 0) {
             enc_pkt->stream_index = stream_mapping[video_idx];
             av_packet_rescale_ts(enc_pkt, venc_ctx->time_base,
                                  v_out->time_base);
-            av_interleaved_write_frame(ofmt_ctx, enc_pkt);
+            pm_write_frame(ofmt_ctx, enc_pkt);
             av_packet_unref(enc_pkt);
         }
     }
-    avcodec_send_frame(venc_ctx, NULL);
-    while (avcodec_receive_packet(venc_ctx, enc_pkt) == 0) {
+    pm_send_frame(venc_ctx, NULL);
+    while (pm_receive_packet(venc_ctx, enc_pkt) == 0) {
         enc_pkt->stream_index = stream_mapping[video_idx];
         av_packet_rescale_ts(enc_pkt, venc_ctx->time_base, v_out->time_base);
-        av_interleaved_write_frame(ofmt_ctx, enc_pkt);
+        pm_write_frame(ofmt_ctx, enc_pkt);
         av_packet_unref(enc_pkt);
     }
     av_packet_free(&enc_pkt);
@@ -909,12 +961,12 @@ PYMEDIA_API uint8_t* crop_video(uint8_t *video_data, size_t video_size,
     AVPacket *enc_pkt = av_packet_alloc();
     if (!enc_pkt) goto cleanup;
 
-    while (av_read_frame(ifmt_ctx, pkt) >= 0) {
+    while (pm_read_frame(ifmt_ctx, pkt) >= 0) {
         if (pkt->stream_index == video_idx) {
-            if (avcodec_send_packet(vdec_ctx, pkt) >= 0) {
-                while (avcodec_receive_frame(vdec_ctx, dec_frame) == 0) {
+            if (pm_send_packet(vdec_ctx, pkt) >= 0) {
+                while (pm_receive_frame(vdec_ctx, dec_frame) == 0) {
                     av_frame_make_writable(full_frame);
-                    sws_scale(sws_full,
+                    pm_sws_scale(sws_full,
                               (const uint8_t *const *)dec_frame->data,
                               dec_frame->linesize, 0, src_h,
                               full_frame->data, full_frame->linesize);
@@ -929,16 +981,16 @@ PYMEDIA_API uint8_t* crop_video(uint8_t *video_data, size_t video_size,
                     crop_linesize[2] = full_frame->linesize[2];
 
                     av_frame_make_writable(crop_frame);
-                    sws_scale(sws_crop,
+                    pm_sws_scale(sws_crop,
                               crop_data, crop_linesize, 0, crop_h,
                               crop_frame->data, crop_frame->linesize);
                     crop_frame->pts = dec_frame->pts;
 
-                    avcodec_send_frame(venc_ctx, crop_frame);
-                    while (avcodec_receive_packet(venc_ctx, enc_pkt) == 0) {
+                    pm_send_frame(venc_ctx, crop_frame);
+                    while (pm_receive_packet(venc_ctx, enc_pkt) == 0) {
                         enc_pkt->stream_index = stream_mapping[video_idx];
                         av_packet_rescale_ts(enc_pkt, venc_ctx->time_base, v_out->time_base);
-                        av_interleaved_write_frame(ofmt_ctx, enc_pkt);
+                        pm_write_frame(ofmt_ctx, enc_pkt);
                         av_packet_unref(enc_pkt);
                     }
                 }
@@ -949,15 +1001,15 @@ PYMEDIA_API uint8_t* crop_video(uint8_t *video_data, size_t video_size,
             pkt->stream_index = audio_out_idx;
             av_packet_rescale_ts(pkt, in_s->time_base, out_s->time_base);
             pkt->pos = -1;
-            av_interleaved_write_frame(ofmt_ctx, pkt);
+            pm_write_frame(ofmt_ctx, pkt);
         }
         av_packet_unref(pkt);
     }
 
-    avcodec_send_packet(vdec_ctx, NULL);
-    while (avcodec_receive_frame(vdec_ctx, dec_frame) == 0) {
+    pm_send_packet(vdec_ctx, NULL);
+    while (pm_receive_frame(vdec_ctx, dec_frame) == 0) {
         av_frame_make_writable(full_frame);
-        sws_scale(sws_full,
+        pm_sws_scale(sws_full,
                   (const uint8_t *const *)dec_frame->data,
                   dec_frame->linesize, 0, src_h,
                   full_frame->data, full_frame->linesize);
@@ -972,24 +1024,24 @@ PYMEDIA_API uint8_t* crop_video(uint8_t *video_data, size_t video_size,
         crop_linesize[2] = full_frame->linesize[2];
 
         av_frame_make_writable(crop_frame);
-        sws_scale(sws_crop,
+        pm_sws_scale(sws_crop,
                   crop_data, crop_linesize, 0, crop_h,
                   crop_frame->data, crop_frame->linesize);
         crop_frame->pts = dec_frame->pts;
 
-        avcodec_send_frame(venc_ctx, crop_frame);
-        while (avcodec_receive_packet(venc_ctx, enc_pkt) == 0) {
+        pm_send_frame(venc_ctx, crop_frame);
+        while (pm_receive_packet(venc_ctx, enc_pkt) == 0) {
             enc_pkt->stream_index = stream_mapping[video_idx];
             av_packet_rescale_ts(enc_pkt, venc_ctx->time_base, v_out->time_base);
-            av_interleaved_write_frame(ofmt_ctx, enc_pkt);
+            pm_write_frame(ofmt_ctx, enc_pkt);
             av_packet_unref(enc_pkt);
         }
     }
-    avcodec_send_frame(venc_ctx, NULL);
-    while (avcodec_receive_packet(venc_ctx, enc_pkt) == 0) {
+    pm_send_frame(venc_ctx, NULL);
+    while (pm_receive_packet(venc_ctx, enc_pkt) == 0) {
         enc_pkt->stream_index = stream_mapping[video_idx];
         av_packet_rescale_ts(enc_pkt, venc_ctx->time_base, v_out->time_base);
-        av_interleaved_write_frame(ofmt_ctx, enc_pkt);
+        pm_write_frame(ofmt_ctx, enc_pkt);
         av_packet_unref(enc_pkt);
     }
     av_packet_free(&enc_pkt);
@@ -1149,23 +1201,23 @@ PYMEDIA_API uint8_t* change_fps(uint8_t *video_data, size_t video_size,
     int64_t in_frames = 0;
     int64_t out_frames = 0;
 
-    while (av_read_frame(ifmt_ctx, pkt) >= 0) {
+    while (pm_read_frame(ifmt_ctx, pkt) >= 0) {
         if (pkt->stream_index == video_idx) {
-            if (avcodec_send_packet(vdec_ctx, pkt) >= 0) {
-                while (avcodec_receive_frame(vdec_ctx, dec_frame) == 0) {
+            if (pm_send_packet(vdec_ctx, pkt) >= 0) {
+                while (pm_receive_frame(vdec_ctx, dec_frame) == 0) {
                     av_frame_make_writable(yuv_frame);
-                    sws_scale(sws, (const uint8_t *const *)dec_frame->data,
+                    pm_sws_scale(sws, (const uint8_t *const *)dec_frame->data,
                               dec_frame->linesize, 0, src_h,
                               yuv_frame->data, yuv_frame->linesize);
                     in_frames++;
                     int64_t should_have = (int64_t)floor((double)in_frames * ratio + 1e-9);
                     while (out_frames < should_have) {
                         yuv_frame->pts = out_frames;
-                        avcodec_send_frame(venc_ctx, yuv_frame);
-                        while (avcodec_receive_packet(venc_ctx, enc_pkt) == 0) {
+                        pm_send_frame(venc_ctx, yuv_frame);
+                        while (pm_receive_packet(venc_ctx, enc_pkt) == 0) {
                             enc_pkt->stream_index = stream_mapping[video_idx];
                             av_packet_rescale_ts(enc_pkt, venc_ctx->time_base, v_out->time_base);
-                            av_interleaved_write_frame(ofmt_ctx, enc_pkt);
+                            pm_write_frame(ofmt_ctx, enc_pkt);
                             av_packet_unref(enc_pkt);
                         }
                         out_frames++;
@@ -1178,37 +1230,37 @@ PYMEDIA_API uint8_t* change_fps(uint8_t *video_data, size_t video_size,
             pkt->stream_index = audio_out_idx;
             av_packet_rescale_ts(pkt, in_s->time_base, out_s->time_base);
             pkt->pos = -1;
-            av_interleaved_write_frame(ofmt_ctx, pkt);
+            pm_write_frame(ofmt_ctx, pkt);
         }
         av_packet_unref(pkt);
     }
 
-    avcodec_send_packet(vdec_ctx, NULL);
-    while (avcodec_receive_frame(vdec_ctx, dec_frame) == 0) {
+    pm_send_packet(vdec_ctx, NULL);
+    while (pm_receive_frame(vdec_ctx, dec_frame) == 0) {
         av_frame_make_writable(yuv_frame);
-        sws_scale(sws, (const uint8_t *const *)dec_frame->data,
+        pm_sws_scale(sws, (const uint8_t *const *)dec_frame->data,
                   dec_frame->linesize, 0, src_h,
                   yuv_frame->data, yuv_frame->linesize);
         in_frames++;
         int64_t should_have = (int64_t)floor((double)in_frames * ratio + 1e-9);
         while (out_frames < should_have) {
             yuv_frame->pts = out_frames;
-            avcodec_send_frame(venc_ctx, yuv_frame);
-            while (avcodec_receive_packet(venc_ctx, enc_pkt) == 0) {
+            pm_send_frame(venc_ctx, yuv_frame);
+            while (pm_receive_packet(venc_ctx, enc_pkt) == 0) {
                 enc_pkt->stream_index = stream_mapping[video_idx];
                 av_packet_rescale_ts(enc_pkt, venc_ctx->time_base, v_out->time_base);
-                av_interleaved_write_frame(ofmt_ctx, enc_pkt);
+                pm_write_frame(ofmt_ctx, enc_pkt);
                 av_packet_unref(enc_pkt);
             }
             out_frames++;
         }
     }
 
-    avcodec_send_frame(venc_ctx, NULL);
-    while (avcodec_receive_packet(venc_ctx, enc_pkt) == 0) {
+    pm_send_frame(venc_ctx, NULL);
+    while (pm_receive_packet(venc_ctx, enc_pkt) == 0) {
         enc_pkt->stream_index = stream_mapping[video_idx];
         av_packet_rescale_ts(enc_pkt, venc_ctx->time_base, v_out->time_base);
-        av_interleaved_write_frame(ofmt_ctx, enc_pkt);
+        pm_write_frame(ofmt_ctx, enc_pkt);
         av_packet_unref(enc_pkt);
     }
 
@@ -1373,12 +1425,12 @@ PYMEDIA_API uint8_t* pad_video(uint8_t *video_data, size_t video_size,
     pad_frame->height = out_height;
     if (av_frame_get_buffer(pad_frame, 0) < 0) goto cleanup;
 
-    while (av_read_frame(ifmt_ctx, pkt) >= 0) {
+    while (pm_read_frame(ifmt_ctx, pkt) >= 0) {
         if (pkt->stream_index == video_idx) {
-            if (avcodec_send_packet(vdec_ctx, pkt) >= 0) {
-                while (avcodec_receive_frame(vdec_ctx, dec_frame) == 0) {
+            if (pm_send_packet(vdec_ctx, pkt) >= 0) {
+                while (pm_receive_frame(vdec_ctx, dec_frame) == 0) {
                     av_frame_make_writable(src_frame);
-                    sws_scale(sws, (const uint8_t *const *)dec_frame->data,
+                    pm_sws_scale(sws, (const uint8_t *const *)dec_frame->data,
                               dec_frame->linesize, 0, src_h,
                               src_frame->data, src_frame->linesize);
 
@@ -1399,11 +1451,11 @@ PYMEDIA_API uint8_t* pad_video(uint8_t *video_data, size_t video_size,
                     }
                     pad_frame->pts = dec_frame->pts;
 
-                    avcodec_send_frame(venc_ctx, pad_frame);
-                    while (avcodec_receive_packet(venc_ctx, enc_pkt) == 0) {
+                    pm_send_frame(venc_ctx, pad_frame);
+                    while (pm_receive_packet(venc_ctx, enc_pkt) == 0) {
                         enc_pkt->stream_index = stream_mapping[video_idx];
                         av_packet_rescale_ts(enc_pkt, venc_ctx->time_base, v_out->time_base);
-                        av_interleaved_write_frame(ofmt_ctx, enc_pkt);
+                        pm_write_frame(ofmt_ctx, enc_pkt);
                         av_packet_unref(enc_pkt);
                     }
                 }
@@ -1414,15 +1466,15 @@ PYMEDIA_API uint8_t* pad_video(uint8_t *video_data, size_t video_size,
             pkt->stream_index = audio_out_idx;
             av_packet_rescale_ts(pkt, in_s->time_base, out_s->time_base);
             pkt->pos = -1;
-            av_interleaved_write_frame(ofmt_ctx, pkt);
+            pm_write_frame(ofmt_ctx, pkt);
         }
         av_packet_unref(pkt);
     }
 
-    avcodec_send_packet(vdec_ctx, NULL);
-    while (avcodec_receive_frame(vdec_ctx, dec_frame) == 0) {
+    pm_send_packet(vdec_ctx, NULL);
+    while (pm_receive_frame(vdec_ctx, dec_frame) == 0) {
         av_frame_make_writable(src_frame);
-        sws_scale(sws, (const uint8_t *const *)dec_frame->data,
+        pm_sws_scale(sws, (const uint8_t *const *)dec_frame->data,
                   dec_frame->linesize, 0, src_h,
                   src_frame->data, src_frame->linesize);
 
@@ -1443,20 +1495,20 @@ PYMEDIA_API uint8_t* pad_video(uint8_t *video_data, size_t video_size,
         }
         pad_frame->pts = dec_frame->pts;
 
-        avcodec_send_frame(venc_ctx, pad_frame);
-        while (avcodec_receive_packet(venc_ctx, enc_pkt) == 0) {
+        pm_send_frame(venc_ctx, pad_frame);
+        while (pm_receive_packet(venc_ctx, enc_pkt) == 0) {
             enc_pkt->stream_index = stream_mapping[video_idx];
             av_packet_rescale_ts(enc_pkt, venc_ctx->time_base, v_out->time_base);
-            av_interleaved_write_frame(ofmt_ctx, enc_pkt);
+            pm_write_frame(ofmt_ctx, enc_pkt);
             av_packet_unref(enc_pkt);
         }
     }
 
-    avcodec_send_frame(venc_ctx, NULL);
-    while (avcodec_receive_packet(venc_ctx, enc_pkt) == 0) {
+    pm_send_frame(venc_ctx, NULL);
+    while (pm_receive_packet(venc_ctx, enc_pkt) == 0) {
         enc_pkt->stream_index = stream_mapping[video_idx];
         av_packet_rescale_ts(enc_pkt, venc_ctx->time_base, v_out->time_base);
-        av_interleaved_write_frame(ofmt_ctx, enc_pkt);
+        pm_write_frame(ofmt_ctx, enc_pkt);
         av_packet_unref(enc_pkt);
     }
 
@@ -1610,12 +1662,12 @@ PYMEDIA_API uint8_t* flip_video(uint8_t *video_data, size_t video_size,
     flip_frame->height = src_h;
     if (av_frame_get_buffer(flip_frame, 0) < 0) goto cleanup;
 
-    while (av_read_frame(ifmt_ctx, pkt) >= 0) {
+    while (pm_read_frame(ifmt_ctx, pkt) >= 0) {
         if (pkt->stream_index == video_idx) {
-            if (avcodec_send_packet(vdec_ctx, pkt) >= 0) {
-                while (avcodec_receive_frame(vdec_ctx, dec_frame) == 0) {
+            if (pm_send_packet(vdec_ctx, pkt) >= 0) {
+                while (pm_receive_frame(vdec_ctx, dec_frame) == 0) {
                     av_frame_make_writable(src_frame);
-                    sws_scale(sws, (const uint8_t *const *)dec_frame->data,
+                    pm_sws_scale(sws, (const uint8_t *const *)dec_frame->data,
                               dec_frame->linesize, 0, src_h,
                               src_frame->data, src_frame->linesize);
 
@@ -1623,11 +1675,11 @@ PYMEDIA_API uint8_t* flip_video(uint8_t *video_data, size_t video_size,
                     flip_yuv420_frame(flip_frame, src_frame, src_w, src_h, horizontal, vertical);
                     flip_frame->pts = dec_frame->pts;
 
-                    avcodec_send_frame(venc_ctx, flip_frame);
-                    while (avcodec_receive_packet(venc_ctx, enc_pkt) == 0) {
+                    pm_send_frame(venc_ctx, flip_frame);
+                    while (pm_receive_packet(venc_ctx, enc_pkt) == 0) {
                         enc_pkt->stream_index = stream_mapping[video_idx];
                         av_packet_rescale_ts(enc_pkt, venc_ctx->time_base, v_out->time_base);
-                        av_interleaved_write_frame(ofmt_ctx, enc_pkt);
+                        pm_write_frame(ofmt_ctx, enc_pkt);
                         av_packet_unref(enc_pkt);
                     }
                 }
@@ -1638,15 +1690,15 @@ PYMEDIA_API uint8_t* flip_video(uint8_t *video_data, size_t video_size,
             pkt->stream_index = audio_out_idx;
             av_packet_rescale_ts(pkt, in_s->time_base, out_s->time_base);
             pkt->pos = -1;
-            av_interleaved_write_frame(ofmt_ctx, pkt);
+            pm_write_frame(ofmt_ctx, pkt);
         }
         av_packet_unref(pkt);
     }
 
-    avcodec_send_packet(vdec_ctx, NULL);
-    while (avcodec_receive_frame(vdec_ctx, dec_frame) == 0) {
+    pm_send_packet(vdec_ctx, NULL);
+    while (pm_receive_frame(vdec_ctx, dec_frame) == 0) {
         av_frame_make_writable(src_frame);
-        sws_scale(sws, (const uint8_t *const *)dec_frame->data,
+        pm_sws_scale(sws, (const uint8_t *const *)dec_frame->data,
                   dec_frame->linesize, 0, src_h,
                   src_frame->data, src_frame->linesize);
 
@@ -1654,20 +1706,20 @@ PYMEDIA_API uint8_t* flip_video(uint8_t *video_data, size_t video_size,
         flip_yuv420_frame(flip_frame, src_frame, src_w, src_h, horizontal, vertical);
         flip_frame->pts = dec_frame->pts;
 
-        avcodec_send_frame(venc_ctx, flip_frame);
-        while (avcodec_receive_packet(venc_ctx, enc_pkt) == 0) {
+        pm_send_frame(venc_ctx, flip_frame);
+        while (pm_receive_packet(venc_ctx, enc_pkt) == 0) {
             enc_pkt->stream_index = stream_mapping[video_idx];
             av_packet_rescale_ts(enc_pkt, venc_ctx->time_base, v_out->time_base);
-            av_interleaved_write_frame(ofmt_ctx, enc_pkt);
+            pm_write_frame(ofmt_ctx, enc_pkt);
             av_packet_unref(enc_pkt);
         }
     }
 
-    avcodec_send_frame(venc_ctx, NULL);
-    while (avcodec_receive_packet(venc_ctx, enc_pkt) == 0) {
+    pm_send_frame(venc_ctx, NULL);
+    while (pm_receive_packet(venc_ctx, enc_pkt) == 0) {
         enc_pkt->stream_index = stream_mapping[video_idx];
         av_packet_rescale_ts(enc_pkt, venc_ctx->time_base, v_out->time_base);
-        av_interleaved_write_frame(ofmt_ctx, enc_pkt);
+        pm_write_frame(ofmt_ctx, enc_pkt);
         av_packet_unref(enc_pkt);
     }
 
@@ -53,13 +53,13 @@ PYMEDIA_API uint8_t* add_watermark(uint8_t *video_data, size_t video_size,
         if (!w_pkt || !wm_dec) goto cleanup;
 
         int found_wm = 0;
-        while (av_read_frame(wfmt_ctx, w_pkt) >= 0) {
+        while (pm_read_frame(wfmt_ctx, w_pkt) >= 0) {
             if (w_pkt->stream_index != wm_video_idx) {
                 av_packet_unref(w_pkt);
                 continue;
             }
-            if (avcodec_send_packet(wdec_ctx, w_pkt) >= 0 &&
-                avcodec_receive_frame(wdec_ctx, wm_dec) == 0) {
+            if (pm_send_packet(wdec_ctx, w_pkt) >= 0 &&
+                pm_receive_frame(wdec_ctx, wm_dec) == 0) {
                 found_wm = 1;
                 av_packet_unref(w_pkt);
                 break;
@@ -82,7 +82,7 @@ PYMEDIA_API uint8_t* add_watermark(uint8_t *video_data, size_t video_size,
 
         uint8_t *dst_data[4] = {wm_rgba, NULL, NULL, NULL};
         int dst_linesize[4] = {wm_linesize, 0, 0, 0};
-        sws_scale(sws_wm_to_rgba,
+        pm_sws_scale(sws_wm_to_rgba,
                   (const uint8_t *const *)wm_dec->data, wm_dec->linesize,
                   0, wm_h, dst_data, dst_linesize);
     }
@@ -175,12 +175,12 @@ PYMEDIA_API uint8_t* add_watermark(uint8_t *video_data, size_t video_size,
     AVPacket *enc_pkt = av_packet_alloc();
     if (!enc_pkt) goto cleanup;
 
-    while (av_read_frame(ifmt_ctx, pkt) >= 0) {
+    while (pm_read_frame(ifmt_ctx, pkt) >= 0) {
         if (pkt->stream_index == video_idx) {
-            if (avcodec_send_packet(vdec_ctx, pkt) >= 0) {
-                while (avcodec_receive_frame(vdec_ctx, dec_frame) == 0) {
+            if (pm_send_packet(vdec_ctx, pkt) >= 0) {
+                while (pm_receive_frame(vdec_ctx, dec_frame) == 0) {
                     av_frame_make_writable(rgba_frame);
-                    sws_scale(sws_dec_to_rgba,
+                    pm_sws_scale(sws_dec_to_rgba,
                               (const uint8_t *const *)dec_frame->data, dec_frame->linesize,
                               0, src_h, rgba_frame->data, rgba_frame->linesize);
 
@@ -188,16 +188,16 @@ PYMEDIA_API uint8_t* add_watermark(uint8_t *video_data, size_t video_size,
                                        pos_x, pos_y, opacity);
 
                     av_frame_make_writable(yuv_frame);
-                    sws_scale(sws_rgba_to_yuv,
+                    pm_sws_scale(sws_rgba_to_yuv,
                               (const uint8_t *const *)rgba_frame->data, rgba_frame->linesize,
                               0, src_h, yuv_frame->data, yuv_frame->linesize);
                     yuv_frame->pts = dec_frame->pts;
 
-                    avcodec_send_frame(venc_ctx, yuv_frame);
-                    while (avcodec_receive_packet(venc_ctx, enc_pkt) == 0) {
+                    pm_send_frame(venc_ctx, yuv_frame);
+                    while (pm_receive_packet(venc_ctx, enc_pkt) == 0) {
                         enc_pkt->stream_index = stream_mapping[video_idx];
                         av_packet_rescale_ts(enc_pkt, venc_ctx->time_base, v_out->time_base);
-                        av_interleaved_write_frame(ofmt_ctx, enc_pkt);
+                        pm_write_frame(ofmt_ctx, enc_pkt);
                         av_packet_unref(enc_pkt);
                     }
                 }
@@ -208,38 +208,38 @@ PYMEDIA_API uint8_t* add_watermark(uint8_t *video_data, size_t video_size,
             pkt->stream_index = audio_out_idx;
             av_packet_rescale_ts(pkt, in_s->time_base, out_s->time_base);
             pkt->pos = -1;
-            av_interleaved_write_frame(ofmt_ctx, pkt);
+            pm_write_frame(ofmt_ctx, pkt);
         }
         av_packet_unref(pkt);
     }
 
-    avcodec_send_packet(vdec_ctx, NULL);
-    while (avcodec_receive_frame(vdec_ctx, dec_frame) == 0) {
+    pm_send_packet(vdec_ctx, NULL);
+    while (pm_receive_frame(vdec_ctx, dec_frame) == 0) {
         av_frame_make_writable(rgba_frame);
-        sws_scale(sws_dec_to_rgba,
+        pm_sws_scale(sws_dec_to_rgba,
                   (const uint8_t *const *)dec_frame->data, dec_frame->linesize,
                   0, src_h, rgba_frame->data, rgba_frame->linesize);
         blend_rgba_overlay(rgba_frame, wm_rgba, wm_w, wm_h, wm_linesize,
                            pos_x, pos_y, opacity);
         av_frame_make_writable(yuv_frame);
-        sws_scale(sws_rgba_to_yuv,
+        pm_sws_scale(sws_rgba_to_yuv,
                   (const uint8_t *const *)rgba_frame->data, rgba_frame->linesize,
                   0, src_h, yuv_frame->data, yuv_frame->linesize);
         yuv_frame->pts = dec_frame->pts;
 
-        avcodec_send_frame(venc_ctx, yuv_frame);
-        while (avcodec_receive_packet(venc_ctx, enc_pkt) == 0) {
+        pm_send_frame(venc_ctx, yuv_frame);
+        while (pm_receive_packet(venc_ctx, enc_pkt) == 0) {
             enc_pkt->stream_index = stream_mapping[video_idx];
             av_packet_rescale_ts(enc_pkt, venc_ctx->time_base, v_out->time_base);
-            av_interleaved_write_frame(ofmt_ctx, enc_pkt);
+            pm_write_frame(ofmt_ctx, enc_pkt);
             av_packet_unref(enc_pkt);
         }
     }
-    avcodec_send_frame(venc_ctx, NULL);
-    while (avcodec_receive_packet(venc_ctx, enc_pkt) == 0) {
+    pm_send_frame(venc_ctx, NULL);
+    while (pm_receive_packet(venc_ctx, enc_pkt) == 0) {
         enc_pkt->stream_index = stream_mapping[video_idx];
         av_packet_rescale_ts(enc_pkt, venc_ctx->time_base, v_out->time_base);
-        av_interleaved_write_frame(ofmt_ctx, enc_pkt);
+        pm_write_frame(ofmt_ctx, enc_pkt);
         av_packet_unref(enc_pkt);
     }
     av_packet_free(&enc_pkt);
@@ -391,7 +391,7 @@ PYMEDIA_API uint8_t* video_to_gif(uint8_t *video_data, size_t video_size,
     if (frame_interval < 1.0) frame_interval = 1.0;
     int64_t decoded_count = 0;
 
-    while (av_read_frame(ifmt_ctx, pkt) >= 0) {
+    while (pm_read_frame(ifmt_ctx, pkt) >= 0) {
         if (pkt->stream_index != video_idx) {
             av_packet_unref(pkt);
             continue;
@@ -403,8 +403,8 @@ PYMEDIA_API uint8_t* video_to_gif(uint8_t *video_data, size_t video_size,
             ? pkt->pts * av_q2d(vs->time_base) : 0;
         if (pkt_time > end_sec) { av_packet_unref(pkt); break; }
 
-        if (avcodec_send_packet(vdec_ctx, pkt) >= 0) {
-            while (avcodec_receive_frame(vdec_ctx, dec_frame) == 0) {
+        if (pm_send_packet(vdec_ctx, pkt) >= 0) {
+            while (pm_receive_frame(vdec_ctx, dec_frame) == 0) {
                 double frame_time = dec_frame->pts * av_q2d(vs->time_base);
                 if (frame_time < start_sec) continue;
                 if (frame_time > end_sec) break;
@@ -417,18 +417,18 @@ PYMEDIA_API uint8_t* video_to_gif(uint8_t *video_data, size_t video_size,
                 decoded_count++;
 
                 av_frame_make_writable(gif_frame);
-                sws_scale(sws,
+                pm_sws_scale(sws,
                     (const uint8_t *const *)dec_frame->data,
                     dec_frame->linesize, 0, src_h,
                     gif_frame->data, gif_frame->linesize);
                 gif_frame->pts = frame_count++;
 
-                avcodec_send_frame(gif_enc_ctx, gif_frame);
-                while (avcodec_receive_packet(gif_enc_ctx, enc_pkt) == 0) {
+                pm_send_frame(gif_enc_ctx, gif_frame);
+                while (pm_receive_packet(gif_enc_ctx, enc_pkt) == 0) {
                     enc_pkt->stream_index = 0;
                     av_packet_rescale_ts(enc_pkt, gif_enc_ctx->time_base,
                                          gif_stream->time_base);
-                    av_interleaved_write_frame(ofmt_ctx, enc_pkt);
+                    pm_write_frame(ofmt_ctx, enc_pkt);
                     av_packet_unref(enc_pkt);
                 }
             }
@@ -437,12 +437,12 @@ PYMEDIA_API uint8_t* video_to_gif(uint8_t *video_data, size_t video_size,
     }
 
     // Flush encoder
-    avcodec_send_frame(gif_enc_ctx, NULL);
-    while (avcodec_receive_packet(gif_enc_ctx, enc_pkt) == 0) {
+    pm_send_frame(gif_enc_ctx, NULL);
+    while (pm_receive_packet(gif_enc_ctx, enc_pkt) == 0) {
         enc_pkt->stream_index = 0;
         av_packet_rescale_ts(enc_pkt, gif_enc_ctx->time_base,
                              gif_stream->time_base);
-        av_interleaved_write_frame(ofmt_ctx, enc_pkt);
+        pm_write_frame(ofmt_ctx, enc_pkt);
         av_packet_unref(enc_pkt);
     }
     av_packet_free(&enc_pkt);
@@ -640,24 +640,24 @@ PYMEDIA_API uint8_t* rotate_video(uint8_t *video_data, size_t video_size,
     yuv_frame->width = src_w; yuv_frame->height = src_h;
     if (av_frame_get_buffer(yuv_frame, 0) < 0) goto cleanup;
 
-    while (av_read_frame(ifmt_ctx, pkt) >= 0) {
+    while (pm_read_frame(ifmt_ctx, pkt) >= 0) {
         if (pkt->stream_index == video_idx) {
-            if (avcodec_send_packet(vdec_ctx, pkt) >= 0) {
-                while (avcodec_receive_frame(vdec_ctx, dec_frame) == 0) {
+            if (pm_send_packet(vdec_ctx, pkt) >= 0) {
+                while (pm_receive_frame(vdec_ctx, dec_frame) == 0) {
                     av_frame_make_writable(yuv_frame);
-                    sws_scale(sws, (const uint8_t *const *)dec_frame->data,
+                    pm_sws_scale(sws, (const uint8_t *const *)dec_frame->data,
                               dec_frame->linesize, 0, src_h,
                               yuv_frame->data, yuv_frame->linesize);
                     yuv_frame->pts = dec_frame->pts;
                     rot_frame = rotate_yuv420p_frame(yuv_frame, angle);
                     if (!rot_frame) continue;
                     rot_frame->pts = yuv_frame->pts;
-                    avcodec_send_frame(venc_ctx, rot_frame);
+                    pm_send_frame(venc_ctx, rot_frame);
                     av_frame_free(&rot_frame); rot_frame = NULL;
-                    while (avcodec_receive_packet(venc_ctx, enc_pkt) == 0) {
+                    while (pm_receive_packet(venc_ctx, enc_pkt) == 0) {
                         enc_pkt->stream_index = stream_mapping[video_idx];
                         av_packet_rescale_ts(enc_pkt, venc_ctx->time_base, v_out->time_base);
-                        av_interleaved_write_frame(ofmt_ctx, enc_pkt);
+                        pm_write_frame(ofmt_ctx, enc_pkt);
                         av_packet_unref(enc_pkt);
                     }
                 }
@@ -667,34 +667,34 @@ PYMEDIA_API uint8_t* rotate_video(uint8_t *video_data, size_t video_size,
             av_packet_rescale_ts(pkt, ifmt_ctx->streams[audio_idx]->time_base,
                                  ofmt_ctx->streams[audio_out_idx]->time_base);
             pkt->pos = -1;
-            av_interleaved_write_frame(ofmt_ctx, pkt);
+            pm_write_frame(ofmt_ctx, pkt);
         }
         av_packet_unref(pkt);
     }
-    avcodec_send_packet(vdec_ctx, NULL);
-    while (avcodec_receive_frame(vdec_ctx, dec_frame) == 0) {
+    pm_send_packet(vdec_ctx, NULL);
+    while (pm_receive_frame(vdec_ctx, dec_frame) == 0) {
         av_frame_make_writable(yuv_frame);
-        sws_scale(sws, (const uint8_t *const *)dec_frame->data,
+        pm_sws_scale(sws, (const uint8_t *const *)dec_frame->data,
                   dec_frame->linesize, 0, src_h, yuv_frame->data, yuv_frame->linesize);
         yuv_frame->pts = dec_frame->pts;
         rot_frame = rotate_yuv420p_frame(yuv_frame, angle);
         if (rot_frame) {
             rot_frame->pts = yuv_frame->pts;
-            avcodec_send_frame(venc_ctx, rot_frame);
+            pm_send_frame(venc_ctx, rot_frame);
             av_frame_free(&rot_frame); rot_frame = NULL;
         }
-        while (avcodec_receive_packet(venc_ctx, enc_pkt) == 0) {
+        while (pm_receive_packet(venc_ctx, enc_pkt) == 0) {
             enc_pkt->stream_index = stream_mapping[video_idx];
             av_packet_rescale_ts(enc_pkt, venc_ctx->time_base, v_out->time_base);
-            av_interleaved_write_frame(ofmt_ctx, enc_pkt);
+            pm_write_frame(ofmt_ctx, enc_pkt);
             av_packet_unref(enc_pkt);
         }
     }
-    avcodec_send_frame(venc_ctx, NULL);
-    while (avcodec_receive_packet(venc_ctx, enc_pkt) == 0) {
+    pm_send_frame(venc_ctx, NULL);
+    while (pm_receive_packet(venc_ctx, enc_pkt) == 0) {
         enc_pkt->stream_index = stream_mapping[video_idx];
         av_packet_rescale_ts(enc_pkt, venc_ctx->time_base, v_out->time_base);
-        av_interleaved_write_frame(ofmt_ctx, enc_pkt);
+        pm_write_frame(ofmt_ctx, enc_pkt);
         av_packet_unref(enc_pkt);
     }
 
@@ -728,12 +728,13 @@ cleanup:
 }
 
 // ============================================================
-// 8. change_speed — speed up or slow down (PTS rescaling)
+// 8. change_speed — PTS rescaling of every packet; used by change_speed
+// (time_stretch.c) for inputs without decodable audio
 // speed > 1.0 = faster, speed < 1.0 = slower
 // ============================================================
 
-PYMEDIA_API uint8_t* change_speed(uint8_t *video_data, size_t video_size,
-                      double speed, size_t *out_size) {
+static uint8_t *retime_packets(uint8_t *video_data, size_t video_size,
+                               double speed, size_t *out_size) {
     *out_size = 0;
     if (speed <= 0.0) return NULL;
 
@@ -772,7 +773,7 @@ PYMEDIA_API uint8_t* change_speed(uint8_t *video_data, size_t video_size,
     pkt = av_packet_alloc();
     if (!pkt) goto cleanup;
 
-    while (av_read_frame(ifmt_ctx, pkt) >= 0) {
+    while (pm_read_frame(ifmt_ctx, pkt) >= 0) {
         int si = pkt->stream_index;
         if (si < 0 || (unsigned)si >= ifmt_ctx->nb_streams || stream_mapping[si] < 0) {
             av_packet_unref(pkt); continue;
@@ -788,7 +789,7 @@ PYMEDIA_API uint8_t* change_speed(uint8_t *video_data, size_t video_size,
         pkt->stream_index = out_si;
         av_packet_rescale_ts(pkt, in_s->time_base, out_s->time_base);
         pkt->pos = -1;
-        av_interleaved_write_frame(ofmt_ctx, pkt);
+        pm_write_frame(ofmt_ctx, pkt);
         av_packet_unref(pkt);
     }
 
@@ -899,7 +900,7 @@ PYMEDIA_API uint8_t* replace_audio(uint8_t *video_data, size_t video_size,
             vpkt->stream_index = v_out->index;
             av_packet_rescale_ts(vpkt, v_ifmt->streams[video_idx]->time_base, v_out->time_base);
             vpkt->pos = -1;
-            av_interleaved_write_frame(ofmt_ctx, vpkt);
+            pm_write_frame(ofmt_ctx, vpkt);
             av_packet_unref(vpkt);
             got_v = read_next_stream_packet(v_ifmt, video_idx, vpkt);
             if (got_v < 0) goto cleanup;
@@ -924,7 +925,7 @@ PYMEDIA_API uint8_t* replace_audio(uint8_t *video_data, size_t video_size,
                 apkt->stream_index = a_out->index;
                 av_packet_rescale_ts(apkt, a_ifmt->streams[audio_idx]->time_base, a_out->time_base);
                 apkt->pos = -1;
-                av_interleaved_write_frame(ofmt_ctx, apkt);
+                pm_write_frame(ofmt_ctx, apkt);
             }
             av_packet_unref(apkt);
             got_a = read_next_stream_packet(a_ifmt, audio_idx, apkt);
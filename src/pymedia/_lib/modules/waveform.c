@@ -0,0 +1,255 @@
+// ============================================================
+// waveform — multi-resolution min/max peak pyramids in the
+// audiowaveform .dat (version 1) layout
+// ============================================================
+
+#define PEAKS_MAX_LEVELS 16
+#define PEAKS_DAT_HEADER 20
+
+// ---------- kernels ----------
+
+// Running min/max of x[0..n) folded into *lo / *hi.
+static void dsp_min_max(const float *x, int n, float *lo, float *hi) {
+    float mn = *lo, mx = *hi;
+    int i = 0;
+#ifdef PM_HAVE_SSE2
+    if (n >= 4) {
+        __m128 vmn = _mm_set1_ps(mn), vmx = _mm_set1_ps(mx);
+        for (; i + 4 <= n; i += 4) {
+            __m128 v = _mm_loadu_ps(x + i);
+            vmn = _mm_min_ps(vmn, v);
+            vmx = _mm_max_ps(vmx, v);
+        }
+        float a[4], b[4];
+        _mm_storeu_ps(a, vmn);
+        _mm_storeu_ps(b, vmx);
+        for (int k = 0; k < 4; k++) {
+            if (a[k] < mn) mn = a[k];
+            if (b[k] > mx) mx = b[k];
+        }
+    }
+#endif
+    for (; i < n; i++) {
+        if (x[i] < mn) mn = x[i];
+        if (x[i] > mx) mx = x[i];
+    }
+    *lo = mn;
+    *hi = mx;
+}
+
+// ---------- pyramid ----------
+//
+// Every level is fed either from raw samples or, when its samples-per-pixel
+// is a multiple of a finer level, from that level's finished pixels. Only
+// the levels without such a parent touch the samples, so extra zoom levels
+// cost almost nothing.
+
+typedef struct {
+    int spp;            // samples per pixel
+    int parent;         // level feeding this one, -1 for raw samples
+    int ratio;          // parent pixels per pixel
+    int filled;         // samples (or parent pixels) in the current pixel
+    float lo, hi;
+    uint8_t *data;      // .dat file, header written at finish
+    size_t len, cap;
+    uint32_t pixels;
+} PeakLevel;
+
+typedef struct {
+    PeakLevel levels[PEAKS_MAX_LEVELS];
+    int order[PEAKS_MAX_LEVELS];    // level indices by ascending spp
+    int count;
+    int bits;
+    int failed;
+} PeakPyramid;
+
+static int peak_quantize(float v, int bits) {
+    int scale = bits == 8 ? 127 : 32767;
+    long q = lrintf(v * scale);
+    if (q < -scale - 1) q = -scale - 1;
+    if (q > scale) q = scale;
+    return (int)q;
+}
+
+static void peak_level_reset(PeakLevel *l) {
+    l->filled = 0;
+    l->lo = INFINITY;
+    l->hi = -INFINITY;
+}
+
+static void peak_emit(PeakPyramid *p, int idx) {
+    PeakLevel *l = &p->levels[idx];
+    float lo = l->lo, hi = l->hi;
+    size_t need = p->bits == 8 ? 2 : 4;
+    if (l->len + need > l->cap) {
+        size_t cap = l->cap * 2;
+        uint8_t *grown = realloc(l->data, cap);
+        if (!grown) {
+            p->failed = 1;
+            return;
+        }
+        l->data = grown;
+        l->cap = cap;
+    }
+    int qlo = peak_quantize(lo, p->bits), qhi = peak_quantize(hi, p->bits);
+    uint8_t *dst = l->data + l->len;
+    if (p->bits == 8) {
+        dst[0] = (uint8_t)(int8_t)qlo;
+        dst[1] = (uint8_t)(int8_t)qhi;
+    } else {
+        dst[0] = (uint8_t)(qlo & 0xff);
+        dst[1] = (uint8_t)((qlo >> 8) & 0xff);
+        dst[2] = (uint8_t)(qhi & 0xff);
+        dst[3] = (uint8_t)((qhi >> 8) & 0xff);
+    }
+    l->len += need;
+    l->pixels++;
+    peak_level_reset(l);
+
+    for (int c = 0; c < p->count; c++) {
+        PeakLevel *child = &p->levels[c];
+        if (child->parent != idx) continue;
+        if (lo < child->lo) child->lo = lo;
+        if (hi > child->hi) child->hi = hi;
+        if (++child->filled == child->ratio) peak_emit(p, c);
+    }
+}
+
+static int peak_pyramid_init(PeakPyramid *p, const int *spp, int count, int bits) {
+    memset(p, 0, sizeof(*p));
+    p->count = count;
+    p->bits = bits;
+    for (int i = 0; i < count; i++) {
+        PeakLevel *l = &p->levels[i];
+        l->spp = spp[i];
+        l->parent = -1;
+        l->ratio = 1;
+        // Coarsest finer level that divides this one evenly.
+        for (int j = 0; j < count; j++) {
+            if (spp[j] >= spp[i] || spp[i] % spp[j] != 0) continue;
+            if (l->parent < 0 || spp[j] > spp[l->parent]) l->parent = j;
+        }
+        if (l->parent >= 0) l->ratio = spp[i] / spp[l->parent];
+        peak_level_reset(l);
+        l->cap = 4096;
+        l->len = PEAKS_DAT_HEADER;
+        l->data = malloc(l->cap);
+        if (!l->data) return -1;
+        p->order[i] = i;
+    }
+    for (int i = 1; i < count; i++) {
+        int v = p->order[i], j = i - 1;
+        while (j >= 0 && spp[p->order[j]] > spp[v]) {
+            p->order[j + 1] = p->order[j];
+            j--;
+        }
+        p->order[j + 1] = v;
+    }
+    return 0;
+}
+
+static void peak_pyramid_free(PeakPyramid *p) {
+    for (int i = 0; i < p->count; i++) free(p->levels[i].data);
+}
+
+static void peak_pyramid_feed(PeakPyramid *p, const float *x, int n) {
+    for (int i = 0; i < p->count; i++) {
+        PeakLevel *l = &p->levels[i];
+        if (l->parent >= 0) continue;
+        const float *src = x;
+        int left = n;
+        while (left > 0 && !p->failed) {
+            int take = l->spp - l->filled;
+            if (take > left) take = left;
+            dsp_min_max(src, take, &l->lo, &l->hi);
+            l->filled += take;
+            src += take;
+            left -= take;
+            if (l->filled == l->spp) peak_emit(p, i);
+        }
+    }
+}
+
+// Flush partial pixels finest first, so a coarse level still sees the tail
+// of its parent, then fill in the headers.
+static void peak_pyramid_finish(PeakPyramid *p, int sample_rate) {
+    for (int k = 0; k < p->count; k++) {
+        int i = p->order[k];
+        if (p->levels[i].filled > 0) peak_emit(p, i);
+    }
+    for (int i = 0; i < p->count; i++) {
+        PeakLevel *l = &p->levels[i];
+        put_le32(l->data, 1);
+        put_le32(l->data + 4, p->bits == 8 ? 1 : 0);
+        put_le32(l->data + 8, (uint32_t)sample_rate);
+        put_le32(l->data + 12, (uint32_t)l->spp);
+        put_le32(l->data + 16, l->pixels);
+    }
+}
+
+// Decode the first audio stream once and return one audiowaveform .dat
+// file per entry of `samples_per_pixel`, concatenated in the given order.
+// Channels are averaged to mono; `bits` selects int8 or int16 pairs.
+PYMEDIA_API uint8_t* audio_peaks(uint8_t *data, size_t size, const int *samples_per_pixel,
+                                 int count, int bits, size_t *out_size) {
+    AudioReader r;
+    PeakPyramid p;
+    float *mono = NULL;
+    uint8_t *result = NULL;
+    int n = -1;
+
+    *out_size = 0;
+    if (count < 1 || count > PEAKS_MAX_LEVELS || (bits != 8 && bits != 16)) return NULL;
+    for (int i = 0; i < count; i++)
+        if (samples_per_pixel[i] < 1) return NULL;
+
+    if (audio_reader_open(&r, data, size, -1, -1) < 0) return NULL;
+    if (peak_pyramid_init(&p, samples_per_pixel, count, bits) < 0) goto cleanup;
+    mono = malloc(sizeof(float) * AUDIO_DSP_CHUNK);
+    int mono_cap = AUDIO_DSP_CHUNK;
+    if (!mono) goto cleanup;
+
+    while ((n = audio_reader_read(&r)) > 0) {
+        const float *src = r.buf[0];
+        if (r.channels > 1) {
+            if (n > mono_cap) {
+                free(mono);
+                mono = malloc(sizeof(float) * n);
+                if (!mono) {
+                    n = -1;
+                    break;
+                }
+                mono_cap = n;
+            }
+            float g = 1.0f / r.channels;
+            memset(mono, 0, sizeof(float) * n);
+            for (int c = 0; c < r.channels; c++) dsp_mix(mono, r.buf[c], n, g);
+            src = mono;
+        }
+        peak_pyramid_feed(&p, src, n);
+        if (p.failed) {
+            n = -1;
+            break;
+        }
+    }
+    if (n < 0) goto cleanup;
+    peak_pyramid_finish(&p, r.sample_rate);
+    if (p.failed) goto cleanup;
+
+    size_t total = 0;
+    for (int i = 0; i < count; i++) total += p.levels[i].len;
+    result = malloc(total);
+    if (!result) goto cleanup;
+    size_t off = 0;
+    for (int i = 0; i < count; i++) {
+        memcpy(result + off, p.levels[i].data, p.levels[i].len);
+        off += p.levels[i].len;
+    }
+    *out_size = total;
+
+cleanup:
+    free(mono);
+    peak_pyramid_free(&p);
+    audio_reader_close(&r);
+    return result;
+}
@@ -4,12 +4,19 @@
 //           muting, frame extraction, GIF conversion, video info,
 //           rotate, speed change, volume adjust, merge, reverse,
 //           metadata strip/set
+//
+// Thread safety: every PYMEDIA_API entry point may be called concurrently.
+// Each call owns its demuxer, codec, scaler and muxer contexts; nothing
+// mutable lives at file scope except the mutex-guarded resampler/FIFO
+// cache in audio.c, whose entries are handed out exclusively. Handles
+// (frame batchers, batch callbacks) must not be shared between threads.
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
 #include <ctype.h>
+#include <time.h>
 
 #include <libavformat/avformat.h>
 #include <libavcodec/avcodec.h>
@@ -17,9 +24,23 @@
 #include <libavutil/audio_fifo.h>
 #include <libavutil/opt.h>
 #include <libavutil/imgutils.h>
+#include <libavutil/cpu.h>
+#include <libavutil/time.h>
 #include <libswresample/swresample.h>
 #include <libswscale/swscale.h>
 
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <emmintrin.h>
+#define PM_HAVE_SSE2 1
+#endif
+
 #if defined(_WIN32)
 #define PYMEDIA_API __declspec(dllexport)
 #else
@@ -32,6 +53,218 @@
 #define FF_NEW_CHANNEL_LAYOUT \
     (LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(59, 37, 100))
 
+// ============================================================
+// Threading shim — minimal pthreads / Win32 wrapper for the
+// native worker pipelines
+// ============================================================
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#define PM_THREAD_LOCAL __declspec(thread)
+static int64_t pm_atomic_load(volatile int64_t *p) { return InterlockedCompareExchange64(p, 0, 0); }
+static void pm_atomic_store(volatile int64_t *p, int64_t v) { InterlockedExchange64(p, v); }
+static int pm_atomic_cas(volatile int64_t *p, int64_t expected, int64_t v) {
+    return InterlockedCompareExchange64(p, v, expected) == expected;
+}
+static void pm_atomic_add(volatile int64_t *p, int64_t v) { InterlockedExchangeAdd64(p, v); }
+#else
+#define PM_THREAD_LOCAL __thread
+static int64_t pm_atomic_load(volatile int64_t *p) { return __atomic_load_n(p, __ATOMIC_ACQUIRE); }
+static void pm_atomic_store(volatile int64_t *p, int64_t v) {
+    __atomic_store_n(p, v, __ATOMIC_RELEASE);
+}
+static int pm_atomic_cas(volatile int64_t *p, int64_t expected, int64_t v) {
+    return __atomic_compare_exchange_n(p, &expected, v, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+static void pm_atomic_add(volatile int64_t *p, int64_t v) {
+    __atomic_fetch_add(p, v, __ATOMIC_RELAXED);
+}
+#endif
+
+// CPU time of the calling thread / whole process, in microseconds.
+static int64_t pm_thread_cpu_us(void) {
+#if defined(_WIN32)
+    FILETIME created, exited, kernel, user;
+    if (!GetThreadTimes(GetCurrentThread(), &created, &exited, &kernel, &user)) return 0;
+    ULARGE_INTEGER k = {{kernel.dwLowDateTime, kernel.dwHighDateTime}};
+    ULARGE_INTEGER u = {{user.dwLowDateTime, user.dwHighDateTime}};
+    return (int64_t)((k.QuadPart + u.QuadPart) / 10);
+#else
+    struct timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) return 0;
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#endif
+}
+
+static int64_t pm_process_cpu_us(void) {
+#if defined(_WIN32)
+    FILETIME created, exited, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user)) return 0;
+    ULARGE_INTEGER k = {{kernel.dwLowDateTime, kernel.dwHighDateTime}};
+    ULARGE_INTEGER u = {{user.dwLowDateTime, user.dwHighDateTime}};
+    return (int64_t)((k.QuadPart + u.QuadPart) / 10);
+#else
+    struct timespec ts;
+    if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts) != 0) return 0;
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#endif
+}
+
+// Pipeline stages timed by the pm_* wrappers around the FFmpeg calls.
+enum {
+    PM_STAGE_DEMUX,      // pm_read_frame
+    PM_STAGE_DECODE,     // pm_send_packet / pm_receive_frame
+    PM_STAGE_SCALE,      // pm_sws_scale
+    PM_STAGE_RESAMPLE,   // pm_swr_convert
+    PM_STAGE_ENCODE,     // pm_send_frame / pm_receive_packet
+    PM_STAGE_MUX,        // pm_write_frame
+    PM_STAGE_COUNT,
+};
+
+static const char *const pm_stage_names[PM_STAGE_COUNT] = {
+    "demux", "decode", "scale", "resample", "encode", "mux",
+};
+
+// Totals for one stage, summed over every thread of the call.
+typedef struct {
+    volatile int64_t wall_us;
+    volatile int64_t cpu_us;        // CPU time of the threads inside the stage
+    volatile int64_t calls;
+    volatile int64_t packets;
+    volatile int64_t frames;        // frames or audio sample blocks
+    volatile int64_t bytes_in;
+    volatile int64_t bytes_out;
+} PmStageStats;
+
+// Receives source seconds processed so far and the source duration (0 if
+// unknown), at most once per percent of progress.
+typedef void (*pymedia_progress_callback)(void *opaque, double processed_sec,
+                                          double duration_sec);
+
+// Cancellation and progress for the call running on this thread. Bound by
+// the job runner or pymedia_control_bind (modules/jobs.c) and inherited by
+// threads the call starts, so worker pipelines stop with their parent.
+// See pm_read_frame / pm_progress.
+typedef struct {
+    volatile int64_t cancelled;
+    volatile int64_t progress_us;   // furthest source timestamp processed
+    volatile int64_t duration_us;   // source duration, 0 until known
+    volatile int64_t offset_us;     // multi-input calls: start of the current input
+    int64_t reported_us;            // last value passed to `callback`
+    pymedia_progress_callback callback;   // invoked on the binding thread only
+    void *opaque;
+    int stats_enabled;              // set before binding; see pm_stage_begin
+    int64_t stats_wall_start, stats_cpu_start;
+    volatile int64_t wall_us, cpu_us;   // bound time and process CPU over it
+    PmStageStats stages[PM_STAGE_COUNT];
+} PmControl;
+
+static PM_THREAD_LOCAL PmControl *pm_control;
+static PM_THREAD_LOCAL int pm_control_inherited;
+
+typedef struct {
+    void *(*fn)(void *);
+    void *arg;
+    PmControl *control;
+} PmThreadStart;
+
+static PmThreadStart *pm_thread_start_new(void *(*fn)(void *), void *arg) {
+    PmThreadStart *start = malloc(sizeof(*start));
+    if (!start) return NULL;
+    start->fn = fn;
+    start->arg = arg;
+    start->control = pm_control;
+    return start;
+}
+
+static void *pm_thread_run(void *p) {
+    PmThreadStart start = *(PmThreadStart *)p;
+    free(p);
+    pm_control = start.control;
+    pm_control_inherited = start.control != NULL;
+    return start.fn(start.arg);
+}
+
+#if defined(_WIN32)
+typedef HANDLE pm_thread_t;
+typedef CRITICAL_SECTION pm_mutex_t;
+typedef CONDITION_VARIABLE pm_cond_t;
+
+static DWORD WINAPI pm_thread_trampoline(LPVOID p) {
+    pm_thread_run(p);
+    return 0;
+}
+
+static int pm_thread_create(pm_thread_t *t, void *(*fn)(void *), void *arg) {
+    PmThreadStart *start = pm_thread_start_new(fn, arg);
+    if (!start) return -1;
+    *t = CreateThread(NULL, 0, pm_thread_trampoline, start, 0, NULL);
+    if (!*t) { free(start); return -1; }
+    return 0;
+}
+
+static void pm_thread_join(pm_thread_t t) {
+    WaitForSingleObject(t, INFINITE);
+    CloseHandle(t);
+}
+
+static void pm_mutex_init(pm_mutex_t *m)    { InitializeCriticalSection(m); }
+static void pm_mutex_destroy(pm_mutex_t *m) { DeleteCriticalSection(m); }
+static void pm_mutex_lock(pm_mutex_t *m)    { EnterCriticalSection(m); }
+static void pm_mutex_unlock(pm_mutex_t *m)  { LeaveCriticalSection(m); }
+static void pm_cond_init(pm_cond_t *c)      { InitializeConditionVariable(c); }
+static void pm_cond_destroy(pm_cond_t *c)   { (void)c; }
+static void pm_cond_wait(pm_cond_t *c, pm_mutex_t *m) { SleepConditionVariableCS(c, m, INFINITE); }
+static void pm_cond_broadcast(pm_cond_t *c) { WakeAllConditionVariable(c); }
+
+typedef INIT_ONCE pm_once_t;
+#define PM_ONCE_INIT INIT_ONCE_STATIC_INIT
+
+static BOOL CALLBACK pm_once_trampoline(PINIT_ONCE once, PVOID fn, PVOID *ctx) {
+    (void)once;
+    (void)ctx;
+    ((void (*)(void))fn)();
+    return TRUE;
+}
+
+static void pm_once(pm_once_t *once, void (*fn)(void)) {
+    InitOnceExecuteOnce(once, pm_once_trampoline, (PVOID)fn, NULL);
+}
+#else
+typedef pthread_t pm_thread_t;
+typedef pthread_mutex_t pm_mutex_t;
+typedef pthread_cond_t pm_cond_t;
+
+static int pm_thread_create(pm_thread_t *t, void *(*fn)(void *), void *arg) {
+    PmThreadStart *start = pm_thread_start_new(fn, arg);
+    if (!start) return -1;
+    if (pthread_create(t, NULL, pm_thread_run, start) != 0) { free(start); return -1; }
+    return 0;
+}
+
+static void pm_thread_join(pm_thread_t t)   { pthread_join(t, NULL); }
+static void pm_mutex_init(pm_mutex_t *m)    { pthread_mutex_init(m, NULL); }
+static void pm_mutex_destroy(pm_mutex_t *m) { pthread_mutex_destroy(m); }
+static void pm_mutex_lock(pm_mutex_t *m)    { pthread_mutex_lock(m); }
+static void pm_mutex_unlock(pm_mutex_t *m)  { pthread_mutex_unlock(m); }
+static void pm_cond_init(pm_cond_t *c)      { pthread_cond_init(c, NULL); }
+static void pm_cond_destroy(pm_cond_t *c)   { pthread_cond_destroy(c); }
+static void pm_cond_wait(pm_cond_t *c, pm_mutex_t *m) { pthread_cond_wait(c, m); }
+static void pm_cond_broadcast(pm_cond_t *c) { pthread_cond_broadcast(c); }
+
+typedef pthread_once_t pm_once_t;
+#define PM_ONCE_INIT PTHREAD_ONCE_INIT
+
+static void pm_once(pm_once_t *once, void (*fn)(void)) { pthread_once(once, fn); }
+#endif
+
+// Worker count for native pipelines: explicit request, else one per core.
+static int pm_worker_count(int requested, int max_workers) {
+    int n = requested > 0 ? requested : av_cpu_count();
+    if (n < 1) n = 1;
+    if (n > max_workers) n = max_workers;
+    return n;
+}
+
 // ============================================================
 // Common helpers
 // ============================================================
@@ -111,12 +344,157 @@ static int find_stream(AVFormatContext *fmt_ctx, enum AVMediaType type) {
     return -1;
 }
 
+static int pm_cancelled(void) {
+    return pm_control && pm_atomic_load(&pm_control->cancelled);
+}
+
+// Record that the call has processed `us` of a source lasting `duration_us`
+// (<= 0: unknown, keep the first duration seen). Progress only moves
+// forward; the callback fires on the binding thread every percent (every
+// second while the duration is unknown).
+static void pm_progress(int64_t us, int64_t duration_us) {
+    PmControl *ctl = pm_control;
+    if (!ctl) return;
+    if (duration_us > 0) pm_atomic_cas(&ctl->duration_us, 0, duration_us);
+    for (int64_t seen = pm_atomic_load(&ctl->progress_us); us > seen;
+         seen = pm_atomic_load(&ctl->progress_us))
+        if (pm_atomic_cas(&ctl->progress_us, seen, us)) break;
+
+    if (!ctl->callback || pm_control_inherited) return;
+    int64_t total = pm_atomic_load(&ctl->duration_us);
+    int64_t done = pm_atomic_load(&ctl->progress_us);
+    int64_t step = total > 0 ? FFMAX(total / 100, 1) : AV_TIME_BASE;
+    if (done - ctl->reported_us < step) return;
+    ctl->reported_us = done;
+    ctl->callback(ctl->opaque, done / (double)AV_TIME_BASE, total / (double)AV_TIME_BASE);
+}
+
+// Calls that read several inputs one after another, or one input in
+// several passes, report progress over their summed duration `total_us`
+// (<= 0: leave unchanged). Reads then count from `offset_us`, where the
+// current input or pass starts in that total; reset it to 0 once the last
+// one is done.
+static void pm_progress_input(int64_t offset_us, int64_t total_us) {
+    PmControl *ctl = pm_control;
+    if (!ctl) return;
+    if (total_us > 0) pm_atomic_store(&ctl->duration_us, total_us);
+    pm_atomic_store(&ctl->offset_us, offset_us);
+}
+
+// ---------- stage instrumentation ----------
+//
+// The pm_* wrappers below stand in for the FFmpeg call of each pipeline
+// stage. With stats enabled on the bound control they add wall time, the
+// thread's CPU time and packet/frame/byte counts to that stage; otherwise
+// the cost is a thread-local load and a branch.
+
+typedef struct {
+    PmStageStats *st;
+    int64_t wall, cpu;
+} PmStageClock;
+
+static PmStageClock pm_stage_begin(int stage) {
+    PmStageClock c = {NULL, 0, 0};
+    PmControl *ctl = pm_control;
+    if (!ctl || !ctl->stats_enabled) return c;
+    c.st = &ctl->stages[stage];
+    c.wall = av_gettime_relative();
+    c.cpu = pm_thread_cpu_us();
+    return c;
+}
+
+static void pm_stage_end(const PmStageClock *c, int64_t packets, int64_t frames,
+                         int64_t bytes_in, int64_t bytes_out) {
+    if (!c->st) return;
+    pm_atomic_add(&c->st->wall_us, av_gettime_relative() - c->wall);
+    pm_atomic_add(&c->st->cpu_us, pm_thread_cpu_us() - c->cpu);
+    pm_atomic_add(&c->st->calls, 1);
+    if (packets) pm_atomic_add(&c->st->packets, packets);
+    if (frames) pm_atomic_add(&c->st->frames, frames);
+    if (bytes_in) pm_atomic_add(&c->st->bytes_in, bytes_in);
+    if (bytes_out) pm_atomic_add(&c->st->bytes_out, bytes_out);
+}
+
+static int pm_send_packet(AVCodecContext *dec_ctx, const AVPacket *pkt) {
+    PmStageClock c = pm_stage_begin(PM_STAGE_DECODE);
+    int ret = avcodec_send_packet(dec_ctx, pkt);
+    int sent = ret >= 0 && pkt;
+    pm_stage_end(&c, sent, 0, sent ? pkt->size : 0, 0);
+    return ret;
+}
+
+static int pm_receive_frame(AVCodecContext *dec_ctx, AVFrame *frame) {
+    PmStageClock c = pm_stage_begin(PM_STAGE_DECODE);
+    int ret = avcodec_receive_frame(dec_ctx, frame);
+    pm_stage_end(&c, 0, ret >= 0, 0, 0);
+    return ret;
+}
+
+static int pm_sws_scale(struct SwsContext *sws, const uint8_t *const src[], const int src_stride[],
+                        int src_y, int src_h, uint8_t *const dst[], const int dst_stride[]) {
+    PmStageClock c = pm_stage_begin(PM_STAGE_SCALE);
+    int ret = sws_scale(sws, src, src_stride, src_y, src_h, dst, dst_stride);
+    pm_stage_end(&c, 0, ret > 0, 0, 0);
+    return ret;
+}
+
+static int pm_swr_convert(SwrContext *swr, uint8_t **out, int out_count,
+                          const uint8_t **in, int in_count) {
+    PmStageClock c = pm_stage_begin(PM_STAGE_RESAMPLE);
+    int ret = swr_convert(swr, out, out_count, in, in_count);
+    pm_stage_end(&c, 0, ret > 0, 0, 0);
+    return ret;
+}
+
+static int pm_send_frame(AVCodecContext *enc_ctx, const AVFrame *frame) {
+    PmStageClock c = pm_stage_begin(PM_STAGE_ENCODE);
+    int ret = avcodec_send_frame(enc_ctx, frame);
+    pm_stage_end(&c, 0, ret >= 0 && frame, 0, 0);
+    return ret;
+}
+
+static int pm_receive_packet(AVCodecContext *enc_ctx, AVPacket *pkt) {
+    PmStageClock c = pm_stage_begin(PM_STAGE_ENCODE);
+    int ret = avcodec_receive_packet(enc_ctx, pkt);
+    int got = ret >= 0;
+    pm_stage_end(&c, got, 0, 0, got ? pkt->size : 0);
+    return ret;
+}
+
+static int pm_write_frame(AVFormatContext *ofmt_ctx, AVPacket *pkt) {
+    PmStageClock c = pm_stage_begin(PM_STAGE_MUX);
+    int size = pkt ? pkt->size : 0;
+    int ret = av_interleaved_write_frame(ofmt_ctx, pkt);
+    pm_stage_end(&c, ret >= 0 && size, 0, 0, ret >= 0 ? size : 0);
+    return ret;
+}
+
+// av_read_frame for every packet loop: stops with AVERROR_EXIT once the
+// bound control is cancelled and reports how far into the source the call
+// has read. Loops treat the error like EOF; callers holding the control
+// discard the partial output.
+static int pm_read_frame(AVFormatContext *fmt_ctx, AVPacket *pkt) {
+    if (pm_cancelled()) return AVERROR_EXIT;
+    PmStageClock c = pm_stage_begin(PM_STAGE_DEMUX);
+    int ret = av_read_frame(fmt_ctx, pkt);
+    pm_stage_end(&c, ret >= 0, 0, ret >= 0 ? pkt->size : 0, 0);
+    if (ret < 0 || !pm_control) return ret;
+
+    int64_t ts = pkt->pts != AV_NOPTS_VALUE ? pkt->pts : pkt->dts;
+    if (ts == AV_NOPTS_VALUE) return ret;
+    int64_t us = av_rescale_q(ts, fmt_ctx->streams[pkt->stream_index]->time_base,
+                              AV_TIME_BASE_Q);
+    if (fmt_ctx->start_time != AV_NOPTS_VALUE) us -= fmt_ctx->start_time;
+    pm_progress(pm_atomic_load(&pm_control->offset_us) + us, fmt_ctx->duration);
+    return ret;
+}
+
 // Read packets until one from target stream is found. Returns:
 //  1 -> packet filled
 //  0 -> EOF
 // -1 -> error
 static int read_next_stream_packet(AVFormatContext *fmt_ctx, int stream_idx, AVPacket *pkt) {
-    while (av_read_frame(fmt_ctx, pkt) >= 0) {
+    while (pm_read_frame(fmt_ctx, pkt) >= 0) {
         if (pkt->stream_index == stream_idx) {
             return 1;
         }
@@ -125,6 +503,19 @@ static int read_next_stream_packet(AVFormatContext *fmt_ctx, int stream_idx, AVP
     return 0;
 }
 
+// Little-endian helpers for the binary formats returned to Python.
+static void put_le32(uint8_t *p, uint32_t v) {
+    for (int i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static void put_le64(uint8_t *p, uint64_t v) {
+    for (int i = 0; i < 8; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static uint32_t get_le32(const uint8_t *p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
 static void blend_rgba_overlay(AVFrame *dst_rgba, const uint8_t *wm_rgba,
                                int wm_w, int wm_h, int wm_linesize,
                                int pos_x, int pos_y, double opacity) {
@@ -455,10 +846,10 @@ static int decode_first_frame_to_yuv420(uint8_t *data, size_t size, int out_w, i
     if (av_frame_get_buffer(yuv_frame, 0) < 0) goto cleanup;
 
     int found = 0;
-    while (av_read_frame(ifmt_ctx, pkt) >= 0) {
+    while (pm_read_frame(ifmt_ctx, pkt) >= 0) {
         if (pkt->stream_index == video_idx) {
-            if (avcodec_send_packet(dec_ctx, pkt) >= 0 &&
-                avcodec_receive_frame(dec_ctx, dec_frame) == 0) {
+            if (pm_send_packet(dec_ctx, pkt) >= 0 &&
+                pm_receive_frame(dec_ctx, dec_frame) == 0) {
                 found = 1;
                 av_packet_unref(pkt);
                 break;
@@ -468,7 +859,7 @@ static int decode_first_frame_to_yuv420(uint8_t *data, size_t size, int out_w, i
     }
     if (!found) goto cleanup;
 
-    sws_scale(sws, (const uint8_t *const *)dec_frame->data, dec_frame->linesize,
+    pm_sws_scale(sws, (const uint8_t *const *)dec_frame->data, dec_frame->linesize,
               0, par->height, yuv_frame->data, yuv_frame->linesize);
     *out_frame = yuv_frame;
     yuv_frame = NULL;
@@ -563,15 +954,50 @@ cleanup:
     return result;
 }
 
+// Keyframe index: presentation timestamps (video time base) of the video
+// stream's keyframe packets, in file order. The caller frees *out.
+static int collect_keyframe_pts(AVFormatContext *ifmt_ctx, int video_idx,
+                                int64_t **out, int *count) {
+    AVPacket *pkt = av_packet_alloc();
+    int cap = 0;
+    *out = NULL;
+    *count = 0;
+    if (!pkt) return -1;
+    while (pm_read_frame(ifmt_ctx, pkt) >= 0) {
+        if (pkt->stream_index == video_idx && (pkt->flags & AV_PKT_FLAG_KEY)) {
+            int64_t ts = (pkt->pts != AV_NOPTS_VALUE) ? pkt->pts : pkt->dts;
+            if (ts != AV_NOPTS_VALUE) {
+                if (*count == cap) {
+                    cap = cap ? cap * 2 : 64;
+                    int64_t *tmp = realloc(*out, sizeof(int64_t) * cap);
+                    if (!tmp) {
+                        av_packet_unref(pkt);
+                        av_packet_free(&pkt);
+                        free(*out);
+                        *out = NULL;
+                        *count = 0;
+                        return -1;
+                    }
+                    *out = tmp;
+                }
+                (*out)[(*count)++] = ts;
+            }
+        }
+        av_packet_unref(pkt);
+    }
+    av_packet_free(&pkt);
+    return 0;
+}
+
 PYMEDIA_API char* list_keyframes_json(uint8_t *video_data, size_t video_size) {
     BufferData bd;
     AVFormatContext *ifmt_ctx = NULL;
     AVIOContext *input_avio_ctx = NULL;
-    AVPacket *pkt = NULL;
+    int64_t *keys = NULL;
+    int key_count = 0;
     char *json = NULL;
     size_t cap = 256;
     size_t len = 0;
-    int first = 1;
 
     json = malloc(cap);
     if (!json) return NULL;
@@ -584,30 +1010,21 @@ PYMEDIA_API char* list_keyframes_json(uint8_t *video_data, size_t video_size) {
     int video_idx = find_stream(ifmt_ctx, AVMEDIA_TYPE_VIDEO);
     if (video_idx < 0) goto cleanup;
     AVStream *vs = ifmt_ctx->streams[video_idx];
-
-    pkt = av_packet_alloc();
-    if (!pkt) goto cleanup;
-
-    while (av_read_frame(ifmt_ctx, pkt) >= 0) {
-        if (pkt->stream_index == video_idx && (pkt->flags & AV_PKT_FLAG_KEY)) {
-            int64_t ts = (pkt->pts != AV_NOPTS_VALUE) ? pkt->pts : pkt->dts;
-            if (ts != AV_NOPTS_VALUE) {
-                double t = ts * av_q2d(vs->time_base);
-                char item[64];
-                int n = snprintf(item, sizeof(item), first ? "%.6f" : ",%.6f", t);
-                if ((size_t)(len + n + 2) >= cap) {
-                    while ((size_t)(len + n + 2) >= cap) cap *= 2;
-                    char *tmp = realloc(json, cap);
-                    if (!tmp) goto cleanup;
-                    json = tmp;
-                }
-                memcpy(json + len, item, n);
-                len += (size_t)n;
-                json[len] = '\0';
-                first = 0;
-            }
+    if (collect_keyframe_pts(ifmt_ctx, video_idx, &keys, &key_count) < 0) goto cleanup;
+
+    for (int i = 0; i < key_count; i++) {
+        double t = keys[i] * av_q2d(vs->time_base);
+        char item[64];
+        int n = snprintf(item, sizeof(item), i == 0 ? "%.6f" : ",%.6f", t);
+        if ((size_t)(len + n + 2) >= cap) {
+            while ((size_t)(len + n + 2) >= cap) cap *= 2;
+            char *tmp = realloc(json, cap);
+            if (!tmp) goto cleanup;
+            json = tmp;
         }
-        av_packet_unref(pkt);
+        memcpy(json + len, item, n);
+        len += (size_t)n;
+        json[len] = '\0';
     }
 
     if (len + 2 >= cap) {
@@ -620,7 +1037,7 @@ PYMEDIA_API char* list_keyframes_json(uint8_t *video_data, size_t video_size) {
     json[len] = '\0';
 
 cleanup:
-    if (pkt) av_packet_free(&pkt);
+    free(keys);
     close_input(&ifmt_ctx, &input_avio_ctx);
     return json;
 }
@@ -632,9 +1049,21 @@ cleanup:
 
 #include "modules/audio.c"
 #include "modules/video_core.c"
+#include "modules/frames.c"
 #include "modules/video_effects.c"
 #include "modules/transforms.c"
 #include "modules/metadata.c"
 #include "modules/subtitles_tracks.c"
 #include "modules/filters.c"
 #include "modules/streaming.c"
+#include "modules/audio_dsp.c"
+#include "modules/loudness.c"
+#include "modules/time_stretch.c"
+#include "modules/waveform.c"
+#include "modules/spectrogram.c"
+#include "modules/analysis.c"
+#include "modules/smart_cut.c"
+#include "modules/concat.c"
+#include "modules/parallel_transcode.c"
+#include "modules/batch.c"
+#include "modules/jobs.c"
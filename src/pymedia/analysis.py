@@ -2,14 +2,16 @@ from __future__ import annotations
 
 import ctypes
 import json
-import zlib
+from typing import Sequence
 
-from pymedia._core import _lib
-from pymedia.frames import extract_frame
-from pymedia.info import get_video_info
-from pymedia.video import transcode_video, trim_video
+from pymedia._core import _call_bytes_fn, _lib
+from pymedia.control import controlled
+from pymedia.video import trim_video
 
+SUPPORTED_FINGERPRINT_ALGORITHMS = ("phash", "dhash")
 
+
+@controlled
 def list_keyframes(video_data: bytes) -> list[float]:
     """Return keyframe timestamps for the primary video stream.
 
@@ -29,51 +31,124 @@ def list_keyframes(video_data: bytes) -> list[float]:
         _lib.pymedia_free(result_ptr)
 
 
+@controlled
 def detect_scenes(
-    video_data: bytes, threshold: float = 0.35, sample_interval: float = 0.5
-) -> list[float]:
-    """Detect approximate scene-change timestamps.
-
-    This uses lightweight frame signature deltas (JPEG size + CRC) sampled
-    at a fixed interval. It is fast and in-process, but less precise than
-    FFmpeg filtergraph scene detection.
+    video_data: bytes,
+    threshold: float = 0.35,
+    sample_interval: float = 0.5,
+    keyframes_only: bool = False,
+    return_scores: bool = False,
+) -> list:
+    """Detect scene-change timestamps.
+
+    The video is decoded once in the native layer at a reduced 64x64 luma
+    resolution. Consecutive samples are compared with a pixel SAD and a luma
+    histogram distance; the change score is their mean, in `[0, 1]`.
 
     Args:
         video_data: In-memory media bytes.
-        threshold: Change sensitivity; higher means fewer scene cuts.
-        sample_interval: Seconds between sampled frames.
+        threshold: Minimum change score for a cut; higher means fewer cuts.
+            Hard cuts between unrelated shots typically score 0.4 or more
+            and motion within a shot stays below about 0.15. Cuts between
+            shots with matching luma histograms need about 0.2.
+        sample_interval: Minimum seconds between compared frames.
+        keyframes_only: Decode keyframes only. Much faster on long inputs,
+            but cuts are only found at GOP granularity.
+        return_scores: Return `(timestamp, score)` tuples instead of bare
+            timestamps.
 
     Returns:
-        Scene-change timestamps in seconds.
+        Scene-change timestamps in seconds, or `(timestamp, score)` tuples
+        when `return_scores` is true.
     """
     if threshold <= 0:
         raise ValueError("threshold must be > 0")
     if sample_interval <= 0:
         raise ValueError("sample_interval must be > 0")
 
-    info = get_video_info(video_data)
-    duration = float(info.get("duration", 0.0))
-    if duration <= 0:
-        return []
-
-    points = []
-    t = 0.0
-    prev_sig = None
-    while t < duration:
-        frame = extract_frame(video_data, timestamp=t, format="jpeg")
-        crc = zlib.crc32(frame)
-        sig = (len(frame), crc)
-        if prev_sig is not None:
-            len_delta = abs(sig[0] - prev_sig[0]) / max(sig[0], prev_sig[0], 1)
-            crc_delta = 0.0 if sig[1] == prev_sig[1] else 1.0
-            score = 0.6 * len_delta + 0.4 * crc_delta
-            if score >= threshold:
-                points.append(round(t, 3))
-        prev_sig = sig
-        t += sample_interval
-    return points
+    buf = (ctypes.c_uint8 * len(video_data)).from_buffer_copy(video_data)
+    result_ptr = _lib.detect_scenes_json(
+        buf,
+        len(video_data),
+        ctypes.c_double(threshold),
+        ctypes.c_double(sample_interval),
+        ctypes.c_int(1 if keyframes_only else 0),
+    )
+    if not result_ptr:
+        raise RuntimeError("Failed to detect scenes")
+    try:
+        cuts = json.loads(ctypes.string_at(result_ptr).decode("utf-8"))
+    finally:
+        _lib.pymedia_free(result_ptr)
+
+    if return_scores:
+        return [(round(c["time"], 3), round(c["score"], 4)) for c in cuts]
+    return [round(c["time"], 3) for c in cuts]
+
+
+@controlled
+def video_fingerprint(
+    video_data: bytes, sample_interval: float = 1.0, algorithm: str = "phash"
+) -> bytes:
+    """Build a compact perceptual fingerprint for near-duplicate detection.
+
+    The video is decoded once at a tiny luma resolution and one 64-bit
+    perceptual hash is computed per sampled frame.
+
+    Args:
+        video_data: In-memory media bytes.
+        sample_interval: Seconds between hashed frames.
+        algorithm: `phash` (32x32 DCT, robust to re-encoding and scaling) or
+            `dhash` (9x8 gradient, cheaper).
+
+    Returns:
+        Fingerprint bytes: a 12-byte header followed by one little-endian
+        64-bit hash per sample. Compare with `fingerprint_similarity`.
+    """
+    if sample_interval <= 0:
+        raise ValueError("sample_interval must be > 0")
+    algo = algorithm.lower()
+    if algo not in SUPPORTED_FINGERPRINT_ALGORITHMS:
+        raise ValueError(
+            f"Unsupported fingerprint algorithm '{algorithm}'. "
+            f"Supported: {SUPPORTED_FINGERPRINT_ALGORITHMS}"
+        )
+
+    buf = (ctypes.c_uint8 * len(video_data)).from_buffer_copy(video_data)
+    return _call_bytes_fn(
+        _lib.video_fingerprint,
+        buf,
+        len(video_data),
+        ctypes.c_double(sample_interval),
+        algo.encode("utf-8"),
+    )
+
+
+def fingerprint_similarity(fingerprint_a: bytes, fingerprint_b: bytes) -> float:
+    """Compare two fingerprints from `video_fingerprint`.
+
+    The hash sequences are slid against each other (at least half of the
+    shorter one must overlap), so trimmed copies still match.
 
+    Args:
+        fingerprint_a: First fingerprint.
+        fingerprint_b: Second fingerprint.
 
+    Returns:
+        Similarity in `[0, 1]`; 1.0 means identical hashes at the best
+        alignment. Re-encodes of the same video typically score above 0.9.
+    """
+    score = _lib.fingerprint_similarity(
+        bytes(fingerprint_a), len(fingerprint_a), bytes(fingerprint_b), len(fingerprint_b)
+    )
+    if score < 0:
+        raise ValueError(
+            "Fingerprints are malformed or were built with different algorithm/interval"
+        )
+    return score
+
+
+@controlled
 def trim_to_keyframes(video_data: bytes, start: float, end: float) -> bytes:
     """Trim a clip while snapping boundaries to nearby keyframes.
 
@@ -101,8 +176,14 @@ def trim_to_keyframes(video_data: bytes, start: float, end: float) -> bytes:
     return trim_video(video_data, start=start_k, end=end_k)
 
 
+@controlled
 def frame_accurate_trim(video_data: bytes, start: float, end: float) -> bytes:
-    """Produce a tighter trim by re-encoding after an initial cut.
+    """Trim to exact frame boundaries, re-encoding only the partial GOPs.
+
+    Frames from ``start`` up to the next keyframe and from the last keyframe
+    before ``end`` are re-encoded; everything between is stream-copied with
+    the source SPS/PPS re-sent at the splice. Sources that cannot be spliced
+    (non-H.264, non-4:2:0, open GOPs) are re-encoded over the whole range.
 
     Args:
         video_data: In-memory media bytes.
@@ -110,13 +191,49 @@ def frame_accurate_trim(video_data: bytes, start: float, end: float) -> bytes:
         end: End time in seconds.
 
     Returns:
-        Re-encoded clip bytes with improved boundary accuracy.
+        MP4 clip bytes covering exactly ``[start, end)``.
     """
     if start < 0:
         raise ValueError("start must be >= 0")
     if end <= start:
         raise ValueError("end must be > start")
 
-    # Best-effort: keyframe trim first, then re-encode to tighten boundaries.
-    clip = trim_video(video_data, start=start, end=end)
-    return transcode_video(clip, vcodec="h264", acodec="copy", crf=20, preset="medium")
+    buf = (ctypes.c_uint8 * len(video_data)).from_buffer_copy(video_data)
+    return _call_bytes_fn(
+        _lib.smart_trim_video,
+        buf,
+        len(video_data),
+        ctypes.c_double(start),
+        ctypes.c_double(end),
+    )
+
+
+@controlled
+def render_edl(video_data: bytes, ranges: Sequence[tuple[float, float]]) -> bytes:
+    """Cut several ranges from one source and join them in a single pass.
+
+    The source is demuxed once and every range is appended, in list order,
+    to one MP4 with continuous timestamps. Each range is frame-accurate with
+    the same smart-cut boundary handling as `frame_accurate_trim`.
+
+    Args:
+        video_data: In-memory media bytes.
+        ranges: ``(start, end)`` pairs in seconds. Ranges may repeat, overlap
+            or go backwards in time.
+
+    Returns:
+        MP4 bytes whose duration is the sum of the range lengths.
+    """
+    if not ranges:
+        raise ValueError("ranges must not be empty")
+    flat = []
+    for start, end in ranges:
+        if start < 0:
+            raise ValueError("range start must be >= 0")
+        if end <= start:
+            raise ValueError("range end must be > start")
+        flat.extend((float(start), float(end)))
+
+    buf = (ctypes.c_uint8 * len(video_data)).from_buffer_copy(video_data)
+    range_arr = (ctypes.c_double * len(flat))(*flat)
+    return _call_bytes_fn(_lib.render_edl, buf, len(video_data), range_arr, len(ranges))
@@ -1,25 +1,29 @@
 from __future__ import annotations
 
 import ctypes
-import io
-import math
-from array import array
+import json
+import struct
 from typing import Sequence
 
-from pymedia._core import _call_bytes_fn, _lib
+from pymedia._core import _call_bytes_fn, _lib, _take_native_buffer
+from pymedia.control import controlled
 
 SUPPORTED_FORMATS = ("mp3", "wav", "aac", "ogg", "flac", "opus")
 
 
+@controlled
 def extract_audio(video_data: bytes, format: str = "mp3") -> bytes:
     """Extract audio from in-memory video data.
 
     Args:
         video_data: Raw video file bytes.
-        format: Output audio format. One of: mp3, wav, aac, ogg.
+        format: Output audio format. One of: mp3, wav, aac, ogg, flac, opus.
 
     Returns:
-        Raw audio file bytes in the requested format.
+        Raw audio file bytes in the requested format. When the source codec
+        already matches ``format`` (e.g. AAC to ``aac``, MP3 to ``mp3``) the
+        packets are stream-copied, keeping the original sample rate and
+        channels; otherwise audio is re-encoded to 44.1 kHz stereo.
     """
     if format not in SUPPORTED_FORMATS:
         raise ValueError(f"Unsupported format '{format}'. Supported: {SUPPORTED_FORMATS}")
@@ -28,6 +32,7 @@ def extract_audio(video_data: bytes, format: str = "mp3") -> bytes:
     return _call_bytes_fn(_lib.extract_audio, buf, len(video_data), format.encode("utf-8"))
 
 
+@controlled
 def adjust_volume(video_data: bytes, factor: float) -> bytes:
     """Adjust audio volume in a video.
 
@@ -47,6 +52,40 @@ def adjust_volume(video_data: bytes, factor: float) -> bytes:
     return _call_bytes_fn(_lib.adjust_volume, buf, len(video_data), ctypes.c_double(factor))
 
 
+@controlled
+def normalize_loudness(
+    video_data: bytes, target_lufs: float = -23.0, true_peak: float = -1.0
+) -> bytes:
+    """Normalize integrated loudness with a true-peak ceiling, keeping video.
+
+    Pass one measures BS.1770 integrated loudness. Pass two applies the
+    static gain through a 5 ms lookahead limiter driven by 4x-oversampled
+    peaks and re-encodes audio to AAC. Video packets are stream-copied, so
+    the video stream is never decoded.
+
+    Args:
+        video_data: Raw video (or audio) file bytes.
+        target_lufs: Target integrated loudness in LUFS (EBU R128 uses -23).
+        true_peak: Maximum true peak in dBTP.
+
+    Returns:
+        MP4 bytes with normalized AAC audio.
+    """
+    if not -70.0 <= target_lufs <= 0.0:
+        raise ValueError("target_lufs must be between -70 and 0")
+    if true_peak > 0.0:
+        raise ValueError("true_peak must be <= 0")
+    buf = (ctypes.c_uint8 * len(video_data)).from_buffer_copy(video_data)
+    return _call_bytes_fn(
+        _lib.normalize_loudness,
+        buf,
+        len(video_data),
+        ctypes.c_double(target_lufs),
+        ctypes.c_double(true_peak),
+    )
+
+
+@controlled
 def transcode_audio(
     data: bytes,
     format: str = "mp3",
@@ -89,96 +128,7 @@ def transcode_audio(
     )
 
 
-def _decode_wav_pcm16(data: bytes) -> tuple[array, int, int]:
-    """Decode PCM16 WAV bytes into sample array and stream properties.
-
-    Returns:
-        Tuple of (`samples`, `channels`, `sample_rate`).
-    """
-    import wave
-
-    with wave.open(io.BytesIO(data), "rb") as wf:
-        channels = wf.getnchannels()
-        sample_rate = wf.getframerate()
-        sampwidth = wf.getsampwidth()
-        if sampwidth != 2:
-            raise ValueError("Only 16-bit PCM WAV is supported")
-        raw = wf.readframes(wf.getnframes())
-
-    samples = array("h")
-    samples.frombytes(raw)
-    if samples.itemsize != 2:
-        raise ValueError("Unexpected sample width")
-    return samples, channels, sample_rate
-
-
-def _decode_or_transcode_wav_pcm16(
-    data: bytes, target_sample_rate: int | None = None, target_channels: int | None = None
-) -> tuple[array, int, int]:
-    """Decode input as WAV PCM16, extracting/transcoding only when required.
-
-    Args:
-        data: Input media/audio bytes.
-        target_sample_rate: Optional target sample rate to enforce.
-        target_channels: Optional target channel count to enforce.
-
-    Returns:
-        Tuple of (`samples`, `channels`, `sample_rate`) decoded from 16-bit PCM WAV.
-    """
-    try:
-        samples, channels, sample_rate = _decode_wav_pcm16(data)
-    except Exception:
-        # Prefer extraction path for container inputs; it is more stable in CI.
-        try:
-            wav = extract_audio(data, format="wav")
-            samples, channels, sample_rate = _decode_wav_pcm16(wav)
-        except Exception:
-            wav = transcode_audio(
-                data,
-                format="wav",
-                sample_rate=target_sample_rate,
-                channels=target_channels,
-            )
-            return _decode_wav_pcm16(wav)
-
-        needs_resample = target_sample_rate is not None and sample_rate != target_sample_rate
-        needs_rechannel = target_channels is not None and channels != target_channels
-        if needs_resample or needs_rechannel:
-            wav = transcode_audio(
-                wav,
-                format="wav",
-                sample_rate=target_sample_rate,
-                channels=target_channels,
-            )
-            return _decode_wav_pcm16(wav)
-        return samples, channels, sample_rate
-
-    needs_resample = target_sample_rate is not None and sample_rate != target_sample_rate
-    needs_rechannel = target_channels is not None and channels != target_channels
-    if needs_resample or needs_rechannel:
-        wav = transcode_audio(
-            data,
-            format="wav",
-            sample_rate=target_sample_rate,
-            channels=target_channels,
-        )
-        return _decode_wav_pcm16(wav)
-    return samples, channels, sample_rate
-
-
-def _encode_wav_pcm16(samples: array, channels: int, sample_rate: int) -> bytes:
-    """Encode PCM16 sample array into WAV bytes."""
-    import wave
-
-    out = io.BytesIO()
-    with wave.open(out, "wb") as wf:
-        wf.setnchannels(channels)
-        wf.setsampwidth(2)
-        wf.setframerate(sample_rate)
-        wf.writeframes(samples.tobytes())
-    return out.getvalue()
-
-
+@controlled
 def change_audio_bitrate(data: bytes, bitrate: int, format: str = "aac") -> bytes:
     """Transcode audio while applying a target bitrate.
 
@@ -195,6 +145,7 @@ def change_audio_bitrate(data: bytes, bitrate: int, format: str = "aac") -> byte
     return transcode_audio(data, format=format, bitrate=bitrate)
 
 
+@controlled
 def resample_audio(
     data: bytes, sample_rate: int, channels: int | None = None, format: str = "aac"
 ) -> bytes:
@@ -206,74 +157,93 @@ def resample_audio(
     return transcode_audio(data, format=format, sample_rate=sample_rate, channels=channels)
 
 
-def fade_audio(data: bytes, in_sec: float = 0.0, out_sec: float = 0.0) -> bytes:
+def _validate_format(format: str) -> None:
+    if format not in SUPPORTED_FORMATS:
+        raise ValueError(f"Unsupported format '{format}'. Supported: {SUPPORTED_FORMATS}")
+
+
+# Failure causes reported by audio_crossfade / audio_mix (audio_dsp.c).
+_DSP_ERRORS = {
+    1: "audio streams must have matching sample rate and channels",
+    2: "duration is too small for input audio lengths",
+}
+
+
+def _call_dsp_fn(fn, *args) -> bytes:
+    """`_call_bytes_fn` for DSP entry points that report a failure cause."""
+    status = ctypes.c_int()
+    try:
+        return _call_bytes_fn(fn, *args, ctypes.byref(status))
+    except RuntimeError:
+        if status.value in _DSP_ERRORS:
+            raise ValueError(_DSP_ERRORS[status.value]) from None
+        raise
+
+
+@controlled
+def fade_audio(
+    data: bytes, in_sec: float = 0.0, out_sec: float = 0.0, format: str = "wav"
+) -> bytes:
     """Apply linear fade-in/fade-out to decoded audio.
 
+    Decoding, the gain envelope and encoding run in one native pass; only
+    the last `out_sec` seconds are buffered for the fade-out.
+
     Args:
         data: Input media/audio bytes.
         in_sec: Fade-in duration in seconds.
         out_sec: Fade-out duration in seconds.
+        format: Output audio format (default wav).
 
     Returns:
-        WAV bytes with fades applied.
+        Audio bytes with fades applied.
     """
     if in_sec < 0 or out_sec < 0:
         raise ValueError("in_sec and out_sec must be >= 0")
-    samples, channels, sample_rate = _decode_or_transcode_wav_pcm16(data)
-
-    total_frames = len(samples) // channels
-    fade_in_frames = min(int(in_sec * sample_rate), total_frames)
-    fade_out_frames = min(int(out_sec * sample_rate), total_frames)
+    _validate_format(format)
+    buf = (ctypes.c_uint8 * len(data)).from_buffer_copy(data)
+    return _call_bytes_fn(
+        _lib.audio_fade,
+        buf,
+        len(data),
+        ctypes.c_double(in_sec),
+        ctypes.c_double(out_sec),
+        format.encode("utf-8"),
+    )
 
-    for i in range(total_frames):
-        gain = 1.0
-        if fade_in_frames > 0 and i < fade_in_frames:
-            gain *= i / fade_in_frames
-        if fade_out_frames > 0 and i >= total_frames - fade_out_frames:
-            tail_idx = i - (total_frames - fade_out_frames)
-            gain *= 1.0 - (tail_idx / fade_out_frames)
-        for c in range(channels):
-            idx = i * channels + c
-            value = int(samples[idx] * gain)
-            samples[idx] = max(-32768, min(32767, value))
-    return _encode_wav_pcm16(samples, channels, sample_rate)
 
+@controlled
+def normalize_audio_lufs(data: bytes, target: float = -16.0, format: str = "wav") -> bytes:
+    """Normalize integrated loudness (ITU-R BS.1770 / EBU R128) toward a target.
 
-def normalize_audio_lufs(data: bytes, target: float = -16.0) -> bytes:
-    """Normalize loudness toward a target level (RMS-based approximation).
+    The native layer measures gated integrated loudness in a first decode
+    pass, then applies a static gain (with hard clipping) while encoding in
+    a second pass. Inputs too short or quiet to gate fall back to RMS.
 
     Args:
         data: Input media/audio bytes.
-        target: Target loudness in dBFS-like scale.
+        target: Target integrated loudness in LUFS.
+        format: Output audio format (default wav).
 
     Returns:
-        WAV bytes with gain adjustment.
+        Audio bytes with gain adjustment.
     """
-    samples, channels, sample_rate = _decode_or_transcode_wav_pcm16(data)
-    if len(samples) == 0:
-        return _encode_wav_pcm16(samples, channels, sample_rate)
-
-    acc = 0.0
-    for s in samples:
-        acc += float(s) * float(s)
-    rms = math.sqrt(acc / len(samples))
-    if rms <= 0:
-        return _encode_wav_pcm16(samples, channels, sample_rate)
-
-    current_dbfs = 20.0 * math.log10(rms / 32767.0)
-    gain_db = target - current_dbfs
-    gain = math.pow(10.0, gain_db / 20.0)
-
-    for i in range(len(samples)):
-        value = int(samples[i] * gain)
-        samples[i] = max(-32768, min(32767, value))
-    return _encode_wav_pcm16(samples, channels, sample_rate)
+    _validate_format(format)
+    buf = (ctypes.c_uint8 * len(data)).from_buffer_copy(data)
+    return _call_bytes_fn(
+        _lib.audio_normalize_lufs, buf, len(data), ctypes.c_double(target), format.encode("utf-8")
+    )
 
 
+@controlled
 def silence_detect(
     data: bytes, threshold_db: float = -40.0, min_silence: float = 0.3
 ) -> list[dict]:
-    """Detect silent intervals from decoded audio amplitude.
+    """Detect silent intervals from a running windowed RMS of decoded audio.
+
+    The native detector keeps a 20 ms trailing mean-square window and closes
+    each range as soon as the level rises again, so memory is bounded by the
+    window size rather than the track duration.
 
     Args:
         data: Input media/audio bytes.
@@ -285,216 +255,348 @@ def silence_detect(
     """
     if min_silence <= 0:
         raise ValueError("min_silence must be > 0")
-    samples, channels, sample_rate = _decode_or_transcode_wav_pcm16(data)
-    return _find_silence_ranges(
-        samples,
-        channels=channels,
-        sample_rate=sample_rate,
-        threshold_db=threshold_db,
-        min_silence=min_silence,
+    buf = (ctypes.c_uint8 * len(data)).from_buffer_copy(data)
+    result_ptr = _lib.audio_silence_ranges_json(
+        buf, len(data), ctypes.c_double(threshold_db), ctypes.c_double(min_silence)
     )
+    if not result_ptr:
+        raise RuntimeError("Operation failed")
+    try:
+        return json.loads(ctypes.string_at(result_ptr).decode("utf-8"))
+    finally:
+        _lib.pymedia_free(result_ptr)
+
+
+@controlled
+def audio_peaks(
+    data: bytes, samples_per_pixel: Sequence[int] = (256,), bits: int = 8
+) -> list[bytes]:
+    """Compute min/max waveform peaks at several zoom levels in one decode.
+
+    Each level is an audiowaveform ``.dat`` (version 1) file: a 20-byte
+    little-endian header (version, flags, sample rate, samples per pixel,
+    pixel count) followed by interleaved min/max pairs. Channels are
+    averaged to mono. Levels whose ``samples_per_pixel`` is a multiple of a
+    finer level are reduced from that level instead of the samples.
+
+    Args:
+        data: Input media/audio bytes.
+        samples_per_pixel: Zoom levels, in source samples per pixel.
+        bits: Peak resolution, 8 (int8) or 16 (int16).
+
+    Returns:
+        One ``.dat`` payload per entry of ``samples_per_pixel``, same order.
+    """
+    levels = [int(v) for v in samples_per_pixel]
+    if not levels:
+        raise ValueError("samples_per_pixel must not be empty")
+    if len(levels) > 16:
+        raise ValueError("at most 16 zoom levels are supported")
+    if any(v < 1 for v in levels):
+        raise ValueError("samples_per_pixel values must be >= 1")
+    if bits not in (8, 16):
+        raise ValueError("bits must be 8 or 16")
+    buf = (ctypes.c_uint8 * len(data)).from_buffer_copy(data)
+    spp = (ctypes.c_int * len(levels))(*levels)
+    blob = _call_bytes_fn(_lib.audio_peaks, buf, len(data), spp, len(levels), bits)
+
+    out = []
+    offset = 0
+    pair_size = 2 if bits == 8 else 4
+    for _ in levels:
+        pixels = struct.unpack_from("<I", blob, offset + 16)[0]
+        end = offset + 20 + pixels * pair_size
+        out.append(blob[offset:end])
+        offset = end
+    return out
+
+
+@controlled
+def audio_spectrogram(
+    data: bytes,
+    n_fft: int = 1024,
+    hop_length: int = 256,
+    n_mels: int = 64,
+    sample_rate: int | None = None,
+    fmin: float = 0.0,
+    fmax: float | None = None,
+    log: bool = True,
+    output: str = "float",
+    num_threads: int = 0,
+) -> memoryview:
+    """Compute an STFT spectrogram or mel-band energies natively.
+
+    Audio is decoded once, resampled and downmixed to mono, then cut into
+    Hann-windowed frames (``n_fft`` long, every ``hop_length`` samples; the
+    last frame is zero-padded). Blocks of frames are transformed by a
+    bundled radix-2 FFT on ``num_threads`` workers.
+
+    Args:
+        data: Input media/audio bytes.
+        n_fft: FFT size, a power of two between 16 and 16384.
+        hop_length: Samples between frame starts. Above ``n_fft`` the
+            samples between frames are skipped.
+        n_mels: Number of mel bands (HTK scale, unit-peak triangles); 0
+            keeps the ``n_fft // 2 + 1`` bin power spectrum.
+        sample_rate: Analysis rate in Hz; the source rate when omitted.
+        fmin: Lowest mel filter edge in Hz.
+        fmax: Highest mel filter edge in Hz; Nyquist when omitted.
+        log: Return power in dB (floored at -100 dB) instead of linear.
+        output: ``float`` for float32 features or ``image`` for an 8-bit
+            grayscale spectrogram covering the loudest 80 dB.
+        num_threads: Worker threads; 0 uses one per core.
+
+    Returns:
+        For ``float``, a ``memoryview`` of float32 shaped ``(frames, bins)``.
+        For ``image``, a ``memoryview`` of unsigned bytes shaped
+        ``(bins, frames)`` with the highest band on the first row.
+        ``numpy.asarray(view)`` wraps either without copying.
+    """
+    if n_fft < 16 or n_fft > 16384 or n_fft & (n_fft - 1):
+        raise ValueError("n_fft must be a power of two between 16 and 16384")
+    if hop_length < 1:
+        raise ValueError("hop_length must be >= 1")
+    if n_mels < 0:
+        raise ValueError("n_mels must be >= 0")
+    if sample_rate is not None and sample_rate <= 0:
+        raise ValueError("sample_rate must be > 0")
+    if fmin < 0 or (fmax is not None and fmax <= fmin):
+        raise ValueError("fmin must be >= 0 and below fmax")
+    if output not in ("float", "image"):
+        raise ValueError("output must be 'float' or 'image'")
+    if num_threads < 0:
+        raise ValueError("num_threads must be >= 0")
 
+    buf = (ctypes.c_uint8 * len(data)).from_buffer_copy(data)
+    frames = ctypes.c_int()
+    bins = ctypes.c_int()
+    out_size = ctypes.c_size_t()
+    result_ptr = _lib.audio_spectrogram(
+        buf,
+        len(data),
+        sample_rate or -1,
+        n_fft,
+        hop_length,
+        n_mels,
+        ctypes.c_double(fmin),
+        ctypes.c_double(fmax or 0.0),
+        1 if log else 0,
+        1 if output == "image" else 0,
+        num_threads,
+        ctypes.byref(frames),
+        ctypes.byref(bins),
+        ctypes.byref(out_size),
+    )
+    if not result_ptr:
+        raise RuntimeError("Operation failed")
+    out = _take_native_buffer(result_ptr, out_size.value)
+    if output == "image":
+        return memoryview(out).cast("B", (bins.value, frames.value))
+    return memoryview(out).cast("f", (frames.value, bins.value))
 
-def silence_remove(data: bytes, threshold_db: float = -40.0, min_silence: float = 0.3) -> bytes:
-    """Remove silent regions from media/audio and return compacted WAV audio.
 
-    The input is decoded to 16-bit PCM WAV, then scanned frame-by-frame.
-    Any contiguous region whose peak amplitude stays below `threshold_db` for at
-    least `min_silence` seconds is removed. Non-silent regions are preserved in
-    their original order without crossfades.
+@controlled
+def silence_remove(
+    data: bytes, threshold_db: float = -40.0, min_silence: float = 0.3, format: str = "wav"
+) -> bytes:
+    """Remove silent regions from media/audio and return compacted audio.
+
+    A first native pass runs the same windowed-RMS detector as
+    `silence_detect`; the second pass copies non-silent audio through
+    unchanged and drops each detected range. Only the cut points are
+    processed: the first and last 10 ms of every removed range are
+    crossfaded so splices do not click.
 
     Args:
         data: Input media or audio bytes.
-        threshold_db: Silence threshold in dBFS. Frames at or below this level
-            are considered silent.
+        threshold_db: Silence threshold in dBFS. Windows whose RMS is at or
+            below this level are considered silent.
         min_silence: Minimum contiguous silence duration (seconds) required
             before a region is removed.
+        format: Output audio format (default wav).
 
     Returns:
-        WAV bytes containing the input audio with detected silence removed.
+        Audio bytes containing the input audio with detected silence removed.
 
     Raises:
         ValueError: If `min_silence` is not greater than zero.
     """
     if min_silence <= 0:
         raise ValueError("min_silence must be > 0")
-    samples, channels, sample_rate = _decode_or_transcode_wav_pcm16(data)
-    total_frames = len(samples) // channels
-    if total_frames == 0:
-        return _encode_wav_pcm16(samples, channels, sample_rate)
-
-    ranges = _find_silence_ranges(
-        samples,
-        channels=channels,
-        sample_rate=sample_rate,
-        threshold_db=threshold_db,
-        min_silence=min_silence,
+    _validate_format(format)
+    buf = (ctypes.c_uint8 * len(data)).from_buffer_copy(data)
+    return _call_bytes_fn(
+        _lib.audio_silence_remove,
+        buf,
+        len(data),
+        ctypes.c_double(threshold_db),
+        ctypes.c_double(min_silence),
+        format.encode("utf-8"),
     )
-    if not ranges:
-        return _encode_wav_pcm16(samples, channels, sample_rate)
-
-    keep = array("h")
-    cursor = 0
-    for r in ranges:
-        start_f = int(r["start"] * sample_rate)
-        end_f = int(r["end"] * sample_rate)
-        if start_f > cursor:
-            keep.extend(samples[cursor * channels : start_f * channels])
-        cursor = max(cursor, end_f)
-    if cursor < total_frames:
-        keep.extend(samples[cursor * channels :])
-    return _encode_wav_pcm16(keep, channels, sample_rate)
-
-
-def _find_silence_ranges(
-    samples: array,
-    *,
-    channels: int,
-    sample_rate: int,
-    threshold_db: float,
-    min_silence: float,
-) -> list[dict]:
-    """Scan decoded PCM samples and return silent time ranges."""
-    total_frames = len(samples) // channels
-    if total_frames == 0:
-        return []
-
-    threshold = int(32767 * math.pow(10.0, threshold_db / 20.0))
-    min_frames = max(1, int(min_silence * sample_rate))
-
-    silent_ranges = []
-    run_start = None
-    for i in range(total_frames):
-        frame_peak = 0
-        base = i * channels
-        for c in range(channels):
-            frame_peak = max(frame_peak, abs(samples[base + c]))
-        is_silent = frame_peak <= threshold
-        if is_silent and run_start is None:
-            run_start = i
-        elif not is_silent and run_start is not None:
-            if i - run_start >= min_frames:
-                silent_ranges.append({"start": run_start / sample_rate, "end": i / sample_rate})
-            run_start = None
-
-    if run_start is not None and total_frames - run_start >= min_frames:
-        silent_ranges.append({"start": run_start / sample_rate, "end": total_frames / sample_rate})
-    return silent_ranges
-
-
-def crossfade_audio(audio_a: bytes, audio_b: bytes, duration: float) -> bytes:
+
+
+@controlled
+def crossfade_audio(audio_a: bytes, audio_b: bytes, duration: float, format: str = "wav") -> bytes:
     """Crossfade two audio inputs over a specified overlap duration.
 
     Inputs can be raw audio bytes or containerized media with audio streams.
-    When possible, WAV PCM16 inputs are decoded directly; otherwise inputs are
-    transcoded to WAV PCM16 before blending.
+    `audio_b` is resampled to the sample rate and channel count of `audio_a`.
+    Only the overlapping `duration` of each input is buffered.
 
     Args:
         audio_a: First input audio/media bytes.
         audio_b: Second input audio/media bytes.
         duration: Crossfade duration in seconds.
+        format: Output audio format (default wav).
 
     Returns:
-        WAV bytes with blended transition.
+        Audio bytes with blended transition.
+
+    Raises:
+        ValueError: If `audio_b` cannot be resampled to the layout of
+            `audio_a`, or the overlap is shorter than one sample.
     """
     if duration <= 0:
         raise ValueError("duration must be > 0")
-    a_samples, a_channels, a_sr = _decode_or_transcode_wav_pcm16(audio_a)
-    b_samples, b_channels, b_sr = _decode_or_transcode_wav_pcm16(
-        audio_b,
-        target_sample_rate=a_sr,
-        target_channels=a_channels,
+    _validate_format(format)
+    buf_a = (ctypes.c_uint8 * len(audio_a)).from_buffer_copy(audio_a)
+    buf_b = (ctypes.c_uint8 * len(audio_b)).from_buffer_copy(audio_b)
+    return _call_dsp_fn(
+        _lib.audio_crossfade,
+        buf_a,
+        len(audio_a),
+        buf_b,
+        len(audio_b),
+        ctypes.c_double(duration),
+        format.encode("utf-8"),
     )
 
-    if a_channels != b_channels or a_sr != b_sr:
-        raise ValueError("audio streams must have matching sample rate and channels")
-
-    channels = a_channels
-    sample_rate = a_sr
-    a_frames = len(a_samples) // channels
-    b_frames = len(b_samples) // channels
-    fade_frames = min(int(duration * sample_rate), a_frames, b_frames)
-    if fade_frames <= 0:
-        raise ValueError("duration is too small for input audio lengths")
-
-    out = array("h")
-    out.extend(a_samples[: (a_frames - fade_frames) * channels])
-    for i in range(fade_frames):
-        t = i / fade_frames
-        for c in range(channels):
-            a_idx = (a_frames - fade_frames + i) * channels + c
-            b_idx = i * channels + c
-            mixed = int((1.0 - t) * a_samples[a_idx] + t * b_samples[b_idx])
-            out.append(max(-32768, min(32767, mixed)))
-    out.extend(b_samples[fade_frames * channels :])
-    return _encode_wav_pcm16(out, channels, sample_rate)
 
+@controlled
+def mix_audio(
+    sources: Sequence[bytes],
+    weights: Sequence[float] | None = None,
+    normalize: bool = True,
+    format: str = "wav",
+) -> bytes:
+    """Mix audio inputs into one audio file.
+
+    Inputs are decoded in lockstep, each resampled to the first input's
+    rate and channel layout. The longest input sets the duration; shorter
+    ones contribute silence once they end.
 
+    Args:
+        sources: Audio/media inputs to mix (at least two).
+        weights: Optional per-source weights.
+        normalize: Whether to divide weights by the sum of absolute weights.
+        format: Output audio format (default wav).
+
+    Returns:
+        Mixed audio bytes.
+
+    Raises:
+        ValueError: If a source cannot be resampled to the first one's
+            layout.
+    """
+    if len(sources) < 2:
+        raise ValueError("sources must contain at least two audio inputs")
+    if weights is not None and len(weights) != len(sources):
+        raise ValueError("weights length must match sources")
+    _validate_format(format)
+    bufs = [(ctypes.c_uint8 * len(src)).from_buffer_copy(src) for src in sources]
+    inputs = (ctypes.POINTER(ctypes.c_uint8) * len(bufs))(*bufs)
+    sizes = (ctypes.c_size_t * len(bufs))(*[len(src) for src in sources])
+    weight_arr = (ctypes.c_double * len(bufs))(*(weights or [1.0] * len(bufs)))
+    return _call_dsp_fn(
+        _lib.audio_mix,
+        inputs,
+        sizes,
+        len(bufs),
+        weight_arr,
+        ctypes.c_int(1 if normalize else 0),
+        format.encode("utf-8"),
+    )
+
+
+@controlled
 def mix_audio_tracks(
     video_data: bytes,
     tracks: Sequence[bytes],
     weights: Sequence[float] | None = None,
     normalize: bool = True,
+    envelopes: Sequence[Sequence[tuple[float, float]] | None] | None = None,
+    duck_track: int | None = None,
+    duck_db: float = -12.0,
+    duck_threshold_db: float = -35.0,
 ) -> bytes:
     """Mix additional audio tracks into a video's base audio track.
 
-    The base track is extracted from `video_data`, each extra track is decoded
-    to WAV PCM16 with matching sample rate/channel layout, and all samples are
-    mixed with optional weighting. When `normalize=True`, the mixed sample is
-    scaled by the sum of absolute weights to avoid excessive clipping.
+    The base track and every extra track are decoded in lockstep by the
+    native mixer, each through its own resampler to the base track's rate
+    and channel layout, and summed with SIMD kernels. The mix is encoded to
+    AAC straight into the output MP4 while the video stream is copied. The
+    mix is trimmed or padded with silence to the base video stream's
+    duration, whatever the length of its own audio. When `normalize=True`, weights are
+    divided by the sum of absolute weights to avoid excessive clipping.
 
     Args:
         video_data: Base video bytes.
         tracks: Extra audio/media tracks to mix in.
         weights: Optional per-track weights including base track.
         normalize: Whether to normalize by total weight.
+        envelopes: Optional gain automation per source (base track first).
+            Each entry is a list of ``(time_seconds, gain)`` points with
+            increasing times, linearly interpolated and held constant outside
+            the first/last point, or ``None`` for no automation.
+        duck_track: Optional source index (0 = base track, 1.. = `tracks`)
+            whose presence ducks every other source, e.g. a voice-over.
+        duck_db: Attenuation applied to the other sources while ducking.
+        duck_threshold_db: Level of `duck_track` (dBFS mean-square) above
+            which ducking engages.
 
     Returns:
         Video bytes with mixed audio track.
     """
     if not tracks:
         raise ValueError("tracks must contain at least one audio source")
-    if weights is not None and len(weights) != len(tracks) + 1:
+    count = len(tracks) + 1
+    if weights is not None and len(weights) != count:
         raise ValueError("weights length must be len(tracks) + 1 (base audio + extra tracks)")
-
-    base_samples, channels, sample_rate = _decode_or_transcode_wav_pcm16(video_data)
-    tracks_decoded = [base_samples]
-    decoded_cache: dict[bytes, array] = {video_data: base_samples}
-
-    for track in tracks:
-        cached = decoded_cache.get(track)
-        if cached is not None:
-            tracks_decoded.append(cached)
-            continue
-        s, _, _ = _decode_or_transcode_wav_pcm16(
-            track,
-            target_sample_rate=sample_rate,
-            target_channels=channels,
-        )
-        decoded_cache[track] = s
-        tracks_decoded.append(s)
-
-    max_len = max(len(s) for s in tracks_decoded)
-    if weights is None:
-        weights = [1.0] * len(tracks_decoded)
-
-    out = array("h")
-    weight_sum = sum(abs(w) for w in weights) if normalize else 1.0
-    if weight_sum <= 0:
-        weight_sum = 1.0
-
-    for i in range(max_len):
-        mixed = 0.0
-        for idx, samples in enumerate(tracks_decoded):
-            if i < len(samples):
-                mixed += samples[i] * weights[idx]
-        mixed /= weight_sum
-        out.append(max(-32768, min(32767, int(mixed))))
-
-    mixed_wav = _encode_wav_pcm16(out, channels, sample_rate)
-    mixed_aac = transcode_audio(mixed_wav, format="aac", sample_rate=sample_rate, channels=channels)
-
-    # Late import avoids module cycle at import-time.
-    from pymedia.video import replace_audio
-
-    return replace_audio(video_data, mixed_aac, trim=True)
+    if envelopes is not None and len(envelopes) != count:
+        raise ValueError("envelopes length must be len(tracks) + 1 (base audio + extra tracks)")
+    if duck_track is not None and not 0 <= duck_track < count:
+        raise ValueError("duck_track must index the base track or one of tracks")
+    if duck_db > 0:
+        raise ValueError("duck_db must be <= 0")
+
+    points: list[float] = []
+    counts: list[int] = []
+    for env in envelopes or [None] * count:
+        env = list(env or [])
+        times = [float(t) for t, _ in env]
+        if any(b < a for a, b in zip(times, times[1:])):
+            raise ValueError("envelope times must be non-decreasing")
+        for t, g in env:
+            points.extend((float(t), float(g)))
+        counts.append(len(env))
+
+    sources = [video_data, *tracks]
+    bufs = [(ctypes.c_uint8 * len(src)).from_buffer_copy(src) for src in sources]
+    inputs = (ctypes.POINTER(ctypes.c_uint8) * len(bufs))(*bufs)
+    sizes = (ctypes.c_size_t * len(bufs))(*[len(src) for src in sources])
+    weight_arr = (ctypes.c_double * len(bufs))(*(weights or [1.0] * len(bufs)))
+    point_arr = (ctypes.c_double * max(1, len(points)))(*points)
+    count_arr = (ctypes.c_int * count)(*counts)
+    return _call_bytes_fn(
+        _lib.audio_mix_video,
+        inputs,
+        sizes,
+        count,
+        weight_arr,
+        ctypes.c_int(1 if normalize else 0),
+        point_arr,
+        count_arr,
+        ctypes.c_int(-1 if duck_track is None else duck_track),
+        ctypes.c_double(duck_db),
+        ctypes.c_double(duck_threshold_db),
+    )
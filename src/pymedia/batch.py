@@ -0,0 +1,147 @@
+from __future__ import annotations
+
+import ctypes
+import json
+from typing import Any, Callable, Mapping, Sequence
+
+from pymedia._core import _BATCH_CALLBACK, _BatchJob, _lib
+from pymedia.control import controlled
+
+# op -> (text parameter, its default, numeric parameters with defaults).
+# Numeric parameters fill `BatchJob.args` in order; see modules/batch.c.
+_BATCH_OPS: dict[str, tuple[str | None, str | None, tuple[tuple[str, float], ...]]] = {
+    "convert_format": ("format", None, ()),
+    "trim_video": (None, None, (("start", 0.0), ("end", -1.0))),
+    "mute_video": (None, None, ()),
+    "compress_video": ("preset", "medium", (("crf", 23),)),
+    "resize_video": (None, None, (("width", -1), ("height", -1), ("crf", 23))),
+    "extract_audio": ("format", "mp3", ()),
+    "transcode_audio": (
+        "format",
+        "mp3",
+        (("bitrate", -1), ("sample_rate", -1), ("channels", -1)),
+    ),
+    "extract_frame": ("format", "jpeg", (("timestamp", 0.0),)),
+    "frame_accurate_trim": (None, None, (("start", 0.0), ("end", -1.0))),
+    "get_video_info": (None, None, ()),
+}
+
+SUPPORTED_BATCH_OPS = tuple(_BATCH_OPS)
+
+
+def _build_job(label: str, spec: Sequence[Any], keep: list) -> _BatchJob:
+    if len(spec) not in (2, 3):
+        raise ValueError(f"{label} must be (op, data) or (op, data, params)")
+    op, data = spec[0], spec[1]
+    params: Mapping[str, Any] = spec[2] if len(spec) == 3 else {}
+    if op not in _BATCH_OPS:
+        raise ValueError(f"Unsupported batch op '{op}'. Supported: {SUPPORTED_BATCH_OPS}")
+    if not data:
+        raise ValueError(f"{label} data must be non-empty bytes")
+    text_name, text_default, numeric = _BATCH_OPS[op]
+    known = {name for name, _ in numeric} | ({text_name} if text_name else set())
+    unknown = set(params) - known
+    if unknown:
+        raise ValueError(f"{label} ({op}) has unknown params: {sorted(unknown)}")
+
+    job = _BatchJob()
+    op_bytes = op.encode("utf-8")
+    buf = (ctypes.c_uint8 * len(data)).from_buffer_copy(data)
+    keep.extend((op_bytes, buf))
+    job.op = op_bytes
+    job.data = buf
+    job.size = len(data)
+    for i, (name, default) in enumerate(numeric):
+        job.args[i] = float(params.get(name, default))
+    if text_name:
+        text = params.get(text_name, text_default)
+        if text is None:
+            raise ValueError(f"{label} ({op}) requires '{text_name}'")
+        text_bytes = str(text).encode("utf-8")
+        keep.append(text_bytes)
+        job.text = text_bytes
+    return job
+
+
+@controlled
+def batch_run(
+    jobs: Sequence[tuple],
+    callback: Callable[[int, Any], None],
+    num_threads: int = 0,
+    max_pending_bytes: int = 0,
+) -> int:
+    """Run many independent jobs on the native worker pool.
+
+    Each job is ``(op, data)`` or ``(op, data, params)`` where ``op`` is one
+    of `SUPPORTED_BATCH_OPS` and ``params`` holds that function's keyword
+    arguments. Jobs are spread over a work-stealing thread pool; the Python
+    side only builds the job table and receives results.
+
+    Args:
+        jobs: Job specifications.
+        callback: Called as ``callback(index, result)`` on the calling
+            thread in completion order. ``result`` is the output bytes (a
+            dict for ``get_video_info``) or ``None`` when the job failed.
+        num_threads: Worker count. ``0`` uses one per CPU core.
+        max_pending_bytes: Bound on input bytes being processed plus
+            results not yet passed to ``callback``; workers wait before
+            starting new jobs past it. ``0`` means unbounded.
+
+    Returns:
+        Number of failed jobs.
+    """
+    if num_threads < 0:
+        raise ValueError("num_threads must be >= 0")
+    if max_pending_bytes < 0:
+        raise ValueError("max_pending_bytes must be >= 0")
+    if not jobs:
+        return 0
+
+    keep: list = []
+    table = (_BatchJob * len(jobs))(
+        *[_build_job(f"job {i}", spec, keep) for i, spec in enumerate(jobs)]
+    )
+    ops = [spec[0] for spec in jobs]
+    errors: list[BaseException] = []
+
+    def on_result(_opaque, index, data_ptr, size):
+        if errors:
+            return
+        try:
+            result = ctypes.string_at(data_ptr, size) if data_ptr else None
+            if result is not None and ops[index] == "get_video_info":
+                result = json.loads(result.decode("utf-8"))
+            callback(index, result)
+        except BaseException as exc:  # re-raised after the native call returns
+            errors.append(exc)
+
+    native_cb = _BATCH_CALLBACK(on_result)
+    failed = _lib.pymedia_batch_run(
+        table, len(jobs), num_threads, max_pending_bytes, native_cb, None
+    )
+    if errors:
+        raise errors[0]
+    if failed < 0:
+        raise RuntimeError("Batch could not be started")
+    return failed
+
+
+@controlled
+def batch_map(jobs: Sequence[tuple], num_threads: int = 0, max_pending_bytes: int = 0) -> list:
+    """Run jobs like `batch_run` and return the results in job order.
+
+    Args:
+        jobs: Job specifications, see `batch_run`.
+        num_threads: Worker count. ``0`` uses one per CPU core.
+        max_pending_bytes: Memory bound, see `batch_run`.
+
+    Returns:
+        One result per job (``None`` for failed jobs).
+    """
+    results: list = [None] * len(jobs)
+
+    def store(index: int, result: Any) -> None:
+        results[index] = result
+
+    batch_run(jobs, store, num_threads=num_threads, max_pending_bytes=max_pending_bytes)
+    return results
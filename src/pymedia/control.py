@@ -0,0 +1,130 @@
+from __future__ import annotations
+
+import ctypes
+import functools
+import json
+import threading
+from typing import Callable
+
+from pymedia._core import _PROGRESS_CALLBACK, _lib
+
+ProgressCallback = Callable[[float, float], None]
+
+
+class OperationCancelled(RuntimeError):
+    """Raised when an operation stops because it was cancelled."""
+
+
+class CancelToken:
+    """Cancellation token for long-running operations.
+
+    Pass it as ``cancel=`` to any operation that accepts one; `cancel` may
+    be called from any thread and stops every call currently using the
+    token at its next packet read. A cancelled token stays cancelled.
+    """
+
+    def __init__(self):
+        self._lock = threading.Lock()
+        self._cancelled = False
+        self._controls: set[int] = set()
+
+    @property
+    def cancelled(self) -> bool:
+        return self._cancelled
+
+    def cancel(self) -> None:
+        # Under the lock so a control cannot be freed while it is cancelled.
+        with self._lock:
+            self._cancelled = True
+            for control in self._controls:
+                _lib.pymedia_control_cancel(control)
+
+    def _attach(self, control: int) -> None:
+        with self._lock:
+            self._controls.add(control)
+            if self._cancelled:
+                _lib.pymedia_control_cancel(control)
+
+    def _detach(self, control: int) -> None:
+        with self._lock:
+            self._controls.discard(control)
+
+
+def _read_stats(control) -> dict:
+    ptr = _lib.pymedia_control_stats_json(control)
+    if not ptr:
+        return {}
+    try:
+        return json.loads(ctypes.string_at(ptr).decode("utf-8"))
+    finally:
+        _lib.pymedia_free(ptr)
+
+
+def controlled(fn):
+    """Add ``progress=``, ``cancel=`` and ``stats=`` keyword arguments to a wrapper.
+
+    ``progress(processed_sec, duration_sec)`` is called on the calling
+    thread roughly every percent of the source; raising from it cancels the
+    operation and re-raises. ``cancel`` is a `CancelToken`. A cancelled call
+    raises `OperationCancelled` instead of returning partial output.
+    ``stats`` is a dict filled with per-stage timings and counters once the
+    call returns (see docs/control.md).
+    """
+
+    @functools.wraps(fn)
+    def wrapper(
+        *args,
+        progress: ProgressCallback | None = None,
+        cancel: CancelToken | None = None,
+        stats: dict | None = None,
+        **kwargs,
+    ):
+        if progress is None and cancel is None and stats is None:
+            return fn(*args, **kwargs)
+        if cancel is not None and cancel.cancelled:
+            raise OperationCancelled(f"{fn.__name__} was cancelled")
+
+        errors: list[BaseException] = []
+        control = None
+
+        def on_progress(_opaque, processed, duration):
+            if errors:
+                return
+            try:
+                progress(processed, duration)
+            except BaseException as exc:  # re-raised once the native call unwinds
+                errors.append(exc)
+                _lib.pymedia_control_cancel(control)
+
+        native_cb = _PROGRESS_CALLBACK(on_progress) if progress else _PROGRESS_CALLBACK()
+        control = _lib.pymedia_control_new(native_cb, None)
+        if not control:
+            raise MemoryError("Could not allocate operation control")
+        if stats is not None:
+            _lib.pymedia_control_enable_stats(control)
+        if cancel is not None:
+            cancel._attach(control)
+        previous = _lib.pymedia_control_bind(control)
+        try:
+            try:
+                result = fn(*args, **kwargs)
+            except RuntimeError:
+                if not _lib.pymedia_control_cancelled(control):
+                    raise
+                result = None
+            cancelled = bool(_lib.pymedia_control_cancelled(control))
+        finally:
+            _lib.pymedia_control_bind(previous)
+            if cancel is not None:
+                cancel._detach(control)
+            if stats is not None:
+                stats.update(_read_stats(control))
+            _lib.pymedia_control_free(control)
+
+        if errors:
+            raise errors[0]
+        if cancelled:
+            raise OperationCancelled(f"{fn.__name__} was cancelled")
+        return result
+
+    return wrapper
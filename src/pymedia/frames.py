@@ -1,17 +1,38 @@
+from __future__ import annotations
+
 import ctypes
 
-from pymedia._core import _call_bytes_fn, _lib
+from pymedia._core import _call_bytes_fn, _lib, _take_native_buffer
+from pymedia.control import controlled
 
 SUPPORTED_IMAGE_FORMATS = ("jpeg", "jpg", "png")
+SUPPORTED_ACCURACY = ("exact", "keyframe")
+SUPPORTED_RAW_FORMATS = ("rgb24", "rgba", "gray8", "yuv420p")
+SUPPORTED_SCALE_ALGORITHMS = ("fast_bilinear", "bilinear", "bicubic", "nearest", "area", "lanczos")
+
+
+def _validate_accuracy(accuracy: str) -> str:
+    """Normalize and validate a frame seek accuracy mode."""
+    mode = accuracy.lower()
+    if mode not in SUPPORTED_ACCURACY:
+        raise ValueError(f"Unsupported accuracy '{accuracy}'. Supported: {SUPPORTED_ACCURACY}")
+    return mode
 
 
-def extract_frame(video_data: bytes, timestamp: float = 0.0, format: str = "jpeg") -> bytes:
+@controlled
+def extract_frame(
+    video_data: bytes, timestamp: float = 0.0, format: str = "jpeg", accuracy: str = "exact"
+) -> bytes:
     """Extract a single frame from a video as an image.
 
     Args:
         video_data: Raw video file bytes.
         timestamp: Time in seconds to extract the frame from.
         format: Output image format (jpeg, jpg, or png).
+        accuracy: `exact` decodes forward to the first frame at or after
+            `timestamp`. `keyframe` returns the nearest keyframe at or before
+            `timestamp` without decoding the rest of the GOP, which is much
+            faster for thumbnails.
 
     Returns:
         Image file bytes (JPEG or PNG).
@@ -21,20 +42,208 @@ def extract_frame(video_data: bytes, timestamp: float = 0.0, format: str = "jpeg
         raise ValueError(
             f"Unsupported image format '{format}'. Supported: {SUPPORTED_IMAGE_FORMATS}"
         )
+    mode = _validate_accuracy(accuracy)
 
+    fn = _lib.extract_keyframe if mode == "keyframe" else _lib.extract_frame
     buf = (ctypes.c_uint8 * len(video_data)).from_buffer_copy(video_data)
-    return _call_bytes_fn(
-        _lib.extract_frame, buf, len(video_data), ctypes.c_double(timestamp), fmt.encode("utf-8")
+    return _call_bytes_fn(fn, buf, len(video_data), ctypes.c_double(timestamp), fmt.encode("utf-8"))
+
+
+def _raw_frame_shape(pix_fmt: str, width: int, height: int) -> tuple:
+    """Return the buffer shape for a packed raw frame in `pix_fmt`."""
+    if pix_fmt == "rgb24":
+        return (height, width, 3)
+    if pix_fmt == "rgba":
+        return (height, width, 4)
+    if pix_fmt == "gray8":
+        return (height, width)
+    # yuv420p: Y plane followed by U and V planes (I420 layout).
+    return (height * 3 // 2, width)
+
+
+def _validate_raw_args(pix_fmt: str, width, height, scale_algo: str) -> str:
+    """Validate raw-frame arguments and return the normalized pixel format."""
+    fmt = pix_fmt.lower()
+    if fmt not in SUPPORTED_RAW_FORMATS:
+        raise ValueError(
+            f"Unsupported pixel format '{pix_fmt}'. Supported: {SUPPORTED_RAW_FORMATS}"
+        )
+    if width is not None and width <= 0:
+        raise ValueError("width must be > 0 when provided")
+    if height is not None and height <= 0:
+        raise ValueError("height must be > 0 when provided")
+    if scale_algo not in SUPPORTED_SCALE_ALGORITHMS:
+        raise ValueError(
+            f"Unsupported scale algorithm '{scale_algo}'. "
+            f"Supported: {SUPPORTED_SCALE_ALGORITHMS}"
+        )
+    return fmt
+
+
+@controlled
+def extract_frame_raw(
+    video_data: bytes,
+    timestamp: float = 0.0,
+    pix_fmt: str = "rgb24",
+    width: int | None = None,
+    height: int | None = None,
+    scale_algo: str = "bilinear",
+    accuracy: str = "exact",
+) -> memoryview:
+    """Extract a single decoded frame as raw pixels.
+
+    The frame is converted and scaled in the native layer, so there is no
+    JPEG/PNG encode and decode round-trip. The result is a writable
+    `memoryview` carrying shape and stride metadata; `numpy.asarray(view)`
+    wraps it without copying.
+
+    Args:
+        video_data: Raw video file bytes.
+        timestamp: Time in seconds to extract the frame from.
+        pix_fmt: Output pixel format (rgb24, rgba, gray8, or yuv420p).
+        width: Output width; derived from `height` and the source aspect
+            ratio when omitted.
+        height: Output height; derived from `width` when omitted.
+        scale_algo: Scaler (fast_bilinear, bilinear, bicubic, nearest, area,
+            or lanczos).
+        accuracy: `exact` or `keyframe` (see `extract_frame`).
+
+    Returns:
+        `memoryview` of unsigned bytes shaped `(h, w, 3)` for rgb24,
+        `(h, w, 4)` for rgba, `(h, w)` for gray8, or `(h * 3 // 2, w)` for
+        yuv420p (I420 plane layout).
+    """
+    fmt = _validate_raw_args(pix_fmt, width, height, scale_algo)
+    mode = _validate_accuracy(accuracy)
+
+    buf = (ctypes.c_uint8 * len(video_data)).from_buffer_copy(video_data)
+    out_w = ctypes.c_int()
+    out_h = ctypes.c_int()
+    out_size = ctypes.c_size_t()
+    result_ptr = _lib.extract_frame_raw(
+        buf,
+        len(video_data),
+        ctypes.c_double(timestamp),
+        fmt.encode("utf-8"),
+        ctypes.c_int(width or -1),
+        ctypes.c_int(height or -1),
+        scale_algo.encode("utf-8"),
+        ctypes.c_int(1 if mode == "keyframe" else 0),
+        ctypes.byref(out_w),
+        ctypes.byref(out_h),
+        ctypes.byref(out_size),
+    )
+    if not result_ptr:
+        raise RuntimeError("Operation failed")
+    data = _take_native_buffer(result_ptr, out_size.value)
+    return memoryview(data).cast("B", _raw_frame_shape(fmt, out_w.value, out_h.value))
+
+
+def iter_frame_batches(
+    video_data: bytes,
+    batch_size: int = 32,
+    fps: float | None = None,
+    width: int | None = 224,
+    height: int | None = 224,
+    pix_fmt: str = "rgb24",
+    scale_algo: str = "bilinear",
+    num_threads: int = 0,
+    pool_size: int = 2,
+):
+    """Decode a video into fixed-size batches of raw frames.
+
+    A native producer thread decodes and samples frames while worker threads
+    scale and convert them directly into a small pool of reusable batch
+    buffers, so no per-frame allocation happens after the first batches.
+    Each batch is a contiguous `(n, h, w, c)` buffer ready for
+    `numpy.asarray` or `torch.frombuffer` without copying.
+
+    Args:
+        video_data: Raw video file bytes.
+        batch_size: Frames per batch. Every batch except the last is full.
+        fps: Sampling rate in frames per second; `None` keeps every frame.
+        width: Output width; derived from `height` and the source aspect
+            ratio when `None`.
+        height: Output height; derived from `width` when `None`.
+        pix_fmt: Output pixel format (rgb24, rgba, gray8, or yuv420p).
+        scale_algo: Scaler (see `extract_frame_raw`).
+        num_threads: Scaling worker threads; 0 uses one per CPU core.
+        pool_size: Number of batch buffers cycled between the native
+            pipeline and the caller (at least 2 keeps decoding ahead).
+
+    Yields:
+        `(frames, timestamps)` where `frames` is a `memoryview` shaped
+        `(n, *frame_shape)` (see `extract_frame_raw` for per-format frame
+        shapes) and `timestamps` lists each frame's time in seconds. The
+        buffer is reused once the next batch is requested; copy it to keep
+        it longer.
+    """
+    fmt = _validate_raw_args(pix_fmt, width, height, scale_algo)
+    if batch_size <= 0:
+        raise ValueError("batch_size must be > 0")
+    if fps is not None and fps <= 0:
+        raise ValueError("fps must be > 0 when provided")
+    if num_threads < 0:
+        raise ValueError("num_threads must be >= 0")
+    if pool_size < 1:
+        raise ValueError("pool_size must be >= 1")
+
+    buf = (ctypes.c_uint8 * len(video_data)).from_buffer_copy(video_data)
+    out_w = ctypes.c_int()
+    out_h = ctypes.c_int()
+    frame_bytes = ctypes.c_size_t()
+    handle = _lib.frame_batcher_open(
+        buf,
+        len(video_data),
+        ctypes.c_double(fps or 0.0),
+        ctypes.c_int(width or -1),
+        ctypes.c_int(height or -1),
+        fmt.encode("utf-8"),
+        scale_algo.encode("utf-8"),
+        ctypes.c_int(batch_size),
+        ctypes.byref(out_w),
+        ctypes.byref(out_h),
+        ctypes.byref(frame_bytes),
     )
+    if not handle:
+        raise RuntimeError("Operation failed")
+
+    try:
+        batch_bytes = frame_bytes.value * batch_size
+        pool = [bytearray(batch_bytes) for _ in range(pool_size)]
+        pool_ptrs = (ctypes.POINTER(ctypes.c_uint8) * pool_size)(
+            *[(ctypes.c_uint8 * batch_bytes).from_buffer(b) for b in pool]
+        )
+        if _lib.frame_batcher_start(handle, pool_ptrs, pool_size, num_threads) < 0:
+            raise RuntimeError("Operation failed")
+
+        frame_shape = _raw_frame_shape(fmt, out_w.value, out_h.value)
+        timestamps = (ctypes.c_double * batch_size)()
+        count = ctypes.c_int()
+        while True:
+            slot = _lib.frame_batcher_next(handle, timestamps, ctypes.byref(count))
+            if slot == -1:
+                return
+            if slot < 0:
+                raise RuntimeError("Operation failed")
+            n = count.value
+            view = memoryview(pool[slot])[: n * frame_bytes.value]
+            yield view.cast("B", (n,) + frame_shape), list(timestamps[:n])
+    finally:
+        _lib.frame_batcher_close(handle)
 
 
-def extract_frames(video_data: bytes, interval: float = 1.0, format: str = "jpeg") -> list:
+@controlled
+def extract_frames(
+    video_data: bytes, interval: float = 1.0, format: str = "jpeg", accuracy: str = "exact"
+) -> list:
     """Extract multiple frames at regular time intervals.
 
     Args:
         video_data: Raw video file bytes.
         interval: Time between frames in seconds (default 1.0).
         format: Output image format (jpeg, jpg, or png).
+        accuracy: `exact` or `keyframe` (see `extract_frame`).
 
     Returns:
         List of image bytes, one per sampled timestamp.
@@ -48,26 +257,29 @@ def extract_frames(video_data: bytes, interval: float = 1.0, format: str = "jpeg
         raise ValueError(
             f"Unsupported image format '{format}'. Supported: {SUPPORTED_IMAGE_FORMATS}"
         )
+    mode = _validate_accuracy(accuracy)
 
     info = get_video_info(video_data)
     duration = info.get("duration", 0.0)
     if duration <= 0:
-        return [extract_frame(video_data, timestamp=0.0, format=fmt)]
+        return [extract_frame(video_data, timestamp=0.0, format=fmt, accuracy=mode)]
 
     frames = []
     ts = 0.0
     while ts < duration:
-        frames.append(extract_frame(video_data, timestamp=ts, format=fmt))
+        frames.append(extract_frame(video_data, timestamp=ts, format=fmt, accuracy=mode))
         ts += interval
     return frames
 
 
-def create_thumbnail(video_data: bytes, format: str = "jpeg") -> bytes:
+@controlled
+def create_thumbnail(video_data: bytes, format: str = "jpeg", accuracy: str = "exact") -> bytes:
     """Create a thumbnail by extracting a frame from 1/3 into the video.
 
     Args:
         video_data: Raw video file bytes.
         format: Output image format (jpeg or png).
+        accuracy: `exact` or `keyframe` (see `extract_frame`).
 
     Returns:
         Image file bytes.
@@ -77,16 +289,20 @@ def create_thumbnail(video_data: bytes, format: str = "jpeg") -> bytes:
     info = get_video_info(video_data)
     duration = info.get("duration", 0.0)
     timestamp = duration / 3.0 if duration > 0 else 0.0
-    return extract_frame(video_data, timestamp=timestamp, format=format)
+    return extract_frame(video_data, timestamp=timestamp, format=format, accuracy=accuracy)
 
 
-def generate_preview(video_data: bytes, num_frames: int = 9, format: str = "jpeg") -> list:
+@controlled
+def generate_preview(
+    video_data: bytes, num_frames: int = 9, format: str = "jpeg", accuracy: str = "exact"
+) -> list:
     """Extract evenly spaced preview frames across the clip.
 
     Args:
         video_data: Raw video file bytes.
         num_frames: Number of preview frames to sample (default 9).
         format: Output image format (jpeg or png).
+        accuracy: `exact` or `keyframe` (see `extract_frame`).
 
     Returns:
         List of image bytes.
@@ -100,19 +316,22 @@ def generate_preview(video_data: bytes, num_frames: int = 9, format: str = "jpeg
         raise ValueError(
             f"Unsupported image format '{format}'. Supported: {SUPPORTED_IMAGE_FORMATS}"
         )
+    mode = _validate_accuracy(accuracy)
 
     info = get_video_info(video_data)
     duration = info.get("duration", 0.0)
     if duration <= 0:
-        return [extract_frame(video_data, timestamp=0.0, format=fmt)]
+        return [extract_frame(video_data, timestamp=0.0, format=fmt, accuracy=mode)]
 
     if num_frames == 1:
-        return [extract_frame(video_data, timestamp=max(duration / 2.0, 0.0), format=fmt)]
+        return [
+            extract_frame(video_data, timestamp=max(duration / 2.0, 0.0), format=fmt, accuracy=mode)
+        ]
 
     # Sample endpoints and evenly spaced points in-between.
     step = duration / (num_frames - 1)
     frames = []
     for i in range(num_frames):
         ts = min(duration, i * step)
-        frames.append(extract_frame(video_data, timestamp=ts, format=fmt))
+        frames.append(extract_frame(video_data, timestamp=ts, format=fmt, accuracy=mode))
     return frames
@@ -2,8 +2,10 @@ import ctypes
 import json
 
 from pymedia._core import _lib
+from pymedia.control import controlled
 
 
+@controlled
 def get_video_info(video_data: bytes) -> dict:
     """Get metadata/info about a video file.
 
@@ -0,0 +1,203 @@
+from __future__ import annotations
+
+import asyncio
+import atexit
+import ctypes
+import itertools
+import json
+import threading
+from typing import Any
+
+from pymedia._core import _JOB_CALLBACK, _lib
+from pymedia.batch import _build_job
+from pymedia.control import OperationCancelled, _read_stats
+
+# Index = native PM_JOB_* state (modules/jobs.c).
+JOB_STATES = ("queued", "running", "done", "failed", "cancelled")
+
+_UNSET = object()
+
+
+class JobCancelledError(OperationCancelled):
+    """Raised when the result of a cancelled job is requested."""
+
+
+# Jobs whose native worker may still call back, keyed by the opaque value
+# passed to pymedia_job_submit. Holding them here keeps the input buffers
+# alive until the worker is done with them.
+_pending: dict[int, MediaJob] = {}
+_pending_lock = threading.Lock()
+_next_key = itertools.count(1)
+
+
+@_JOB_CALLBACK
+def _on_job_finished(opaque, state):
+    with _pending_lock:
+        job = _pending.pop(opaque, None)
+    if job is not None:
+        job._finished(JOB_STATES[state])
+
+
+def _resolve(future: asyncio.Future) -> None:
+    if not future.done():
+        future.set_result(None)
+
+
+class MediaJob:
+    """Handle to an operation running on the native job queue.
+
+    Created by `submit_job`. The handle can be polled, cancelled, waited on
+    with `result`, or awaited from asyncio code.
+    """
+
+    def __init__(self, op: str, keep: list):
+        self.op = op
+        self._handle = None
+        self._keep: list | None = keep
+        self._lock = threading.Lock()
+        self._state: str | None = None
+        self._waiters: list[tuple[asyncio.AbstractEventLoop, asyncio.Future]] = []
+        self._result: Any = _UNSET
+
+    def poll(self) -> str:
+        """Return the current state: one of `JOB_STATES`."""
+        return JOB_STATES[_lib.pymedia_job_poll(self._handle)]
+
+    def done(self) -> bool:
+        """Return True once the job has finished, failed or been cancelled."""
+        return self.poll() in ("done", "failed", "cancelled")
+
+    def progress(self) -> float:
+        """Return the fraction of the source processed so far, 0.0 to 1.0."""
+        return _lib.pymedia_job_progress(self._handle)
+
+    def stats(self) -> dict:
+        """Return the job's per-stage statistics so far (see docs/control.md).
+
+        Jobs always collect them; once the job has finished they cover the
+        whole operation.
+        """
+        return _read_stats(_lib.pymedia_job_control(self._handle))
+
+    def cancel(self) -> None:
+        """Request cancellation; a running job stops at its next packet read."""
+        _lib.pymedia_job_cancel(self._handle)
+
+    def result(self) -> Any:
+        """Block until the job finishes and return its output.
+
+        Returns:
+            Output bytes (a dict for ``get_video_info``).
+
+        Raises:
+            JobCancelledError: If the job was cancelled.
+            RuntimeError: If the operation failed.
+        """
+        state = JOB_STATES[_lib.pymedia_job_wait(self._handle)]
+        if state == "cancelled":
+            raise JobCancelledError(f"{self.op} job was cancelled")
+        if state == "failed":
+            raise RuntimeError("Operation failed")
+        with self._lock:
+            if self._result is _UNSET:
+                size = ctypes.c_size_t()
+                ptr = _lib.pymedia_job_result(self._handle, ctypes.byref(size))
+                data = ctypes.string_at(ptr, size.value)
+                _lib.pymedia_free(ptr)
+                self._result = (
+                    json.loads(data.decode("utf-8")) if self.op == "get_video_info" else data
+                )
+            return self._result
+
+    def __await__(self):
+        return self._wait().__await__()
+
+    async def _wait(self) -> Any:
+        loop = asyncio.get_running_loop()
+        future = loop.create_future()
+        with self._lock:
+            finished = self._state is not None
+            if not finished:
+                self._waiters.append((loop, future))
+        if finished:
+            future.set_result(None)
+        try:
+            await future
+        except asyncio.CancelledError:
+            self.cancel()
+            raise
+        return self.result()
+
+    def _finished(self, state: str) -> None:
+        # Runs on the native worker thread.
+        with self._lock:
+            self._state = state
+            self._keep = None
+            waiters, self._waiters = self._waiters, []
+        for loop, future in waiters:
+            try:
+                loop.call_soon_threadsafe(_resolve, future)
+            except RuntimeError:
+                pass  # the loop was closed; nobody is waiting any more
+
+    def __del__(self):
+        handle = getattr(self, "_handle", None)
+        if handle:
+            _lib.pymedia_job_release(handle)
+            self._handle = None
+
+
+def submit_job(op: str, data: bytes, **params: Any) -> MediaJob:
+    """Queue one operation on the native job queue and return its handle.
+
+    ``op`` and ``params`` follow the batch job table (`SUPPORTED_BATCH_OPS`);
+    the queue runs jobs on one worker per CPU core shared by the process.
+
+    Args:
+        op: Operation name, e.g. ``"compress_video"``.
+        data: Input media bytes.
+        **params: Keyword arguments of that operation.
+
+    Returns:
+        A `MediaJob` handle.
+    """
+    keep: list = []
+    spec = _build_job(op, (op, data, params), keep)
+    job = MediaJob(op, keep)
+    key = next(_next_key)
+    with _pending_lock:
+        _pending[key] = job
+    handle = _lib.pymedia_job_submit(ctypes.byref(spec), _on_job_finished, key)
+    if not handle:
+        with _pending_lock:
+            _pending.pop(key, None)
+        raise RuntimeError("Job could not be queued")
+    job._handle = handle
+    return job
+
+
+async def run_async(op: str, data: bytes, **params: Any) -> Any:
+    """Run one operation on the native job queue and await its output.
+
+    Cancelling the awaiting task cancels the native job.
+
+    Args:
+        op: Operation name, e.g. ``"compress_video"``.
+        data: Input media bytes.
+        **params: Keyword arguments of that operation.
+
+    Returns:
+        Output bytes (a dict for ``get_video_info``).
+    """
+    return await submit_job(op, data, **params)
+
+
+@atexit.register
+def _cancel_pending_jobs() -> None:
+    # Workers must not call back into a finalizing interpreter.
+    with _pending_lock:
+        jobs = list(_pending.values())
+    for job in jobs:
+        if job._handle:
+            job.cancel()
+            _lib.pymedia_job_wait(job._handle)
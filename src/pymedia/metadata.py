@@ -1,8 +1,10 @@
 import ctypes
 
 from pymedia._core import _call_bytes_fn, _lib
+from pymedia.control import controlled
 
 
+@controlled
 def strip_metadata(video_data: bytes) -> bytes:
     """Remove all metadata tags from a video (title, artist, comment, etc.).
 
@@ -16,6 +18,7 @@ def strip_metadata(video_data: bytes) -> bytes:
     return _call_bytes_fn(_lib.strip_metadata, buf, len(video_data))
 
 
+@controlled
 def set_metadata(video_data: bytes, key: str, value: str) -> bytes:
     """Set a metadata tag on a video (e.g. title, artist, comment).
 
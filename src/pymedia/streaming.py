@@ -7,11 +7,12 @@ from typing import Any
 
 from pymedia._core import _call_bytes_fn, _lib
 from pymedia.analysis import list_keyframes
-from pymedia.audio import extract_audio
+from pymedia.control import controlled
 from pymedia.info import get_video_info
 from pymedia.video import convert_format, split_video, transcode_video
 
 
+@controlled
 def create_fragmented_mp4(data: bytes) -> bytes:
     """Remux media into fragmented MP4 (fMP4) output.
 
@@ -25,6 +26,7 @@ def create_fragmented_mp4(data: bytes) -> bytes:
     return _call_bytes_fn(_lib.create_fragmented_mp4, buf, len(data))
 
 
+@controlled
 def stream_copy(data: bytes, map_spec: str | None = None, output_format: str = "mp4") -> bytes:
     """Copy streams into a new container without re-encoding.
 
@@ -53,6 +55,7 @@ def _video_packet_timestamps(data: bytes) -> list[float]:
         _lib.pymedia_free(ptr)
 
 
+@controlled
 def probe_media(data: bytes, packets: bool = False, frames: bool = False) -> dict[str, Any]:
     """Probe media structure and optional packet/frame timestamp detail.
 
@@ -105,53 +108,39 @@ def probe_media(data: bytes, packets: bool = False, frames: bool = False) -> dic
     return out
 
 
+@controlled
 def analyze_loudness(data: bytes) -> dict[str, float]:
-    """Compute simple loudness metrics from decoded PCM audio.
+    """Measure loudness per ITU-R BS.1770-4 / EBU R128 in a single decode pass.
+
+    The native meter applies K-weighting, gates 400 ms blocks for integrated
+    loudness, tracks momentary (400 ms) and short-term (3 s) maxima, computes
+    loudness range (LRA) and a 4x-oversampled true peak. Memory does not grow
+    with duration.
 
     Args:
         data: Input media bytes.
 
     Returns:
-        Dict containing RMS/peak dBFS and audio stream properties.
+        Dict with ``integrated_lufs``, ``momentary_max_lufs``,
+        ``short_term_max_lufs``, ``loudness_range_lu``, ``true_peak_dbtp``,
+        ``peak_dbfs`` (sample peak), ``rms_dbfs``, ``sample_rate`` and
+        ``channels``. Levels that cannot be measured (silence, inputs shorter
+        than one block) are ``-inf``.
+
+    Raises:
+        RuntimeError: If the input has no decodable audio stream.
     """
-    wav = extract_audio(data, format="wav")
-    import io
-    import wave
-    from array import array
-
-    with wave.open(io.BytesIO(wav), "rb") as wf:
-        raw = wf.readframes(wf.getnframes())
-        sr = wf.getframerate()
-        ch = wf.getnchannels()
-
-    arr = array("h")
-    arr.frombytes(raw)
-    if not arr:
-        return {
-            "rms_dbfs": float("-inf"),
-            "peak_dbfs": float("-inf"),
-            "sample_rate": float(sr),
-            "channels": float(ch),
-        }
-
-    acc = 0.0
-    peak = 0
-    for s in arr:
-        v = abs(int(s))
-        peak = max(peak, v)
-        acc += float(s) * float(s)
-    rms = math.sqrt(acc / len(arr))
-
-    rms_dbfs = 20.0 * math.log10(max(rms, 1.0) / 32767.0)
-    peak_dbfs = 20.0 * math.log10(max(peak, 1) / 32767.0)
-    return {
-        "rms_dbfs": float(rms_dbfs),
-        "peak_dbfs": float(peak_dbfs),
-        "sample_rate": float(sr),
-        "channels": float(ch),
-    }
+    buf = (ctypes.c_uint8 * len(data)).from_buffer_copy(data)
+    result_ptr = _lib.analyze_loudness_json(buf, len(data))
+    if not result_ptr:
+        raise RuntimeError("Failed to analyze loudness")
+    try:
+        return json.loads(ctypes.string_at(result_ptr).decode("utf-8"))
+    finally:
+        _lib.pymedia_free(result_ptr)
 
 
+@controlled
 def analyze_gop(data: bytes) -> dict[str, Any]:
     """Analyze GOP structure from keyframe spacing.
 
@@ -174,6 +163,7 @@ def analyze_gop(data: bytes) -> dict[str, Any]:
     }
 
 
+@controlled
 def detect_vfr_cfr(data: bytes) -> dict[str, Any]:
     """Classify stream timing as CFR or VFR from packet deltas.
 
@@ -199,6 +189,7 @@ def detect_vfr_cfr(data: bytes) -> dict[str, Any]:
     return {"mode": mode, "jitter": jitter, "packet_count": len(ts), "mean_delta": mean}
 
 
+@controlled
 def package_hls(
     data: bytes, segment_time: int = 6, variants: list[dict] | None = None, encrypt: bool = False
 ):
@@ -312,6 +303,7 @@ def package_hls(
     }
 
 
+@controlled
 def package_dash(data: bytes, segment_time: int = 6, profile: str = "live"):
     """Package media into in-memory DASH artifacts.
 
@@ -5,6 +5,7 @@ import json
 import re
 
 from pymedia._core import _call_bytes_fn, _lib
+from pymedia.control import controlled
 
 
 def _normalize_newlines(text: str) -> str:
@@ -105,6 +106,7 @@ def convert_subtitles(sub_data: bytes | str, src: str = "srt", dst: str = "vtt")
     raise ValueError("Unsupported subtitle conversion; supported: srt<->vtt")
 
 
+@controlled
 def extract_subtitles(video_data: bytes) -> list[dict]:
     """Extract soft subtitle tracks as structured metadata.
 
@@ -124,6 +126,7 @@ def extract_subtitles(video_data: bytes) -> list[dict]:
         _lib.pymedia_free(result_ptr)
 
 
+@controlled
 def add_subtitle_track(
     video_data: bytes, subtitles: str | bytes, lang: str = "eng", codec: str = "mov_text"
 ) -> bytes:
@@ -155,6 +158,7 @@ def add_subtitle_track(
     )
 
 
+@controlled
 def remove_subtitle_tracks(video_data: bytes, language: str | None = None) -> bytes:
     """Remove subtitle streams from media.
 
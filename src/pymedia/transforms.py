@@ -2,10 +2,12 @@ import ctypes
 from typing import Sequence
 
 from pymedia._core import _call_bytes_fn, _lib
+from pymedia.control import controlled
 
 SUPPORTED_ANGLES = (90, 180, 270, -90)
 
 
+@controlled
 def rotate_video(video_data: bytes, angle: int) -> bytes:
     """Rotate video by 90, 180, or 270 degrees (re-encodes with H.264).
 
@@ -22,12 +24,15 @@ def rotate_video(video_data: bytes, angle: int) -> bytes:
     return _call_bytes_fn(_lib.rotate_video, buf, len(video_data), ctypes.c_int(angle))
 
 
+@controlled
 def change_speed(video_data: bytes, speed: float) -> bytes:
-    """Change video playback speed by rescaling timestamps.
+    """Change playback speed while preserving audio pitch.
 
-    Note: This adjusts both video and audio timing. Audio pitch will change
-    proportionally (tape-speed effect). Use speed > 1.0 to speed up, < 1.0
-    to slow down.
+    Video packets are stream-copied with rescaled timestamps. Audio is
+    decoded and time-stretched with WSOLA on a separate thread, then
+    re-encoded to AAC, so duration and sync follow the new speed without a
+    pitch shift. Inputs without decodable audio are only retimed. Use
+    speed > 1.0 to speed up, < 1.0 to slow down.
 
     Args:
         video_data: Raw video file bytes.
@@ -42,6 +47,7 @@ def change_speed(video_data: bytes, speed: float) -> bytes:
     return _call_bytes_fn(_lib.change_speed, buf, len(video_data), ctypes.c_double(speed))
 
 
+@controlled
 def merge_videos(video_data1: bytes, video_data2: bytes) -> bytes:
     """Concatenate two videos sequentially.
 
@@ -66,8 +72,14 @@ def merge_videos(video_data1: bytes, video_data2: bytes) -> bytes:
     )
 
 
+@controlled
 def concat_videos(videos: Sequence[bytes]) -> bytes:
-    """Concatenate multiple videos in order.
+    """Concatenate multiple videos in order in a single pass.
+
+    The output tracks take the first video's parameters. Inputs with the
+    same codec configuration are stream-copied; the others are re-encoded
+    into those tracks (H.264 video scaled to the first video's size, audio
+    with its codec, rate and channels).
 
     Args:
         videos: Sequence of video byte blobs. Must contain at least two items.
@@ -80,12 +92,13 @@ def concat_videos(videos: Sequence[bytes]) -> bytes:
     if any(not item for item in videos):
         raise ValueError("all videos must be non-empty bytes")
 
-    merged = merge_videos(videos[0], videos[1])
-    for video in videos[2:]:
-        merged = merge_videos(merged, video)
-    return merged
+    bufs = [(ctypes.c_uint8 * len(v)).from_buffer_copy(v) for v in videos]
+    inputs = (ctypes.POINTER(ctypes.c_uint8) * len(bufs))(*bufs)
+    sizes = (ctypes.c_size_t * len(bufs))(*[len(v) for v in videos])
+    return _call_bytes_fn(_lib.concat_videos, inputs, sizes, len(bufs))
 
 
+@controlled
 def reverse_video(video_data: bytes) -> bytes:
     """Reverse video playback (plays backwards).
 
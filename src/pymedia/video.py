@@ -5,11 +5,13 @@ from typing import Sequence
 
 from pymedia._core import _call_bytes_fn, _lib
 from pymedia.audio import transcode_audio
+from pymedia.control import controlled
 from pymedia.info import get_video_info
 
 SUPPORTED_CONTAINER_FORMATS = ("mp4", "mkv", "webm", "avi", "mov", "flv", "ts")
 
 
+@controlled
 def convert_format(video_data: bytes, format: str) -> bytes:
     """Convert video to a different container format (remux, no re-encoding).
 
@@ -24,6 +26,7 @@ def convert_format(video_data: bytes, format: str) -> bytes:
     return _call_bytes_fn(_lib.convert_format, buf, len(video_data), format.encode("utf-8"))
 
 
+@controlled
 def trim_video(video_data: bytes, start: float = 0.0, end: float = -1.0) -> bytes:
     """Trim video to a time range (remux, no re-encoding).
 
@@ -44,6 +47,7 @@ def trim_video(video_data: bytes, start: float = 0.0, end: float = -1.0) -> byte
     )
 
 
+@controlled
 def cut_video(video_data: bytes, start: float = 0.0, duration: float = -1.0) -> bytes:
     """Cut a clip from a video by start + duration.
 
@@ -63,6 +67,7 @@ def cut_video(video_data: bytes, start: float = 0.0, duration: float = -1.0) ->
     return trim_video(video_data, start=start, end=end)
 
 
+@controlled
 def mute_video(video_data: bytes) -> bytes:
     """Remove all audio tracks from a video (remux, no re-encoding).
 
@@ -76,7 +81,10 @@ def mute_video(video_data: bytes) -> bytes:
     return _call_bytes_fn(_lib.mute_video, buf, len(video_data))
 
 
-def compress_video(video_data: bytes, crf: int = 23, preset: str = "medium") -> bytes:
+@controlled
+def compress_video(
+    video_data: bytes, crf: int = 23, preset: str = "medium", segments: int = 1
+) -> bytes:
     """Re-encode video with H.264 at the given CRF quality.
 
     Args:
@@ -85,11 +93,28 @@ def compress_video(video_data: bytes, crf: int = 23, preset: str = "medium") ->
              Default 23 is visually lossless for most content.
         preset: Encoding speed preset. One of: ultrafast, superfast, veryfast,
                 faster, fast, medium, slow, slower, veryslow.
+        segments: Number of keyframe-aligned chunks encoded in parallel by
+                independent encoders. 1 uses a single encoder; 0 uses one
+                chunk per CPU core. Rate control restarts at each chunk.
 
     Returns:
         Re-encoded MP4 video bytes.
     """
+    if segments < 0:
+        raise ValueError("segments must be >= 0")
+
     buf = (ctypes.c_uint8 * len(video_data)).from_buffer_copy(video_data)
+    if segments != 1:
+        return _call_bytes_fn(
+            _lib.reencode_video_parallel,
+            buf,
+            len(video_data),
+            ctypes.c_int(crf),
+            preset.encode("utf-8"),
+            ctypes.c_int(-1),
+            ctypes.c_int(-1),
+            ctypes.c_int(segments),
+        )
     return _call_bytes_fn(
         _lib.reencode_video,
         buf,
@@ -101,6 +126,7 @@ def compress_video(video_data: bytes, crf: int = 23, preset: str = "medium") ->
     )
 
 
+@controlled
 def transcode_video(
     data: bytes,
     vcodec: str = "h264",
@@ -156,6 +182,7 @@ def transcode_video(
     return out
 
 
+@controlled
 def resize_video(video_data: bytes, width: int = -1, height: int = -1, crf: int = 23) -> bytes:
     """Resize video to the given dimensions (re-encodes with H.264).
 
@@ -186,6 +213,7 @@ def resize_video(video_data: bytes, width: int = -1, height: int = -1, crf: int
     )
 
 
+@controlled
 def crop_video(
     video_data: bytes,
     x: int,
@@ -228,6 +256,7 @@ def crop_video(
     )
 
 
+@controlled
 def change_fps(video_data: bytes, fps: float, crf: int = 23, preset: str = "medium") -> bytes:
     """Convert a video to a target constant frame rate."""
     if fps <= 0:
@@ -243,6 +272,7 @@ def change_fps(video_data: bytes, fps: float, crf: int = 23, preset: str = "medi
     )
 
 
+@controlled
 def pad_video(
     video_data: bytes,
     width: int,
@@ -276,6 +306,7 @@ def pad_video(
     )
 
 
+@controlled
 def flip_video(
     video_data: bytes,
     horizontal: bool = False,
@@ -322,6 +353,7 @@ def _apply_basic_filter(
     )
 
 
+@controlled
 def blur_video(
     video_data: bytes, sigma: float = 2.0, crf: int = 23, preset: str = "medium"
 ) -> bytes:
@@ -332,6 +364,7 @@ def blur_video(
     return _apply_basic_filter(video_data, mode=1, p1=radius, crf=crf, preset=preset)
 
 
+@controlled
 def denoise_video(
     video_data: bytes, strength: float = 0.5, crf: int = 23, preset: str = "medium"
 ) -> bytes:
@@ -342,6 +375,7 @@ def denoise_video(
     return _apply_basic_filter(video_data, mode=2, p1=radius, crf=crf, preset=preset)
 
 
+@controlled
 def sharpen_video(
     video_data: bytes, amount: float = 1.0, crf: int = 23, preset: str = "medium"
 ) -> bytes:
@@ -351,6 +385,7 @@ def sharpen_video(
     return _apply_basic_filter(video_data, mode=3, p1=amount, crf=crf, preset=preset)
 
 
+@controlled
 def color_correct(
     video_data: bytes,
     brightness: float = 0.0,
@@ -365,6 +400,7 @@ def color_correct(
     )
 
 
+@controlled
 def apply_lut(
     video_data: bytes, lut_file_bytes: bytes, crf: int = 23, preset: str = "medium"
 ) -> bytes:
@@ -384,6 +420,7 @@ def apply_lut(
     return _apply_basic_filter(video_data, mode=5, p1=gamma, crf=crf, preset=preset)
 
 
+@controlled
 def overlay_video(
     base: bytes,
     pip: bytes,
@@ -413,6 +450,7 @@ def overlay_video(
     return add_watermark(base, pip_frame, x=x, y=y, opacity=opacity)
 
 
+@controlled
 def stack_videos(videos: Sequence[bytes], layout: str = "hstack|vstack|grid") -> bytes:
     """Compose multiple inputs into a stacked layout.
 
@@ -486,6 +524,7 @@ def stack_videos(videos: Sequence[bytes], layout: str = "hstack|vstack|grid") ->
     return out
 
 
+@controlled
 def split_screen(videos: Sequence[bytes], layout: str = "2x2") -> bytes:
     """Compose videos into split-screen output.
 
@@ -515,6 +554,7 @@ def split_screen(videos: Sequence[bytes], layout: str = "2x2") -> bytes:
     raise ValueError("layout must be one of: 2x2, 2x1, 1x2, hstack, vstack, grid")
 
 
+@controlled
 def apply_filtergraph(
     data: bytes,
     video_filters: Sequence[str] | str | None = None,
@@ -628,6 +668,7 @@ def apply_filtergraph(
     return out
 
 
+@controlled
 def replace_audio(video_data: bytes, audio_source_data: bytes, trim: bool = True) -> bytes:
     """Replace a video's audio track with audio from another media file.
 
@@ -654,6 +695,7 @@ def replace_audio(video_data: bytes, audio_source_data: bytes, trim: bool = True
     )
 
 
+@controlled
 def add_watermark(
     video_data: bytes,
     watermark_image_data: bytes,
@@ -698,6 +740,7 @@ def add_watermark(
     )
 
 
+@controlled
 def video_to_gif(
     video_data: bytes, fps: int = 10, width: int = 320, start: float = 0.0, duration: float = -1.0
 ) -> bytes:
@@ -725,6 +768,7 @@ def video_to_gif(
     )
 
 
+@controlled
 def stabilize_video(video_data: bytes, strength: int = 16) -> bytes:
     """Apply lightweight temporal stabilization.
 
@@ -743,6 +787,7 @@ def stabilize_video(video_data: bytes, strength: int = 16) -> bytes:
     return _call_bytes_fn(_lib.stabilize_video, buf, len(video_data), ctypes.c_int(strength))
 
 
+@controlled
 def subtitle_burn_in(
     video_data: bytes,
     subtitles: str,
@@ -784,6 +829,7 @@ def subtitle_burn_in(
     )
 
 
+@controlled
 def create_audio_image_video(
     audio_data: bytes,
     images: Sequence[bytes],
@@ -843,11 +889,13 @@ def create_audio_image_video(
     )
 
 
+@controlled
 def change_video_audio(video_data: bytes, audio_source_data: bytes, trim: bool = True) -> bytes:
     """Alias for replace_audio with identical behavior."""
     return replace_audio(video_data, audio_source_data, trim=trim)
 
 
+@controlled
 def split_video(
     video_data: bytes,
     segment_duration: float,
@@ -1,10 +1,166 @@
+import math
+import struct
+import wave
+import zlib
+from io import BytesIO
 from pathlib import Path
 
 import pytest
 
+from pymedia import concat_videos, create_audio_image_video, iter_frame_batches
+
 
 @pytest.fixture(scope="session")
 def video_data():
     """Load a minimal 1-second MP4 fixture bundled with the tests."""
     sample = Path(__file__).parent / "assets" / "sample.mp4"
     return sample.read_bytes()
+
+
+@pytest.fixture(scope="session")
+def multi_gop_video(video_data):
+    """Three copies of the fixture back to back: keyframes at 0, 1 and 2 seconds."""
+    return concat_videos([video_data] * 3)
+
+
+def tone_wav(segments, rate=44100, channels=1):
+    """16-bit PCM WAV of `(freq, seconds)` or `(freq, seconds, amplitude)` sine
+    segments, each starting at phase zero; freq 0 is silence. The amplitude
+    defaults to 16000 and every channel carries the same signal."""
+    samples = []
+    for freq, seconds, *amp in segments:
+        peak = amp[0] if amp else 16000
+        samples += [
+            int(peak * math.sin(2 * math.pi * freq * i / rate)) for i in range(int(seconds * rate))
+        ]
+    samples = [s for s in samples for _ in range(channels)]
+    out = BytesIO()
+    with wave.open(out, "wb") as wf:
+        wf.setnchannels(channels)
+        wf.setsampwidth(2)
+        wf.setframerate(rate)
+        wf.writeframes(struct.pack(f"<{len(samples)}h", *samples))
+    return out.getvalue()
+
+
+def gray_png(width, height, pixel):
+    """8-bit grayscale PNG; `pixel` is a level or a function `(x, y) -> level`."""
+    at = pixel if callable(pixel) else lambda x, y: pixel
+    rows = (b"\x00" + bytes(at(x, y) for x in range(width)) for y in range(height))
+    raw = zlib.compress(b"".join(rows))
+
+    def chunk(tag, data):
+        body = tag + data
+        return struct.pack(">I", len(data)) + body + struct.pack(">I", zlib.crc32(body))
+
+    header = struct.pack(">IIBBBBB", width, height, 8, 0, 0, 0, 0)
+    return b"\x89PNG\r\n\x1a\n" + chunk(b"IHDR", header) + chunk(b"IDAT", raw) + chunk(b"IEND", b"")
+
+
+@pytest.fixture(scope="session")
+def h264_multi_gop_video(video_data):
+    """Three one-second H.264 slideshows joined by stream copy, so each starts
+    a GOP. Every half second shows a different gray level."""
+    clips = [
+        create_audio_image_video(
+            video_data,
+            [gray_png(64, 64, 20 + 80 * i), gray_png(64, 64, 60 + 80 * i)],
+            seconds_per_image=0.5,
+            transition="none",
+            width=64,
+            height=64,
+        )
+        for i in range(3)
+    ]
+    return concat_videos(clips)
+
+
+@pytest.fixture(scope="session")
+def decode_frames():
+    """Return a helper decoding every video frame to `(timestamp, 32x32 gray bytes)`."""
+
+    def decode(data):
+        out = []
+        for frames, timestamps in iter_frame_batches(
+            data, batch_size=16, width=32, height=32, pix_fmt="gray8"
+        ):
+            raw = frames.tobytes()
+            size = len(raw) // len(timestamps)
+            out.extend((t, raw[i * size : (i + 1) * size]) for i, t in enumerate(timestamps))
+        return out
+
+    return decode
+
+
+def _mp4_boxes(data, pos, end):
+    while pos + 8 <= end:
+        size, kind = struct.unpack_from(">I4s", data, pos)
+        header = 8
+        if size == 1:
+            size = struct.unpack_from(">Q", data, pos + 8)[0]
+            header = 16
+        elif size == 0:
+            size = end - pos
+        if size < header:
+            return
+        yield kind, pos + header, pos + size
+        pos += size
+
+
+def _mp4_child(data, parent, kind):
+    for k, start, end in _mp4_boxes(data, *parent):
+        if k == kind:
+            return start, end
+    return None
+
+
+@pytest.fixture(scope="session")
+def video_samples():
+    """Return a helper listing an MP4's video samples in decode order as
+    `(bytes, is_sync)`, read straight from the sample tables."""
+
+    def samples(data):
+        moov = _mp4_child(data, (0, len(data)), b"moov")
+        for kind, start, end in _mp4_boxes(data, *moov):
+            if kind != b"trak":
+                continue
+            mdia = _mp4_child(data, (start, end), b"mdia")
+            hdlr = _mp4_child(data, mdia, b"hdlr")
+            if data[hdlr[0] + 8 : hdlr[0] + 12] != b"vide":
+                continue
+            stbl = _mp4_child(data, _mp4_child(data, mdia, b"minf"), b"stbl")
+
+            pos = _mp4_child(data, stbl, b"stsz")[0]
+            fixed, count = struct.unpack_from(">II", data, pos + 4)
+            sizes = [fixed] * count if fixed else struct.unpack_from(f">{count}I", data, pos + 12)
+
+            co = _mp4_child(data, stbl, b"stco")
+            fmt = "I" if co else "Q"
+            co = co or _mp4_child(data, stbl, b"co64")
+            n = struct.unpack_from(">I", data, co[0] + 4)[0]
+            offsets = struct.unpack_from(f">{n}{fmt}", data, co[0] + 8)
+
+            pos = _mp4_child(data, stbl, b"stsc")[0]
+            n = struct.unpack_from(">I", data, pos + 4)[0]
+            runs = [struct.unpack_from(">III", data, pos + 8 + 12 * i)[:2] for i in range(n)]
+
+            stss = _mp4_child(data, stbl, b"stss")
+            sync = None
+            if stss:
+                n = struct.unpack_from(">I", data, stss[0] + 4)[0]
+                sync = set(struct.unpack_from(f">{n}I", data, stss[0] + 8))
+
+            out = []
+            for chunk, offset in enumerate(offsets, 1):
+                per_chunk = [spc for first, spc in runs if first <= chunk][-1]
+                for _ in range(per_chunk):
+                    if len(out) == len(sizes):
+                        break
+                    size = sizes[len(out)]
+                    is_sync = sync is None or len(out) + 1 in sync
+                    out.append((data[offset : offset + size], is_sync))
+                    offset += size
+            return out
+        return []
+
+    return samples
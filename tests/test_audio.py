@@ -1,10 +1,20 @@
+import io
+import struct
+import wave
+
 import pytest
+from conftest import tone_wav
 
 from pymedia import (
+    analyze_loudness,
+    audio_peaks,
+    audio_spectrogram,
     change_audio_bitrate,
     crossfade_audio,
     extract_audio,
     fade_audio,
+    get_video_info,
+    mix_audio,
     normalize_audio_lufs,
     resample_audio,
     silence_detect,
@@ -12,6 +22,9 @@ from pymedia import (
     transcode_audio,
 )
 
+# 0.5 s of 440 Hz, 0.5 s of silence, 0.5 s of 440 Hz at 44.1 kHz.
+_TONE_GAP_TONE = tone_wav([(440, 0.5), (0, 0.5), (440, 0.5)])
+
 
 def test_extract_mp3(video_data):
     audio = extract_audio(video_data, format="mp3")
@@ -30,6 +43,19 @@ def test_extract_aac(video_data):
     assert len(audio) > 0
 
 
+def test_extract_aac_stream_copy_keeps_source_rate(video_data):
+    # The fixture carries AAC audio, so "aac" takes the stream-copy path and
+    # emits ADTS frames at the source sample rate.
+    src = get_video_info(video_data)
+    assert src["audio_codec"] == "aac"
+    audio = extract_audio(video_data, format="aac")
+    assert audio[0] == 0xFF and audio[1] & 0xF0 == 0xF0
+    out = get_video_info(audio)
+    assert out["audio_codec"] == "aac"
+    assert out["sample_rate"] == src["sample_rate"]
+    assert out["channels"] == src["channels"]
+
+
 def test_extract_ogg(video_data):
     audio = extract_audio(video_data, format="ogg")
     assert len(audio) > 0
@@ -75,6 +101,12 @@ def test_normalize_audio_lufs(video_data):
     assert normalized[:4] == b"RIFF"
 
 
+def test_normalize_audio_lufs_hits_target(video_data):
+    normalized = normalize_audio_lufs(video_data, target=-23.0)
+    measured = analyze_loudness(normalized)["integrated_lufs"]
+    assert abs(measured - -23.0) < 1.5
+
+
 def test_silence_detect(video_data):
     ranges = silence_detect(video_data, threshold_db=-35.0, min_silence=0.05)
     assert isinstance(ranges, list)
@@ -88,6 +120,106 @@ def test_silence_remove(video_data):
     assert removed[:4] == b"RIFF"
 
 
+def test_silence_detect_windowed_rms_bounds():
+    ranges = silence_detect(_TONE_GAP_TONE, threshold_db=-40.0, min_silence=0.2)
+    assert len(ranges) == 1
+    assert abs(ranges[0]["start"] - 0.5) < 0.03
+    assert abs(ranges[0]["end"] - 1.0) < 0.03
+
+
+def test_silence_detect_close_ranges_disjoint():
+    # Two silences split by a 10 ms blip, shorter than the 20 ms RMS window.
+    wav = tone_wav([(440, 0.3), (0, 0.3), (440, 0.01, 650), (0, 0.3), (440, 0.3)], rate=48000)
+    ranges = silence_detect(wav, threshold_db=-40.0, min_silence=0.1)
+    assert len(ranges) == 2
+    for prev, cur in zip(ranges, ranges[1:]):
+        assert prev["start"] < prev["end"] <= cur["start"] < cur["end"]
+
+
+def test_silence_remove_crossfades_only_at_cut():
+    wav = _TONE_GAP_TONE
+    out = silence_remove(wav, threshold_db=-40.0, min_silence=0.2)
+    # 1.5 s in, 0.5 s gap removed, 10 ms of the gap kept as the crossfade.
+    assert abs(_wav_frames(out) - (44100 + 441)) < 0.03 * 44100
+
+
+def test_audio_peaks_dat_pyramid():
+    wav = _TONE_GAP_TONE
+    fine, coarse = audio_peaks(wav, samples_per_pixel=[441, 4410], bits=8)
+    version, flags, rate, spp, length = struct.unpack_from("<iIiiI", fine)
+    assert (version, flags, rate, spp, length) == (1, 1, 44100, 441, 150)
+    assert len(fine) == 20 + 2 * length
+    pairs = struct.unpack_from(f"<{2 * length}b", fine, 20)
+    assert pairs[2 * 10] <= -60 and pairs[2 * 10 + 1] >= 60
+    assert pairs[2 * 75] == 0 and pairs[2 * 75 + 1] == 0
+    # The coarse level is folded from the fine one and must agree with it.
+    _, _, _, spp, length = struct.unpack_from("<iIiiI", coarse)
+    assert (spp, length) == (4410, 15)
+    coarse_pairs = struct.unpack_from(f"<{2 * length}b", coarse, 20)
+    for i in range(length):
+        block = pairs[20 * i : 20 * (i + 1)]
+        assert coarse_pairs[2 * i] == min(block[0::2])
+        assert coarse_pairs[2 * i + 1] == max(block[1::2])
+
+
+def test_audio_peaks_int16(video_data):
+    (dat,) = audio_peaks(video_data, samples_per_pixel=[512], bits=16)
+    version, flags, _, spp, length = struct.unpack_from("<iIiiI", dat)
+    assert (version, flags, spp) == (1, 0, 512)
+    assert length > 0 and len(dat) == 20 + 4 * length
+
+
+def test_audio_peaks_invalid_args(video_data):
+    with pytest.raises(ValueError, match="bits"):
+        audio_peaks(video_data, bits=12)
+    with pytest.raises(ValueError, match="samples_per_pixel"):
+        audio_peaks(video_data, samples_per_pixel=[0])
+
+
+def test_audio_spectrogram_tone_peak_bin():
+    wav = _TONE_GAP_TONE
+    spec = audio_spectrogram(wav, n_fft=1024, hop_length=256, n_mels=0)
+    frames, bins = spec.shape
+    assert bins == 513
+    assert frames == 1 + -(-(66150 - 1024) // 256)
+    row = [spec[10, k] for k in range(bins)]
+    assert row.index(max(row)) == round(440 * 1024 / 44100)
+    # The zero-filled gap sits on the dB floor.
+    assert all(spec[130, k] == -100.0 for k in range(bins))
+
+
+def test_audio_spectrogram_hop_longer_than_frame():
+    # hop_length > n_fft skips the samples between frames, also across the
+    # 256-frame blocks; every frame equals the dense STFT's at that start.
+    wav = tone_wav([(440, 8.0)])
+    sparse = audio_spectrogram(wav, n_fft=16, hop_length=1024, n_mels=0, log=False)
+    dense = audio_spectrogram(wav, n_fft=16, hop_length=16, n_mels=0, log=False)
+    frames, bins = sparse.shape
+    assert frames == -(-8 * 44100 // 1024)
+    for i in range(frames):
+        assert [sparse[i, k] for k in range(bins)] == [dense[64 * i, k] for k in range(bins)]
+
+
+def test_audio_spectrogram_threads_agree_and_mel_shape(video_data):
+    one = audio_spectrogram(video_data, n_mels=40, sample_rate=16000, num_threads=1)
+    many = audio_spectrogram(video_data, n_mels=40, sample_rate=16000, num_threads=4)
+    assert one.shape[1] == 40 and one.shape[0] > 0
+    assert one.tobytes() == many.tobytes()
+
+
+def test_audio_spectrogram_image(video_data):
+    img = audio_spectrogram(video_data, n_mels=32, output="image")
+    assert img.format == "B" and img.shape[0] == 32
+    assert max(img.tobytes()) == 255
+
+
+def test_audio_spectrogram_invalid_args(video_data):
+    with pytest.raises(ValueError, match="n_fft"):
+        audio_spectrogram(video_data, n_fft=1000)
+    with pytest.raises(ValueError, match="output"):
+        audio_spectrogram(video_data, output="png")
+
+
 def test_crossfade_audio(video_data):
     wav = transcode_audio(video_data, format="wav")
     out = crossfade_audio(wav, wav, duration=0.1)
@@ -95,6 +227,76 @@ def test_crossfade_audio(video_data):
     assert out[:4] == b"RIFF"
 
 
+def _wav_frames(data):
+    with wave.open(io.BytesIO(data), "rb") as wf:
+        return wf.getnframes()
+
+
+def test_fade_audio_preserves_length(video_data):
+    wav = transcode_audio(video_data, format="wav")
+    faded = fade_audio(wav, in_sec=0.2, out_sec=0.2)
+    assert _wav_frames(faded) == _wav_frames(wav)
+
+
+def test_fade_audio_aac_output(video_data):
+    out = fade_audio(video_data, in_sec=0.1, out_sec=0.1, format="aac")
+    assert out[0] == 0xFF and (out[1] & 0xF0) == 0xF0
+
+
+def test_crossfade_audio_overlap_length(video_data):
+    wav = transcode_audio(video_data, format="wav")
+    out = crossfade_audio(wav, wav, duration=0.1)
+    n = _wav_frames(wav)
+    with wave.open(io.BytesIO(wav), "rb") as wf:
+        rate = wf.getframerate()
+    assert abs(_wav_frames(out) - (2 * n - int(0.1 * rate))) <= 1
+
+
+def test_crossfade_audio_overlap_too_small():
+    wav = tone_wav([(440, 0.5)])
+    with pytest.raises(ValueError, match="duration is too small"):
+        crossfade_audio(wav, wav, duration=1e-6)
+    with pytest.raises(ValueError, match="duration is too small"):
+        crossfade_audio(wav, tone_wav([]), duration=0.1)
+
+
+def test_crossfade_and_mix_reject_unconvertible_layout():
+    # More channels than the resampler supports (64).
+    wav = tone_wav([(440, 0.5)])
+    wide = tone_wav([(0, 0.1)], channels=65)
+    with pytest.raises(ValueError, match="matching sample rate and channels"):
+        crossfade_audio(wav, wide, duration=0.1)
+    with pytest.raises(ValueError, match="matching sample rate and channels"):
+        mix_audio([wav, wide])
+
+
+def test_mix_audio_longest_input_sets_length():
+    wav = _TONE_GAP_TONE
+    short = tone_wav([(440, 0.5)])
+    out = mix_audio([short, wav], weights=[0.5, 0.5])
+    assert out[:4] == b"RIFF"
+    assert _wav_frames(out) == _wav_frames(wav)
+    with pytest.raises(ValueError, match="at least two"):
+        mix_audio([wav])
+    with pytest.raises(ValueError, match="weights length"):
+        mix_audio([wav, wav], weights=[1.0])
+
+
+def test_audio_dsp_invalid_format(video_data):
+    with pytest.raises(ValueError, match="Unsupported format"):
+        fade_audio(video_data, in_sec=0.1, format="aiff")
+    with pytest.raises(ValueError, match="Unsupported format"):
+        silence_remove(video_data, format="aiff")
+
+
+def test_repeated_extract_reuses_resampler_state(video_data):
+    # Cached resamplers are re-armed per call: no samples leak between runs.
+    first = extract_audio(video_data, format="wav")
+    extract_audio(video_data, format="mp3")
+    second = extract_audio(video_data, format="wav")
+    assert first == second
+
+
 def test_invalid_input():
     with pytest.raises(RuntimeError):
         extract_audio(b"not a video", format="mp3")
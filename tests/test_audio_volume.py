@@ -1,6 +1,6 @@
 import pytest
 
-from pymedia import adjust_volume, get_video_info
+from pymedia import adjust_volume, analyze_loudness, get_video_info, normalize_loudness
 
 
 def test_adjust_volume_reduce(video_data):
@@ -26,3 +26,21 @@ def test_adjust_volume_silence(video_data):
 def test_adjust_volume_invalid(video_data):
     with pytest.raises(ValueError, match="factor must be >= 0"):
         adjust_volume(video_data, factor=-1.0)
+
+
+def test_normalize_loudness_keeps_video(video_data):
+    result = normalize_loudness(video_data, target_lufs=-23.0, true_peak=-1.0)
+    info = get_video_info(result)
+    assert info["has_audio"] is True
+    assert info["has_video"] is True
+    d = analyze_loudness(result)
+    assert abs(d["integrated_lufs"] - -23.0) < 2.0
+    # AAC can overshoot the limiter ceiling slightly on decode.
+    assert d["true_peak_dbtp"] <= 0.0
+
+
+def test_normalize_loudness_invalid(video_data):
+    with pytest.raises(ValueError, match="target_lufs"):
+        normalize_loudness(video_data, target_lufs=5.0)
+    with pytest.raises(ValueError, match="true_peak"):
+        normalize_loudness(video_data, true_peak=1.0)
@@ -0,0 +1,57 @@
+import pytest
+
+from pymedia import batch_map, batch_run, get_video_info
+
+
+def test_batch_map_returns_results_in_job_order(video_data):
+    jobs = [
+        ("get_video_info", video_data),
+        ("trim_video", video_data, {"start": 0.0, "end": 0.5}),
+        ("extract_audio", video_data, {"format": "mp3"}),
+        ("extract_frame", video_data, {"timestamp": 0.2, "format": "png"}),
+    ]
+    results = batch_map(jobs, num_threads=2)
+
+    assert results[0]["duration"] == pytest.approx(get_video_info(video_data)["duration"])
+    assert get_video_info(results[1])["duration"] <= 0.75
+    assert len(results[2]) > 0
+    assert results[3].startswith(b"\x89PNG")
+
+
+def test_batch_run_reports_every_index_and_failures(video_data):
+    jobs = [("mute_video", video_data)] * 6 + [("mute_video", b"not a video")]
+    seen = {}
+
+    failed = batch_run(jobs, lambda i, out: seen.__setitem__(i, out), num_threads=3)
+
+    assert failed == 1
+    assert sorted(seen) == list(range(7))
+    assert seen[6] is None
+    assert all(isinstance(seen[i], bytes) for i in range(6))
+
+
+def test_batch_run_small_memory_budget_completes(video_data):
+    jobs = [("convert_format", video_data, {"format": "mkv"})] * 8
+    seen = []
+
+    failed = batch_run(jobs, lambda i, out: seen.append(i), max_pending_bytes=1)
+
+    assert failed == 0
+    assert sorted(seen) == list(range(8))
+
+
+def test_batch_run_rejects_invalid_jobs(video_data):
+    with pytest.raises(ValueError):
+        batch_map([("no_such_op", video_data)])
+    with pytest.raises(ValueError):
+        batch_map([("trim_video", video_data, {"begin": 1.0})])
+    with pytest.raises(ValueError):
+        batch_map([("convert_format", video_data)])
+
+
+def test_batch_run_reraises_callback_errors(video_data):
+    def boom(index, result):
+        raise KeyError(index)
+
+    with pytest.raises(KeyError):
+        batch_run([("mute_video", video_data)] * 2, boom)
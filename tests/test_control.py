@@ -0,0 +1,159 @@
+import pytest
+
+from pymedia import (
+    CancelToken,
+    OperationCancelled,
+    analyze_gop,
+    batch_map,
+    compress_video,
+    concat_videos,
+    create_thumbnail,
+    extract_frame,
+    extract_subtitles,
+    get_video_info,
+    list_keyframes,
+    merge_videos,
+    normalize_loudness,
+    probe_media,
+    render_edl,
+    reverse_video,
+    silence_remove,
+    stream_copy,
+    strip_metadata,
+    trim_to_keyframes,
+)
+
+
+def test_progress_reports_increasing_source_time(video_data):
+    calls = []
+    out = compress_video(
+        video_data, crf=35, preset="ultrafast", progress=lambda d, t: calls.append((d, t))
+    )
+
+    assert len(out) > 0
+    assert calls
+    processed = [d for d, _ in calls]
+    assert processed == sorted(processed)
+    duration = get_video_info(video_data)["duration"]
+    assert calls[-1][1] == pytest.approx(duration, abs=0.1)
+    assert processed[-1] <= duration + 0.1
+
+
+@pytest.mark.parametrize(
+    "run, inputs",
+    [
+        (lambda v, **kw: concat_videos([v, v, v], **kw), 3),
+        (lambda v, **kw: merge_videos(v, v, **kw), 2),
+    ],
+)
+def test_progress_accumulates_over_inputs(video_data, run, inputs):
+    calls = []
+    run(video_data, progress=lambda d, t: calls.append((d, t)))
+
+    duration = get_video_info(video_data)["duration"]
+    assert calls[-1][1] == pytest.approx(inputs * duration, abs=0.1 * inputs)
+    processed = [d for d, _ in calls]
+    assert processed == sorted(processed)
+    # The last input's reads count from where the earlier inputs end.
+    assert processed[-1] > (inputs - 1) * duration
+
+
+def test_reverse_video_reports_encode_progress(video_data):
+    calls = []
+    reverse_video(video_data, progress=lambda d, t: calls.append((d, t)))
+
+    duration = get_video_info(video_data)["duration"]
+    assert calls[-1][1] == pytest.approx(2 * duration, abs=0.2)
+    # Decoding covers the first half; the encode pass reports the second.
+    assert calls[-1][0] > 1.5 * duration
+
+
+@pytest.mark.parametrize(
+    "run",
+    [
+        normalize_loudness,
+        silence_remove,
+        lambda v, **kw: render_edl(v, [(0.0, get_video_info(v)["duration"])], **kw),
+    ],
+)
+def test_progress_spans_every_pass(video_data, run):
+    calls = []
+    run(video_data, progress=lambda d, t: calls.append((d, t)))
+
+    duration = get_video_info(video_data)["duration"]
+    assert calls[-1][1] == pytest.approx(2 * duration, abs=0.2)
+    processed = [d for d, _ in calls]
+    assert processed == sorted(processed)
+    # The second pass counts on from where the first one ended.
+    assert processed[-1] > 1.5 * duration
+
+
+def test_cancelled_token_raises_before_work(video_data):
+    token = CancelToken()
+    token.cancel()
+    assert token.cancelled
+    with pytest.raises(OperationCancelled):
+        compress_video(video_data, crf=35, cancel=token)
+
+
+def test_cancel_during_operation(video_data):
+    token = CancelToken()
+    seen = []
+
+    def on_progress(done, total):
+        seen.append(done)
+        token.cancel()
+
+    with pytest.raises(OperationCancelled):
+        compress_video(video_data, crf=35, progress=on_progress, cancel=token)
+    assert len(seen) == 1
+
+
+def test_progress_exception_propagates(video_data):
+    def boom(done, total):
+        raise KeyError("stop")
+
+    with pytest.raises(KeyError):
+        compress_video(video_data, crf=35, progress=boom)
+
+
+def test_stats_cover_every_stage(video_data):
+    stats = {}
+    out = compress_video(video_data, crf=35, preset="ultrafast", stats=stats)
+
+    stages = stats["stages"]
+    assert set(stages) == {"demux", "decode", "scale", "resample", "encode", "mux"}
+    assert stages["demux"]["packets"] > 0
+    assert stages["demux"]["bytes_in"] <= len(video_data)
+    assert stages["decode"]["frames"] > 0
+    assert stages["encode"]["packets"] > 0
+    assert 0 < stages["mux"]["bytes_out"] <= len(out)
+    assert stats["wall_us"] >= stages["demux"]["wall_us"]
+
+
+@pytest.mark.parametrize(
+    "run",
+    [
+        get_video_info,
+        list_keyframes,
+        lambda v, **kw: extract_frame(v, timestamp=0.2, **kw),
+        create_thumbnail,
+        probe_media,
+        lambda v, **kw: stream_copy(v, output_format="mkv", **kw),
+        analyze_gop,
+        lambda v, **kw: trim_to_keyframes(v, start=0.0, end=0.5, **kw),
+        extract_subtitles,
+        strip_metadata,
+        lambda v, **kw: batch_map([("get_video_info", v)], **kw),
+    ],
+)
+def test_stats_and_cancel_on_quick_wrappers(video_data, run):
+    stats = {}
+    run(video_data, stats=stats)
+    assert stats["wall_us"] > 0
+    assert set(stats["stages"]) == {"demux", "decode", "scale", "resample", "encode", "mux"}
+
+    token = CancelToken()
+    token.cancel()
+    with pytest.raises(OperationCancelled):
+        run(video_data, cancel=token)
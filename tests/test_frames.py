@@ -1,6 +1,14 @@
 import pytest
 
-from pymedia import create_thumbnail, extract_frame, extract_frames, generate_preview
+from pymedia import (
+    create_thumbnail,
+    extract_frame,
+    extract_frame_raw,
+    extract_frames,
+    generate_preview,
+    get_video_info,
+    iter_frame_batches,
+)
 
 
 def test_extract_frame_jpeg(video_data):
@@ -26,6 +34,91 @@ def test_extract_frame_invalid_format(video_data):
         extract_frame(video_data, format="bmp")
 
 
+def test_extract_frame_keyframe_accuracy(video_data):
+    frame = extract_frame(video_data, timestamp=0.5, format="jpeg", accuracy="keyframe")
+    assert len(frame) > 0
+    assert frame[:2] == b"\xff\xd8"
+
+
+def test_extract_frame_invalid_accuracy(video_data):
+    with pytest.raises(ValueError, match="Unsupported accuracy"):
+        extract_frame(video_data, accuracy="nearest")
+
+
+def test_extract_frame_raw_rgb24(video_data):
+    info = get_video_info(video_data)
+    view = extract_frame_raw(video_data, timestamp=0.0)
+    assert view.shape == (info["height"], info["width"], 3)
+    assert view.nbytes == info["height"] * info["width"] * 3
+
+
+def test_extract_frame_raw_scaled_gray8(video_data):
+    view = extract_frame_raw(video_data, pix_fmt="gray8", width=64, height=48, scale_algo="area")
+    assert view.shape == (48, 64)
+    assert view.strides == (64, 1)
+
+
+def test_extract_frame_raw_yuv420p_keeps_aspect(video_data):
+    view = extract_frame_raw(video_data, pix_fmt="yuv420p", width=64, accuracy="keyframe")
+    height = view.shape[0] * 2 // 3
+    assert view.shape[1] == 64
+    assert height % 2 == 0
+    assert view.nbytes == 64 * height * 3 // 2
+
+
+def test_extract_frame_raw_invalid_args(video_data):
+    with pytest.raises(ValueError, match="Unsupported pixel format"):
+        extract_frame_raw(video_data, pix_fmt="bgr48")
+    with pytest.raises(ValueError, match="Unsupported scale algorithm"):
+        extract_frame_raw(video_data, scale_algo="spline")
+    with pytest.raises(ValueError, match="width must be > 0"):
+        extract_frame_raw(video_data, width=0)
+
+
+def test_iter_frame_batches_fixed_size(video_data):
+    batches = []
+    for frames, timestamps in iter_frame_batches(
+        video_data, batch_size=4, fps=5.0, width=32, height=32, num_threads=2
+    ):
+        assert frames.shape[1:] == (32, 32, 3)
+        assert frames.shape[0] == len(timestamps)
+        batches.append((frames.shape[0], timestamps))
+    assert batches
+    assert all(n == 4 for n, _ in batches[:-1])
+    assert 1 <= batches[-1][0] <= 4
+    flat = [t for _, ts in batches for t in ts]
+    assert flat == sorted(flat)
+    assert len(flat) <= int(get_video_info(video_data)["duration"] * 5.0) + 1
+
+
+def test_iter_frame_batches_matches_all_frames(video_data):
+    total = sum(
+        frames.shape[0]
+        for frames, _ in iter_frame_batches(video_data, batch_size=8, width=16, pix_fmt="gray8")
+    )
+    batched_fps = sum(
+        frames.shape[0]
+        for frames, _ in iter_frame_batches(video_data, batch_size=8, fps=2.0, width=16)
+    )
+    assert total > batched_fps > 0
+
+
+def test_iter_frame_batches_early_exit(video_data):
+    gen = iter_frame_batches(video_data, batch_size=2, width=16, height=16)
+    frames, _ = next(gen)
+    assert frames.shape == (2, 16, 16, 3)
+    gen.close()
+
+
+def test_iter_frame_batches_invalid_args(video_data):
+    with pytest.raises(ValueError, match="batch_size must be > 0"):
+        next(iter_frame_batches(video_data, batch_size=0))
+    with pytest.raises(ValueError, match="fps must be > 0"):
+        next(iter_frame_batches(video_data, fps=0))
+    with pytest.raises(ValueError, match="Unsupported pixel format"):
+        next(iter_frame_batches(video_data, pix_fmt="bgr48"))
+
+
 def test_extract_frames_default_interval(video_data):
     frames = extract_frames(video_data, interval=0.5)
     assert isinstance(frames, list)
@@ -51,6 +144,13 @@ def test_extract_frames_invalid_format(video_data):
         extract_frames(video_data, format="bmp")
 
 
+def test_extract_frames_keyframe_accuracy(video_data):
+    frames = extract_frames(video_data, interval=0.5, accuracy="keyframe")
+    assert len(frames) >= 1
+    for frame in frames:
+        assert frame[:2] == b"\xff\xd8"
+
+
 def test_create_thumbnail_jpeg(video_data):
     thumb = create_thumbnail(video_data)
     assert len(thumb) > 0
@@ -78,6 +178,13 @@ def test_generate_preview_png(video_data):
         assert frame[:4] == b"\x89PNG"
 
 
+def test_generate_preview_keyframe_accuracy(video_data):
+    previews = generate_preview(video_data, num_frames=4, accuracy="keyframe")
+    assert len(previews) == 4
+    for frame in previews:
+        assert frame[:2] == b"\xff\xd8"
+
+
 def test_generate_preview_invalid_num_frames(video_data):
     with pytest.raises(ValueError, match="num_frames must be greater than 0"):
         generate_preview(video_data, num_frames=0)
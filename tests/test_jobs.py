@@ -0,0 +1,65 @@
+import asyncio
+
+import pytest
+
+from pymedia import JobCancelledError, get_video_info, run_async, submit_job
+
+
+def test_submit_job_result_matches_sync_call(video_data):
+    job = submit_job("get_video_info", video_data)
+    assert job.result() == get_video_info(video_data)
+    assert job.poll() == "done"
+    assert job.done()
+    assert job.progress() == 1.0
+
+
+def test_job_stats(video_data):
+    job = submit_job("compress_video", video_data, crf=35)
+    out = job.result()
+    stats = job.stats()
+    assert stats["wall_us"] > 0
+    assert stats["stages"]["decode"]["frames"] > 0
+    assert 0 < stats["stages"]["mux"]["bytes_out"] <= len(out)
+
+
+def test_run_async_gathers_jobs(video_data):
+    async def main():
+        return await asyncio.gather(
+            run_async("trim_video", video_data, start=0.0, end=0.5),
+            run_async("extract_frame", video_data, timestamp=0.2, format="png"),
+            run_async("get_video_info", video_data),
+        )
+
+    trimmed, frame, info = asyncio.run(main())
+    assert get_video_info(trimmed)["duration"] <= 0.75
+    assert frame.startswith(b"\x89PNG")
+    assert info["has_video"]
+
+
+def test_cancelled_jobs_raise(video_data):
+    # Queue more jobs than there are workers so some are still waiting.
+    jobs = [submit_job("compress_video", video_data, crf=35) for _ in range(64)]
+    for job in jobs:
+        job.cancel()
+
+    states = []
+    for job in jobs:
+        try:
+            job.result()
+            states.append("done")
+        except JobCancelledError:
+            states.append("cancelled")
+    assert "cancelled" in states
+    assert all(job.poll() == state for job, state in zip(jobs, states))
+
+
+def test_failed_job_raises_runtime_error():
+    job = submit_job("mute_video", b"not a video")
+    with pytest.raises(RuntimeError):
+        job.result()
+    assert job.poll() == "failed"
+
+
+def test_submit_job_rejects_unknown_op(video_data):
+    with pytest.raises(ValueError):
+        submit_job("no_such_op", video_data)
@@ -1,3 +1,5 @@
+import pytest
+
 from pymedia import (
     analyze_gop,
     analyze_loudness,
@@ -34,6 +36,28 @@ def test_analyze_loudness(video_data):
     assert "peak_dbfs" in d
 
 
+def test_analyze_loudness_r128_metrics(video_data):
+    d = analyze_loudness(video_data)
+    for key in (
+        "integrated_lufs",
+        "momentary_max_lufs",
+        "short_term_max_lufs",
+        "loudness_range_lu",
+        "true_peak_dbtp",
+    ):
+        assert key in d
+    assert d["integrated_lufs"] <= 0.0
+    assert d["loudness_range_lu"] >= 0.0
+    # Oversampled peak can only add inter-sample overs to the sample peak.
+    assert d["true_peak_dbtp"] >= d["peak_dbfs"] - 1e-6
+    assert d["sample_rate"] > 0
+
+
+def test_analyze_loudness_no_audio():
+    with pytest.raises(RuntimeError):
+        analyze_loudness(b"not media")
+
+
 def test_analyze_gop(video_data):
     d = analyze_gop(video_data)
     assert "keyframes" in d
@@ -1,14 +1,20 @@
 import pytest
+from conftest import gray_png, tone_wav
 
 from pymedia import (
     add_subtitle_track,
     convert_subtitles,
+    create_audio_image_video,
     detect_scenes,
     extract_subtitles,
+    fingerprint_similarity,
     frame_accurate_trim,
+    get_video_info,
     list_keyframes,
     remove_subtitle_tracks,
+    render_edl,
     trim_to_keyframes,
+    video_fingerprint,
 )
 
 
@@ -37,6 +43,84 @@ def test_detect_scenes(video_data):
     assert isinstance(scenes, list)
 
 
+def test_detect_scenes_scores(video_data):
+    cuts = detect_scenes(video_data, threshold=0.01, sample_interval=0.1, return_scores=True)
+    assert isinstance(cuts, list)
+    for t, score in cuts:
+        assert t >= 0.0
+        assert 0.01 <= score <= 1.0
+    times = [t for t, _ in cuts]
+    assert times == sorted(times)
+
+
+def test_detect_scenes_default_threshold():
+    audio = tone_wav([(440, 2.0)])
+    gradient = gray_png(64, 64, lambda x, y: x * 255 // 63)
+    # Hard cut at 1 s from a horizontal gradient to flat light gray.
+    cut = create_audio_image_video(
+        audio,
+        [gradient, gray_png(64, 64, 200)],
+        seconds_per_image=1.0,
+        transition="none",
+        width=64,
+        height=64,
+    )
+    cuts = detect_scenes(cut, return_scores=True)
+    assert len(cuts) == 1
+    assert abs(cuts[0][0] - 1.0) <= 0.5
+    assert cuts[0][1] >= 0.35
+    # The same gradient held for 2 s: no cut.
+    still = create_audio_image_video(audio, [gradient], seconds_per_image=2.0, width=64, height=64)
+    assert detect_scenes(still) == []
+
+
+def test_detect_scenes_keyframes_only(video_data):
+    keys = list_keyframes(video_data)
+    cuts = detect_scenes(video_data, threshold=0.01, keyframes_only=True)
+    for t in cuts:
+        assert any(abs(t - k) < 1e-3 for k in keys)
+
+
+def test_detect_scenes_invalid_args(video_data):
+    with pytest.raises(ValueError, match="threshold must be > 0"):
+        detect_scenes(video_data, threshold=0)
+    with pytest.raises(ValueError, match="sample_interval must be > 0"):
+        detect_scenes(video_data, sample_interval=0)
+
+
+def test_video_fingerprint_layout(video_data):
+    fp = video_fingerprint(video_data, sample_interval=0.5)
+    assert fp[:4] == b"PMFP"
+    assert len(fp) > 12
+    assert (len(fp) - 12) % 8 == 0
+
+
+def test_fingerprint_similarity_self_and_trimmed(video_data):
+    fp = video_fingerprint(video_data, sample_interval=0.25, algorithm="dhash")
+    assert fingerprint_similarity(fp, fp) == pytest.approx(1.0)
+    clip = trim_to_keyframes(video_data, start=0.0, end=0.6)
+    fp_clip = video_fingerprint(clip, sample_interval=0.25, algorithm="dhash")
+    assert fingerprint_similarity(fp, fp_clip) > 0.8
+    # A horizontal gradient slideshow: every dHash bit differs from the
+    # fixture's flat frames.
+    other = create_audio_image_video(
+        video_data, [gray_png(64, 64, lambda x, y: x * 255 // 63)], width=64, height=64
+    )
+    fp_other = video_fingerprint(other, sample_interval=0.25, algorithm="dhash")
+    assert fingerprint_similarity(fp, fp_other) < 0.5
+
+
+def test_video_fingerprint_invalid_args(video_data):
+    with pytest.raises(ValueError, match="Unsupported fingerprint algorithm"):
+        video_fingerprint(video_data, algorithm="ahash")
+    with pytest.raises(ValueError, match="sample_interval must be > 0"):
+        video_fingerprint(video_data, sample_interval=0)
+    phash = video_fingerprint(video_data)
+    dhash = video_fingerprint(video_data, algorithm="dhash")
+    with pytest.raises(ValueError, match="different algorithm"):
+        fingerprint_similarity(phash, dhash)
+
+
 def test_trim_to_keyframes(video_data):
     clip = trim_to_keyframes(video_data, start=0.1, end=0.6)
     assert len(clip) > 0
@@ -47,6 +131,99 @@ def test_frame_accurate_trim(video_data):
     assert len(clip) > 0
 
 
+def test_frame_accurate_trim_duration_and_streams(video_data):
+    clip = frame_accurate_trim(video_data, start=0.2, end=0.7)
+    info = get_video_info(clip)
+    assert info["has_video"]
+    assert info["has_audio"]
+    assert info["video_codec"] == "h264"
+    assert abs(info["duration"] - 0.5) < 0.1
+
+
+def test_frame_accurate_trim_to_end(video_data):
+    src = get_video_info(video_data)
+    clip = frame_accurate_trim(video_data, start=0.3, end=src["duration"] + 5.0)
+    info = get_video_info(clip)
+    assert info["has_video"]
+    assert abs(info["duration"] - (src["duration"] - 0.3)) < 0.15
+
+
+def _mean_diff(a, b):
+    return sum(abs(x - y) for x, y in zip(a, b)) / len(a)
+
+
+def test_frame_accurate_trim_frames_and_copied_gop(
+    h264_multi_gop_video, decode_frames, video_samples
+):
+    src = h264_multi_gop_video
+    src_frames = decode_frames(src)
+    keys = list_keyframes(src)
+    # Start on the first second's second image, end inside the last GOP.
+    start = next(t for t, _ in src_frames if t >= 0.7)
+    end = next(t for t, _ in src_frames if t >= 2.3)
+    k1 = min(k for k in keys if k > start)
+    k2 = max(k for k in keys if k <= end)
+    assert k1 < k2
+
+    clip = frame_accurate_trim(src, start=start, end=end)
+    # In-band parameter-set switches: the sample entry is avc3, not avc1.
+    assert b"avc3" in clip
+
+    # Every frame of [start, end) decodes, the first one being the frame at
+    # `start` rather than the keyframe before it.
+    wanted = [f for t, f in src_frames if start - 1e-3 <= t < end - 1e-3]
+    out = decode_frames(clip)
+    assert len(out) == len(wanted)
+    assert out[0][0] == pytest.approx(0.0, abs=0.02)
+    assert _mean_diff(out[0][1], wanted[0]) < 4
+    assert _mean_diff(out[0][1], src_frames[0][1]) > 20
+
+    # [k1, k2) is stream-copied: the source packets come through unchanged,
+    # the first one behind the re-sent source SPS/PPS.
+    src_samples = video_samples(src)
+    sync = [i for i, (_, is_sync) in enumerate(src_samples) if is_sync]
+    copied = [d for d, _ in src_samples[sync[keys.index(k1)] : sync[keys.index(k2)]]]
+    out_samples = [d for d, _ in video_samples(clip)]
+    at = next(i for i, d in enumerate(out_samples) if d.endswith(copied[0]))
+    assert out_samples[at + 1 : at + len(copied)] == copied[1:]
+
+
+def test_render_edl_joins_ranges(video_data):
+    clip = render_edl(video_data, [(0.1, 0.3), (0.5, 0.8), (0.2, 0.4)])
+    info = get_video_info(clip)
+    assert info["has_video"]
+    assert info["has_audio"]
+    assert abs(info["duration"] - 0.7) < 0.15
+
+
+def test_render_edl_single_range_matches_trim(video_data):
+    clip = render_edl(video_data, [(0.2, 0.7)])
+    ref = frame_accurate_trim(video_data, start=0.2, end=0.7)
+    assert abs(get_video_info(clip)["duration"] - get_video_info(ref)["duration"]) < 1e-3
+
+
+def test_render_edl_copy_after_encoded_tail_decodes(multi_gop_video, decode_frames):
+    # The first range ends in an encoded tail (in-band encoder SPS/PPS); the
+    # second starts on the 2 s keyframe and is stream-copied, so it must be
+    # decoded against the source parameter sets again.
+    assert any(abs(k - 2.0) < 1e-3 for k in list_keyframes(multi_gop_video))
+    src = decode_frames(multi_gop_video)
+    clip = render_edl(multi_gop_video, [(0.3, 1.5), (2.0, 10.0)])
+    out = decode_frames(clip)
+
+    head = [f for t, f in src if 0.3 - 1e-3 <= t < 1.5 - 1e-3]
+    copied = [f for t, f in src if t >= 2.0 - 1e-3]
+    assert len(out) == len(head) + len(copied)
+    assert [f for _, f in out[len(head) :]] == copied
+
+
+def test_render_edl_invalid_ranges(video_data):
+    with pytest.raises(ValueError):
+        render_edl(video_data, [])
+    with pytest.raises(ValueError):
+        render_edl(video_data, [(0.5, 0.2)])
+
+
 def test_convert_subtitles_invalid_pair():
     with pytest.raises(ValueError):
         convert_subtitles("abc", src="srt", dst="ass")
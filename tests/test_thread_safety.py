@@ -0,0 +1,89 @@
+import threading
+from concurrent.futures import ThreadPoolExecutor
+
+import pytest
+
+from pymedia import (
+    adjust_volume,
+    analyze_loudness,
+    audio_peaks,
+    batch_map,
+    compress_video,
+    convert_format,
+    detect_scenes,
+    extract_audio,
+    extract_frame_raw,
+    frame_accurate_trim,
+    get_video_info,
+    list_keyframes,
+    mute_video,
+    trim_video,
+)
+
+NUM_THREADS = 64
+
+
+def _duration(data):
+    return round(get_video_info(data)["duration"], 1)
+
+
+# name -> (call, summary compared against a serial run)
+OPERATIONS = {
+    "get_video_info": (get_video_info, lambda out: out),
+    "list_keyframes": (list_keyframes, lambda out: out),
+    "detect_scenes": (lambda d: detect_scenes(d, threshold=0.2, sample_interval=0.2), list),
+    "analyze_loudness": (analyze_loudness, lambda out: out),
+    "audio_peaks": (lambda d: audio_peaks(d, bits=16), lambda out: out),
+    "extract_frame_raw": (lambda d: extract_frame_raw(d, timestamp=0.0), bytes),
+    "extract_audio": (lambda d: extract_audio(d, format="wav"), len),
+    "adjust_volume": (lambda d: adjust_volume(d, factor=0.5), len),
+    "mute_video": (mute_video, lambda out: get_video_info(out)["has_audio"]),
+    "trim_video": (lambda d: trim_video(d, start=0.0, end=0.5), _duration),
+    "convert_format": (lambda d: convert_format(d, format="matroska"), _duration),
+    "compress_video": (lambda d: compress_video(d, crf=35, preset="ultrafast"), _duration),
+    "frame_accurate_trim": (lambda d: frame_accurate_trim(d, start=0.1, end=0.6), _duration),
+    "batch_map": (
+        lambda d: batch_map([("mute_video", d), ("get_video_info", d)], num_threads=2),
+        lambda out: (len(out), out[1]),
+    ),
+}
+
+
+@pytest.fixture(scope="module")
+def serial_results(video_data):
+    return {name: summary(call(video_data)) for name, (call, summary) in OPERATIONS.items()}
+
+
+def test_all_operations_from_64_threads(video_data, serial_results):
+    names = list(OPERATIONS)
+    start = threading.Barrier(NUM_THREADS)
+
+    def worker(slot):
+        start.wait()
+        mismatches = []
+        # Rotate the order so different operations overlap in time.
+        for name in names[slot % len(names) :] + names[: slot % len(names)]:
+            call, summary = OPERATIONS[name]
+            if summary(call(video_data)) != serial_results[name]:
+                mismatches.append(name)
+        return mismatches
+
+    with ThreadPoolExecutor(max_workers=NUM_THREADS) as pool:
+        results = list(pool.map(worker, range(NUM_THREADS)))
+
+    assert [m for m in results if m] == []
+
+
+def test_default_format_remux_from_many_threads(video_data):
+    # trim_video/mute_video derive the output muxer name from the input;
+    # that name used to live in a static buffer shared by all calls.
+    start = threading.Barrier(NUM_THREADS)
+
+    def worker(_):
+        start.wait()
+        return trim_video(video_data, start=0.0, end=0.5)[4:8]
+
+    with ThreadPoolExecutor(max_workers=NUM_THREADS) as pool:
+        boxes = set(pool.map(worker, range(NUM_THREADS)))
+
+    assert boxes == {b"ftyp"}
@@ -1,12 +1,20 @@
+import io
+import struct
+import wave
+
 import pytest
+from conftest import tone_wav
 
 from pymedia import (
     change_speed,
     concat_videos,
     get_video_info,
     merge_videos,
+    resize_video,
     reverse_video,
     rotate_video,
+    transcode_audio,
+    trim_video,
 )
 
 
@@ -57,6 +65,32 @@ def test_change_speed_slower(video_data):
     assert info["duration"] > original["duration"] * 0.9
 
 
+def _dominant_freq(wav_bytes):
+    with wave.open(io.BytesIO(wav_bytes), "rb") as wf:
+        rate, channels = wf.getframerate(), wf.getnchannels()
+        frames = wf.readframes(wf.getnframes())
+    pcm = struct.unpack(f"<{len(frames) // 2}h", frames)[::channels]
+    body = pcm[len(pcm) // 5 : -len(pcm) // 5]
+    crossings = sum(1 for a, b in zip(body, body[1:]) if (a < 0) != (b < 0))
+    return crossings / 2 / (len(body) / rate), len(pcm) / rate
+
+
+@pytest.mark.parametrize("speed", [2.0, 0.5])
+def test_change_speed_keeps_audio_pitch(speed):
+    out = change_speed(tone_wav([(440, 1.0)]), speed=speed)
+    freq, duration = _dominant_freq(transcode_audio(out, format="wav"))
+    assert abs(freq - 440.0) < 440.0 * 0.03
+    assert abs(duration - 1.0 / speed) < 0.1
+
+
+def test_change_speed_audio_follows_video(video_data):
+    result = change_speed(video_data, speed=2.0)
+    info = get_video_info(result)
+    original = get_video_info(video_data)
+    assert info["has_audio"] and info["has_video"]
+    assert abs(info["duration"] - original["duration"] / 2) < 0.15
+
+
 def test_change_speed_invalid(video_data):
     with pytest.raises(ValueError, match="speed must be greater than 0"):
         change_speed(video_data, speed=0)
@@ -78,6 +112,39 @@ def test_concat_videos(video_data):
     assert info["duration"] > original["duration"] * 2.2
 
 
+def test_concat_videos_many_inputs_duration(video_data):
+    original = get_video_info(video_data)
+    merged = concat_videos([video_data] * 5)
+    info = get_video_info(merged)
+    assert abs(info["duration"] - original["duration"] * 5) < original["duration"] * 0.2
+    assert info["has_audio"] is True
+
+
+def test_concat_videos_reencodes_mismatched_input(video_data):
+    original = get_video_info(video_data)
+    small = resize_video(
+        video_data, width=original["width"] // 4 * 2, height=original["height"] // 4 * 2
+    )
+    merged = concat_videos([video_data, small, video_data])
+    info = get_video_info(merged)
+    assert info["width"] == original["width"]
+    assert info["height"] == original["height"]
+    assert info["duration"] > original["duration"] * 2.5
+
+
+def test_concat_videos_drops_input_start_offset(multi_gop_video, decode_frames):
+    # The remux keeps the 1 s keyframe 0.09 s after the cut: the clip starts late.
+    shifted = trim_video(multi_gop_video, start=0.91, end=3.0)
+    source = decode_frames(shifted)
+    assert source[0][0] > 0.05
+    frames = decode_frames(concat_videos([shifted, shifted]))
+    assert len(frames) == 2 * len(source)
+    times = [t for t, _ in frames]
+    assert times[0] < 0.01
+    step = source[1][0] - source[0][0]
+    assert all(b - a < 1.5 * step for a, b in zip(times, times[1:]))
+
+
 def test_concat_videos_invalid(video_data):
     with pytest.raises(ValueError, match="at least two"):
         concat_videos([video_data])
@@ -1,4 +1,8 @@
+import io
+import wave
+
 import pytest
+from conftest import tone_wav
 
 from pymedia import (
     add_watermark,
@@ -9,9 +13,11 @@ from pymedia import (
     create_audio_image_video,
     crop_video,
     cut_video,
+    extract_audio,
     extract_frame,
     flip_video,
     get_video_info,
+    list_keyframes,
     mix_audio_tracks,
     mute_video,
     pad_video,
@@ -171,6 +177,33 @@ def test_compress_video(video_data):
     assert len(compressed) > 0
 
 
+def test_compress_video_parallel_segments(multi_gop_video, decode_frames):
+    original = get_video_info(multi_gop_video)
+    compressed = compress_video(multi_gop_video, crf=35, preset="ultrafast", segments=3)
+    info = get_video_info(compressed)
+    assert info["width"] == original["width"]
+    assert info["has_audio"] == original["has_audio"]
+    assert abs(info["duration"] - original["duration"]) < 0.2
+    assert len(decode_frames(compressed)) == len(decode_frames(multi_gop_video))
+
+    # Each segment is its own encode and starts with an IDR on a source
+    # keyframe; one encoder over the flat fixture places only the first.
+    boundaries = list_keyframes(multi_gop_video)[1:]
+    assert len(boundaries) == 2
+
+    def has_key(data, t):
+        return any(abs(k - t) < 1e-3 for k in list_keyframes(data))
+
+    assert all(has_key(compressed, t) for t in boundaries)
+    single = compress_video(multi_gop_video, crf=35, preset="ultrafast")
+    assert not any(has_key(single, t) for t in boundaries)
+
+
+def test_compress_video_invalid_segments(video_data):
+    with pytest.raises(ValueError):
+        compress_video(video_data, segments=-1)
+
+
 # ── Resize ──
 
 
@@ -238,6 +271,46 @@ def test_mix_audio_tracks(video_data):
     assert info["has_audio"] is True
 
 
+def test_mix_audio_tracks_envelope_and_ducking(video_data):
+    mixed = mix_audio_tracks(
+        video_data,
+        [video_data],
+        envelopes=[None, [(0.0, 0.0), (1.0, 1.0)]],
+        duck_track=0,
+        duck_db=-18.0,
+    )
+    info = get_video_info(mixed)
+    assert info["has_video"] is True
+    assert info["has_audio"] is True
+    assert abs(info["duration"] - get_video_info(video_data)["duration"]) < 0.5
+
+
+def _audio_seconds(data):
+    with wave.open(io.BytesIO(extract_audio(data, format="wav")), "rb") as wf:
+        return wf.getnframes() / wf.getframerate()
+
+
+@pytest.mark.parametrize("audio_seconds", [0.4, 3.0])
+def test_mix_audio_tracks_length_follows_video_stream(video_data, decode_frames, audio_seconds):
+    # Base videos whose own audio is shorter / longer than their video stream.
+    base = replace_audio(video_data, tone_wav([(440, audio_seconds)]), trim=False)
+    assert abs(_audio_seconds(base) - audio_seconds) < 0.1
+    frames = decode_frames(video_data)
+    video_seconds = len(frames) / get_video_info(video_data)["fps"]
+    mixed = mix_audio_tracks(base, [tone_wav([(440, 2.0)])])
+    assert abs(_audio_seconds(mixed) - video_seconds) < 0.06
+    assert len(decode_frames(mixed)) == len(frames)
+
+
+def test_mix_audio_tracks_invalid(video_data):
+    with pytest.raises(ValueError, match="envelopes length"):
+        mix_audio_tracks(video_data, [video_data], envelopes=[None])
+    with pytest.raises(ValueError, match="non-decreasing"):
+        mix_audio_tracks(video_data, [video_data], envelopes=[[(1.0, 1.0), (0.5, 0.0)], None])
+    with pytest.raises(ValueError, match="duck_track"):
+        mix_audio_tracks(video_data, [video_data], duck_track=2)
+
+
 def test_transcode_video(video_data):
     out = transcode_video(video_data, vcodec="h264", acodec="copy", crf=28, preset="fast")
     assert len(out) > 0